@@ -0,0 +1,34 @@
+/*
+ * composite_printer.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_COMPOSITE_PRINTER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_COMPOSITE_PRINTER_H_
+
+
+#include "printer.h"
+
+
+/**
+ * Create a Printer that forwards everything that is printed to several
+ * other Printers so that a single pass through a resource can write it
+ * in more than one format.
+ *
+ * When the Printer is opened, each of the Printers opens its own file
+ * using the given filename with its extension replaced by that Printer's
+ * extension. The Printer's pr_out_f is the file of the first Printer.
+ * It only supports writing single documents if all of the Printers do.
+ *
+ * @param printers_pp The Printers to forward to. If the Printer is created
+ * successfully, it takes ownership of these and will free them when it is freed.
+ * @param extensions_ss The file extension for each of the Printers.
+ * @param num_printers The number of Printers.
+ * @return The new Printer or <code>NULL</code> upon error.
+ */
+Printer *AllocateCompositePrinter (Printer **printers_pp, const char **extensions_ss, const size_t num_printers);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_COMPOSITE_PRINTER_H_ */
@@ -0,0 +1,104 @@
+/*
+ * csv_reader.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_CSV_READER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_CSV_READER_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+
+/**
+ * The function called for each row of a CSV file.
+ *
+ * @param data_p The custom data for the rows.
+ * @param row The number of the row, starting from 1, or 0 for the header row.
+ * @param values_ss The values of the row. These, and the array itself, are only valid
+ * until the function returns.
+ * @param num_values The number of values in the row.
+ * @return <code>true</code> to carry on reading, <code>false</code> to stop.
+ */
+typedef bool (*CSVRowCallback) (void *data_p, const size_t row, char **values_ss, const size_t num_values);
+
+
+/**
+ * The functions used to process the chunks of rows that a CSV file is split into
+ * so that they can be parsed on several threads.
+ */
+typedef struct CSVChunkFunctions
+{
+	/**
+	 * Called for each row of a chunk, which may be on a worker thread. The data
+	 * is the chunk's and the row numbers start from 1 for each chunk.
+	 */
+	CSVRowCallback cf_row_fn;
+
+	/**
+	 * If this is not <code>NULL</code>, it is called with the chunk's data and
+	 * number of rows, on the same thread, once all of the chunk's rows have been read.
+	 */
+	void (*cf_end_fn) (void *chunk_data_p, const size_t num_rows);
+
+	/**
+	 * Called on the calling thread for each of the chunks in the order that they
+	 * are in the file. It is passed the custom data for the whole file, the chunk's
+	 * data and the number of rows before the chunk. It must reset the chunk's data
+	 * so that it can be used for another chunk and return <code>false</code> to stop
+	 * reading the file.
+	 */
+	bool (*cf_merge_fn) (void *data_p, void *chunk_data_p, const size_t first_row, const size_t num_rows);
+
+	/** Called to discard the rows of a chunk that needs to be parsed again. */
+	void (*cf_reset_fn) (void *chunk_data_p);
+} CSVChunkFunctions;
+
+
+/**
+ * Check whether a tabular-data-resource has its data in external
+ * files given by its path rather than inline data.
+ *
+ * @param resource_p The resource to check.
+ * @return <code>true</code> if the resource has a path and no inline data,
+ * <code>false</code> otherwise.
+ */
+bool IsPathBasedResource (const json_t *resource_p);
+
+
+/**
+ * Read the CSV data for a tabular-data-resource from the file, or files if
+ * it is split into several parts, given by its path.
+ *
+ * Local files are memory-mapped and split into byte ranges that are parsed
+ * on a pool of threads. As a range can start part of the way through a row,
+ * each one speculatively starts after its first new line, and then when the
+ * chunks are merged in order this is checked against where the previous chunk
+ * actually finished. If a range started within a quoted value, it is parsed
+ * again from the right place. Files with a URL are parsed as they are downloaded
+ * and split into chunks of rows on the calling thread. Only a limited number of
+ * chunks are held at once so the memory used doesn't depend upon the size of the data.
+ *
+ * The resource's dialect is used for the delimiter, quote character and whether
+ * there is a header row. If there is, only the header row of the first part is
+ * passed to header_fn and this is done before any chunks are read.
+ *
+ * @param resource_p The resource to read the data for.
+ * @param package_file_s The filename of the data package. Relative paths are
+ * resolved against the directory containing it.
+ * @param header_fn The function to call with data_p for the header row.
+ * @param functions_p The functions to process the chunks of rows.
+ * @param chunks_pp The data for each of the chunks that can be held at once.
+ * @param num_chunks The number of entries in chunks_pp.
+ * @param num_threads The number of threads to parse the chunks with.
+ * @param data_p The custom data to pass to header_fn and the merge function.
+ * @return <code>true</code> if all of the data was read successfully,
+ * <code>false</code> if there was an error or one of the functions stopped the reading.
+ */
+bool ReadCSVResource (const json_t *resource_p, const char *package_file_s, CSVRowCallback header_fn, const CSVChunkFunctions *functions_p, void **chunks_pp, const size_t num_chunks, const size_t num_threads, void *data_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_CSV_READER_H_ */
@@ -0,0 +1,80 @@
+/*
+ * csv_writer.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_CSV_WRITER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_CSV_WRITER_H_
+
+#include <stdio.h>
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "output_sink.h"
+
+
+/**
+ * Write the inline data of a tabular-data-resource to a CSV file.
+ *
+ * @param filename_s The file to write to.
+ * @param col_sep_s The separator to use between columns.
+ * @param row_sep_s The separator to use between rows.
+ * @param headers_p The JSON array of fields from the resource's schema.
+ * @param data_p The JSON array of rows.
+ * @return <code>true</code> if the file was written successfully, <code>false</code> otherwise.
+ */
+bool CreateCSVFile (const char *filename_s, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p);
+
+
+/**
+ * Write the inline data of a tabular-data-resource to an OutputSink
+ * and flush it.
+ *
+ * @param sink_p The OutputSink to write to.
+ * @param col_sep_s The separator to use between columns.
+ * @param row_sep_s The separator to use between rows.
+ * @param headers_p The JSON array of fields from the resource's schema.
+ * @param data_p The JSON array of rows.
+ * @return <code>true</code> if the data was written successfully, <code>false</code> otherwise.
+ */
+bool CreateCSVOutput (OutputSink *sink_p, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p);
+
+
+/**
+ * Write the inline data of a tabular-data-resource to an already open file.
+ *
+ * @param csv_f The file to write to.
+ * @param col_sep_s The separator to use between columns.
+ * @param row_sep_s The separator to use between rows.
+ * @param headers_p The JSON array of fields from the resource's schema.
+ * @param data_p The JSON array of rows.
+ * @return <code>true</code> if the data was written successfully, <code>false</code> otherwise.
+ */
+bool WriteCSVData (FILE *csv_f, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p);
+
+
+/**
+ * Write the data of a tabular-data-resource that is in external CSV files,
+ * given by its path, to an already open file in the same layout as WriteCSVData ().
+ * The data is streamed rather than being loaded and large local files are parsed
+ * in chunks on several threads, with the rows still written in their original order.
+ *
+ * @param csv_f The file to write to.
+ * @param col_sep_s The separator to use between columns.
+ * @param row_sep_s The separator to use between rows.
+ * @param headers_p The JSON array of fields from the resource's schema. If the
+ * input has a header row, its columns are matched to these by name.
+ * @param resource_p The tabular-data-resource.
+ * @param package_file_s The filename of the data package that relative paths are resolved against.
+ * @param num_threads The number of threads to parse the data with.
+ * @param num_rows_p If this is not <code>NULL</code>, the number of rows written will be stored here.
+ * @return <code>true</code> if the data was written successfully, <code>false</code> otherwise.
+ */
+bool WriteCSVResourceData (FILE *csv_f, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *resource_p, const char *package_file_s, const size_t num_threads, size_t *num_rows_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_CSV_WRITER_H_ */
@@ -0,0 +1,241 @@
+/*
+ * fd_renderer.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_FD_RENDERER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_FD_RENDERER_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "schema_cache.h"
+#include "tool_stats.h"
+#include "output_sink.h"
+#include "output_directory.h"
+
+
+/**
+ * The formats that the resources with a schema can be written in.
+ */
+typedef enum
+{
+	PRINTER_FORMAT_HTML,
+	PRINTER_FORMAT_MARKDOWN,
+	PRINTER_FORMAT_JSON,
+
+	/** All of the resources are written to a single JSON Lines file */
+	PRINTER_FORMAT_NDJSON,
+
+	/** The files are written using FDRenderOptions::ro_template_filename_s */
+	PRINTER_FORMAT_TEMPLATE,
+
+	PRINTER_FORMAT_NUM_FORMATS
+} PrinterFormat;
+
+
+/**
+ * The options for how an FDRenderer writes the resources of
+ * data packages. These are the same as the tool's command
+ * line arguments.
+ */
+typedef struct FDRenderOptions
+{
+	/**
+	 * The formats to write each resource with a schema in. If there is more
+	 * than one, each resource is only traversed once with each format
+	 * written to its own file.
+	 */
+	const PrinterFormat *ro_formats_p;
+	size_t ro_num_formats;
+
+	/** The template file for PRINTER_FORMAT_TEMPLATE */
+	const char *ro_template_filename_s;
+
+	/** The format for tabular data resources, currently only "csv" */
+	const char *ro_table_format_s;
+
+	/** Write the properties in markdown files as tables rather than lists */
+	bool ro_md_tables_flag;
+
+	/** Write all of the properties even when their values are empty */
+	bool ro_full_flag;
+
+	bool ro_debug_flag;
+
+	/**
+	 * The limits for embedded JSON values, see SetFDPrinterJSONLimits ().
+	 * A value of 0 means there is no limit.
+	 */
+	size_t ro_json_max_size;
+	size_t ro_json_collapse_size;
+
+	/**
+	 * Keep a manifest of digests in the output directory and only regenerate
+	 * the output files for resources that have changed.
+	 */
+	bool ro_incremental_flag;
+
+	/**
+	 * Write all of the resources into a single document and, if ro_page_size
+	 * is non-zero, split it into pages of about that many bytes.
+	 */
+	bool ro_single_page_flag;
+	size_t ro_page_size;
+
+	/** The number of threads to parse large external CSV files with */
+	size_t ro_num_jobs;
+
+	/**
+	 * The number of levels of subdirectories, up to OD_MAX_SHARD_DEPTH, to
+	 * split each resource's files between using a hash of their names. If
+	 * this is 0, all of the files are written to the output directory.
+	 */
+	uint32 ro_shard_depth;
+
+	/**
+	 * Write an index, .grassroots_fd_files.json, to the output directory
+	 * listing the files that were written for each resource.
+	 */
+	bool ro_file_index_flag;
+
+	/**
+	 * How the output files are flushed to disk. The default,
+	 * OD_DURABILITY_NONE, leaves it to the operating system.
+	 */
+	OutputDurability ro_durability;
+} FDRenderOptions;
+
+
+/**
+ * An FDRenderer writes the resources of data packages using a given
+ * set of options. It has its own printers so it must only be used by
+ * one thread at a time, but any number of FDRenderers can be used at
+ * once and they can share a SchemaCache so each schema is only fetched
+ * and parsed once between them.
+ */
+typedef struct FDRenderer FDRenderer;
+
+
+/**
+ * Set the options to their defaults, which is to write html files
+ * for the resources with a schema and csv files for tabular data.
+ *
+ * @param options_p The options to set.
+ */
+void InitFDRenderOptions (FDRenderOptions *options_p);
+
+
+/**
+ * Allocate an FDRenderer.
+ *
+ * @param options_p The options to use. These are copied apart from the strings
+ * and the formats which must stay valid for the life of the FDRenderer.
+ * @param schema_cache_p The SchemaCache to use. This can be shared with other
+ * FDRenderers and must be freed after them. If this is <code>NULL</code>, the
+ * FDRenderer has its own one.
+ * @return The new FDRenderer or <code>NULL</code> upon error, such as the
+ * options not being valid together.
+ */
+FDRenderer *AllocateFDRenderer (const FDRenderOptions *options_p, SchemaCache *schema_cache_p);
+
+
+void FreeFDRenderer (FDRenderer *renderer_p);
+
+
+/**
+ * Collect the timings and counters for each of the resources that are written.
+ * The ToolStats aren't thread-safe so they can only be used by one FDRenderer
+ * at a time.
+ *
+ * @param renderer_p The FDRenderer.
+ * @param stats_p The ToolStats to add to or <code>NULL</code> to stop collecting them.
+ */
+void SetFDRendererStats (FDRenderer *renderer_p, ToolStats *stats_p);
+
+
+/**
+ * Write the output to OutputSinks rather than to files in the output directory.
+ * The filenames are worked out in the same way and get_sink_fn is called with
+ * each one, so with several data formats there is a call for each format, and
+ * the OutputSink is flushed once the output has been written to it. Incremental
+ * builds are not used when writing to OutputSinks.
+ *
+ * @param renderer_p The FDRenderer.
+ * @param get_sink_fn The function to get the OutputSink for each output file or
+ * <code>NULL</code> to write to files again.
+ * @param get_sink_data_p The custom data to pass to get_sink_fn.
+ */
+void SetFDRendererOutputSinks (FDRenderer *renderer_p, GetOutputSinkFn get_sink_fn, void *get_sink_data_p);
+
+
+/**
+ * Get the file extensions of the data formats.
+ *
+ * @param renderer_p The FDRenderer.
+ * @return The extensions separated by commas, e.g. "html,md".
+ */
+const char *GetFDRendererExtensions (const FDRenderer *renderer_p);
+
+
+/**
+ * Load a data package and write its resources.
+ *
+ * @param renderer_p The FDRenderer.
+ * @param fd_file_s The data package's filename.
+ * @param out_dir_s The directory to write the files to.
+ * @param outputs_p If this is not <code>NULL</code>, the filenames of
+ * the files that were written are appended to this array.
+ * @return <code>true</code> if the data package was loaded and its resources
+ * were written, <code>false</code> otherwise.
+ */
+bool RenderFDPackageFile (FDRenderer *renderer_p, const char *fd_file_s, const char *out_dir_s, json_t *outputs_p);
+
+
+/**
+ * Write the resources of a data package that has already been loaded.
+ *
+ * @param renderer_p The FDRenderer.
+ * @param fd_p The data package.
+ * @param fd_file_s The filename to use for the data package. Any relative
+ * paths to CSV files are resolved against its directory and files that
+ * have all of the resources are named after it.
+ * @param out_dir_s The directory to write the files to.
+ * @param outputs_p If this is not <code>NULL</code>, the filenames of
+ * the files that were written are appended to this array.
+ * @return <code>true</code> if the resources were written, <code>false</code>
+ * otherwise.
+ */
+bool RenderFDPackage (FDRenderer *renderer_p, const json_t *fd_p, const char *fd_file_s, const char *out_dir_s, json_t *outputs_p);
+
+
+/**
+ * Keep running and, each time that the data package file is modified,
+ * regenerate the files for the resources that have been added or changed
+ * since the file was last rendered.
+ *
+ * @param renderer_p The FDRenderer.
+ * @param fd_file_s The data package's filename, which should already have
+ * been rendered with RenderFDPackageFile ().
+ * @param out_dir_s The directory to write the files to.
+ * @return <code>false</code> if the file could not be watched, otherwise
+ * this only returns once watching the file fails.
+ */
+bool WatchFDPackageFile (FDRenderer *renderer_p, const char *fd_file_s, const char *out_dir_s);
+
+
+/**
+ * Get the version of the library. This is part of the digests
+ * used for incremental builds.
+ *
+ * @param major_p The major version number.
+ * @param minor_p The minor version number.
+ * @param rev_p The revision number.
+ */
+void GetFDRendererVersion (uint32 *major_p, uint32 *minor_p, uint32 *rev_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_FD_RENDERER_H_ */
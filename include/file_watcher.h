@@ -0,0 +1,44 @@
+/*
+ * file_watcher.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_FILE_WATCHER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_FILE_WATCHER_H_
+
+#include "typedefs.h"
+
+
+/**
+ * A FileWatcher waits for a file to be modified. On Linux this uses
+ * inotify and on other platforms it polls the file's modification time.
+ */
+typedef struct FileWatcher FileWatcher;
+
+
+/**
+ * Start watching a file.
+ *
+ * @param filename_s The file to watch.
+ * @return The new FileWatcher or <code>NULL</code> upon error.
+ */
+FileWatcher *AllocateFileWatcher (const char *filename_s);
+
+
+void FreeFileWatcher (FileWatcher *watcher_p);
+
+
+/**
+ * Block until the watched file has been changed. Bursts of changes, such
+ * as an editor writing a file in several steps, are reported as one change.
+ *
+ * @param watcher_p The FileWatcher.
+ * @return <code>true</code> if the file was changed, <code>false</code> if
+ * there was an error and watching should stop.
+ */
+bool WaitForFileChange (FileWatcher *watcher_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_FILE_WATCHER_H_ */
@@ -0,0 +1,53 @@
+/*
+ * html_escape.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_HTML_ESCAPE_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_HTML_ESCAPE_H_
+
+#include <stdio.h>
+
+#include "typedefs.h"
+
+
+/**
+ * Where in an HTML document a value is being written.
+ */
+typedef enum
+{
+	/** Element content, where &amp;, &lt; and &gt; need escaping */
+	HE_TEXT,
+
+	/** A quoted attribute value, such as an href, where quotes need escaping too */
+	HE_ATTRIBUTE
+} HTMLEscapeContext;
+
+
+/**
+ * Write a value with any characters that are special in the given context
+ * replaced by their character references. The value is scanned several bytes
+ * at a time and the runs of characters that don't need escaping are written
+ * in single calls.
+ *
+ * @param out_f The FILE to write to.
+ * @param value_s The value to write.
+ * @param length The number of bytes of value_s to write.
+ * @param context The context that the value is being written in.
+ * @return <code>true</code> if the value was written successfully,
+ * <code>false</code> otherwise.
+ */
+bool WriteEscapedHTML (FILE *out_f, const char *value_s, const size_t length, const HTMLEscapeContext context);
+
+
+/**
+ * Write a NULL-terminated value with any special characters escaped.
+ *
+ * @see WriteEscapedHTML
+ */
+bool WriteEscapedHTMLString (FILE *out_f, const char *value_s, const HTMLEscapeContext context);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_HTML_ESCAPE_H_ */
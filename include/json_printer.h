@@ -0,0 +1,28 @@
+/*
+ * json_printer.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_JSON_PRINTER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_JSON_PRINTER_H_
+
+
+#include "printer.h"
+
+
+/**
+ * Create a Printer that writes each resource as a single line of JSON
+ * so that the output can be read as JSON Lines (NDJSON). The values are
+ * written straight to the output file as they are printed rather than
+ * building a JSON document in memory first. Each line has the form
+ *
+ * {"name": <title>, "properties": { <key>: <value>, <section>: [ { ... } ] }, "footer": <text>}
+ *
+ * @return The new Printer or <code>NULL</code> upon error.
+ */
+Printer *AllocateJSONPrinter (void);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_JSON_PRINTER_H_ */
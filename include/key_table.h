@@ -0,0 +1,85 @@
+/*
+ * key_table.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_KEY_TABLE_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_KEY_TABLE_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+
+/**
+ * The ID of a key in a KeyTable.
+ */
+typedef uint32 KeyID;
+
+
+/**
+ * The keys that every KeyTable starts with, so that their
+ * IDs are known without having to look them up.
+ */
+typedef enum
+{
+	KI_NAME,
+	KI_TITLE,
+	KI_PROFILE,
+	KI_SCHEMA,
+	KI_DATA,
+	KI_RESOURCES,
+	KI_FIELDS,
+	KI_TYPE,
+	KI_FORMAT,
+	KI_NUM_PREDEFINED_KEYS
+} PredefinedKey;
+
+
+/**
+ * A KeyTable interns the property names from schemas and data so that
+ * each distinct name has a single copy and a stable ID. Once a key has
+ * been interned, checking whether it is a particular key is just a
+ * comparison of their IDs rather than of the strings.
+ *
+ * A KeyTable can be used by several threads at once.
+ */
+typedef struct KeyTable KeyTable;
+
+
+/**
+ * Allocate a KeyTable containing the PredefinedKeys.
+ *
+ * @return The new KeyTable or <code>NULL</code> upon error.
+ */
+KeyTable *AllocateKeyTable (void);
+
+
+void FreeKeyTable (KeyTable *table_p);
+
+
+/**
+ * Get the ID of a key, adding the key to the table if it isn't already in it.
+ *
+ * @param table_p The KeyTable.
+ * @param key_s The key.
+ * @param id_p The key's ID will be stored here.
+ * @return The table's copy of the key, which stays valid for the life of
+ * the KeyTable, or <code>NULL</code> upon error.
+ */
+const char *InternKey (KeyTable *table_p, const char *key_s, KeyID *id_p);
+
+
+/**
+ * Get the number of keys in a KeyTable. Each of the IDs
+ * in use is less than this.
+ *
+ * @param table_p The KeyTable.
+ * @return The number of keys.
+ */
+size_t GetNumInternedKeys (KeyTable *table_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_KEY_TABLE_H_ */
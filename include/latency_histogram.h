@@ -0,0 +1,53 @@
+/*
+ * latency_histogram.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_LATENCY_HISTOGRAM_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include "typedefs.h"
+
+
+/**
+ * A histogram of durations in microseconds in the style of HdrHistogram.
+ * Values below 128 are counted exactly and above that each power of two
+ * is split into 64 linear buckets, so any recorded value is accurate to
+ * within about 1.5% while using a fixed amount of memory.
+ */
+typedef struct LatencyHistogram
+{
+	uint64_t *lh_counts_p;
+	size_t lh_num_buckets;
+	uint64_t lh_total_count;
+	uint64_t lh_min;
+	uint64_t lh_max;
+	double lh_sum;
+} LatencyHistogram;
+
+
+LatencyHistogram *AllocateLatencyHistogram (void);
+
+
+void FreeLatencyHistogram (LatencyHistogram *histogram_p);
+
+
+void AddLatencyHistogramValue (LatencyHistogram *histogram_p, const uint64_t value);
+
+
+/**
+ * Get the value at a given percentile.
+ *
+ * @param histogram_p The LatencyHistogram.
+ * @param percentile The percentile between 0 and 100.
+ * @return The highest value that is equivalent, within the histogram's
+ * precision, to the value at the given percentile or 0 if the histogram is empty.
+ */
+uint64_t GetLatencyHistogramPercentile (const LatencyHistogram *histogram_p, const double percentile);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_LATENCY_HISTOGRAM_H_ */
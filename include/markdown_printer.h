@@ -12,7 +12,15 @@
 #include "printer.h"
 
 
-struct Printer *AllocateMarkdownPrinter (void);
+/**
+ * Create a Printer that writes Markdown.
+ *
+ * @param tables_flag If this is <code>true</code> then the properties of each
+ * section are written as GitHub Flavored Markdown tables, otherwise they are
+ * written as lists.
+ * @return The new Printer or <code>NULL</code> upon error.
+ */
+struct Printer *AllocateMarkdownPrinter (const bool tables_flag);
 
 
 #endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_MARKDOWN_PRINTER_H_ */
@@ -0,0 +1,116 @@
+/*
+ * output_cache.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_CACHE_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_CACHE_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "schema_cache.h"
+#include "output_directory.h"
+
+
+/**
+ * The manifest of the output files that have been generated
+ * along with digests of everything that went into creating
+ * them. This allows incremental runs to skip any resources
+ * whose output files are already up to date.
+ */
+typedef struct OutputCache
+{
+	/** The filename of the manifest within the output directory. */
+	char *oc_manifest_filename_s;
+
+	/** The digests from the previous run keyed by output filename. */
+	json_t *oc_previous_outputs_p;
+
+	/** The digests for the outputs that have been written or kept during this run. */
+	json_t *oc_current_outputs_p;
+
+	/** The recursive digests of each web-based schema keyed by url. */
+	json_t *oc_schema_digests_p;
+
+	/** The printer options and program version that are part of every digest. */
+	char *oc_options_s;
+
+	/** The number of resources that were skipped because they were up to date. */
+	size_t oc_num_skipped;
+} OutputCache;
+
+
+
+/**
+ * Create an OutputCache and load any existing manifest from a previous run.
+ *
+ * @param out_dir_s The output directory. If this is <code>NULL</code> then
+ * the current directory is used.
+ * @param options_s A string representation of all of the options that affect
+ * the generated output.
+ * @return The new OutputCache or <code>NULL</code> upon error.
+ */
+OutputCache *AllocateOutputCache (const char *out_dir_s, const char *options_s);
+
+
+void FreeOutputCache (OutputCache *cache_p);
+
+
+/**
+ * Write the manifest for the outputs recorded during this run.
+ *
+ * @param cache_p The OutputCache.
+ * @param dir_p The OutputDirectory that the outputs were written to. The
+ * manifest is written in the same way as them so, once they have been synced,
+ * it is never left listing an output that hasn't been written.
+ * @return <code>true</code> if the manifest was written successfully,
+ * <code>false</code> otherwise.
+ */
+bool SaveOutputCache (OutputCache *cache_p, OutputDirectory *dir_p);
+
+
+/**
+ * Calculate the digest for a resource from its canonical JSON, the schema
+ * that it will be rendered with, including any child schemas that it refers
+ * to, and the printer options.
+ *
+ * @param cache_p The OutputCache.
+ * @param resource_p The resource.
+ * @param schema_url_s The url of the schema for the resource or <code>NULL</code>
+ * if the schema is inline within the resource.
+ * @param schema_cache_p The SchemaCache used to get any web-based schemas.
+ * @return The digest as a newly-allocated hex string which should be freed with
+ * FreeCopiedString () or <code>NULL</code> upon error.
+ */
+char *GetResourceDigest (OutputCache *cache_p, const json_t *resource_p, const char *schema_url_s, SchemaCache *schema_cache_p);
+
+
+/**
+ * Check whether an output file exists and was generated from the given digest.
+ */
+bool IsOutputCurrent (const OutputCache *cache_p, const char *filename_s, const char *digest_s);
+
+
+/**
+ * Record the digest of an output file that has been written or kept during this run.
+ */
+bool SetOutputDigest (OutputCache *cache_p, const char *filename_s, const char *digest_s);
+
+
+/**
+ * Carry all of the outputs from the previous run over to this one. This is
+ * for when only some of the resources are checked, such as when watching a
+ * data package, so that the manifest still lists the outputs of the others.
+ *
+ * @param cache_p The OutputCache.
+ * @return <code>true</code> if the outputs were copied successfully,
+ * <code>false</code> otherwise.
+ */
+bool KeepPreviousOutputs (OutputCache *cache_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_CACHE_H_ */
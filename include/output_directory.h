@@ -0,0 +1,175 @@
+/*
+ * output_directory.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_DIRECTORY_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_DIRECTORY_H_
+
+#include <stdio.h>
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+
+/**
+ * The most levels of subdirectories that the output files can be sharded into.
+ */
+#define OD_MAX_SHARD_DEPTH (4)
+
+
+/**
+ * How an OutputDirectory makes sure that its files survive a crash.
+ * Whichever is used, each file is written under a temporary name and
+ * only renamed to its real one once it has been completely written, so
+ * a file is never left partially written if the run is interrupted.
+ */
+typedef enum
+{
+	/** Leave it to the operating system to write the files to disk */
+	OD_DURABILITY_NONE,
+
+	/**
+	 * Collect the written files and, every so often and when
+	 * SyncOutputDirectory () is called, flush all of them to disk
+	 * at once before renaming them. If they can't be flushed, they
+	 * are discarded rather than replacing the previous versions.
+	 */
+	OD_DURABILITY_BATCH,
+
+	/** Flush each file, and its directory, to disk as soon as it is closed */
+	OD_DURABILITY_STRICT,
+
+	OD_NUM_DURABILITIES
+} OutputDurability;
+
+
+/**
+ * An OutputDirectory is the directory that a data package's output files
+ * are written to. Rather than putting every file directly in it, the files
+ * can be sharded into levels of subdirectories named after a hash of each
+ * file's name, e.g. 3f/a2/my_resource.html, so that no single directory
+ * ends up with a huge number of files.
+ *
+ * Each subdirectory is only created the first time that a file is written
+ * to it and, where possible, the files are opened relative to the
+ * directory rather than resolving its full path every time.
+ *
+ * The files are written to temporary files which replace the real ones
+ * when they are closed, or, for OD_DURABILITY_BATCH, when the batch that
+ * they are in is synced.
+ *
+ * An OutputDirectory must only be used by one thread at a time.
+ */
+typedef struct OutputDirectory OutputDirectory;
+
+
+/**
+ * Allocate an OutputDirectory, creating the directory if it doesn't exist.
+ *
+ * @param path_s The directory or <code>NULL</code> for the current directory.
+ * This is copied.
+ * @param shard_depth The number of levels of subdirectories to shard the files
+ * into, up to OD_MAX_SHARD_DEPTH. If this is 0, all of the files are written
+ * directly to the directory.
+ * @param durability How the files are flushed to disk.
+ * @return The new OutputDirectory or <code>NULL</code> upon error.
+ */
+OutputDirectory *AllocateOutputDirectory (const char *path_s, const uint32 shard_depth, const OutputDurability durability);
+
+
+/**
+ * Free an OutputDirectory. Any files that are waiting to be synced are
+ * put in place first and any that are still open are discarded.
+ *
+ * @param dir_p The OutputDirectory to free.
+ */
+void FreeOutputDirectory (OutputDirectory *dir_p);
+
+
+/**
+ * Get the full filename for a file in an OutputDirectory.
+ *
+ * @param dir_p The OutputDirectory.
+ * @param filename_s The name of the file within the directory. When sharding,
+ * the subdirectories are chosen using the part of this before its extension
+ * so that the files for the same resource in different formats all end up
+ * next to each other.
+ * @param shard_flag If this is <code>true</code>, the file is put in the
+ * subdirectories for its name, otherwise it goes directly in the directory.
+ * @return The filename which should be freed with FreeCopiedString (), or
+ * <code>NULL</code> upon error.
+ */
+char *GetOutputDirectoryFilename (const OutputDirectory *dir_p, const char *filename_s, const bool shard_flag);
+
+
+/**
+ * Open a file in an OutputDirectory to write to, creating its subdirectory
+ * if it is the first file to be written to it. Until the file is closed,
+ * it is written to a temporary file and any existing file with the same
+ * name is left as it is.
+ *
+ * @param dir_p The OutputDirectory.
+ * @param filename_s The filename from GetOutputDirectoryFilename (). Any
+ * other filename is opened as it is.
+ * @return The file, which must be closed with CloseOutputDirectoryFile (),
+ * or <code>NULL</code> upon error.
+ */
+FILE *OpenOutputDirectoryFile (OutputDirectory *dir_p, const char *filename_s);
+
+
+/**
+ * Close a file from OpenOutputDirectoryFile () and, if it was written
+ * successfully, replace the file with its name with it.
+ *
+ * @param dir_p The OutputDirectory.
+ * @param out_f The file to close.
+ * @param keep_flag If this is <code>false</code>, because writing the
+ * file failed, it is deleted and any existing file is kept.
+ * @return <code>true</code> if the file was closed and put in place, or
+ * is waiting to be synced, <code>false</code> otherwise.
+ */
+bool CloseOutputDirectoryFile (OutputDirectory *dir_p, FILE *out_f, const bool keep_flag);
+
+
+/**
+ * Write a JSON value to a file in an OutputDirectory in the same
+ * way as any other file.
+ *
+ * @param dir_p The OutputDirectory.
+ * @param filename_s The filename from GetOutputDirectoryFilename ().
+ * @param value_p The value to write.
+ * @param flags The flags to pass to json_dumpf ().
+ * @return <code>true</code> if the file was written successfully,
+ * <code>false</code> otherwise.
+ */
+bool SaveOutputDirectoryJSON (OutputDirectory *dir_p, const char *filename_s, const json_t *value_p, const size_t flags);
+
+
+/**
+ * For OD_DURABILITY_BATCH, flush all of the files that have been closed
+ * since the last time to disk and then put them in place. For the other
+ * OutputDurabilities this does nothing.
+ *
+ * @param dir_p The OutputDirectory.
+ * @return <code>true</code> if all of the files were synced successfully,
+ * <code>false</code> otherwise.
+ */
+bool SyncOutputDirectory (OutputDirectory *dir_p);
+
+
+/**
+ * Get the part of a filename within an OutputDirectory.
+ *
+ * @param dir_p The OutputDirectory.
+ * @param filename_s The filename from GetOutputDirectoryFilename ().
+ * @return The filename relative to the directory, which points into
+ * filename_s, or <code>NULL</code> if the file is somewhere else.
+ */
+const char *GetOutputDirectoryRelativeFilename (const OutputDirectory *dir_p, const char *filename_s);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_DIRECTORY_H_ */
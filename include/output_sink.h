@@ -0,0 +1,141 @@
+/*
+ * output_sink.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_SINK_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_SINK_H_
+
+#include <stdio.h>
+
+#include "typedefs.h"
+
+
+/**
+ * An OutputSink is somewhere that the printers and the CSV writer
+ * can write their output to, such as a file, an already open file
+ * descriptor, a growable memory buffer or a callback function.
+ *
+ * Each OutputSink has a stream that the output is written to, so
+ * the printers can write to any of them in the same way, and after
+ * each output has been written the OutputSink is flushed. An
+ * OutputSink can be written to again after it has been flushed
+ * with the subsequent output following on from the previous one.
+ */
+typedef struct OutputSink OutputSink;
+
+
+/**
+ * A function that is called with the output written to a callback OutputSink.
+ *
+ * @param data_s The data, this is not NULL-terminated.
+ * @param length The length of the data.
+ * @param data_p The data that was passed to AllocateCallbackOutputSink ().
+ * @return <code>true</code> if the data was consumed successfully,
+ * <code>false</code> otherwise.
+ */
+typedef bool (*OutputSinkWriteFn) (const char *data_s, const size_t length, void *data_p);
+
+
+/**
+ * A function that is called to get the OutputSink to write a
+ * given output file to rather than creating the file itself.
+ *
+ * @param filename_s The filename that the output would have been written to.
+ * @param data_p The custom data that was registered along with this function.
+ * @return The OutputSink to write to, which is still owned by the caller,
+ * or <code>NULL</code> upon error.
+ */
+typedef OutputSink *(*GetOutputSinkFn) (const char *filename_s, void *data_p);
+
+
+/**
+ * Allocate an OutputSink that writes to a file.
+ *
+ * @param filename_s The filename to write to. Any existing file is overwritten.
+ * @return The new OutputSink or <code>NULL</code> upon error.
+ */
+OutputSink *AllocateFileOutputSink (const char *filename_s);
+
+
+/**
+ * Allocate an OutputSink that writes to an already open file descriptor
+ * such as the standard output or one end of a pipe.
+ *
+ * @param fd The file descriptor. This is not closed when the OutputSink is freed.
+ * @return The new OutputSink or <code>NULL</code> upon error.
+ */
+OutputSink *AllocateFDOutputSink (const int fd);
+
+
+/**
+ * Allocate an OutputSink that keeps its output in a buffer that grows as needed.
+ * Use GetOutputSinkData () to get the output once the OutputSink has been flushed.
+ *
+ * @return The new OutputSink or <code>NULL</code> upon error.
+ */
+OutputSink *AllocateMemoryOutputSink (void);
+
+
+/**
+ * Allocate an OutputSink that passes its output to a function as it is written,
+ * in chunks of up to the size of the stream's buffer.
+ *
+ * @param write_fn The function to call with each chunk of output.
+ * @param data_p The custom data to pass to write_fn.
+ * @return The new OutputSink or <code>NULL</code> upon error.
+ */
+OutputSink *AllocateCallbackOutputSink (OutputSinkWriteFn write_fn, void *data_p);
+
+
+/**
+ * Free an OutputSink, flushing any output that hasn't been written yet.
+ *
+ * @param sink_p The OutputSink to free.
+ */
+void FreeOutputSink (OutputSink *sink_p);
+
+
+/**
+ * Get the stream to write an OutputSink's output to.
+ *
+ * @param sink_p The OutputSink.
+ * @return The stream. This is owned by the OutputSink and must not be closed.
+ */
+FILE *GetOutputSinkStream (OutputSink *sink_p);
+
+
+/**
+ * Make sure that all of the output written so far has reached its
+ * destination. This is called when each output has been written.
+ *
+ * @param sink_p The OutputSink.
+ * @return <code>true</code> if all of the output was written successfully,
+ * <code>false</code> if any of it failed.
+ */
+bool FlushOutputSink (OutputSink *sink_p);
+
+
+/**
+ * Get the output that has been written to a memory OutputSink.
+ *
+ * @param sink_p The OutputSink, which should have been flushed.
+ * @param length_p The length of the output will be stored here.
+ * @return The output, which is not NULL-terminated, or <code>NULL</code> if
+ * nothing has been written or sink_p is not a memory OutputSink.
+ */
+const char *GetOutputSinkData (const OutputSink *sink_p, size_t *length_p);
+
+
+/**
+ * Discard the output that has been written to a memory OutputSink
+ * so that it can be used for the next output.
+ *
+ * @param sink_p The OutputSink, which should have been flushed.
+ */
+void ResetOutputSinkData (OutputSink *sink_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_OUTPUT_SINK_H_ */
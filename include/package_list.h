@@ -0,0 +1,63 @@
+/*
+ * package_list.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_PACKAGE_LIST_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_PACKAGE_LIST_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+
+/**
+ * Get the data package files to process from the values given to --in.
+ * Each value can be:
+ *
+ * - a data package file.
+ * - a directory, in which case its .json files are used along with the
+ * datapackage.json files in any of its subdirectories.
+ * - a manifest file prefixed with an '@', which lists any of these one
+ * per line. Blank lines and lines starting with a '#' are ignored and
+ * relative paths are relative to the manifest's directory.
+ *
+ * The files from each directory are in alphabetical order so that
+ * the results are the same between runs.
+ *
+ * @param inputs_ss The values given to --in.
+ * @param num_inputs The number of values.
+ * @return A JSON array of the filenames or <code>NULL</code> upon error.
+ */
+json_t *GetPackageFilenames (char **inputs_ss, const size_t num_inputs);
+
+
+/**
+ * Get the name of the directory to write a data package's output files
+ * to when several packages are processed at once. This is the package's
+ * filename without its extension, or the name of the directory that it is
+ * in if it is a datapackage.json file.
+ *
+ * @param fd_file_s The data package's filename.
+ * @return The name which should be freed with FreeCopiedString () or
+ * <code>NULL</code> upon error.
+ */
+char *GetPackageOutputName (const char *fd_file_s);
+
+
+/**
+ * Get the names of the directories to write several data packages' output
+ * files to. These are from GetPackageOutputName () but if more than one
+ * package would get the same name, ignoring case, the later ones have
+ * "_2", "_3", etc. appended in the order that they are listed.
+ *
+ * @param filenames_p A JSON array of the data packages' filenames.
+ * @return A JSON array of the names in the same order as the filenames or
+ * <code>NULL</code> upon error.
+ */
+json_t *GetPackageOutputNames (const json_t *filenames_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_PACKAGE_LIST_H_ */
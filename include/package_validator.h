@@ -0,0 +1,94 @@
+/*
+ * package_validator.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_PACKAGE_VALIDATOR_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_PACKAGE_VALIDATOR_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "schema_cache.h"
+
+
+/**
+ * A schema compiled into the checks to run on each value.
+ */
+typedef struct SchemaNode SchemaNode;
+
+
+/**
+ * Checks the resources of a Data Package against their profiles.
+ *
+ * Each schema is compiled once into a tree of SchemaNodes, with all
+ * of its refs resolved, which are then shared by all of the resources
+ * that use that schema.
+ */
+typedef struct PackageValidator
+{
+	SchemaCache *pv_schema_cache_p;
+
+	/** The maximum number of threads to use. */
+	size_t pv_num_threads;
+
+	/** The maximum number of errors to report for each resource. */
+	size_t pv_max_errors;
+
+	/** All of the compiled schemas so that they can be freed. */
+	SchemaNode **pv_nodes_pp;
+	size_t pv_num_nodes;
+	size_t pv_nodes_capacity;
+
+	/**
+	 * The index within pv_nodes_pp of each compiled schema
+	 * keyed by the address of the schema's JSON.
+	 */
+	json_t *pv_compiled_p;
+} PackageValidator;
+
+
+/**
+ * Create a PackageValidator.
+ *
+ * @param schema_cache_p The SchemaCache to get the profiles and any schemas
+ * that they refer to from. This must outlive the PackageValidator.
+ * @param num_threads The maximum number of threads to use.
+ * @param max_errors The maximum number of errors to report for each resource.
+ * All of the errors are still counted.
+ * @return The new PackageValidator or <code>NULL</code> upon error.
+ */
+PackageValidator *AllocatePackageValidator (SchemaCache *schema_cache_p, const size_t num_threads, const size_t max_errors);
+
+
+void FreePackageValidator (PackageValidator *validator_p);
+
+
+/**
+ * Check each of the resources in a Data Package without rendering them.
+ *
+ * Resources with a web-based profile are checked against that schema for
+ * missing required properties, types, formats and the enum, minimum, maximum,
+ * minLength, maxLength and pattern keywords. Each row of the data in a
+ * tabular-data-resource is checked against the type and the constraints of
+ * each of the fields in its schema. Data in external CSV files given by a
+ * resource's path is streamed a chunk of rows at a time. Once all of the
+ * schemas have been loaded, the resources, and chunks of the rows of large
+ * tables, are checked in parallel.
+ *
+ * @param validator_p The PackageValidator.
+ * @param fd_p The Data Package.
+ * @param fd_file_s The filename of the Data Package which the paths of any
+ * resources are relative to.
+ * @param valid_flag_p If this is not <code>NULL</code>, it will be set to whether
+ * all of the resources are valid.
+ * @return The report of any errors for each resource or <code>NULL</code> upon error.
+ * The caller takes ownership of this.
+ */
+json_t *ValidatePackage (PackageValidator *validator_p, const json_t *fd_p, const char *fd_file_s, bool *valid_flag_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_PACKAGE_VALIDATOR_H_ */
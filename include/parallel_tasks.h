@@ -0,0 +1,130 @@
+/*
+ * parallel_tasks.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_PARALLEL_TASKS_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_PARALLEL_TASKS_H_
+
+#include <stddef.h>
+
+#include "typedefs.h"
+
+
+/**
+ * A function to run a single task.
+ *
+ * @param data_p The data that was passed to RunParallelTasks ().
+ * @param task_index The index of the task to run.
+ */
+typedef void (*ParallelTaskFn) (void *data_p, const size_t task_index);
+
+
+/**
+ * A mutex for guarding data that is shared between tasks.
+ */
+typedef struct TaskLock TaskLock;
+
+
+/**
+ * A condition that tasks can wait on, while holding a TaskLock,
+ * until another task signals that it has changed.
+ */
+typedef struct TaskCondition TaskCondition;
+
+
+/**
+ * Run a number of independent tasks using a pool of threads. Each
+ * thread takes the next task that hasn't been started until they
+ * have all been run, so the tasks can be of differing sizes.
+ *
+ * @param num_tasks The number of tasks.
+ * @param num_threads The maximum number of threads to use, including
+ * the calling thread. If this is 0 or 1, the tasks are run in order on
+ * the calling thread.
+ * @param task_fn The function to run each task.
+ * @param data_p The data to pass to task_fn.
+ * @return <code>true</code> if all of the tasks were run, <code>false</code> if the
+ * threads could not be set up.
+ */
+bool RunParallelTasks (const size_t num_tasks, const size_t num_threads, ParallelTaskFn task_fn, void *data_p);
+
+
+/**
+ * Get the number of processors that are available.
+ *
+ * @return The number of processors, which is at least 1.
+ */
+size_t GetNumberOfProcessors (void);
+
+
+/**
+ * Allocate a TaskLock.
+ *
+ * @return The new TaskLock or <code>NULL</code> upon error.
+ */
+TaskLock *AllocateTaskLock (void);
+
+
+/**
+ * Free a TaskLock, which must not be held.
+ *
+ * @param lock_p The TaskLock to free.
+ */
+void FreeTaskLock (TaskLock *lock_p);
+
+
+/**
+ * Wait until a TaskLock can be held by the calling thread.
+ *
+ * @param lock_p The TaskLock to acquire.
+ */
+void AcquireTaskLock (TaskLock *lock_p);
+
+
+/**
+ * Release a TaskLock that is held by the calling thread.
+ *
+ * @param lock_p The TaskLock to release.
+ */
+void ReleaseTaskLock (TaskLock *lock_p);
+
+
+/**
+ * Allocate a TaskCondition.
+ *
+ * @return The new TaskCondition or <code>NULL</code> upon error.
+ */
+TaskCondition *AllocateTaskCondition (void);
+
+
+/**
+ * Free a TaskCondition, which must not have any tasks waiting on it.
+ *
+ * @param condition_p The TaskCondition to free.
+ */
+void FreeTaskCondition (TaskCondition *condition_p);
+
+
+/**
+ * Release a TaskLock and wait until a TaskCondition is signalled, then
+ * hold the TaskLock again. As a wait can end without a signal, the caller
+ * should check whatever it is waiting for in a loop.
+ *
+ * @param condition_p The TaskCondition to wait on.
+ * @param lock_p The TaskLock, which must be held by the calling thread.
+ */
+void WaitForTaskCondition (TaskCondition *condition_p, TaskLock *lock_p);
+
+
+/**
+ * Wake all of the tasks that are waiting on a TaskCondition.
+ *
+ * @param condition_p The TaskCondition to signal.
+ */
+void SignalTaskCondition (TaskCondition *condition_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_PARALLEL_TASKS_H_ */
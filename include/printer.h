@@ -14,6 +14,9 @@
 
 #include "typedefs.h"
 
+#include "output_sink.h"
+#include "output_directory.h"
+
 
 typedef struct Printer Printer;
 
@@ -32,9 +35,83 @@ struct Printer
 	bool (*pr_print_boolean_fn) (Printer *printer_p, const char *key_s, const bool *value_p, const bool required_flag, const char *format_s);
 	bool (*pr_print_json_fn) (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s);
 	void (*pr_free_fn) (Printer *printer_p);
+
+	/*
+	 * These are optional and are called around each entry of an array
+	 * within a section, for printers that need to delimit the entries.
+	 */
+	bool (*pr_print_entry_start_fn) (Printer *printer_p);
+	bool (*pr_print_entry_end_fn) (Printer *printer_p);
+
+	/*
+	 * These are optional and are called around a single object-typed
+	 * value, for printers that need to tell it apart from an array. If
+	 * they are not set, the object is printed as a section with a single
+	 * entry.
+	 */
+	bool (*pr_print_object_start_fn) (Printer *printer_p, const char *key_s, const char *title_s);
+	bool (*pr_print_object_end_fn) (Printer *printer_p);
+
+	/*
+	 * These are optional and are used to write several resources into a
+	 * single document. Each resource is printed between calls to
+	 * pr_print_resource_start_fn and pr_print_resource_end_fn rather than
+	 * pr_print_header_fn and pr_print_footer_fn.
+	 */
+	bool (*pr_print_document_start_fn) (Printer *printer_p, const char *title_s);
+	bool (*pr_print_contents_fn) (Printer *printer_p, const json_t *entries_p);
+	bool (*pr_print_resource_start_fn) (Printer *printer_p, const char *anchor_s, const char *title_s);
+	bool (*pr_print_resource_end_fn) (Printer *printer_p, const char *text_s);
+	bool (*pr_print_document_end_fn) (Printer *printer_p);
+
+	/*
+	 * The limits for printing JSON values. Values longer than
+	 * pr_json_max_size bytes are truncated and printers that can
+	 * collapse content do so after pr_json_collapse_size bytes.
+	 * A value of 0 means there is no limit.
+	 */
+	size_t pr_json_max_size;
+	size_t pr_json_collapse_size;
+
+	/*
+	 * These are optional and are for printers that write to something
+	 * other than pr_out_f. If they are set, OpenFDPrinter () and
+	 * CloseFDPrinter () call them rather than opening and closing
+	 * pr_out_f directly.
+	 */
+	bool (*pr_open_fn) (Printer *printer_p, const char *filename_s);
+	bool (*pr_close_fn) (Printer *printer_p);
+
+	/*
+	 * These are optional and, if pr_get_sink_fn is set, OpenFDPrinter ()
+	 * writes to the OutputSink that it returns, which is pr_sink_p until
+	 * CloseFDPrinter () is called, rather than creating the file.
+	 */
+	GetOutputSinkFn pr_get_sink_fn;
+	void *pr_get_sink_data_p;
+	OutputSink *pr_sink_p;
+
+	/*
+	 * This is optional and, if it is set, OpenFDPrinter () creates
+	 * the files using it rather than opening them directly. It must
+	 * not be changed while a file is open.
+	 */
+	OutputDirectory *pr_out_dir_p;
 };
 
 
+/**
+ * A function that is called with each chunk of a JSON value as it is serialised.
+ *
+ * @param chunk_s The chunk, this is not NULL-terminated.
+ * @param length The length of the chunk.
+ * @param data_p The data that was passed to StreamJSONValue ().
+ * @return <code>true</code> if the chunk was written successfully,
+ * <code>false</code> otherwise.
+ */
+typedef bool (*JSONChunkWriter) (const char *chunk_s, const size_t length, void *data_p);
+
+
 
 
 void InitFDPrinter (Printer *printer_p,
@@ -50,6 +127,55 @@ void InitFDPrinter (Printer *printer_p,
 									bool (*print_json_fn) (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s),
 									void (*free_fn) (Printer *printer_p));
 
+void SetFDPrinterEntryFunctions (Printer *printer_p,
+																 bool (*print_entry_start_fn) (Printer *printer_p),
+																 bool (*print_entry_end_fn) (Printer *printer_p));
+
+void SetFDPrinterObjectFunctions (Printer *printer_p,
+																	bool (*print_object_start_fn) (Printer *printer_p, const char *key_s, const char *title_s),
+																	bool (*print_object_end_fn) (Printer *printer_p));
+
+void SetFDPrinterDocumentFunctions (Printer *printer_p,
+																		bool (*print_document_start_fn) (Printer *printer_p, const char *title_s),
+																		bool (*print_contents_fn) (Printer *printer_p, const json_t *entries_p),
+																		bool (*print_resource_start_fn) (Printer *printer_p, const char *anchor_s, const char *title_s),
+																		bool (*print_resource_end_fn) (Printer *printer_p, const char *text_s),
+																		bool (*print_document_end_fn) (Printer *printer_p));
+
+
+void SetFDPrinterJSONLimits (Printer *printer_p, const size_t max_size, const size_t collapse_size);
+
+void SetFDPrinterFileFunctions (Printer *printer_p,
+																bool (*open_fn) (Printer *printer_p, const char *filename_s),
+																bool (*close_fn) (Printer *printer_p));
+
+
+/**
+ * Write to OutputSinks rather than files.
+ *
+ * @param printer_p The Printer.
+ * @param get_sink_fn The function that OpenFDPrinter () calls with each filename
+ * to get the OutputSink to write to or <code>NULL</code> to write to files again.
+ * @param get_sink_data_p The custom data to pass to get_sink_fn.
+ */
+void SetFDPrinterOutputSinks (Printer *printer_p, GetOutputSinkFn get_sink_fn, void *get_sink_data_p);
+
+
+/**
+ * Create the files that are written to using an OutputDirectory.
+ *
+ * @param printer_p The Printer.
+ * @param out_dir_p The OutputDirectory that the filenames given to OpenFDPrinter ()
+ * came from or <code>NULL</code> to open the files directly.
+ */
+void SetFDPrinterOutputDirectory (Printer *printer_p, OutputDirectory *out_dir_p);
+
+
+/**
+ * Check whether a Printer can write several resources into a single document.
+ */
+bool DoesFDPrinterSupportDocuments (const Printer *printer_p);
+
 bool OpenFDPrinter (Printer *printer_p, const char *filename_s);
 
 bool CloseFDPrinter (Printer *printer_p);
@@ -60,6 +186,60 @@ bool StartPrintSection (Printer *printer_p, const char *value_s);
 
 bool EndPrintSection (Printer *printer_p, const char *value_s);
 
+bool StartPrintEntry (Printer *printer_p);
+
+bool EndPrintEntry (Printer *printer_p);
+
+/**
+ * Start printing an object-typed value.
+ *
+ * @param printer_p The Printer.
+ * @param key_s The key of the value in its parent object.
+ * @param title_s The title to show for the value.
+ * @return <code>true</code> if the start of the object was printed successfully,
+ * <code>false</code> otherwise.
+ */
+bool StartPrintObject (Printer *printer_p, const char *key_s, const char *title_s);
+
+bool EndPrintObject (Printer *printer_p);
+
+
+bool PrintDocumentStart (Printer *printer_p, const char *title_s);
+
+/**
+ * Print a table of contents.
+ *
+ * @param printer_p The Printer.
+ * @param entries_p An array of objects each with "title" and "link" strings.
+ * @return <code>true</code> if the contents were printed successfully,
+ * <code>false</code> otherwise.
+ */
+bool PrintContents (Printer *printer_p, const json_t *entries_p);
+
+bool PrintResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s);
+
+bool PrintResourceEnd (Printer *printer_p, const char *text_s);
+
+bool PrintDocumentEnd (Printer *printer_p);
+
+
+/**
+ * Serialise a JSON value a chunk at a time rather than building the
+ * whole string in memory first.
+ *
+ * @param value_p The value to serialise.
+ * @param flags The jansson encoding flags.
+ * @param max_size The maximum number of bytes to write or 0 for no limit.
+ * The value is cut at the last whole UTF-8 character before the limit.
+ * @param writer_fn The function to call with each chunk.
+ * @param writer_data_p The data to pass to writer_fn.
+ * @param truncated_flag_p If this is not <code>NULL</code> then it will be
+ * set to whether the value was truncated.
+ * @return <code>true</code> if the value was written successfully,
+ * <code>false</code> otherwise.
+ */
+bool StreamJSONValue (const json_t *value_p, const size_t flags, const size_t max_size, JSONChunkWriter writer_fn, void *writer_data_p, bool *truncated_flag_p);
+
 
 bool PrintHeader (Printer *printer_p, const char *title_s, const char *text_s);
 
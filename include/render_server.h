@@ -0,0 +1,57 @@
+/*
+ * render_server.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_RENDER_SERVER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_RENDER_SERVER_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+
+/**
+ * The function called for each render request.
+ *
+ * @param data_p The data that was passed to RunRenderServer ().
+ * @param worker_index The index of the worker that is handling the request,
+ * from 0 up to the number of workers. Each worker only handles one request
+ * at a time so this can be used to pick per-worker state without locking.
+ * @param request_p The request.
+ * @param response_p The response to fill in. This should have an "outputs"
+ * array added with the filenames of the files that were written and, if
+ * the request fails, an "error" string.
+ * @return <code>true</code> if the request was carried out successfully,
+ * <code>false</code> otherwise.
+ */
+typedef bool (*RenderRequestFn) (void *data_p, const size_t worker_index, const json_t *request_p, json_t *response_p);
+
+
+/**
+ * Listen for render requests on a Unix domain socket until a
+ * request of {"command": "stop"} is received.
+ *
+ * Each request is a JSON object on a single line and any number of
+ * them can be sent on a connection. Each one gets a single line JSON
+ * response with "success", "time_ms" and, if successful, "outputs"
+ * which is an array of objects with the "file" and "size" of each file
+ * that was written. If the request has "stream" set to true, the contents
+ * of each of the files follow the response in the same order.
+ *
+ * The connections are handled concurrently by a pool of workers.
+ *
+ * @param socket_filename_s The filename for the socket. Any existing
+ * socket at this path is replaced.
+ * @param num_workers The number of requests that can be handled at once.
+ * @param request_fn The function to call for each request.
+ * @param data_p The custom data to pass to request_fn.
+ * @return <code>true</code> if the server ran and was stopped by a request,
+ * <code>false</code> if it could not be started.
+ */
+bool RunRenderServer (const char *socket_filename_s, const size_t num_workers, RenderRequestFn request_fn, void *data_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_RENDER_SERVER_H_ */
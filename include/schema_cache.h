@@ -0,0 +1,142 @@
+/*
+ * schema_cache.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_SCHEMA_CACHE_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_SCHEMA_CACHE_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "tool_stats.h"
+#include "parallel_tasks.h"
+#include "key_table.h"
+
+
+/**
+ * A store of the web-based schemas that have been downloaded
+ * so that each one only gets fetched once per run.
+ */
+typedef struct SchemaCache
+{
+	/** The schemas keyed by their urls. Failed downloads are stored as JSON null. */
+	json_t *sc_schemas_p;
+
+	/** The number of schemas that have been downloaded. */
+	size_t sc_num_fetches;
+
+	/** The number of requests that were served from the cache. */
+	size_t sc_num_hits;
+
+	/**
+	 * Replacement url prefixes keyed by the prefixes that they replace, e.g.
+	 * to load the schemas from local files using file:// urls.
+	 */
+	json_t *sc_mappings_p;
+
+	/** If this is set, the downloading and parsing of schemas are timed. */
+	ToolStats *sc_stats_p;
+
+	/**
+	 * The index of the local refs, such as "#/definitions/plot", within
+	 * each schema keyed by the schema's url and then by the ref.
+	 */
+	json_t *sc_refs_p;
+
+	/**
+	 * The urls of the schemas that are being downloaded, so that any other
+	 * threads that want them wait for the download rather than repeating it.
+	 */
+	json_t *sc_fetching_p;
+
+	/**
+	 * This guards all of the above so that a cache can be shared by the
+	 * threads that are processing different data packages. It isn't held
+	 * while a schema is being downloaded.
+	 */
+	TaskLock *sc_lock_p;
+
+	/** This is signalled whenever a download has finished. */
+	TaskCondition *sc_fetched_p;
+
+	/**
+	 * The property names from the schemas, so that they have the same
+	 * IDs for all of the data packages that share this cache. This has
+	 * its own lock.
+	 */
+	KeyTable *sc_keys_p;
+} SchemaCache;
+
+
+
+SchemaCache *AllocateSchemaCache (void);
+
+
+void FreeSchemaCache (SchemaCache *cache_p);
+
+
+/**
+ * Get a schema, downloading it if it has not been requested before. This
+ * can be called from several threads at once and if they ask for a schema
+ * that isn't cached yet, it is only downloaded once with the others waiting
+ * for it. Other schemas can be got from the cache during the download.
+ *
+ * @param cache_p The SchemaCache to use.
+ * @param url_s The url of the schema.
+ * @return The schema or <code>NULL</code> if it could not be retrieved.
+ * This is owned by the SchemaCache so must not be freed by the caller.
+ */
+const json_t *GetSchemaFromCache (SchemaCache *cache_p, const char *url_s);
+
+
+/**
+ * Download any schemas whose urls start with a given prefix from a different location.
+ * The schemas are still cached using their original urls.
+ *
+ * @param cache_p The SchemaCache to use.
+ * @param prefix_s The url prefix to replace, e.g. "https://example.org/schemas/".
+ * @param replacement_s The prefix to use instead, e.g. "file:///data/schemas/".
+ * @return <code>true</code> if the mapping was added successfully, <code>false</code> otherwise.
+ */
+bool AddSchemaMapping (SchemaCache *cache_p, const char *prefix_s, const char *replacement_s);
+
+
+/**
+ * Get the schema that a $ref points to. Refs to other schemas are made
+ * absolute using the url of the schema that they are in and fetched
+ * through the cache. Local refs such as "#/definitions/plot" are looked
+ * up using an index of each schema's definitions, which is built the
+ * first time that a schema is used, so the schema is only walked once.
+ *
+ * @param cache_p The SchemaCache to use.
+ * @param document_p The schema that contains the ref.
+ * @param url_s The url of document_p. If this is <code>NULL</code>, relative
+ * refs cannot be resolved and local refs aren't indexed.
+ * @param ref_s The value of the $ref.
+ * @param document_pp If this is not <code>NULL</code>, it will be set to the
+ * schema that contains the result so that any refs within the result can be
+ * resolved in turn.
+ * @param document_url_ss If this is not <code>NULL</code>, it will be set to
+ * the url of *document_pp. This is owned by the SchemaCache.
+ * @return The schema or <code>NULL</code> if it could not be found.
+ */
+const json_t *ResolveSchemaRef (SchemaCache *cache_p, const json_t *document_p, const char *url_s, const char *ref_s, const json_t **document_pp, const char **document_url_ss);
+
+
+/**
+ * Make the url part of a $ref absolute.
+ *
+ * @param base_url_s The url of the schema containing the ref. This may be <code>NULL</code>.
+ * @param ref_s The $ref.
+ * @return The absolute url without any fragment, or <code>NULL</code> if it
+ * is a local ref or could not be made absolute. This should be freed with
+ * FreeCopiedString ().
+ */
+char *GetAbsoluteSchemaURL (const char *base_url_s, const char *ref_s);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_SCHEMA_CACHE_H_ */
@@ -0,0 +1,44 @@
+/*
+ * schema_parser.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_SCHEMA_PARSER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_SCHEMA_PARSER_H_
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "printer.h"
+#include "schema_cache.h"
+
+
+/**
+ * Print a resource using its schema to determine the properties and
+ * the order that they are printed in.
+ *
+ * Nested objects and arrays are printed as sections. Any "$ref" values
+ * within the schema can be urls, paths relative to the schema's url or
+ * local refs such as "#/definitions/name" and these are resolved via
+ * the SchemaCache. For properties using "anyOf" or "oneOf", the first
+ * schema that matches the property's value is used.
+ *
+ * @param data_p The resource.
+ * @param schema_p The schema for the resource.
+ * @param schema_url_s The url of the schema, used to resolve any relative refs
+ * within it. This can be <code>NULL</code> in which case only local refs and
+ * absolute urls can be resolved.
+ * @param printer_p The Printer to write the properties with.
+ * @param schema_cache_p The SchemaCache used to get any child schemas.
+ * @param full_flag If this is <code>true</code> then properties without values are printed too.
+ * @param debug_flag If this is <code>true</code> then progress information is printed.
+ * @param indent_level The nesting level of the resource.
+ * @return <code>true</code> if all of the required properties were found, <code>false</code> otherwise.
+ */
+bool ParsePackageFromSchema (const json_t *data_p, const json_t *schema_p, const char *schema_url_s, Printer *printer_p, SchemaCache *schema_cache_p, const bool full_flag, const bool debug_flag, const size_t indent_level);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_SCHEMA_PARSER_H_ */
@@ -0,0 +1,181 @@
+/*
+ * template_printer.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_TEMPLATE_PRINTER_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_TEMPLATE_PRINTER_H_
+
+#include <stdint.h>
+
+#include "printer.h"
+
+
+/**
+ * The fragments that a template can supply, one for each
+ * of the Printer's functions.
+ */
+typedef enum
+{
+	TF_HEADER,
+	TF_FOOTER,
+	TF_TEXT,
+	TF_SECTION_START,
+	TF_SECTION_END,
+	TF_ENTRY_START,
+	TF_ENTRY_END,
+	TF_STRING,
+	TF_INTEGER,
+	TF_NUMBER,
+	TF_BOOLEAN,
+	TF_JSON,
+
+	/** This is inserted wherever the {{required}} slot is used for a required value. */
+	TF_REQUIRED,
+	TF_NUM_FRAGMENTS
+} TemplateFragmentType;
+
+
+/**
+ * The values that can be inserted into a fragment.
+ */
+typedef enum
+{
+	TS_TITLE,
+	TS_TEXT,
+	TS_KEY,
+	TS_VALUE,
+	TS_FORMAT,
+	TS_REQUIRED,
+	TS_NUM_SLOTS
+} TemplateSlot;
+
+
+typedef enum
+{
+	/** Copy a run of the template's text. */
+	TO_LITERAL,
+
+	/** Insert a value, escaping it if the template requires it. */
+	TO_SLOT,
+
+	/** Insert a value as it is. */
+	TO_RAW_SLOT
+} TemplateOpType;
+
+
+typedef enum
+{
+	TE_NONE,
+	TE_HTML
+} TemplateEscaping;
+
+
+/**
+ * A single step of a compiled fragment.
+ */
+typedef struct TemplateOp
+{
+	TemplateOpType to_type;
+
+	/** For a literal, where the text is within the template's source. */
+	size_t to_offset;
+	size_t to_length;
+
+	/** For a slot, the value to insert. */
+	TemplateSlot to_slot;
+} TemplateOp;
+
+
+/**
+ * A fragment is a run of consecutive ops.
+ */
+typedef struct TemplateFragment
+{
+	size_t tf_first_op;
+	size_t tf_num_ops;
+	bool tf_defined_flag;
+} TemplateFragment;
+
+
+/**
+ * A fragment that is used instead of the string fragment
+ * for values with a given format such as "uri" or "email".
+ */
+typedef struct TemplateFormatFragment
+{
+	char *tff_format_s;
+	TemplateFragment tff_fragment;
+} TemplateFormatFragment;
+
+
+/**
+ * A template file compiled into the ops for each of its fragments.
+ */
+typedef struct PrinterTemplate
+{
+	/** The contents of the template file that the literal ops point into. */
+	char *pt_source_s;
+
+	TemplateOp *pt_ops_p;
+	size_t pt_num_ops;
+	size_t pt_ops_capacity;
+
+	TemplateFragment pt_fragments [TF_NUM_FRAGMENTS];
+
+	TemplateFormatFragment *pt_string_formats_p;
+	size_t pt_num_string_formats;
+
+	TemplateEscaping pt_escaping;
+
+	/** The file extension to use for the output files. */
+	char *pt_extension_s;
+
+	/** A digest of the template's contents so that changes to it can be detected. */
+	uint64_t pt_digest;
+} PrinterTemplate;
+
+
+
+/**
+ * Load and compile a template file.
+ *
+ * The file consists of directive lines starting with "%%" each followed
+ * by the text of a fragment. The directives are
+ *
+ *  %% extension <ext>     The extension for the output files, the default is "txt".
+ *  %% escape html|none    How the values are escaped, the default is "none".
+ *  %% header, footer, text, section_start, section_end, entry_start,
+ *     entry_end, string, integer, number, boolean, json, required
+ *                         Start the fragment for that Printer function.
+ *  %% string <format>     Start the fragment for strings with the given format.
+ *
+ * Within a fragment, {{title}}, {{text}}, {{key}}, {{value}}, {{format}}
+ * and {{required}} are replaced with the given values and {{&value}}, etc.
+ * inserts the value without escaping it. A line ending with a backslash is
+ * joined to the next one. The integer, number, boolean and json fragments
+ * fall back to the string fragment if they are not given. Any text before
+ * the first directive is ignored.
+ *
+ * @param filename_s The template file.
+ * @return The compiled template or <code>NULL</code> upon error.
+ */
+PrinterTemplate *LoadPrinterTemplate (const char *filename_s);
+
+
+void FreePrinterTemplate (PrinterTemplate *template_p);
+
+
+/**
+ * Create a Printer that writes its output using a compiled template.
+ *
+ * @param template_p The template. If the Printer is created successfully,
+ * it takes ownership of this and will free it when the Printer is freed.
+ * @return The new Printer or <code>NULL</code> upon error.
+ */
+Printer *AllocateTemplatePrinter (PrinterTemplate *template_p);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_TEMPLATE_PRINTER_H_ */
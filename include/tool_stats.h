@@ -0,0 +1,171 @@
+/*
+ * tool_stats.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifndef CLIENTS_FRICTIONLESS_DATA_INCLUDE_TOOL_STATS_H_
+#define CLIENTS_FRICTIONLESS_DATA_INCLUDE_TOOL_STATS_H_
+
+#include <stdio.h>
+
+#include "jansson.h"
+
+#include "typedefs.h"
+#include "latency_histogram.h"
+
+
+/**
+ * The phases of a run that are timed.
+ */
+typedef enum
+{
+	SP_JSON_LOAD,
+	SP_SCHEMA_FETCH,
+	SP_SCHEMA_PARSE,
+	SP_RENDER,
+	SP_CSV_WRITE,
+	SP_CLOSE,
+	SP_NUM_PHASES
+} StatsPhase;
+
+
+typedef struct StatsTimer StatsTimer;
+
+/**
+ * A timer for a single occurrence of a phase. Timers can be nested,
+ * e.g. a schema fetch during rendering, and the time spent in a nested
+ * timer is not counted towards the enclosing one.
+ */
+struct StatsTimer
+{
+	StatsPhase st_phase;
+	double st_start_wall;
+	double st_start_cpu;
+	double st_child_wall;
+	double st_child_cpu;
+	StatsTimer *st_parent_p;
+};
+
+
+/**
+ * The time taken to generate the output for a single resource.
+ */
+typedef struct ResourceTiming
+{
+	char *rt_name_s;
+	double rt_wall;
+	size_t rt_bytes;
+} ResourceTiming;
+
+
+/**
+ * The timings and counters for a run.
+ */
+typedef struct ToolStats
+{
+	double ts_wall_times [SP_NUM_PHASES];
+	double ts_cpu_times [SP_NUM_PHASES];
+	size_t ts_phase_counts [SP_NUM_PHASES];
+
+	size_t ts_bytes_written;
+	size_t ts_rows_exported;
+	size_t ts_resources_processed;
+	size_t ts_schema_fetches;
+	size_t ts_schema_cache_hits;
+
+	double ts_start_wall;
+
+	/** The time taken for each resource in microseconds. */
+	LatencyHistogram *ts_resource_times_p;
+
+	/** The slowest resources so far, slowest first. */
+	ResourceTiming *ts_slowest_p;
+	size_t ts_num_slowest;
+	size_t ts_max_slowest;
+
+	/** The currently running timer. */
+	StatsTimer *ts_current_timer_p;
+
+	/** The Chrome trace events, this is only set if tracing was requested. */
+	json_t *ts_trace_events_p;
+} ToolStats;
+
+
+
+/**
+ * Create a ToolStats.
+ *
+ * @param trace_flag If this is <code>true</code> then each timed phase is
+ * also recorded as a trace event.
+ * @param max_slowest The number of the slowest resources to keep the details of.
+ * @return The new ToolStats or <code>NULL</code> upon error.
+ */
+ToolStats *AllocateToolStats (const bool trace_flag, const size_t max_slowest);
+
+
+void FreeToolStats (ToolStats *stats_p);
+
+
+/**
+ * Start timing a phase. If stats_p is <code>NULL</code> this does nothing
+ * so callers don't need to check whether stats are being collected.
+ */
+void StartStatsTimer (ToolStats *stats_p, StatsTimer *timer_p, const StatsPhase phase);
+
+
+/**
+ * Stop timing a phase.
+ *
+ * @param stats_p The ToolStats, this may be <code>NULL</code>.
+ * @param timer_p The timer that was passed to StartStatsTimer ().
+ * @param detail_s An optional description, such as the resource name,
+ * which is added to any trace event.
+ */
+void StopStatsTimer (ToolStats *stats_p, StatsTimer *timer_p, const char *detail_s);
+
+
+/**
+ * Record the time taken to generate the output for a resource.
+ *
+ * @param stats_p The ToolStats, this may be <code>NULL</code>.
+ * @param name_s The name of the resource.
+ * @param wall The number of seconds taken.
+ * @param bytes The size of the generated output.
+ */
+void AddResourceTiming (ToolStats *stats_p, const char *name_s, const double wall, const size_t bytes);
+
+
+/**
+ * Print the percentiles of the resource timings and a table of the
+ * slowest resources.
+ */
+void PrintResourceTimings (const ToolStats *stats_p, FILE *out_f);
+
+
+/**
+ * Write the timings and counters as JSON.
+ */
+bool WriteToolStats (const ToolStats *stats_p, const char *filename_s);
+
+
+/**
+ * Write the trace events in the Chrome trace event format.
+ */
+bool WriteToolStatsTrace (const ToolStats *stats_p, const char *filename_s);
+
+
+/**
+ * Get the number of seconds from a monotonic clock.
+ */
+double GetWallClockTime (void);
+
+
+/**
+ * Get the number of seconds of CPU time used by the process.
+ */
+double GetCPUTime (void);
+
+
+#endif /* CLIENTS_FRICTIONLESS_DATA_INCLUDE_TOOL_STATS_H_ */
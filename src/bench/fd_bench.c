@@ -0,0 +1,905 @@
+/*
+ * fd_bench.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ *
+ * A benchmark for the Frictionless Data tool. It generates a synthetic
+ * Data Package along with its profile schemas and then times each of the
+ * phases of processing it, writing the results as JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "frictionless_data_util.h"
+
+#include "json_util.h"
+#include "string_utils.h"
+#include "filesystem_utils.h"
+
+#include "printer.h"
+#include "html_printer.h"
+#include "markdown_printer.h"
+#include "template_printer.h"
+#include "schema_cache.h"
+#include "schema_parser.h"
+#include "csv_writer.h"
+#include "tool_stats.h"
+
+
+typedef struct
+{
+	size_t bc_num_resources;
+	size_t bc_num_tables;
+	size_t bc_num_properties;
+	size_t bc_depth;
+	size_t bc_fanout;
+	size_t bc_num_rows;
+	size_t bc_num_columns;
+	size_t bc_num_iterations;
+	const char *bc_work_dir_s;
+	const char *bc_schema_url_s;
+	const char *bc_results_file_s;
+	bool bc_markdown_flag;
+	const char *bc_template_file_s;
+} BenchConfig;
+
+
+typedef enum
+{
+	BP_LOAD,
+	BP_SCHEMA_FETCH,
+	BP_RENDER,
+	BP_CSV_EXPORT,
+	BP_NUM_PHASES
+} BenchPhase;
+
+
+static const char * const S_PHASE_NAMES [BP_NUM_PHASES] = { "load", "schema_fetch", "render", "csv_export" };
+
+
+/*
+ * The schemas are given urls under this prefix, which are then mapped
+ * onto the generated files, unless a real server has been specified.
+ */
+static const char * const S_STAND_IN_URL_S = "http://fd-bench.invalid/schemas/";
+
+static const char * const S_CHILDREN_KEY_S = "children";
+
+
+/*
+ * static declarations
+ */
+
+static bool GenerateSchemas (const BenchConfig *config_p, const char *schemas_dir_s, const char *base_url_s);
+
+static json_t *GenerateResource (const BenchConfig *config_p, const size_t index, const char *base_url_s, uint32 *seed_p);
+
+static json_t *GenerateObject (const BenchConfig *config_p, const size_t level, uint32 *seed_p);
+
+static json_t *GenerateTable (const BenchConfig *config_p, const size_t index, uint32 *seed_p);
+
+static json_t *GenerateValue (const size_t type_index, const size_t suffix, uint32 *seed_p);
+
+static const char *GetTypeName (const size_t type_index);
+
+static uint32 GetNextRandom (uint32 *seed_p);
+
+static bool RunIteration (const BenchConfig *config_p, const char *package_s, const char *out_dir_s, const char *base_url_s, const char *mapped_url_s, double *times_p);
+
+static bool FetchSchemas (SchemaCache *cache_p, const json_t *schema_p, const char *schema_url_s, const size_t depth);
+
+static json_t *GetResults (const BenchConfig *config_p, double *times_p);
+
+static bool ParseSizeArgument (int argc, char *argv [], int *index_p, size_t *value_p);
+
+
+/*
+ * api definitions
+ */
+
+int main (int argc, char *argv [])
+{
+	int res = 1;
+	BenchConfig config;
+	bool args_ok_flag = true;
+	int i;
+
+	config.bc_num_resources = 100;
+	config.bc_num_tables = 10;
+	config.bc_num_properties = 20;
+	config.bc_depth = 2;
+	config.bc_fanout = 3;
+	config.bc_num_rows = 1000;
+	config.bc_num_columns = 10;
+	config.bc_num_iterations = 3;
+	config.bc_work_dir_s = "fd_bench";
+	config.bc_schema_url_s = NULL;
+	config.bc_results_file_s = NULL;
+	config.bc_markdown_flag = false;
+	config.bc_template_file_s = NULL;
+
+	for (i = 1; (i < argc) && args_ok_flag; ++ i)
+		{
+			if (strcmp (argv [i], "--resources") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_num_resources));
+				}
+			else if (strcmp (argv [i], "--tables") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_num_tables));
+				}
+			else if (strcmp (argv [i], "--properties") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_num_properties));
+				}
+			else if (strcmp (argv [i], "--depth") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_depth));
+				}
+			else if (strcmp (argv [i], "--fanout") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_fanout));
+				}
+			else if (strcmp (argv [i], "--rows") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_num_rows));
+				}
+			else if (strcmp (argv [i], "--columns") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_num_columns));
+				}
+			else if (strcmp (argv [i], "--iterations") == 0)
+				{
+					args_ok_flag = ParseSizeArgument (argc, argv, &i, & (config.bc_num_iterations));
+				}
+			else if ((strcmp (argv [i], "--work-dir") == 0) && ((i + 1) < argc))
+				{
+					config.bc_work_dir_s = argv [++ i];
+				}
+			else if ((strcmp (argv [i], "--schema-url") == 0) && ((i + 1) < argc))
+				{
+					config.bc_schema_url_s = argv [++ i];
+				}
+			else if ((strcmp (argv [i], "--results") == 0) && ((i + 1) < argc))
+				{
+					config.bc_results_file_s = argv [++ i];
+				}
+			else if (strcmp (argv [i], "--markdown") == 0)
+				{
+					config.bc_markdown_flag = true;
+				}
+			else if ((strcmp (argv [i], "--template") == 0) && ((i + 1) < argc))
+				{
+					config.bc_template_file_s = argv [++ i];
+				}
+			else
+				{
+					args_ok_flag = false;
+				}
+		}
+
+	if ((!args_ok_flag) || (config.bc_depth == 0) || (config.bc_num_iterations == 0))
+		{
+			printf (
+					"USAGE: grassroots_fd_bench\n"
+					"\t--resources <n>, the number of resources that use the generated profile schemas (default 100).\n"
+					"\t--tables <n>, the number of tabular-data-resources with inline data (default 10).\n"
+					"\t--properties <n>, the number of properties in each schema (default 20).\n"
+					"\t--depth <n>, the number of levels of nested schemas, must be at least 1 (default 2).\n"
+					"\t--fanout <n>, the number of child entries for each nested object (default 3).\n"
+					"\t--rows <n>, the number of rows in each table (default 1000).\n"
+					"\t--columns <n>, the number of columns in each table (default 10).\n"
+					"\t--iterations <n>, the number of times to run each phase (default 3).\n"
+					"\t--work-dir <directory>, where the package, schemas and output files are written (default fd_bench).\n"
+					"\t--schema-url <url>, the url that <work-dir>/schemas/ is being served from. If this is not set\n"
+					"\t\tthen the schemas are loaded directly from the files.\n"
+					"\t--results <filename>, write the JSON results to this file rather than to stdout.\n"
+					"\t--markdown, render in markdown rather than html.\n"
+					"\t--template <filename>, render using this template file rather than html.\n"
+					);
+		}
+	else
+		{
+			char *schemas_dir_s = MakeFilename (config.bc_work_dir_s, "schemas");
+			char *out_dir_s = MakeFilename (config.bc_work_dir_s, "out");
+			char *package_s = MakeFilename (config.bc_work_dir_s, "datapackage.json");
+
+			if (schemas_dir_s && out_dir_s && package_s)
+				{
+					if (EnsureDirectoryExists (config.bc_work_dir_s) && EnsureDirectoryExists (schemas_dir_s) && EnsureDirectoryExists (out_dir_s))
+						{
+							const char *base_url_s = config.bc_schema_url_s ? config.bc_schema_url_s : S_STAND_IN_URL_S;
+							char *mapped_url_s = NULL;
+							bool ok_flag = true;
+
+							if (!config.bc_schema_url_s)
+								{
+									char path_s [PATH_MAX];
+
+									if (realpath (schemas_dir_s, path_s))
+										{
+											mapped_url_s = ConcatenateVarargsStrings ("file://", path_s, "/", NULL);
+										}
+
+									ok_flag = (mapped_url_s != NULL);
+								}
+
+							if (ok_flag && GenerateSchemas (&config, schemas_dir_s, base_url_s))
+								{
+									json_t *package_p = json_object ();
+									json_t *resources_p = json_array ();
+
+									if (package_p && resources_p && (json_object_set_new (package_p, FD_RESOURCES_S, resources_p) == 0))
+										{
+											uint32 seed = 1;
+											size_t j;
+
+											SetJSONString (package_p, FD_NAME_S, "fd-bench");
+
+											for (j = 0; j < config.bc_num_resources; ++ j)
+												{
+													json_array_append_new (resources_p, GenerateResource (&config, j, base_url_s, &seed));
+												}
+
+											for (j = 0; j < config.bc_num_tables; ++ j)
+												{
+													json_array_append_new (resources_p, GenerateTable (&config, j, &seed));
+												}
+
+											if (json_dump_file (package_p, package_s, JSON_INDENT (2)) == 0)
+												{
+													double *times_p = (double *) calloc (config.bc_num_iterations * BP_NUM_PHASES, sizeof (double));
+
+													if (times_p)
+														{
+															for (j = 0; (j < config.bc_num_iterations) && ok_flag; ++ j)
+																{
+																	ok_flag = RunIteration (&config, package_s, out_dir_s, base_url_s, mapped_url_s, times_p + (j * BP_NUM_PHASES));
+																}
+
+															if (ok_flag)
+																{
+																	json_t *results_p = GetResults (&config, times_p);
+
+																	if (results_p)
+																		{
+																			if (config.bc_results_file_s)
+																				{
+																					if (json_dump_file (results_p, config.bc_results_file_s, JSON_INDENT (2)) == 0)
+																						{
+																							res = 0;
+																						}
+																				}
+																			else if (json_dumpf (results_p, stdout, JSON_INDENT (2)) == 0)
+																				{
+																					printf ("\n");
+																					res = 0;
+																				}
+
+																			json_decref (results_p);
+																		}
+																}
+
+															free (times_p);
+														}
+												}
+											else
+												{
+													fprintf (stderr, "Failed to write \"%s\"\n", package_s);
+												}
+										}
+
+									json_decref (package_p);
+								}
+
+							if (mapped_url_s)
+								{
+									FreeCopiedString (mapped_url_s);
+								}
+						}
+					else
+						{
+							fprintf (stderr, "Failed to create the directories in \"%s\"\n", config.bc_work_dir_s);
+						}
+				}
+
+			if (package_s)
+				{
+					FreeCopiedString (package_s);
+				}
+
+			if (out_dir_s)
+				{
+					FreeCopiedString (out_dir_s);
+				}
+
+			if (schemas_dir_s)
+				{
+					FreeCopiedString (schemas_dir_s);
+				}
+		}
+
+	return res;
+}
+
+
+/*
+ * static definitions
+ */
+
+
+/*
+ * Write a schema for each level of nesting. Each one has the requested
+ * number of properties, cycling through the scalar types, and all but
+ * the deepest have an array of child objects using the next level's schema.
+ */
+static bool GenerateSchemas (const BenchConfig *config_p, const char *schemas_dir_s, const char *base_url_s)
+{
+	size_t level;
+
+	for (level = 0; level < config_p -> bc_depth; ++ level)
+		{
+			bool success_flag = false;
+			json_t *schema_p = json_object ();
+
+			if (schema_p)
+				{
+					json_t *properties_p = json_object ();
+
+					if (properties_p && (json_object_set_new (schema_p, "properties", properties_p) == 0))
+						{
+							json_t *required_p = json_array ();
+
+							if (required_p && (json_object_set_new (schema_p, "required", required_p) == 0))
+								{
+									size_t i;
+									char filename_s [64];
+
+									SetJSONString (schema_p, FD_TABLE_FIELD_TYPE, "object");
+
+									for (i = 0; i < config_p -> bc_num_properties; ++ i)
+										{
+											char key_s [32];
+											json_t *property_p = json_object ();
+
+											snprintf (key_s, sizeof (key_s), "property_%lu", (unsigned long) i);
+
+											SetJSONString (property_p, FD_TABLE_FIELD_TYPE, GetTypeName (i));
+											SetJSONInteger (property_p, FD_PROFILE_PROPERTY_ORDER_S, (json_int_t) i);
+
+											json_object_set_new (properties_p, key_s, property_p);
+
+											if ((i % 4) == 0)
+												{
+													json_array_append_new (required_p, json_string (key_s));
+												}
+										}
+
+									if (level + 1 < config_p -> bc_depth)
+										{
+											json_t *property_p = json_object ();
+											json_t *items_p = json_object ();
+											char *child_url_s;
+
+											snprintf (filename_s, sizeof (filename_s), "level_%lu.json", (unsigned long) (level + 1));
+											child_url_s = ConcatenateStrings (base_url_s, filename_s);
+
+											SetJSONString (property_p, FD_TABLE_FIELD_TYPE, FD_TYPE_JSON_ARRAY);
+											SetJSONInteger (property_p, FD_PROFILE_PROPERTY_ORDER_S, (json_int_t) config_p -> bc_num_properties);
+											SetJSONString (items_p, "$ref", child_url_s);
+											json_object_set_new (property_p, "items", items_p);
+											json_object_set_new (properties_p, S_CHILDREN_KEY_S, property_p);
+
+											FreeCopiedString (child_url_s);
+										}
+
+									snprintf (filename_s, sizeof (filename_s), "level_%lu.json", (unsigned long) level);
+
+									{
+										char *schema_file_s = MakeFilename (schemas_dir_s, filename_s);
+
+										if (schema_file_s)
+											{
+												success_flag = (json_dump_file (schema_p, schema_file_s, JSON_INDENT (2)) == 0);
+												FreeCopiedString (schema_file_s);
+											}
+									}
+								}
+						}
+
+					json_decref (schema_p);
+				}
+
+			if (!success_flag)
+				{
+					fprintf (stderr, "Failed to write schema for level %lu\n", (unsigned long) level);
+					return false;
+				}
+		}
+
+	return true;
+}
+
+
+static json_t *GenerateResource (const BenchConfig *config_p, const size_t index, const char *base_url_s, uint32 *seed_p)
+{
+	json_t *resource_p = GenerateObject (config_p, 0, seed_p);
+
+	if (resource_p)
+		{
+			char name_s [32];
+			char *profile_s = ConcatenateStrings (base_url_s, "level_0.json");
+
+			snprintf (name_s, sizeof (name_s), "resource-%lu", (unsigned long) index);
+
+			SetJSONString (resource_p, FD_NAME_S, name_s);
+
+			if (profile_s)
+				{
+					SetJSONString (resource_p, FD_PROFILE_S, profile_s);
+					FreeCopiedString (profile_s);
+				}
+		}
+
+	return resource_p;
+}
+
+
+static json_t *GenerateObject (const BenchConfig *config_p, const size_t level, uint32 *seed_p)
+{
+	json_t *object_p = json_object ();
+
+	if (object_p)
+		{
+			size_t i;
+
+			for (i = 0; i < config_p -> bc_num_properties; ++ i)
+				{
+					char key_s [32];
+
+					snprintf (key_s, sizeof (key_s), "property_%lu", (unsigned long) i);
+					json_object_set_new (object_p, key_s, GenerateValue (i, i, seed_p));
+				}
+
+			if (level + 1 < config_p -> bc_depth)
+				{
+					json_t *children_p = json_array ();
+
+					if (children_p)
+						{
+							for (i = 0; i < config_p -> bc_fanout; ++ i)
+								{
+									json_array_append_new (children_p, GenerateObject (config_p, level + 1, seed_p));
+								}
+
+							json_object_set_new (object_p, S_CHILDREN_KEY_S, children_p);
+						}
+				}
+		}
+
+	return object_p;
+}
+
+
+static json_t *GenerateTable (const BenchConfig *config_p, const size_t index, uint32 *seed_p)
+{
+	json_t *resource_p = json_object ();
+
+	if (resource_p)
+		{
+			json_t *schema_p = json_object ();
+			json_t *fields_p = json_array ();
+			json_t *data_p = json_array ();
+			char name_s [32];
+			size_t i;
+
+			snprintf (name_s, sizeof (name_s), "table-%lu", (unsigned long) index);
+
+			SetJSONString (resource_p, FD_NAME_S, name_s);
+			SetJSONString (resource_p, FD_PROFILE_S, FD_PROFILE_TABULAR_RESOURCE_S);
+
+			for (i = 0; i < config_p -> bc_num_columns; ++ i)
+				{
+					json_t *field_p = json_object ();
+					char key_s [32];
+
+					snprintf (key_s, sizeof (key_s), "column_%lu", (unsigned long) i);
+					SetJSONString (field_p, FD_TABLE_FIELD_NAME, key_s);
+
+					/* csv export only handles the string, integer and number types */
+					SetJSONString (field_p, FD_TABLE_FIELD_TYPE, GetTypeName (i % 3));
+					json_array_append_new (fields_p, field_p);
+				}
+
+			for (i = 0; i < config_p -> bc_num_rows; ++ i)
+				{
+					json_t *row_p = json_object ();
+					size_t j;
+
+					for (j = 0; j < config_p -> bc_num_columns; ++ j)
+						{
+							json_object_set_new (row_p, json_string_value (json_object_get (json_array_get (fields_p, j), FD_TABLE_FIELD_NAME)), GenerateValue (j % 3, i, seed_p));
+						}
+
+					json_array_append_new (data_p, row_p);
+				}
+
+			json_object_set_new (schema_p, FD_TABLE_FIELDS_S, fields_p);
+			json_object_set_new (resource_p, FD_SCHEMA_S, schema_p);
+			json_object_set_new (resource_p, FD_DATA_S, data_p);
+		}
+
+	return resource_p;
+}
+
+
+static json_t *GenerateValue (const size_t type_index, const size_t suffix, uint32 *seed_p)
+{
+	json_t *value_p = NULL;
+	const uint32 r = GetNextRandom (seed_p);
+
+	switch (type_index % 4)
+		{
+			case 0:
+				{
+					/*
+					 * Mix in some characters that need escaping
+					 * along with some values of varying length
+					 */
+					static const char * const words_ss [] = { "wheat", "barley", "plot <A>", "rust & mildew", "\"trial\"", "Earlham Institute, Norwich Research Park" };
+					char buffer_s [128];
+
+					snprintf (buffer_s, sizeof (buffer_s), "%s %lu", words_ss [r % (sizeof (words_ss) / sizeof (words_ss [0]))], (unsigned long) suffix);
+					value_p = json_string (buffer_s);
+				}
+				break;
+
+			case 1:
+				value_p = json_integer ((json_int_t) r);
+				break;
+
+			case 2:
+				value_p = json_real ((double) r / 1000.0);
+				break;
+
+			default:
+				value_p = json_boolean (r & 1);
+				break;
+		}
+
+	return value_p;
+}
+
+
+static const char *GetTypeName (const size_t type_index)
+{
+	const char *type_s;
+
+	switch (type_index % 4)
+		{
+			case 0:
+				type_s = FD_TYPE_STRING;
+				break;
+
+			case 1:
+				type_s = FD_TYPE_INTEGER;
+				break;
+
+			case 2:
+				type_s = FD_TYPE_NUMBER;
+				break;
+
+			default:
+				type_s = FD_TYPE_BOOLEAN;
+				break;
+		}
+
+	return type_s;
+}
+
+
+/*
+ * A simple linear congruential generator so that the
+ * generated packages are the same on every platform.
+ */
+static uint32 GetNextRandom (uint32 *seed_p)
+{
+	*seed_p = (*seed_p * 1103515245U) + 12345U;
+
+	return (*seed_p >> 8);
+}
+
+
+static bool RunIteration (const BenchConfig *config_p, const char *package_s, const char *out_dir_s, const char *base_url_s, const char *mapped_url_s, double *times_p)
+{
+	bool success_flag = false;
+	SchemaCache *cache_p = AllocateSchemaCache ();
+
+	if (cache_p)
+		{
+			if ((!mapped_url_s) || (AddSchemaMapping (cache_p, base_url_s, mapped_url_s)))
+				{
+					Printer *printer_p = NULL;
+					const char *ext_s = NULL;
+
+					if (config_p -> bc_template_file_s)
+						{
+							PrinterTemplate *template_p = LoadPrinterTemplate (config_p -> bc_template_file_s);
+
+							if (template_p)
+								{
+									printer_p = AllocateTemplatePrinter (template_p);
+
+									if (printer_p)
+										{
+											ext_s = template_p -> pt_extension_s;
+										}
+									else
+										{
+											FreePrinterTemplate (template_p);
+										}
+								}
+						}
+					else if (config_p -> bc_markdown_flag)
+						{
+							printer_p = AllocateMarkdownPrinter (false);
+							ext_s = "md";
+						}
+					else
+						{
+							printer_p = AllocateHTMLPrinter ();
+							ext_s = "html";
+						}
+
+					if (printer_p)
+						{
+							json_error_t err;
+							double start = GetWallClockTime ();
+							json_t *package_p = json_load_file (package_s, 0, &err);
+
+							times_p [BP_LOAD] = GetWallClockTime () - start;
+
+							if (package_p)
+								{
+									const json_t *resources_p = json_object_get (package_p, FD_RESOURCES_S);
+									const json_t *resource_p;
+									size_t i;
+
+									success_flag = true;
+
+									/*
+									 * Fetch all of the schemas up front so that
+									 * the render timings don't include them
+									 */
+									start = GetWallClockTime ();
+
+									json_array_foreach (resources_p, i, resource_p)
+										{
+											const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
+
+											if (DoesStringStartWith (profile_s, "http"))
+												{
+													if (!FetchSchemas (cache_p, GetSchemaFromCache (cache_p, profile_s), profile_s, 0))
+														{
+															fprintf (stderr, "Failed to get schema \"%s\"\n", profile_s);
+															success_flag = false;
+														}
+												}
+										}
+
+									times_p [BP_SCHEMA_FETCH] = GetWallClockTime () - start;
+
+									/*
+									 * Render the resources that use the web-based profiles
+									 */
+									start = GetWallClockTime ();
+
+									json_array_foreach (resources_p, i, resource_p)
+										{
+											const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
+
+											if (DoesStringStartWith (profile_s, "http"))
+												{
+													char *filename_s = ConcatenateVarargsStrings (out_dir_s, "/", GetJSONString (resource_p, FD_NAME_S), ".", ext_s, NULL);
+
+													if (filename_s)
+														{
+															if (OpenFDPrinter (printer_p, filename_s))
+																{
+																	PrintHeader (printer_p, GetJSONString (resource_p, FD_NAME_S), NULL);
+																	ParsePackageFromSchema (resource_p, GetSchemaFromCache (cache_p, profile_s), profile_s, printer_p, cache_p, false, false, 0);
+																	PrintFooter (printer_p, NULL);
+
+																	if (!CloseFDPrinter (printer_p))
+																		{
+																			success_flag = false;
+																		}
+																}
+
+															FreeCopiedString (filename_s);
+														}
+												}
+										}
+
+									times_p [BP_RENDER] = GetWallClockTime () - start;
+
+									/*
+									 * Export the tables
+									 */
+									start = GetWallClockTime ();
+
+									json_array_foreach (resources_p, i, resource_p)
+										{
+											const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
+
+											if ((profile_s) && (strcmp (profile_s, FD_PROFILE_TABULAR_RESOURCE_S) == 0))
+												{
+													char *filename_s = ConcatenateVarargsStrings (out_dir_s, "/", GetJSONString (resource_p, FD_NAME_S), ".csv", NULL);
+
+													if (filename_s)
+														{
+															const json_t *headers_p = json_object_get (json_object_get (resource_p, FD_SCHEMA_S), FD_TABLE_FIELDS_S);
+
+															if (!CreateCSVFile (filename_s, ",", "\n", headers_p, json_object_get (resource_p, FD_DATA_S)))
+																{
+																	success_flag = false;
+																}
+
+															FreeCopiedString (filename_s);
+														}
+												}
+										}
+
+									times_p [BP_CSV_EXPORT] = GetWallClockTime () - start;
+
+									json_decref (package_p);
+								}
+							else
+								{
+									fprintf (stderr, "Failed to load \"%s\": %s\n", package_s, err.text);
+								}
+
+							FreeFDPrinter (printer_p);
+						}
+				}
+
+			FreeSchemaCache (cache_p);
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Load the child schemas that a schema refers to
+ */
+static bool FetchSchemas (SchemaCache *cache_p, const json_t *schema_p, const char *schema_url_s, const size_t depth)
+{
+	bool success_flag = false;
+
+	if (schema_p)
+		{
+			const json_t *properties_p = json_object_get (schema_p, "properties");
+			const char *key_s;
+			json_t *property_p;
+
+			success_flag = true;
+
+			json_object_foreach ((json_t *) properties_p, key_s, property_p)
+				{
+					const char *ref_s = GetRefSchemaURI (property_p);
+
+					if ((ref_s) && (*ref_s != '#') && (depth < 16))
+						{
+							char *child_url_s = GetAbsoluteSchemaURL (schema_url_s, ref_s);
+
+							if (child_url_s)
+								{
+									if (!FetchSchemas (cache_p, GetSchemaFromCache (cache_p, child_url_s), child_url_s, depth + 1))
+										{
+											success_flag = false;
+										}
+
+									FreeCopiedString (child_url_s);
+								}
+							else
+								{
+									success_flag = false;
+								}
+						}
+				}
+		}
+
+	return success_flag;
+}
+
+
+static json_t *GetResults (const BenchConfig *config_p, double *times_p)
+{
+	json_t *results_p = json_object ();
+
+	if (results_p)
+		{
+			json_t *config_json_p = json_pack ("{s:I,s:I,s:I,s:I,s:I,s:I,s:I,s:I,s:s,s:s}",
+																				 "resources", (json_int_t) config_p -> bc_num_resources,
+																				 "tables", (json_int_t) config_p -> bc_num_tables,
+																				 "properties", (json_int_t) config_p -> bc_num_properties,
+																				 "depth", (json_int_t) config_p -> bc_depth,
+																				 "fanout", (json_int_t) config_p -> bc_fanout,
+																				 "rows", (json_int_t) config_p -> bc_num_rows,
+																				 "columns", (json_int_t) config_p -> bc_num_columns,
+																				 "iterations", (json_int_t) config_p -> bc_num_iterations,
+																				 "format", config_p -> bc_template_file_s ? "template" : (config_p -> bc_markdown_flag ? "markdown" : "html"),
+																				 "schemas", config_p -> bc_schema_url_s ? "http" : "file");
+			json_t *phases_p = json_object ();
+
+			if (config_json_p && phases_p)
+				{
+					size_t i;
+
+					json_object_set_new (results_p, "config", config_json_p);
+					json_object_set_new (results_p, "phases", phases_p);
+
+					for (i = 0; i < BP_NUM_PHASES; ++ i)
+						{
+							double min_time = times_p [i];
+							double max_time = times_p [i];
+							double total_time = 0.0;
+							size_t j;
+
+							for (j = 0; j < config_p -> bc_num_iterations; ++ j)
+								{
+									const double t = times_p [(j * BP_NUM_PHASES) + i];
+
+									if (t < min_time)
+										{
+											min_time = t;
+										}
+
+									if (t > max_time)
+										{
+											max_time = t;
+										}
+
+									total_time += t;
+								}
+
+							json_object_set_new (phases_p, S_PHASE_NAMES [i], json_pack ("{s:f,s:f,s:f}", "min_s", min_time, "mean_s", total_time / config_p -> bc_num_iterations, "max_s", max_time));
+						}
+
+					return results_p;
+				}
+
+			json_decref (config_json_p);
+			json_decref (phases_p);
+			json_decref (results_p);
+		}
+
+	return NULL;
+}
+
+
+static bool ParseSizeArgument (int argc, char *argv [], int *index_p, size_t *value_p)
+{
+	if ((*index_p + 1) < argc)
+		{
+			char *end_s;
+			const unsigned long value = strtoul (argv [++ (*index_p)], &end_s, 10);
+
+			if (*end_s == '\0')
+				{
+					*value_p = (size_t) value;
+					return true;
+				}
+		}
+
+	return false;
+}
@@ -0,0 +1,611 @@
+/*
+ * composite_printer.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "composite_printer.h"
+
+#include "string_utils.h"
+
+
+typedef struct
+{
+	Printer cp_printer;
+	Printer **cp_printers_pp;
+	char **cp_extensions_ss;
+	size_t cp_num_printers;
+} CompositePrinter;
+
+
+/*
+ * static declarations
+ */
+
+static bool PrintCompositeHeader (Printer *printer_p, const char *title_s, const char *text_s);
+
+static bool PrintCompositeFooter (Printer *printer_p, const char *text_s);
+
+static bool PrintCompositeText (Printer *printer_p, const char *value_s);
+
+static bool PrintCompositeString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s);
+
+static bool PrintCompositeInteger (Printer *printer_p, const char *key_s, const json_int_t *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintCompositeNumber (Printer *printer_p, const char *key_s, const double *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintCompositeBoolean (Printer *printer_p, const char *key_s, const bool *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintCompositeJSON (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s);
+
+static void FreeCompositePrinter (Printer *printer_p);
+
+static bool PrintCompositeSectionStart (Printer *printer_p, const char *value_s);
+
+static bool PrintCompositeSectionEnd (Printer *printer_p, const char *value_s);
+
+static bool PrintCompositeEntryStart (Printer *printer_p);
+
+static bool PrintCompositeEntryEnd (Printer *printer_p);
+
+static bool PrintCompositeObjectStart (Printer *printer_p, const char *key_s, const char *title_s);
+
+static bool PrintCompositeObjectEnd (Printer *printer_p);
+
+static bool PrintCompositeDocumentStart (Printer *printer_p, const char *title_s);
+
+static bool PrintCompositeContents (Printer *printer_p, const json_t *entries_p);
+
+static bool PrintCompositeResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s);
+
+static bool PrintCompositeResourceEnd (Printer *printer_p, const char *text_s);
+
+static bool PrintCompositeDocumentEnd (Printer *printer_p);
+
+static bool OpenCompositePrinter (Printer *printer_p, const char *filename_s);
+
+static bool CloseCompositePrinter (Printer *printer_p);
+
+
+/*
+ * api definitions
+ */
+
+Printer *AllocateCompositePrinter (Printer **printers_pp, const char **extensions_ss, const size_t num_printers)
+{
+	CompositePrinter *printer_p = (CompositePrinter *) malloc (sizeof (CompositePrinter));
+
+	if (printer_p)
+		{
+			printer_p -> cp_printers_pp = (Printer **) calloc (num_printers, sizeof (Printer *));
+
+			if (printer_p -> cp_printers_pp)
+				{
+					printer_p -> cp_extensions_ss = (char **) calloc (num_printers, sizeof (char *));
+
+					if (printer_p -> cp_extensions_ss)
+						{
+							size_t i;
+							bool documents_flag = true;
+
+							for (i = 0; i < num_printers; ++ i)
+								{
+									printer_p -> cp_extensions_ss [i] = EasyCopyToNewString (extensions_ss [i]);
+
+									if (! (printer_p -> cp_extensions_ss [i]))
+										{
+											while (i > 0)
+												{
+													-- i;
+													FreeCopiedString (printer_p -> cp_extensions_ss [i]);
+												}
+
+											free (printer_p -> cp_extensions_ss);
+											free (printer_p -> cp_printers_pp);
+											free (printer_p);
+
+											return NULL;
+										}
+
+									if (!DoesFDPrinterSupportDocuments (printers_pp [i]))
+										{
+											documents_flag = false;
+										}
+								}
+
+							memcpy (printer_p -> cp_printers_pp, printers_pp, num_printers * sizeof (Printer *));
+							printer_p -> cp_num_printers = num_printers;
+
+							InitFDPrinter (& (printer_p -> cp_printer), PrintCompositeHeader, PrintCompositeFooter, PrintCompositeText,
+														 PrintCompositeSectionStart, PrintCompositeSectionEnd, PrintCompositeString,
+														 PrintCompositeInteger, PrintCompositeNumber, PrintCompositeBoolean, PrintCompositeJSON, FreeCompositePrinter);
+
+							SetFDPrinterEntryFunctions (& (printer_p -> cp_printer), PrintCompositeEntryStart, PrintCompositeEntryEnd);
+							SetFDPrinterObjectFunctions (& (printer_p -> cp_printer), PrintCompositeObjectStart, PrintCompositeObjectEnd);
+							SetFDPrinterFileFunctions (& (printer_p -> cp_printer), OpenCompositePrinter, CloseCompositePrinter);
+
+							if (documents_flag)
+								{
+									SetFDPrinterDocumentFunctions (& (printer_p -> cp_printer), PrintCompositeDocumentStart, PrintCompositeContents, PrintCompositeResourceStart,
+																								 PrintCompositeResourceEnd, PrintCompositeDocumentEnd);
+								}
+
+							return (& (printer_p -> cp_printer));
+						}
+
+					free (printer_p -> cp_printers_pp);
+				}
+
+			free (printer_p);
+		}
+
+	return NULL;
+}
+
+
+/*
+ * static definitions
+ */
+
+/*
+ * Each of these calls every Printer even if an earlier one fails
+ * so that one bad file doesn't stop the others being written.
+ */
+
+static bool PrintCompositeHeader (Printer *printer_p, const char *title_s, const char *text_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintHeader (comp_printer_p -> cp_printers_pp [i], title_s, text_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeFooter (Printer *printer_p, const char *text_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintFooter (comp_printer_p -> cp_printers_pp [i], text_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeText (Printer *printer_p, const char *value_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintText (comp_printer_p -> cp_printers_pp [i], value_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintString (comp_printer_p -> cp_printers_pp [i], key_s, value_s, required_flag, format_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeInteger (Printer *printer_p, const char *key_s, const json_int_t *value_p, const bool required_flag, const char *format_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintInteger (comp_printer_p -> cp_printers_pp [i], key_s, value_p, required_flag, format_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeNumber (Printer *printer_p, const char *key_s, const double *value_p, const bool required_flag, const char *format_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintNumber (comp_printer_p -> cp_printers_pp [i], key_s, value_p, required_flag, format_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeBoolean (Printer *printer_p, const char *key_s, const bool *value_p, const bool required_flag, const char *format_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintBoolean (comp_printer_p -> cp_printers_pp [i], key_s, value_p, required_flag, format_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeJSON (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			Printer *child_p = comp_printer_p -> cp_printers_pp [i];
+
+			/* The limits are set on this Printer so pass them on */
+			SetFDPrinterJSONLimits (child_p, printer_p -> pr_json_max_size, printer_p -> pr_json_collapse_size);
+
+			if (!PrintJSONObject (child_p, key_s, value_p, required_flag, format_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static void FreeCompositePrinter (Printer *printer_p)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			FreeFDPrinter (comp_printer_p -> cp_printers_pp [i]);
+			FreeCopiedString (comp_printer_p -> cp_extensions_ss [i]);
+		}
+
+	free (comp_printer_p -> cp_extensions_ss);
+	free (comp_printer_p -> cp_printers_pp);
+	free (comp_printer_p);
+}
+
+
+static bool PrintCompositeSectionStart (Printer *printer_p, const char *value_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!StartPrintSection (comp_printer_p -> cp_printers_pp [i], value_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeSectionEnd (Printer *printer_p, const char *value_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!EndPrintSection (comp_printer_p -> cp_printers_pp [i], value_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeEntryStart (Printer *printer_p)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!StartPrintEntry (comp_printer_p -> cp_printers_pp [i]))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeEntryEnd (Printer *printer_p)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!EndPrintEntry (comp_printer_p -> cp_printers_pp [i]))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeObjectStart (Printer *printer_p, const char *key_s, const char *title_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!StartPrintObject (comp_printer_p -> cp_printers_pp [i], key_s, title_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeObjectEnd (Printer *printer_p)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!EndPrintObject (comp_printer_p -> cp_printers_pp [i]))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeDocumentStart (Printer *printer_p, const char *title_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintDocumentStart (comp_printer_p -> cp_printers_pp [i], title_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeContents (Printer *printer_p, const json_t *entries_p)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintContents (comp_printer_p -> cp_printers_pp [i], entries_p))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintResourceStart (comp_printer_p -> cp_printers_pp [i], anchor_s, title_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeResourceEnd (Printer *printer_p, const char *text_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintResourceEnd (comp_printer_p -> cp_printers_pp [i], text_s))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintCompositeDocumentEnd (Printer *printer_p)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!PrintDocumentEnd (comp_printer_p -> cp_printers_pp [i]))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Open a file for each Printer by swapping the filename's
+ * extension for each Printer's one.
+ */
+static bool OpenCompositePrinter (Printer *printer_p, const char *filename_s)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = false;
+	const char *dot_s = strrchr (filename_s, '.');
+	const char *sep_s = strrchr (filename_s, '/');
+	char *stem_s;
+
+#ifdef WINDOWS
+	if (!sep_s)
+		{
+			sep_s = strrchr (filename_s, '\\');
+		}
+#endif
+
+	if ((!dot_s) || (sep_s && (dot_s < sep_s)))
+		{
+			dot_s = filename_s + strlen (filename_s);
+		}
+
+	stem_s = CopyToNewString (filename_s, dot_s - filename_s, false);
+
+	if (stem_s)
+		{
+			size_t i;
+
+			success_flag = true;
+
+			for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+				{
+					char *child_filename_s = ConcatenateVarargsStrings (stem_s, ".", comp_printer_p -> cp_extensions_ss [i], NULL);
+
+					if (child_filename_s)
+						{
+							SetFDPrinterOutputSinks (comp_printer_p -> cp_printers_pp [i], printer_p -> pr_get_sink_fn, printer_p -> pr_get_sink_data_p);
+							SetFDPrinterOutputDirectory (comp_printer_p -> cp_printers_pp [i], printer_p -> pr_out_dir_p);
+
+							if (!OpenFDPrinter (comp_printer_p -> cp_printers_pp [i], child_filename_s))
+								{
+									fprintf (stderr, "Failed to open \"%s\"\n", child_filename_s);
+									success_flag = false;
+								}
+
+							FreeCopiedString (child_filename_s);
+						}
+					else
+						{
+							success_flag = false;
+						}
+				}
+
+			FreeCopiedString (stem_s);
+		}
+
+	if (success_flag)
+		{
+			printer_p -> pr_out_f = comp_printer_p -> cp_printers_pp [0] -> pr_out_f;
+		}
+	else
+		{
+			CloseCompositePrinter (printer_p);
+		}
+
+	return success_flag;
+}
+
+
+static bool CloseCompositePrinter (Printer *printer_p)
+{
+	CompositePrinter *comp_printer_p = (CompositePrinter *) printer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; i < comp_printer_p -> cp_num_printers; ++ i)
+		{
+			if (!CloseFDPrinter (comp_printer_p -> cp_printers_pp [i]))
+				{
+					success_flag = false;
+				}
+		}
+
+	printer_p -> pr_out_f = NULL;
+
+	return success_flag;
+}
@@ -0,0 +1,1248 @@
+/*
+ * csv_reader.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WINDOWS
+	#include <intrin.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#if defined __SSE2__ || defined _M_X64
+	#include <emmintrin.h>
+	#define CSV_READER_USE_SSE2 (1)
+#endif
+
+#include "csv_reader.h"
+
+#include "frictionless_data_util.h"
+#include "parallel_tasks.h"
+
+#include "curl_tools.h"
+#include "json_util.h"
+#include "string_utils.h"
+
+
+typedef enum
+{
+	/** At the start of a value. */
+	CPS_VALUE_START,
+
+	/** In a value that isn't quoted. */
+	CPS_UNQUOTED,
+
+	/** In a quoted value. */
+	CPS_QUOTED,
+
+	/** Just after a quote in a quoted value, which is either the end of the value or an escaped quote. */
+	CPS_QUOTE,
+
+	/** Just after a carriage return, which may be followed by a line feed. */
+	CPS_CARRIAGE_RETURN
+} CSVParserState;
+
+
+typedef struct
+{
+	char cd_delimiter;
+	char cd_quote;
+	bool cd_header_flag;
+} CSVDialect;
+
+
+/*
+ * A CSV parser that can be given the data a buffer at a time, so
+ * it only needs to store the values of the row that it is in.
+ */
+typedef struct
+{
+	CSVDialect cp_dialect;
+	CSVParserState cp_state;
+	CSVRowCallback cp_row_fn;
+	void *cp_row_data_p;
+
+	/** The values of the current row, each terminated by a '\0'. */
+	char *cp_values_s;
+	size_t cp_values_length;
+	size_t cp_values_capacity;
+
+	/** The offset in cp_values_s of each value of the current row. */
+	size_t *cp_offsets_p;
+	char **cp_values_ss;
+	size_t cp_num_values;
+	size_t cp_max_values;
+
+	/** Whether anything has been read for the current row, so that blank lines can be skipped. */
+	bool cp_row_started_flag;
+
+	/** The number of records read from the current part, including any header row. */
+	size_t cp_num_records;
+
+	/** The number of the last data row that has been read. */
+	size_t cp_row;
+
+	/** Whether the header row of the current part is passed on or skipped. */
+	bool cp_skip_header_flag;
+
+	bool cp_stopped_flag;
+
+	/**
+	 * If this is set, the parser stops at the first row that starts at or
+	 * after it and sets cp_stop_s to where that row starts.
+	 */
+	const char *cp_limit_s;
+	const char *cp_stop_s;
+
+	/**
+	 * If this is set, the parser gives up and sets cp_aborted_flag when it
+	 * gets this far, as the row that it is in has run on for too long.
+	 */
+	const char *cp_abort_s;
+	bool cp_aborted_flag;
+} CSVParser;
+
+
+/*
+ * The state for reading a resource's data a chunk at a time
+ */
+typedef struct
+{
+	CSVDialect cr_dialect;
+	CSVRowCallback cr_header_fn;
+	const CSVChunkFunctions *cr_functions_p;
+	void **cr_chunks_pp;
+	size_t cr_num_chunks;
+	size_t cr_num_threads;
+	void *cr_data_p;
+
+	/** The number of rows that have been merged so far. */
+	size_t cr_num_rows;
+
+	/** Whether the header row of the current part is skipped. */
+	bool cr_skip_header_flag;
+} CSVChunkReader;
+
+
+/*
+ * A byte range of a memory-mapped file that is parsed as a single chunk.
+ */
+typedef struct
+{
+	/** Where the parsing starts, which is only a guess for all but the first block of a round. */
+	const char *cb_start_s;
+
+	/** The block has the rows that start before this. */
+	const char *cb_limit_s;
+
+	/** Where the first row after the block starts. */
+	const char *cb_stop_s;
+
+	/**
+	 * If this is set, the block is given up on if it gets this far, as its
+	 * guessed start was most likely within a quoted value.
+	 */
+	const char *cb_abort_s;
+
+	size_t cb_num_rows;
+	bool cb_success_flag;
+} CSVBlock;
+
+
+/*
+ * The blocks that are parsed in parallel before being merged
+ */
+typedef struct
+{
+	CSVChunkReader *br_reader_p;
+	CSVBlock *br_blocks_p;
+
+	/** The start and end of the mapped file. */
+	const char *br_data_s;
+	const char *br_end_s;
+} CSVBlockRound;
+
+
+/*
+ * The state for splitting data that is parsed as it is read into chunks of rows
+ */
+typedef struct
+{
+	CSVChunkReader *cs_reader_p;
+	size_t cs_num_rows;
+} CSVChunkStream;
+
+
+/*
+ * Local files are split into blocks of this size which are parsed
+ * in parallel and then released once they've been merged.
+ */
+static const size_t S_BLOCK_SIZE = 1 << 20;
+
+/*
+ * The number of rows in each chunk of the files that are parsed as they are read.
+ */
+static const size_t S_STREAMED_CHUNK_ROWS = 1 << 14;
+
+static const size_t S_READ_BUFFER_SIZE = 1 << 16;
+
+
+/*
+ * static declarations
+ */
+
+static void InitCSVDialect (CSVDialect *dialect_p, const json_t *resource_p);
+
+static bool InitCSVParser (CSVParser *parser_p, const CSVDialect *dialect_p, CSVRowCallback row_fn, void *data_p);
+
+static void ClearCSVParser (CSVParser *parser_p);
+
+static bool ParseCSVBuffer (CSVParser *parser_p, const char *buffer_s, const size_t length);
+
+static bool FinishCSVPart (CSVParser *parser_p);
+
+static bool AppendToValue (CSVParser *parser_p, const char *start_s, const size_t length);
+
+static bool EndValue (CSVParser *parser_p);
+
+static bool EndRow (CSVParser *parser_p);
+
+static const char *FindUnquotedEnd (const char *start_s, const char *end_s, const char delimiter);
+
+static bool ReadStreamedCSVPart (CSVChunkReader *reader_p, const char *location_s);
+
+static bool AddStreamedRow (void *data_p, const size_t row, char **values_ss, const size_t num_values);
+
+static bool MergeStreamedChunk (CSVChunkStream *stream_p);
+
+static bool ReadCSVFile (CSVParser *parser_p, const char *filename_s);
+
+static bool ReadCSVURL (CSVParser *parser_p, const char *url_s);
+
+static size_t ParseDownloadedData (char *data_p, size_t size, size_t num_items, void *parser_p);
+
+#ifndef WINDOWS
+static bool ReadMappedCSVPart (CSVChunkReader *reader_p, const char *filename_s);
+
+static const char *ReadMappedCSVHeader (CSVChunkReader *reader_p, const char *data_s, const char *end_s);
+
+static const char *FindSpeculativeRowStart (const char *start_s, const char *end_s, const CSVDialect *dialect_p);
+
+static void ParseCSVBlockTask (void *data_p, const size_t task_index);
+
+static void ParseCSVBlock (CSVChunkReader *reader_p, CSVBlock *block_p, void *chunk_p, const char *data_s, const char *end_s);
+#endif
+
+static char *GetCSVPartLocation (const char *package_file_s, const char *path_s);
+
+
+/*
+ * api definitions
+ */
+
+bool IsPathBasedResource (const json_t *resource_p)
+{
+	const json_t *path_p = json_object_get (resource_p, "path");
+
+	return ((json_is_string (path_p) || json_is_array (path_p)) && (!json_object_get (resource_p, FD_DATA_S)));
+}
+
+
+bool ReadCSVResource (const json_t *resource_p, const char *package_file_s, CSVRowCallback header_fn, const CSVChunkFunctions *functions_p, void **chunks_pp, const size_t num_chunks, const size_t num_threads, void *data_p)
+{
+	bool success_flag = true;
+	const json_t *path_p = json_object_get (resource_p, "path");
+	const size_t num_parts = json_is_array (path_p) ? json_array_size (path_p) : 1;
+	CSVChunkReader reader;
+	size_t i;
+
+	memset (&reader, 0, sizeof (CSVChunkReader));
+	InitCSVDialect (& (reader.cr_dialect), resource_p);
+
+	reader.cr_header_fn = header_fn;
+	reader.cr_functions_p = functions_p;
+	reader.cr_chunks_pp = chunks_pp;
+	reader.cr_num_chunks = num_chunks;
+	reader.cr_num_threads = num_threads;
+	reader.cr_data_p = data_p;
+
+	for (i = 0; (i < num_parts) && success_flag; ++ i)
+		{
+			const json_t *part_p = json_is_array (path_p) ? json_array_get (path_p, i) : path_p;
+			const char *part_s = json_string_value (part_p);
+
+			success_flag = false;
+
+			if (part_s)
+				{
+					char *location_s = GetCSVPartLocation (package_file_s, part_s);
+
+					if (location_s)
+						{
+							/* Only the first part's header is used */
+							reader.cr_skip_header_flag = (i > 0);
+
+#ifdef WINDOWS
+							success_flag = ReadStreamedCSVPart (&reader, location_s);
+#else
+							if (strstr (location_s, "://"))
+								{
+									success_flag = ReadStreamedCSVPart (&reader, location_s);
+								}
+							else
+								{
+									success_flag = ReadMappedCSVPart (&reader, location_s);
+								}
+#endif
+
+							FreeCopiedString (location_s);
+						}
+				}
+			else
+				{
+					fprintf (stderr, "The path of the resource is not a string or an array of strings\n");
+				}
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * static definitions
+ */
+
+static void InitCSVDialect (CSVDialect *dialect_p, const json_t *resource_p)
+{
+	const json_t *dialect_json_p = json_object_get (resource_p, "dialect");
+	const char *format_s = GetJSONString (resource_p, "format");
+
+	dialect_p -> cd_delimiter = ',';
+	dialect_p -> cd_quote = '"';
+	dialect_p -> cd_header_flag = true;
+
+	if ((format_s) && (strcmp (format_s, "tsv") == 0))
+		{
+			dialect_p -> cd_delimiter = '\t';
+		}
+
+	if (dialect_json_p)
+		{
+			const char *value_s = GetJSONString (dialect_json_p, "delimiter");
+
+			/* Only single byte delimiters and quotes are supported */
+			if ((value_s) && (*value_s != '\0'))
+				{
+					dialect_p -> cd_delimiter = *value_s;
+				}
+
+			value_s = GetJSONString (dialect_json_p, "quoteChar");
+
+			if ((value_s) && (*value_s != '\0'))
+				{
+					dialect_p -> cd_quote = *value_s;
+				}
+
+			GetJSONBoolean (dialect_json_p, "header", & (dialect_p -> cd_header_flag));
+		}
+}
+
+
+static bool InitCSVParser (CSVParser *parser_p, const CSVDialect *dialect_p, CSVRowCallback row_fn, void *data_p)
+{
+	memset (parser_p, 0, sizeof (CSVParser));
+
+	parser_p -> cp_dialect = *dialect_p;
+	parser_p -> cp_state = CPS_VALUE_START;
+	parser_p -> cp_row_fn = row_fn;
+	parser_p -> cp_row_data_p = data_p;
+
+	parser_p -> cp_values_capacity = 1024;
+	parser_p -> cp_values_s = (char *) malloc (parser_p -> cp_values_capacity);
+
+	if (parser_p -> cp_values_s)
+		{
+			parser_p -> cp_max_values = 64;
+			parser_p -> cp_offsets_p = (size_t *) malloc (parser_p -> cp_max_values * sizeof (size_t));
+
+			if (parser_p -> cp_offsets_p)
+				{
+					parser_p -> cp_values_ss = (char **) malloc (parser_p -> cp_max_values * sizeof (char *));
+
+					if (parser_p -> cp_values_ss)
+						{
+							return true;
+						}
+
+					free (parser_p -> cp_offsets_p);
+				}
+
+			free (parser_p -> cp_values_s);
+		}
+
+	return false;
+}
+
+
+static void ClearCSVParser (CSVParser *parser_p)
+{
+	free (parser_p -> cp_values_ss);
+	free (parser_p -> cp_offsets_p);
+	free (parser_p -> cp_values_s);
+}
+
+
+static bool ParseCSVBuffer (CSVParser *parser_p, const char *buffer_s, const size_t length)
+{
+	const char *c_p = buffer_s;
+	const char *end_s = buffer_s + length;
+	const char delimiter = parser_p -> cp_dialect.cd_delimiter;
+	const char quote = parser_p -> cp_dialect.cd_quote;
+	bool success_flag = true;
+
+	/* Skip any UTF-8 byte order mark */
+	if ((parser_p -> cp_num_records == 0) && (!parser_p -> cp_row_started_flag) && (length >= 3) && (memcmp (c_p, "\xEF\xBB\xBF", 3) == 0))
+		{
+			c_p += 3;
+		}
+
+	while ((c_p < end_s) && success_flag)
+		{
+			if ((parser_p -> cp_abort_s) && (c_p >= parser_p -> cp_abort_s))
+				{
+					parser_p -> cp_aborted_flag = true;
+					return true;
+				}
+
+			switch (parser_p -> cp_state)
+				{
+					case CPS_VALUE_START:
+						if ((parser_p -> cp_limit_s) && (!parser_p -> cp_row_started_flag) && (c_p >= parser_p -> cp_limit_s))
+							{
+								parser_p -> cp_stop_s = c_p;
+								return true;
+							}
+
+						if (*c_p == quote)
+							{
+								parser_p -> cp_state = CPS_QUOTED;
+								parser_p -> cp_row_started_flag = true;
+								++ c_p;
+							}
+						else
+							{
+								parser_p -> cp_state = CPS_UNQUOTED;
+							}
+						break;
+
+					case CPS_UNQUOTED:
+						{
+							const char *value_end_s = FindUnquotedEnd (c_p, end_s, delimiter);
+
+							if (value_end_s > c_p)
+								{
+									parser_p -> cp_row_started_flag = true;
+									success_flag = AppendToValue (parser_p, c_p, value_end_s - c_p);
+								}
+
+							c_p = value_end_s;
+
+							if ((c_p < end_s) && success_flag)
+								{
+									if (*c_p == delimiter)
+										{
+											parser_p -> cp_row_started_flag = true;
+											success_flag = EndValue (parser_p);
+											parser_p -> cp_state = CPS_VALUE_START;
+										}
+									else
+										{
+											/* Blank lines are skipped */
+											if (parser_p -> cp_row_started_flag)
+												{
+													success_flag = EndValue (parser_p) && EndRow (parser_p);
+												}
+
+											parser_p -> cp_state = (*c_p == '\r') ? CPS_CARRIAGE_RETURN : CPS_VALUE_START;
+										}
+
+									++ c_p;
+								}
+						}
+						break;
+
+					case CPS_QUOTED:
+						{
+							/* Don't gather a quoted value beyond where the parser gives up */
+							const char *search_end_s = ((parser_p -> cp_abort_s) && (parser_p -> cp_abort_s < end_s)) ? parser_p -> cp_abort_s : end_s;
+							const char *quote_s = (const char *) memchr (c_p, quote, search_end_s - c_p);
+							const char *value_end_s = quote_s ? quote_s : search_end_s;
+
+							if (value_end_s > c_p)
+								{
+									success_flag = AppendToValue (parser_p, c_p, value_end_s - c_p);
+								}
+
+							if (quote_s)
+								{
+									parser_p -> cp_state = CPS_QUOTE;
+									c_p = quote_s + 1;
+								}
+							else
+								{
+									c_p = search_end_s;
+								}
+						}
+						break;
+
+					case CPS_QUOTE:
+						if (*c_p == quote)
+							{
+								/* A doubled quote is an escaped quote */
+								success_flag = AppendToValue (parser_p, c_p, 1);
+								parser_p -> cp_state = CPS_QUOTED;
+								++ c_p;
+							}
+						else
+							{
+								/* Anything after the closing quote is added to the value as it is */
+								parser_p -> cp_state = CPS_UNQUOTED;
+							}
+						break;
+
+					case CPS_CARRIAGE_RETURN:
+						if (*c_p == '\n')
+							{
+								++ c_p;
+							}
+
+						parser_p -> cp_state = CPS_VALUE_START;
+						break;
+				}
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Pass on the last row if the data doesn't end with a new line
+ */
+static bool FinishCSVPart (CSVParser *parser_p)
+{
+	bool success_flag = true;
+
+	if (parser_p -> cp_row_started_flag)
+		{
+			success_flag = EndValue (parser_p) && EndRow (parser_p);
+		}
+
+	parser_p -> cp_state = CPS_VALUE_START;
+
+	return success_flag;
+}
+
+
+static bool AppendToValue (CSVParser *parser_p, const char *start_s, const size_t length)
+{
+	/* Leave room for the terminating '\0' */
+	const size_t required_length = parser_p -> cp_values_length + length + 1;
+
+	if (required_length > parser_p -> cp_values_capacity)
+		{
+			size_t new_capacity = parser_p -> cp_values_capacity << 1;
+			char *values_s;
+
+			while (new_capacity < required_length)
+				{
+					new_capacity <<= 1;
+				}
+
+			values_s = (char *) realloc (parser_p -> cp_values_s, new_capacity);
+
+			if (!values_s)
+				{
+					fprintf (stderr, "Failed to allocate %lu bytes for a CSV row\n", (unsigned long) new_capacity);
+					return false;
+				}
+
+			parser_p -> cp_values_s = values_s;
+			parser_p -> cp_values_capacity = new_capacity;
+		}
+
+	memcpy (parser_p -> cp_values_s + parser_p -> cp_values_length, start_s, length);
+	parser_p -> cp_values_length += length;
+
+	return true;
+}
+
+
+static bool EndValue (CSVParser *parser_p)
+{
+	if (parser_p -> cp_num_values == parser_p -> cp_max_values)
+		{
+			const size_t max_values = parser_p -> cp_max_values << 1;
+			size_t *offsets_p = (size_t *) realloc (parser_p -> cp_offsets_p, max_values * sizeof (size_t));
+			char **values_ss;
+
+			if (!offsets_p)
+				{
+					return false;
+				}
+
+			parser_p -> cp_offsets_p = offsets_p;
+			values_ss = (char **) realloc (parser_p -> cp_values_ss, max_values * sizeof (char *));
+
+			if (!values_ss)
+				{
+					return false;
+				}
+
+			parser_p -> cp_values_ss = values_ss;
+			parser_p -> cp_max_values = max_values;
+		}
+
+	if (!AppendToValue (parser_p, "", 1))
+		{
+			return false;
+		}
+
+	/* Store where the next value will start */
+	parser_p -> cp_offsets_p [parser_p -> cp_num_values] = parser_p -> cp_values_length;
+	++ (parser_p -> cp_num_values);
+
+	return true;
+}
+
+
+static bool EndRow (CSVParser *parser_p)
+{
+	bool success_flag = true;
+	const bool header_flag = (parser_p -> cp_num_records == 0) && (parser_p -> cp_dialect.cd_header_flag);
+
+	if (! (header_flag && (parser_p -> cp_skip_header_flag)))
+		{
+			size_t i;
+
+			/* The values can only be pointed to once the row is complete as the buffer may have moved */
+			parser_p -> cp_values_ss [0] = parser_p -> cp_values_s;
+
+			for (i = 1; i < parser_p -> cp_num_values; ++ i)
+				{
+					parser_p -> cp_values_ss [i] = parser_p -> cp_values_s + parser_p -> cp_offsets_p [i - 1];
+				}
+
+			if (!header_flag)
+				{
+					++ (parser_p -> cp_row);
+				}
+
+			if (! (parser_p -> cp_row_fn (parser_p -> cp_row_data_p, header_flag ? 0 : parser_p -> cp_row, parser_p -> cp_values_ss, parser_p -> cp_num_values)))
+				{
+					parser_p -> cp_stopped_flag = true;
+					success_flag = false;
+				}
+		}
+
+	++ (parser_p -> cp_num_records);
+	parser_p -> cp_values_length = 0;
+	parser_p -> cp_num_values = 0;
+	parser_p -> cp_row_started_flag = false;
+
+	return success_flag;
+}
+
+
+/*
+ * Find the first delimiter or line ending, checking 16 bytes
+ * at a time where SSE2 is available.
+ */
+static const char *FindUnquotedEnd (const char *start_s, const char *end_s, const char delimiter)
+{
+	const char *c_p = start_s;
+
+#ifdef CSV_READER_USE_SSE2
+	const __m128i delimiters = _mm_set1_epi8 (delimiter);
+	const __m128i line_feeds = _mm_set1_epi8 ('\n');
+	const __m128i carriage_returns = _mm_set1_epi8 ('\r');
+
+	while (end_s - c_p >= 16)
+		{
+			const __m128i chunk = _mm_loadu_si128 ((const __m128i *) c_p);
+			const __m128i matches = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (chunk, delimiters), _mm_cmpeq_epi8 (chunk, line_feeds)), _mm_cmpeq_epi8 (chunk, carriage_returns));
+			const int mask = _mm_movemask_epi8 (matches);
+
+			if (mask != 0)
+				{
+					#ifdef WINDOWS
+					unsigned long index;
+
+					_BitScanForward (&index, (unsigned long) mask);
+					return c_p + index;
+					#else
+					return c_p + __builtin_ctz ((unsigned int) mask);
+					#endif
+				}
+
+			c_p += 16;
+		}
+#endif
+
+	while ((c_p < end_s) && (*c_p != delimiter) && (*c_p != '\n') && (*c_p != '\r'))
+		{
+			++ c_p;
+		}
+
+	return c_p;
+}
+
+
+/*
+ * Parse a file as it is read or downloaded on the calling thread, passing
+ * the rows on in chunks of S_STREAMED_CHUNK_ROWS.
+ */
+static bool ReadStreamedCSVPart (CSVChunkReader *reader_p, const char *location_s)
+{
+	bool success_flag = false;
+	CSVChunkStream stream;
+	CSVParser parser;
+
+	stream.cs_reader_p = reader_p;
+	stream.cs_num_rows = 0;
+
+	if (InitCSVParser (&parser, & (reader_p -> cr_dialect), AddStreamedRow, &stream))
+		{
+			parser.cp_skip_header_flag = reader_p -> cr_skip_header_flag;
+
+			if (strstr (location_s, "://"))
+				{
+					success_flag = ReadCSVURL (&parser, location_s);
+				}
+			else
+				{
+					success_flag = ReadCSVFile (&parser, location_s);
+				}
+
+			if (success_flag)
+				{
+					success_flag = FinishCSVPart (&parser) && MergeStreamedChunk (&stream);
+				}
+			else if (!parser.cp_stopped_flag)
+				{
+					fprintf (stderr, "Failed to read the CSV data from \"%s\"\n", location_s);
+				}
+
+			ClearCSVParser (&parser);
+		}
+
+	return success_flag;
+}
+
+
+static bool AddStreamedRow (void *data_p, const size_t row, char **values_ss, const size_t num_values)
+{
+	CSVChunkStream *stream_p = (CSVChunkStream *) data_p;
+	CSVChunkReader *reader_p = stream_p -> cs_reader_p;
+	bool success_flag;
+
+	if (row == 0)
+		{
+			return reader_p -> cr_header_fn (reader_p -> cr_data_p, 0, values_ss, num_values);
+		}
+
+	++ (stream_p -> cs_num_rows);
+	success_flag = reader_p -> cr_functions_p -> cf_row_fn (reader_p -> cr_chunks_pp [0], stream_p -> cs_num_rows, values_ss, num_values);
+
+	if (success_flag && (stream_p -> cs_num_rows == S_STREAMED_CHUNK_ROWS))
+		{
+			success_flag = MergeStreamedChunk (stream_p);
+		}
+
+	return success_flag;
+}
+
+
+static bool MergeStreamedChunk (CSVChunkStream *stream_p)
+{
+	bool success_flag = true;
+
+	if (stream_p -> cs_num_rows > 0)
+		{
+			CSVChunkReader *reader_p = stream_p -> cs_reader_p;
+			const CSVChunkFunctions *functions_p = reader_p -> cr_functions_p;
+			void *chunk_p = reader_p -> cr_chunks_pp [0];
+
+			if (functions_p -> cf_end_fn)
+				{
+					functions_p -> cf_end_fn (chunk_p, stream_p -> cs_num_rows);
+				}
+
+			success_flag = functions_p -> cf_merge_fn (reader_p -> cr_data_p, chunk_p, reader_p -> cr_num_rows, stream_p -> cs_num_rows);
+
+			reader_p -> cr_num_rows += stream_p -> cs_num_rows;
+			stream_p -> cs_num_rows = 0;
+		}
+
+	return success_flag;
+}
+
+
+static bool ReadCSVFile (CSVParser *parser_p, const char *filename_s)
+{
+	bool success_flag = false;
+	FILE *in_f = fopen (filename_s, "rb");
+
+	if (in_f)
+		{
+			char *buffer_s = (char *) malloc (S_READ_BUFFER_SIZE);
+
+			if (buffer_s)
+				{
+					size_t length;
+
+					success_flag = true;
+
+					while (success_flag && ((length = fread (buffer_s, 1, S_READ_BUFFER_SIZE, in_f)) > 0))
+						{
+							success_flag = ParseCSVBuffer (parser_p, buffer_s, length);
+						}
+
+					if (ferror (in_f))
+						{
+							success_flag = false;
+						}
+
+					free (buffer_s);
+				}
+
+			fclose (in_f);
+		}
+
+	return success_flag;
+}
+
+
+static bool ReadCSVURL (CSVParser *parser_p, const char *url_s)
+{
+	bool success_flag = false;
+	CurlTool *curl_tool_p = AllocateMemoryCurlTool (0);
+
+	if (curl_tool_p)
+		{
+			if (SetUriForCurlTool (curl_tool_p, url_s))
+				{
+					/* Parse the data as it arrives rather than storing it all in the CurlTool's buffer */
+					if ((curl_easy_setopt (curl_tool_p -> ct_curl_p, CURLOPT_WRITEFUNCTION, ParseDownloadedData) == CURLE_OK) &&
+							(curl_easy_setopt (curl_tool_p -> ct_curl_p, CURLOPT_WRITEDATA, parser_p) == CURLE_OK) &&
+							(curl_easy_setopt (curl_tool_p -> ct_curl_p, CURLOPT_FAILONERROR, 1L) == CURLE_OK))
+						{
+							const CURLcode res = RunCurlTool (curl_tool_p);
+
+							if (res == CURLE_OK)
+								{
+									success_flag = true;
+								}
+							else if (!parser_p -> cp_stopped_flag)
+								{
+									fprintf (stderr, "Failed to download \"%s\", %s\n", url_s, curl_easy_strerror (res));
+								}
+						}
+				}
+
+			FreeCurlTool (curl_tool_p);
+		}
+
+	return success_flag;
+}
+
+
+static size_t ParseDownloadedData (char *data_p, size_t size, size_t num_items, void *parser_p)
+{
+	const size_t length = size * num_items;
+
+	/* Returning a different length makes curl stop the download */
+	return ParseCSVBuffer ((CSVParser *) parser_p, data_p, length) ? length : 0;
+}
+
+
+#ifndef WINDOWS
+
+/*
+ * Memory-map a file and parse it in rounds of up to one block per chunk, with
+ * the blocks of each round parsed in parallel and then merged in order.
+ */
+static bool ReadMappedCSVPart (CSVChunkReader *reader_p, const char *filename_s)
+{
+	bool success_flag = false;
+	const int fd = open (filename_s, O_RDONLY);
+
+	if (fd != -1)
+		{
+			struct stat st;
+
+			if (fstat (fd, &st) == 0)
+				{
+					const size_t size = (size_t) st.st_size;
+
+					if (size > 0)
+						{
+							char *mapped_p = (char *) mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+							if (mapped_p != MAP_FAILED)
+								{
+									CSVBlock *blocks_p = (CSVBlock *) calloc (reader_p -> cr_num_chunks, sizeof (CSVBlock));
+
+									madvise (mapped_p, size, MADV_SEQUENTIAL);
+
+									if (blocks_p)
+										{
+											const size_t page_size = (size_t) sysconf (_SC_PAGESIZE);
+											const CSVChunkFunctions *functions_p = reader_p -> cr_functions_p;
+											const char *data_s = mapped_p;
+											const char *end_s = data_s + size;
+											const char *next_s = ReadMappedCSVHeader (reader_p, data_s, end_s);
+											size_t num_released = 0;
+											CSVBlockRound round;
+
+											round.br_reader_p = reader_p;
+											round.br_blocks_p = blocks_p;
+											round.br_data_s = data_s;
+											round.br_end_s = end_s;
+
+											success_flag = (next_s != NULL);
+
+											while (success_flag && (next_s < end_s))
+												{
+													const size_t num_blocks_left = ((end_s - next_s) + S_BLOCK_SIZE - 1) / S_BLOCK_SIZE;
+													const size_t num_blocks = (num_blocks_left < reader_p -> cr_num_chunks) ? num_blocks_left : reader_p -> cr_num_chunks;
+													const char *expected_s = next_s;
+													size_t i;
+
+													for (i = 0; i < num_blocks; ++ i)
+														{
+															CSVBlock *block_p = blocks_p + i;
+															const size_t limit_offset = (i + 1) * S_BLOCK_SIZE;
+
+															block_p -> cb_limit_s = ((size_t) (end_s - next_s) > limit_offset) ? next_s + limit_offset : end_s;
+
+															if (i == 0)
+																{
+																	block_p -> cb_start_s = next_s;
+																	block_p -> cb_abort_s = NULL;
+																}
+															else
+																{
+																	block_p -> cb_start_s = FindSpeculativeRowStart (next_s + (i * S_BLOCK_SIZE), end_s, & (reader_p -> cr_dialect));
+																	block_p -> cb_abort_s = ((size_t) (end_s - block_p -> cb_limit_s) > S_BLOCK_SIZE) ? block_p -> cb_limit_s + S_BLOCK_SIZE : NULL;
+																}
+														}
+
+													success_flag = RunParallelTasks (num_blocks, reader_p -> cr_num_threads, ParseCSVBlockTask, &round);
+
+													for (i = 0; (i < num_blocks) && success_flag; ++ i)
+														{
+															CSVBlock *block_p = blocks_p + i;
+															void *chunk_p = reader_p -> cr_chunks_pp [i];
+
+															/*
+															 * If the block's guessed start was within a quoted value, its rows
+															 * are wrong so parse it again from where the previous block stopped.
+															 * A block that was given up on has no start so it is parsed again too.
+															 */
+															if (block_p -> cb_start_s != expected_s)
+																{
+																	functions_p -> cf_reset_fn (chunk_p);
+																	block_p -> cb_start_s = expected_s;
+																	block_p -> cb_abort_s = NULL;
+																	ParseCSVBlock (reader_p, block_p, chunk_p, data_s, end_s);
+																}
+
+															success_flag = (block_p -> cb_success_flag) && (functions_p -> cf_merge_fn (reader_p -> cr_data_p, chunk_p, reader_p -> cr_num_rows, block_p -> cb_num_rows));
+
+															reader_p -> cr_num_rows += block_p -> cb_num_rows;
+															expected_s = block_p -> cb_stop_s;
+														}
+
+													next_s = expected_s;
+
+													/* Release the pages that have been merged */
+													if (success_flag)
+														{
+															const size_t num_parsed = ((size_t) (next_s - data_s)) & ~(page_size - 1);
+
+															if (num_parsed > num_released)
+																{
+																	madvise (mapped_p + num_released, num_parsed - num_released, MADV_DONTNEED);
+																	num_released = num_parsed;
+																}
+														}
+												}
+
+											free (blocks_p);
+										}
+
+									munmap (mapped_p, size);
+								}
+						}
+					else
+						{
+							success_flag = true;
+						}
+				}
+
+			close (fd);
+		}
+
+	if ((!success_flag) && (fd == -1))
+		{
+			fprintf (stderr, "Failed to read the CSV data from \"%s\"\n", filename_s);
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Read the header row, if there is one, so that it is passed on before
+ * any of the chunks and get where the data rows start.
+ */
+static const char *ReadMappedCSVHeader (CSVChunkReader *reader_p, const char *data_s, const char *end_s)
+{
+	const char *start_s = data_s;
+	const char *next_s = NULL;
+	CSVParser parser;
+
+	if (! (reader_p -> cr_dialect.cd_header_flag))
+		{
+			return data_s;
+		}
+
+	/* Skip any byte order mark and blank lines so the limit is within the header row */
+	if ((end_s - start_s >= 3) && (memcmp (start_s, "\xEF\xBB\xBF", 3) == 0))
+		{
+			start_s += 3;
+		}
+
+	while ((start_s < end_s) && ((*start_s == '\n') || (*start_s == '\r')))
+		{
+			++ start_s;
+		}
+
+	if (InitCSVParser (&parser, & (reader_p -> cr_dialect), reader_p -> cr_header_fn, reader_p -> cr_data_p))
+		{
+			parser.cp_skip_header_flag = reader_p -> cr_skip_header_flag;
+			parser.cp_limit_s = start_s + 1;
+
+			if (ParseCSVBuffer (&parser, start_s, end_s - start_s))
+				{
+					if (parser.cp_stop_s)
+						{
+							next_s = parser.cp_stop_s;
+						}
+					else if (FinishCSVPart (&parser))
+						{
+							next_s = end_s;
+						}
+				}
+
+			ClearCSVParser (&parser);
+		}
+
+	return next_s;
+}
+
+
+/*
+ * Guess where the first row that starts at or after start_s is. Whether
+ * start_s is within a quoted value is worked out from the first quote after
+ * it that can only be an opening one, straight after a delimiter or new line,
+ * or a closing one, straight before them. If there isn't one within a block,
+ * it is assumed not to be.
+ */
+static const char *FindSpeculativeRowStart (const char *start_s, const char *end_s, const CSVDialect *dialect_p)
+{
+	const char delimiter = dialect_p -> cd_delimiter;
+	const char quote = dialect_p -> cd_quote;
+	const char *scan_end_s = ((size_t) (end_s - start_s) > S_BLOCK_SIZE) ? start_s + S_BLOCK_SIZE : end_s;
+	const char *c_p = start_s - 1;
+	const char *quote_s;
+	bool quoted_flag = false;
+	bool odd_flag = false;
+
+	while ((quote_s = (const char *) memchr (c_p, quote, scan_end_s - c_p)) != NULL)
+		{
+			const char prev = * (quote_s - 1);
+			const char next = (quote_s + 1 < end_s) ? * (quote_s + 1) : '\n';
+			const bool after_break_flag = (prev == delimiter) || (prev == '\n') || (prev == '\r');
+			const bool before_break_flag = (next == delimiter) || (next == '\n') || (next == '\r');
+
+			if (after_break_flag && (!before_break_flag) && (next != quote))
+				{
+					/* An opening quote is outside of a quoted value */
+					quoted_flag = odd_flag;
+					break;
+				}
+			else if (before_break_flag && (!after_break_flag) && (prev != quote))
+				{
+					/* A closing quote is within one */
+					quoted_flag = !odd_flag;
+					break;
+				}
+
+			odd_flag = !odd_flag;
+			c_p = quote_s + 1;
+		}
+
+	/* Find the first new line from just before start_s that isn't in a quoted value */
+	c_p = start_s - 1;
+
+	while (c_p < end_s)
+		{
+			if (quoted_flag)
+				{
+					quote_s = (const char *) memchr (c_p, quote, end_s - c_p);
+
+					if (!quote_s)
+						{
+							return end_s;
+						}
+
+					quoted_flag = false;
+					c_p = quote_s + 1;
+				}
+			else
+				{
+					const char *new_line_s = (const char *) memchr (c_p, '\n', end_s - c_p);
+
+					if (!new_line_s)
+						{
+							return end_s;
+						}
+
+					quote_s = (const char *) memchr (c_p, quote, new_line_s - c_p);
+
+					if (!quote_s)
+						{
+							return new_line_s + 1;
+						}
+
+					quoted_flag = true;
+					c_p = quote_s + 1;
+				}
+		}
+
+	return end_s;
+}
+
+
+static void ParseCSVBlockTask (void *data_p, const size_t task_index)
+{
+	CSVBlockRound *round_p = (CSVBlockRound *) data_p;
+	CSVChunkReader *reader_p = round_p -> br_reader_p;
+
+	ParseCSVBlock (reader_p, round_p -> br_blocks_p + task_index, reader_p -> cr_chunks_pp [task_index], round_p -> br_data_s, round_p -> br_end_s);
+}
+
+
+static void ParseCSVBlock (CSVChunkReader *reader_p, CSVBlock *block_p, void *chunk_p, const char *data_s, const char *end_s)
+{
+	const CSVChunkFunctions *functions_p = reader_p -> cr_functions_p;
+	CSVParser parser;
+
+	block_p -> cb_success_flag = false;
+	block_p -> cb_num_rows = 0;
+	block_p -> cb_stop_s = end_s;
+
+	if (InitCSVParser (&parser, & (reader_p -> cr_dialect), functions_p -> cf_row_fn, chunk_p))
+		{
+			/*
+			 * Only a block at the start of the file can begin with a byte order
+			 * mark or the header row, which has been read already if there is one.
+			 */
+			parser.cp_num_records = (block_p -> cb_start_s == data_s) ? 0 : 1;
+			parser.cp_limit_s = block_p -> cb_limit_s;
+			parser.cp_abort_s = block_p -> cb_abort_s;
+
+			if (ParseCSVBuffer (&parser, block_p -> cb_start_s, end_s - block_p -> cb_start_s))
+				{
+					if (parser.cp_aborted_flag)
+						{
+							/* Clear the start so that the block gets parsed again from the right place */
+							block_p -> cb_start_s = NULL;
+						}
+					else if (parser.cp_stop_s)
+						{
+							block_p -> cb_stop_s = parser.cp_stop_s;
+							block_p -> cb_success_flag = true;
+						}
+					else
+						{
+							block_p -> cb_success_flag = FinishCSVPart (&parser);
+						}
+				}
+
+			block_p -> cb_num_rows = parser.cp_row;
+
+			if ((block_p -> cb_success_flag) && (functions_p -> cf_end_fn))
+				{
+					functions_p -> cf_end_fn (chunk_p, block_p -> cb_num_rows);
+				}
+
+			ClearCSVParser (&parser);
+		}
+}
+
+#endif
+
+
+/*
+ * Paths that aren't URLs are relative to the data package
+ */
+static char *GetCSVPartLocation (const char *package_file_s, const char *path_s)
+{
+	char *location_s = NULL;
+
+	if ((strstr (path_s, "://")) || (*path_s == '/') || (!package_file_s))
+		{
+			location_s = EasyCopyToNewString (path_s);
+		}
+	else
+		{
+			const char *dir_end_s = strrchr (package_file_s, '/');
+
+#ifdef WINDOWS
+			const char *backslash_s = strrchr (package_file_s, '\\');
+
+			if ((backslash_s) && ((!dir_end_s) || (backslash_s > dir_end_s)))
+				{
+					dir_end_s = backslash_s;
+				}
+#endif
+
+			if (dir_end_s)
+				{
+					char *dir_s = CopyToNewString (package_file_s, dir_end_s + 1 - package_file_s, false);
+
+					if (dir_s)
+						{
+							location_s = ConcatenateStrings (dir_s, path_s);
+							FreeCopiedString (dir_s);
+						}
+				}
+			else
+				{
+					location_s = EasyCopyToNewString (path_s);
+				}
+		}
+
+	return location_s;
+}
@@ -0,0 +1,511 @@
+/*
+ * csv_writer.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "csv_writer.h"
+#include "csv_reader.h"
+
+#include "frictionless_data_util.h"
+
+#include "byte_buffer.h"
+#include "json_util.h"
+
+
+/*
+ * The state for copying the rows of an external CSV file
+ */
+typedef struct
+{
+	FILE *cc_out_f;
+	const char *cc_col_sep_s;
+	const char *cc_row_sep_s;
+	const json_t *cc_headers_p;
+	size_t cc_num_fields;
+
+	/** The index of the input column for each field, or -1 if it is not in the input. */
+	long *cc_columns_p;
+
+	/** Whether each field's values are written without quotes. */
+	bool *cc_numeric_fields_p;
+
+	size_t cc_num_rows;
+} CSVCopy;
+
+
+/*
+ * A chunk of copied rows that is formatted, possibly on a worker
+ * thread, before being written to the output file in order.
+ */
+typedef struct
+{
+	const CSVCopy *ch_copy_p;
+	ByteBuffer *ch_buffer_p;
+	bool ch_success_flag;
+} CSVCopyChunk;
+
+
+static const size_t S_CHUNK_BUFFER_SIZE = 1 << 16;
+
+
+/*
+ * static declarations
+ */
+
+static bool WriteCSVHeaders (FILE *csv_f, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p);
+
+static bool MapCSVColumns (void *data_p, const size_t row, char **values_ss, const size_t num_values);
+
+static bool CopyCSVRow (void *data_p, const size_t row, char **values_ss, const size_t num_values);
+
+static bool WriteCopiedCSVRows (void *data_p, void *chunk_data_p, const size_t first_row, const size_t num_rows);
+
+static void ResetCopiedCSVRows (void *chunk_data_p);
+
+static bool AppendQuotedCSVValue (ByteBuffer *buffer_p, const char *value_s);
+
+
+/*
+ * api definitions
+ */
+
+bool CreateCSVFile (const char *filename_s, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p)
+{
+	bool success_flag = false;
+	OutputSink *sink_p = AllocateFileOutputSink (filename_s);
+
+	/* open the output file */
+	if (sink_p)
+		{
+			success_flag = CreateCSVOutput (sink_p, col_sep_s, row_sep_s, headers_p, data_p);
+			FreeOutputSink (sink_p);
+		}		/* if (sink_p) */
+	else
+		{
+			fprintf (stderr, "Failed to open CSV output file \"%s\"\n", filename_s);
+		}
+
+	return success_flag;
+}
+
+
+bool CreateCSVOutput (OutputSink *sink_p, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p)
+{
+	bool success_flag = WriteCSVData (GetOutputSinkStream (sink_p), col_sep_s, row_sep_s, headers_p, data_p);
+
+	if (!FlushOutputSink (sink_p))
+		{
+			success_flag = false;
+		}
+
+	return success_flag;
+}
+
+
+bool WriteCSVData (FILE *csv_f, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p)
+{
+	bool success_flag = false;
+
+	if (headers_p)
+		{
+			const size_t num_columns = json_array_size (headers_p);
+			size_t i;
+
+			success_flag = WriteCSVHeaders (csv_f, col_sep_s, row_sep_s, headers_p);
+
+			/*
+			 * write the data in the same order as the headers
+			 */
+			if (success_flag)
+				{
+					/* The strings are quoted in here in the same way as for the external files */
+					ByteBuffer *buffer_p = AllocateByteBuffer (1024);
+					const size_t num_rows = json_array_size (data_p);
+
+					if (!buffer_p)
+						{
+							return false;
+						}
+
+					for (i = 0; i < num_rows; ++ i)
+						{
+							const json_t *row_p = json_array_get (data_p, i);
+							size_t j;
+							bool add_sep_flag = false;
+
+							for (j = 0; j < num_columns; ++ j)
+								{
+									const json_t *header_p = json_array_get (headers_p, j);
+									const char *header_s = GetJSONString (header_p, FD_TABLE_FIELD_NAME);
+
+									if (header_s)
+										{
+											const json_t *value_p = json_object_get (row_p, header_s);
+
+											if (add_sep_flag)
+												{
+													fprintf (csv_f, "%s ", col_sep_s);
+												}
+											else
+												{
+													add_sep_flag = true;
+												}
+
+
+											if (value_p)
+												{
+													if (json_is_string (value_p))
+														{
+															const char *value_s = json_string_value (value_p);
+
+															if (value_s)
+																{
+																	ResetByteBuffer (buffer_p);
+
+																	if (AppendQuotedCSVValue (buffer_p, value_s))
+																		{
+																			const size_t length = GetByteBufferSize (buffer_p);
+
+																			if (fwrite (GetByteBufferData (buffer_p), 1, length, csv_f) != length)
+																				{
+																					success_flag = false;
+																				}
+																		}
+																	else
+																		{
+																			success_flag = false;
+																		}
+																}
+															else
+																{
+																	fprintf (csv_f, " ");
+																}
+														}
+													else if (json_is_integer (value_p))
+														{
+															const json_int_t value = json_integer_value (value_p);
+
+															fprintf (csv_f, "%" JSON_INTEGER_FORMAT, value);
+														}
+													else if (json_is_real (value_p))
+														{
+															const double value = json_real_value (value_p);
+
+															fprintf (csv_f, "%lf", value);
+														}
+													else
+														{
+															PrintJSON (stderr, value_p, "Unknown JSON type: ");
+														}
+												}
+
+										}		/* if (header_s) */
+									else
+										{
+											success_flag = false;
+										}
+
+								}		/* for (i = 0; i < num_columns; ++ i) */
+
+							fprintf (csv_f, "%s", row_sep_s);
+						}
+
+					FreeByteBuffer (buffer_p);
+				}
+
+		}		/* if (headers_p) */
+	else
+		{
+			/*
+			 * no headers so just write out in an arbitrary order
+			 */
+		}
+
+	return success_flag;
+}
+
+
+bool WriteCSVResourceData (FILE *csv_f, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *resource_p, const char *package_file_s, const size_t num_threads, size_t *num_rows_p)
+{
+	bool success_flag = false;
+
+	if (headers_p)
+		{
+			/* Have a couple of chunks for each thread so they don't wait on each other as much */
+			const size_t num_chunks = (num_threads > 1) ? (num_threads << 1) : 1;
+			CSVCopyChunk *chunks_p = (CSVCopyChunk *) calloc (num_chunks, sizeof (CSVCopyChunk));
+			void **chunks_pp = (void **) calloc (num_chunks, sizeof (void *));
+			CSVCopy copy;
+
+			copy.cc_out_f = csv_f;
+			copy.cc_col_sep_s = col_sep_s;
+			copy.cc_row_sep_s = row_sep_s;
+			copy.cc_headers_p = headers_p;
+			copy.cc_num_fields = json_array_size (headers_p);
+			copy.cc_num_rows = 0;
+			copy.cc_columns_p = (long *) malloc ((copy.cc_num_fields + 1) * sizeof (long));
+			copy.cc_numeric_fields_p = (bool *) malloc ((copy.cc_num_fields + 1) * sizeof (bool));
+
+			if ((copy.cc_columns_p) && (copy.cc_numeric_fields_p) && (chunks_p) && (chunks_pp))
+				{
+					const json_t *header_p;
+					size_t i;
+
+					success_flag = true;
+
+					/* Without a header row, the columns are in the same order as the fields */
+					json_array_foreach (headers_p, i, header_p)
+						{
+							const char *type_s = GetJSONString (header_p, FD_TABLE_FIELD_TYPE);
+
+							copy.cc_columns_p [i] = (long) i;
+							copy.cc_numeric_fields_p [i] = (type_s) && ((strcmp (type_s, FD_TYPE_INTEGER) == 0) || (strcmp (type_s, FD_TYPE_NUMBER) == 0));
+						}
+
+					for (i = 0; (i < num_chunks) && success_flag; ++ i)
+						{
+							chunks_p [i].ch_copy_p = &copy;
+							chunks_p [i].ch_success_flag = true;
+							chunks_p [i].ch_buffer_p = AllocateByteBuffer (S_CHUNK_BUFFER_SIZE);
+							chunks_pp [i] = chunks_p + i;
+
+							success_flag = (chunks_p [i].ch_buffer_p != NULL);
+						}
+
+					if (success_flag && WriteCSVHeaders (csv_f, col_sep_s, row_sep_s, headers_p))
+						{
+							CSVChunkFunctions functions;
+
+							functions.cf_row_fn = CopyCSVRow;
+							functions.cf_end_fn = NULL;
+							functions.cf_merge_fn = WriteCopiedCSVRows;
+							functions.cf_reset_fn = ResetCopiedCSVRows;
+
+							success_flag = ReadCSVResource (resource_p, package_file_s, MapCSVColumns, &functions, chunks_pp, num_chunks, num_threads, &copy);
+						}
+					else
+						{
+							success_flag = false;
+						}
+
+					if (num_rows_p)
+						{
+							*num_rows_p = copy.cc_num_rows;
+						}
+				}
+
+			if (chunks_p)
+				{
+					size_t i;
+
+					for (i = 0; i < num_chunks; ++ i)
+						{
+							if (chunks_p [i].ch_buffer_p)
+								{
+									FreeByteBuffer (chunks_p [i].ch_buffer_p);
+								}
+						}
+
+					free (chunks_p);
+				}
+
+			if (chunks_pp)
+				{
+					free (chunks_pp);
+				}
+
+			if (copy.cc_columns_p)
+				{
+					free (copy.cc_columns_p);
+				}
+
+			if (copy.cc_numeric_fields_p)
+				{
+					free (copy.cc_numeric_fields_p);
+				}
+
+		}		/* if (headers_p) */
+
+	return success_flag;
+}
+
+
+/*
+ * static definitions
+ */
+
+static bool WriteCSVHeaders (FILE *csv_f, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p)
+{
+	const size_t num_columns = json_array_size (headers_p);
+	size_t i;
+	bool success_flag = true;
+
+	for (i = 0; i < num_columns; ++ i)
+		{
+			const json_t *header_p = json_array_get (headers_p, i);
+			const char *header_s = GetJSONString (header_p, FD_TABLE_FIELD_NAME);
+
+			if (header_s)
+				{
+					const char *sep_s;
+
+					if (i == num_columns - 1)
+						{
+							sep_s = row_sep_s;
+						}
+					else
+						{
+							sep_s = col_sep_s;
+						}
+
+					fprintf (csv_f, "\"%s\"%s ", header_s, sep_s);
+				}		/* if (header_s) */
+			else
+				{
+					success_flag = false;
+				}
+
+		}		/* for (i = 0; i < num_columns; ++ i) */
+
+	return success_flag;
+}
+
+
+/*
+ * Match the header row's columns to the fields by name
+ */
+static bool MapCSVColumns (void *data_p, const size_t row, char **values_ss, const size_t num_values)
+{
+	CSVCopy *copy_p = (CSVCopy *) data_p;
+	size_t i;
+
+	for (i = 0; i < copy_p -> cc_num_fields; ++ i)
+		{
+			const char *name_s = GetJSONString (json_array_get (copy_p -> cc_headers_p, i), FD_TABLE_FIELD_NAME);
+			size_t j;
+
+			copy_p -> cc_columns_p [i] = -1;
+
+			for (j = 0; j < num_values; ++ j)
+				{
+					if ((name_s) && (strcmp (values_ss [j], name_s) == 0))
+						{
+							copy_p -> cc_columns_p [i] = (long) j;
+							break;
+						}
+				}
+		}
+
+	return true;
+}
+
+
+/*
+ * Format a row of an external CSV file into its chunk's buffer in the
+ * same way as WriteCSVData () writes a row of inline data. This can
+ * be on a worker thread so the shared CSVCopy is only read.
+ */
+static bool CopyCSVRow (void *data_p, const size_t row, char **values_ss, const size_t num_values)
+{
+	CSVCopyChunk *chunk_p = (CSVCopyChunk *) data_p;
+	const CSVCopy *copy_p = chunk_p -> ch_copy_p;
+	ByteBuffer *buffer_p = chunk_p -> ch_buffer_p;
+	bool success_flag = true;
+	size_t i;
+
+	for (i = 0; (i < copy_p -> cc_num_fields) && success_flag; ++ i)
+		{
+			const long column = copy_p -> cc_columns_p [i];
+
+			if (i > 0)
+				{
+					success_flag = AppendStringToByteBuffer (buffer_p, copy_p -> cc_col_sep_s) && AppendToByteBuffer (buffer_p, " ", 1);
+				}
+
+			if (success_flag && (column >= 0) && ((size_t) column < num_values))
+				{
+					const char *value_s = values_ss [column];
+
+					if ((copy_p -> cc_numeric_fields_p [i]) && (*value_s != '\0'))
+						{
+							success_flag = AppendStringToByteBuffer (buffer_p, value_s);
+						}
+					else
+						{
+							success_flag = AppendQuotedCSVValue (buffer_p, value_s);
+						}
+				}
+		}
+
+	if (success_flag)
+		{
+			success_flag = AppendStringToByteBuffer (buffer_p, copy_p -> cc_row_sep_s);
+		}
+
+	if (!success_flag)
+		{
+			chunk_p -> ch_success_flag = false;
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Write a chunk's formatted rows to the output file, in order, on the calling thread
+ */
+static bool WriteCopiedCSVRows (void *data_p, void *chunk_data_p, const size_t first_row, const size_t num_rows)
+{
+	CSVCopy *copy_p = (CSVCopy *) data_p;
+	CSVCopyChunk *chunk_p = (CSVCopyChunk *) chunk_data_p;
+	bool success_flag = chunk_p -> ch_success_flag;
+
+	if (success_flag)
+		{
+			const size_t length = GetByteBufferSize (chunk_p -> ch_buffer_p);
+
+			if ((length > 0) && (fwrite (GetByteBufferData (chunk_p -> ch_buffer_p), 1, length, copy_p -> cc_out_f) != length))
+				{
+					success_flag = false;
+				}
+
+			copy_p -> cc_num_rows += num_rows;
+		}
+
+	ResetCopiedCSVRows (chunk_p);
+
+	return success_flag;
+}
+
+
+static void ResetCopiedCSVRows (void *chunk_data_p)
+{
+	CSVCopyChunk *chunk_p = (CSVCopyChunk *) chunk_data_p;
+
+	ResetByteBuffer (chunk_p -> ch_buffer_p);
+	chunk_p -> ch_success_flag = true;
+}
+
+
+/*
+ * Values can contain quotes so these are escaped by doubling them
+ */
+static bool AppendQuotedCSVValue (ByteBuffer *buffer_p, const char *value_s)
+{
+	const char *quote_s;
+	bool success_flag = AppendToByteBuffer (buffer_p, "\"", 1);
+
+	while (success_flag && ((quote_s = strchr (value_s, '"')) != NULL))
+		{
+			success_flag = AppendToByteBuffer (buffer_p, value_s, quote_s + 1 - value_s) && AppendToByteBuffer (buffer_p, "\"", 1);
+			value_s = quote_s + 1;
+		}
+
+	return success_flag && AppendStringToByteBuffer (buffer_p, value_s) && AppendToByteBuffer (buffer_p, "\"", 1);
+}
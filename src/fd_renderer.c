@@ -0,0 +1,2383 @@
+/*
+ * fd_renderer.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+#include "jansson.h"
+
+#include "typedefs.h"
+
+#include "fd_renderer.h"
+
+#include "frictionless_data_util.h"
+
+#include "printer.h"
+#include "json_util.h"
+#include "string_utils.h"
+#include "filesystem_utils.h"
+
+#include "html_printer.h"
+#include "markdown_printer.h"
+#include "json_printer.h"
+#include "template_printer.h"
+#include "composite_printer.h"
+
+#include "output_cache.h"
+#include "file_watcher.h"
+#include "schema_parser.h"
+#include "csv_writer.h"
+#include "csv_reader.h"
+
+
+/*
+ * The settings and shared state used when
+ * processing each of the resources.
+ */
+typedef struct
+{
+	const char *tc_fd_file_s;
+	const char *tc_out_dir_s;
+	const char *tc_data_ext_s;
+
+	/** The extensions of all of the data formats, separated by commas */
+	const char *tc_data_exts_s;
+
+	const char *tc_table_format_s;
+	bool tc_full_flag;
+	bool tc_debug_flag;
+
+	/** The number of threads to parse large external CSV files with */
+	size_t tc_num_jobs;
+
+	/** The number of levels of subdirectories to shard the resources' files into */
+	uint32 tc_shard_depth;
+
+	/** How the output files are flushed to disk */
+	OutputDurability tc_durability;
+
+	/** This is set while the files for a data package are being written */
+	OutputDirectory *tc_out_dir_p;
+
+	/**
+	 * The stem of the filenames for each of the package's resources, in
+	 * the same order as the resources. These are worked out before any
+	 * of the resources are written so that any resources whose names
+	 * only differ by characters that can't be used in filenames get
+	 * their own files.
+	 */
+	json_t *tc_file_stems_p;
+
+	/**
+	 * The same stems keyed by the resources' index keys, so that when
+	 * watching a package, any unchanged resources whose stems have changed
+	 * are written again rather than being overwritten by other resources.
+	 */
+	json_t *tc_resource_stems_p;
+
+	/**
+	 * These are only set if an index of the files that each resource was
+	 * written to is being kept, with tc_resource_files_p being the list
+	 * of files for the resource that is currently being processed.
+	 */
+	bool tc_file_index_flag;
+	json_t *tc_file_index_p;
+	json_t *tc_resource_files_p;
+
+	Printer *tc_printer_p;
+	SchemaCache *tc_schema_cache_p;
+
+	/** This is only set for incremental builds */
+	OutputCache *tc_output_cache_p;
+
+	/** This is only set if timings and counters are being collected */
+	ToolStats *tc_stats_p;
+
+	/**
+	 * This is only set if all of the resources are written to a single
+	 * file, in which case tc_printer_p is kept open for the whole run.
+	 */
+	char *tc_combined_filename_s;
+
+	/**
+	 * These are only used when writing the resources as a single document
+	 * and, if tc_page_size is non-zero, splitting it into pages of
+	 * about that many bytes with tc_combined_filename_s as the index.
+	 */
+	bool tc_single_page_flag;
+	const char *tc_document_title_s;
+	size_t tc_page_size;
+	size_t tc_page_number;
+	bool tc_page_full_flag;
+	json_t *tc_contents_p;
+
+	/**
+	 * If this is set, the names of the files that are written are
+	 * added to it as keys so that they can be returned to a client.
+	 */
+	json_t *tc_outputs_p;
+
+	/** If this is set, the output is written to the OutputSinks that it returns rather than to files */
+	GetOutputSinkFn tc_get_sink_fn;
+	void *tc_get_sink_data_p;
+} ToolContext;
+
+
+struct FDRenderer
+{
+	/** The settings that the ToolContext for each data package is copied from */
+	ToolContext fr_context;
+
+	/** Whether all of the resources of a package are written to a single file */
+	bool fr_combined_flag;
+
+	/**
+	 * For incremental builds, anything that changes the generated output
+	 * needs to be part of the digests and is stored here.
+	 */
+	bool fr_incremental_flag;
+	char fr_options_s [256];
+
+	char fr_data_exts_s [64];
+
+	/** Whether the SchemaCache was allocated by the FDRenderer */
+	bool fr_own_schema_cache_flag;
+};
+
+
+static const uint32 S_VERSION_MAJOR = 0;
+static const uint32 S_VERSION_MINOR = 9;
+static const uint32 S_VERSION_REV = 1;
+
+static const char * const S_FILE_INDEX_FILENAME_S = ".grassroots_fd_files.json";
+static const json_int_t S_FILE_INDEX_VERSION = 1;
+
+
+/*
+ * static declarations
+ */
+
+static bool ProcessResource (ToolContext *context_p, const json_t *resource_p, const size_t index);
+
+static char *GetOutputFilename (const OutputDirectory *dir_p, const char *name_s, const char *extension_s, const bool shard_flag);
+
+static void RenderResource (ToolContext *context_p, const json_t *resource_p, const json_t *schema_p, const char *name_s, const char *profile_s, const size_t index);
+
+static bool ProcessResources (ToolContext *context_p, const json_t *resources_p, const json_t *previous_index_p, size_t *num_processed_p);
+
+static char *GetCombinedOutputFilename (const OutputDirectory *dir_p, const char *fd_file_s, const char *suffix_s, const char *extension_s);
+
+static bool OpenCombinedOutput (ToolContext *context_p, const json_t *resources_p);
+
+static bool CloseCombinedOutput (ToolContext *context_p);
+
+static bool OpenCombinedOutputFile (ToolContext *context_p, const char *filename_s);
+
+static bool CloseCombinedOutputFile (ToolContext *context_p, const char *filename_s);
+
+static bool OpenPage (ToolContext *context_p);
+
+static char *GetPageFilename (const ToolContext *context_p, const OutputDirectory *dir_p);
+
+static json_t *GetContents (const json_t *resources_p);
+
+static const char *GetDocumentTitle (const json_t *fd_p);
+
+static Printer *AllocateToolPrinter (const PrinterFormat *formats_p, const size_t num_formats, const FDRenderOptions *options_p, PrinterTemplate **template_pp, const char **data_ext_ss, char *data_exts_s, const size_t data_exts_size);
+
+static Printer *AllocatePrinterForFormat (const PrinterFormat format, const bool md_tables_flag, const char *template_filename_s, PrinterTemplate **template_pp, const char **extension_ss);
+
+static bool ExportCSVFile (ToolContext *context_p, const char *filename_s, const char *name_s, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *resource_p, const json_t *data_p);
+
+static char *GetResourceFilename (const ToolContext *context_p, const size_t index, const char *extension_s);
+
+static bool AssignResourceFilenames (ToolContext *context_p, const json_t *resources_p);
+
+static const char *GetResourceBaseName (const ToolContext *context_p, const json_t *resource_p, const char **exts_ss);
+
+static bool CheckFilenameStem (json_t *used_p, const char *stem_s, const char *exts_s, const bool claim_flag);
+
+static void ReplaceNonFilenameCharacters (char *value_s, size_t length);
+
+static bool SaveFileIndex (ToolContext *context_p);
+
+static bool LoadFileIndex (ToolContext *context_p);
+
+static char *CheckOutputCache (ToolContext *context_p, const json_t *resource_p, const char *schema_url_s, const char *filename_s, const bool data_flag, bool *up_to_date_flag_p);
+
+static bool DoDataFilesExist (const ToolContext *context_p, const char *filename_s);
+
+static bool WatchPackage (ToolContext *context_p, const json_t *fd_p);
+
+static json_t *GetResourcesIndex (const json_t *resources_p);
+
+static const char *GetResourceIndexKey (const json_t *resource_p, const size_t index, char *buffer_s, const size_t buffer_size);
+
+static bool OpenPackageOutputs (ToolContext *context_p, const bool combined_flag, const char *options_s);
+
+static void ClosePackageOutputs (ToolContext *context_p);
+
+static bool ExportPackageResources (ToolContext *context_p, const json_t *fd_p);
+
+static void AddOutputFilename (ToolContext *context_p, const char *filename_s, const bool data_flag, const bool resource_flag);
+
+static void RecordOutputFilename (ToolContext *context_p, const char *filename_s, const bool resource_flag);
+
+static const char *GetDigestOptions (const FDRenderer *renderer_p);
+
+
+/*
+ * api definitions
+ */
+
+void InitFDRenderOptions (FDRenderOptions *options_p)
+{
+	memset (options_p, 0, sizeof (FDRenderOptions));
+
+	options_p -> ro_table_format_s = "csv";
+}
+
+
+FDRenderer *AllocateFDRenderer (const FDRenderOptions *options_p, SchemaCache *schema_cache_p)
+{
+	FDRenderer *renderer_p = (FDRenderer *) calloc (1, sizeof (FDRenderer));
+
+	if (renderer_p)
+		{
+			ToolContext *context_p = & (renderer_p -> fr_context);
+			const PrinterFormat *formats_p = options_p -> ro_formats_p;
+			size_t num_formats = options_p -> ro_num_formats;
+			PrinterFormat default_format = PRINTER_FORMAT_HTML;
+			PrinterTemplate *template_p = NULL;
+			const char *data_ext_s = NULL;
+
+			/* Use the template if one was given and no formats were */
+			if (num_formats == 0)
+				{
+					if (options_p -> ro_template_filename_s)
+						{
+							default_format = PRINTER_FORMAT_TEMPLATE;
+						}
+
+					formats_p = &default_format;
+					num_formats = 1;
+				}
+
+			context_p -> tc_printer_p = AllocateToolPrinter (formats_p, num_formats, options_p, &template_p, &data_ext_s, renderer_p -> fr_data_exts_s, sizeof (renderer_p -> fr_data_exts_s));
+
+			if (context_p -> tc_printer_p)
+				{
+					const bool ndjson_flag = (num_formats == 1) && (*formats_p == PRINTER_FORMAT_NDJSON);
+					bool success_flag = true;
+
+					context_p -> tc_data_ext_s = data_ext_s;
+					context_p -> tc_data_exts_s = renderer_p -> fr_data_exts_s;
+					context_p -> tc_table_format_s = options_p -> ro_table_format_s ? options_p -> ro_table_format_s : "csv";
+					context_p -> tc_full_flag = options_p -> ro_full_flag;
+					context_p -> tc_debug_flag = options_p -> ro_debug_flag;
+					context_p -> tc_num_jobs = (options_p -> ro_num_jobs > 0) ? options_p -> ro_num_jobs : 1;
+					context_p -> tc_shard_depth = options_p -> ro_shard_depth;
+					context_p -> tc_file_index_flag = options_p -> ro_file_index_flag;
+					context_p -> tc_durability = options_p -> ro_durability;
+
+					if (context_p -> tc_shard_depth > OD_MAX_SHARD_DEPTH)
+						{
+							printf ("--shard-depth can be at most %d\n", OD_MAX_SHARD_DEPTH);
+							success_flag = false;
+						}
+
+					if (context_p -> tc_durability >= OD_NUM_DURABILITIES)
+						{
+							printf ("Unknown durability %d\n", (int) (context_p -> tc_durability));
+							success_flag = false;
+						}
+
+					if (options_p -> ro_single_page_flag)
+						{
+							if (ndjson_flag)
+								{
+									printf ("--single-page is ignored for ndjson which always writes a single file\n");
+								}
+							else if (DoesFDPrinterSupportDocuments (context_p -> tc_printer_p))
+								{
+									context_p -> tc_single_page_flag = true;
+									context_p -> tc_page_size = options_p -> ro_page_size;
+
+									/* The links between the pages only go to the first format's files */
+									if ((context_p -> tc_page_size > 0) && (num_formats > 1))
+										{
+											printf ("--page-size cannot be used with more than one data format\n");
+											success_flag = false;
+										}
+								}
+							else
+								{
+									printf ("--single-page is not supported for the %s format\n", renderer_p -> fr_data_exts_s);
+									success_flag = false;
+								}
+						}
+
+					renderer_p -> fr_combined_flag = ndjson_flag || (context_p -> tc_single_page_flag);
+
+					if (options_p -> ro_incremental_flag)
+						{
+							if (renderer_p -> fr_combined_flag)
+								{
+									printf ("--incremental is ignored when writing all of the resources to a single file\n");
+								}
+							else
+								{
+									char *options_s = renderer_p -> fr_options_s;
+									const size_t options_size = sizeof (renderer_p -> fr_options_s);
+
+									/*
+									 * Anything that changes the generated output needs to be
+									 * part of the digests, including the program version
+									 * and the contents of any template
+									 */
+									snprintf (options_s, options_size, "ver=%u.%u.%u;data=%s;table=%s;full=%d;md_tables=%d", S_VERSION_MAJOR, S_VERSION_MINOR, S_VERSION_REV,
+														renderer_p -> fr_data_exts_s, context_p -> tc_table_format_s, options_p -> ro_full_flag ? 1 : 0, options_p -> ro_md_tables_flag ? 1 : 0);
+
+									if ((options_p -> ro_json_max_size > 0) || (options_p -> ro_json_collapse_size > 0))
+										{
+											const size_t length = strlen (options_s);
+
+											snprintf (options_s + length, options_size - length, ";json_max=%lu;json_collapse=%lu", (unsigned long) (options_p -> ro_json_max_size), (unsigned long) (options_p -> ro_json_collapse_size));
+										}
+
+									if (template_p)
+										{
+											const size_t length = strlen (options_s);
+
+											snprintf (options_s + length, options_size - length, ";template=%08lx%08lx",
+																(unsigned long) (template_p -> pt_digest >> 32), (unsigned long) (template_p -> pt_digest & 0xFFFFFFFFUL));
+										}
+
+									renderer_p -> fr_incremental_flag = true;
+								}
+						}
+
+					if (success_flag)
+						{
+							if (schema_cache_p)
+								{
+									context_p -> tc_schema_cache_p = schema_cache_p;
+								}
+							else
+								{
+									context_p -> tc_schema_cache_p = AllocateSchemaCache ();
+									renderer_p -> fr_own_schema_cache_flag = true;
+								}
+
+							if (context_p -> tc_schema_cache_p)
+								{
+									return renderer_p;
+								}
+						}
+				}
+
+			FreeFDRenderer (renderer_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeFDRenderer (FDRenderer *renderer_p)
+{
+	ToolContext *context_p = & (renderer_p -> fr_context);
+
+	if (context_p -> tc_printer_p)
+		{
+			FreeFDPrinter (context_p -> tc_printer_p);
+		}
+
+	if ((renderer_p -> fr_own_schema_cache_flag) && (context_p -> tc_schema_cache_p))
+		{
+			FreeSchemaCache (context_p -> tc_schema_cache_p);
+		}
+
+	free (renderer_p);
+}
+
+
+void SetFDRendererStats (FDRenderer *renderer_p, ToolStats *stats_p)
+{
+	renderer_p -> fr_context.tc_stats_p = stats_p;
+}
+
+
+void SetFDRendererOutputSinks (FDRenderer *renderer_p, GetOutputSinkFn get_sink_fn, void *get_sink_data_p)
+{
+	ToolContext *context_p = & (renderer_p -> fr_context);
+
+	context_p -> tc_get_sink_fn = get_sink_fn;
+	context_p -> tc_get_sink_data_p = get_sink_data_p;
+
+	SetFDPrinterOutputSinks (context_p -> tc_printer_p, get_sink_fn, get_sink_data_p);
+}
+
+
+const char *GetFDRendererExtensions (const FDRenderer *renderer_p)
+{
+	return renderer_p -> fr_data_exts_s;
+}
+
+
+bool RenderFDPackageFile (FDRenderer *renderer_p, const char *fd_file_s, const char *out_dir_s, json_t *outputs_p)
+{
+	bool success_flag = false;
+	ToolStats *stats_p = renderer_p -> fr_context.tc_stats_p;
+	json_error_t err;
+	StatsTimer timer;
+	json_t *fd_p;
+
+	StartStatsTimer (stats_p, &timer, SP_JSON_LOAD);
+	fd_p = json_load_file (fd_file_s, 0, &err);
+	StopStatsTimer (stats_p, &timer, fd_file_s);
+
+	if (fd_p)
+		{
+			success_flag = RenderFDPackage (renderer_p, fd_p, fd_file_s, out_dir_s, outputs_p);
+			json_decref (fd_p);
+		}
+	else
+		{
+			printf ("Failed to load %s as a JSON file\n", fd_file_s);
+		}
+
+	return success_flag;
+}
+
+
+bool RenderFDPackage (FDRenderer *renderer_p, const json_t *fd_p, const char *fd_file_s, const char *out_dir_s, json_t *outputs_p)
+{
+	bool success_flag = false;
+	ToolContext context = renderer_p -> fr_context;
+
+	context.tc_fd_file_s = fd_file_s;
+	context.tc_out_dir_s = out_dir_s;
+
+	if (outputs_p)
+		{
+			/* This is an object so that any files that are written more than once are only listed once */
+			context.tc_outputs_p = json_object ();
+
+			if (! (context.tc_outputs_p))
+				{
+					return false;
+				}
+		}
+
+	if (OpenPackageOutputs (&context, renderer_p -> fr_combined_flag, GetDigestOptions (renderer_p)))
+		{
+			success_flag = ExportPackageResources (&context, fd_p);
+		}
+
+	ClosePackageOutputs (&context);
+
+	if (context.tc_outputs_p)
+		{
+			if (success_flag)
+				{
+					const char *filename_s;
+					json_t *value_p;
+
+					json_object_foreach (context.tc_outputs_p, filename_s, value_p)
+						{
+							if (json_array_append_new (outputs_p, json_string (filename_s)) != 0)
+								{
+									success_flag = false;
+								}
+						}
+				}
+
+			json_decref (context.tc_outputs_p);
+		}
+
+	return success_flag;
+}
+
+
+bool WatchFDPackageFile (FDRenderer *renderer_p, const char *fd_file_s, const char *out_dir_s)
+{
+	bool success_flag = false;
+	ToolContext context = renderer_p -> fr_context;
+
+	context.tc_fd_file_s = fd_file_s;
+	context.tc_out_dir_s = out_dir_s;
+
+	if (OpenPackageOutputs (&context, renderer_p -> fr_combined_flag, GetDigestOptions (renderer_p)))
+		{
+			json_error_t err;
+			json_t *fd_p = json_load_file (fd_file_s, 0, &err);
+
+			if (fd_p)
+				{
+					context.tc_document_title_s = GetDocumentTitle (fd_p);
+
+					/* Carry on from the index that the initial render wrote, so it keeps the unchanged resources */
+					if (context.tc_file_index_p)
+						{
+							LoadFileIndex (&context);
+						}
+
+					success_flag = WatchPackage (&context, fd_p);
+					json_decref (fd_p);
+				}
+			else
+				{
+					printf ("Failed to load %s as a JSON file\n", fd_file_s);
+				}
+		}
+
+	ClosePackageOutputs (&context);
+
+	return success_flag;
+}
+
+
+void GetFDRendererVersion (uint32 *major_p, uint32 *minor_p, uint32 *rev_p)
+{
+	*major_p = S_VERSION_MAJOR;
+	*minor_p = S_VERSION_MINOR;
+	*rev_p = S_VERSION_REV;
+}
+
+
+/*
+ * static definitions
+ */
+
+
+static bool ProcessResource (ToolContext *context_p, const json_t *resource_p, const size_t index)
+{
+	bool success_flag = false;
+	bool generated_flag = false;
+	const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
+	const char *name_s = NULL;
+	size_t start_bytes = 0;
+	double start_wall = 0.0;
+
+	if (context_p -> tc_stats_p)
+		{
+			start_bytes = context_p -> tc_stats_p -> ts_bytes_written;
+			start_wall = GetWallClockTime ();
+		}
+
+	if (profile_s)
+		{
+			char *filename_s = NULL;
+
+			name_s = GetJSONString (resource_p, FD_NAME_S);
+
+			if (!name_s)
+				{
+					name_s = GetJSONString (resource_p, FD_TABLE_FIELD_TITLE);
+				}
+
+			if (DoesStringStartWith (profile_s, "http"))
+				{
+					const json_t *schema_p = GetSchemaFromCache (context_p -> tc_schema_cache_p, profile_s);
+
+					if (schema_p)
+						{
+							if (context_p -> tc_combined_filename_s)
+								{
+									/* The printer is already open */
+									generated_flag = true;
+									RenderResource (context_p, resource_p, schema_p, name_s, profile_s, index);
+									success_flag = true;
+
+									if (context_p -> tc_resource_files_p)
+										{
+											/* List the page that the resource is on */
+											char *page_filename_s = (context_p -> tc_page_size > 0) ? GetPageFilename (context_p, context_p -> tc_out_dir_p) : NULL;
+
+											AddOutputFilename (context_p, page_filename_s ? page_filename_s : context_p -> tc_combined_filename_s, true, true);
+
+											if (page_filename_s)
+												{
+													FreeCopiedString (page_filename_s);
+												}
+										}
+								}
+							else
+								{
+									filename_s = GetResourceFilename (context_p, index, context_p -> tc_data_ext_s);
+
+								if (filename_s)
+									{
+										bool up_to_date_flag = false;
+										char *digest_s = CheckOutputCache (context_p, resource_p, profile_s, filename_s, true, &up_to_date_flag);
+
+										if (up_to_date_flag)
+											{
+												success_flag = true;
+											}
+										else
+											{
+												Printer *printer_p = context_p -> tc_printer_p;
+
+												generated_flag = true;
+
+												if (OpenFDPrinter (printer_p, filename_s))
+													{
+														StatsTimer timer;
+
+														RenderResource (context_p, resource_p, schema_p, name_s, profile_s, index);
+
+														StartStatsTimer (context_p -> tc_stats_p, &timer, SP_CLOSE);
+														success_flag = CloseFDPrinter (printer_p);
+														StopStatsTimer (context_p -> tc_stats_p, &timer, name_s);
+													}		/* if (OpenPrinter (printer_p, filename_s)) */
+												else
+													{
+														printf ("Failed to open \"%s\" for to write to.\n", filename_s);
+													}
+											}
+
+										if (digest_s)
+											{
+												if (success_flag)
+													{
+														SetOutputDigest (context_p -> tc_output_cache_p, filename_s, digest_s);
+													}
+
+												FreeCopiedString (digest_s);
+											}
+
+										if (success_flag)
+											{
+												AddOutputFilename (context_p, filename_s, true, true);
+											}
+
+										FreeCopiedString (filename_s);
+									}		/* if (filename_s) */
+								}		/* if (context_p -> tc_combined_filename_s) else */
+
+						}		/* if (schema_p) */
+				}
+			else if (strcmp (profile_s, FD_PROFILE_TABULAR_RESOURCE_S) == 0)
+				{
+					const json_t *schema_p = json_object_get (resource_p, FD_SCHEMA_S);
+					const json_t *data_p = json_object_get (resource_p, FD_DATA_S);
+					const json_t *headers_p = NULL;
+
+					if (schema_p)
+						{
+							headers_p = json_object_get (schema_p, FD_TABLE_FIELDS_S);
+
+							if (!name_s)
+								{
+									name_s = GetJSONString (schema_p, FD_TITLE_S);
+								}
+
+						}
+
+					if ((data_p) || (IsPathBasedResource (resource_p)))
+						{
+							const char *col_sep_s = ",";
+							const char *row_sep_s = "\n";
+
+							filename_s = GetResourceFilename (context_p, index, context_p -> tc_table_format_s);
+
+							if (filename_s)
+								{
+									bool up_to_date_flag = false;
+									char *digest_s = NULL;
+
+									/* External files can change without the package changing so they are always exported */
+									if (data_p)
+										{
+											digest_s = CheckOutputCache (context_p, resource_p, NULL, filename_s, false, &up_to_date_flag);
+										}
+
+									if (up_to_date_flag)
+										{
+											success_flag = true;
+										}
+									else
+										{
+											generated_flag = true;
+											success_flag = ExportCSVFile (context_p, filename_s, name_s, col_sep_s, row_sep_s, headers_p, resource_p, data_p);
+										}
+
+									if (digest_s)
+										{
+											if (success_flag)
+												{
+													SetOutputDigest (context_p -> tc_output_cache_p, filename_s, digest_s);
+												}
+
+											FreeCopiedString (digest_s);
+										}
+
+									if (success_flag)
+										{
+											AddOutputFilename (context_p, filename_s, false, true);
+										}
+
+									FreeCopiedString (filename_s);
+								}		/* if (filename_s) */
+
+						}
+
+				}		/* if (strcmp (profile_s, FD_PROFILE_TABULAR_RESOURCE_S) == 0) */
+
+		}		/* if (profile_s) */
+
+	if (context_p -> tc_stats_p)
+		{
+			ToolStats *stats_p = context_p -> tc_stats_p;
+
+			if (success_flag)
+				{
+					++ (stats_p -> ts_resources_processed);
+				}
+
+			/*
+			 * The time includes fetching any schemas that weren't already
+			 * cached, up to date resources from an incremental build aren't
+			 * recorded.
+			 */
+			if (generated_flag)
+				{
+					char index_s [32];
+
+					if (!name_s)
+						{
+							name_s = GetResourceIndexKey (resource_p, index, index_s, sizeof (index_s));
+						}
+
+					AddResourceTiming (stats_p, name_s, GetWallClockTime () - start_wall, (stats_p -> ts_bytes_written) - start_bytes);
+				}
+		}
+
+	return success_flag;
+}
+
+/*
+ * Write the resource to the already open printer.
+ */
+static void RenderResource (ToolContext *context_p, const json_t *resource_p, const json_t *schema_p, const char *name_s, const char *profile_s, const size_t index)
+{
+	Printer *printer_p = context_p -> tc_printer_p;
+	ToolStats *stats_p = context_p -> tc_stats_p;
+	StatsTimer timer;
+	char *footer_s;
+	long start_pos = 0;
+	char anchor_s [32];
+
+	if (context_p -> tc_page_full_flag)
+		{
+			if (CloseCombinedOutputFile (context_p, NULL))
+				{
+					OpenPage (context_p);
+				}
+		}
+
+	if (stats_p)
+		{
+			start_pos = ftell (printer_p -> pr_out_f);
+		}
+
+	StartStatsTimer (stats_p, &timer, SP_RENDER);
+
+	footer_s = ConcatenateVarargsStrings ("Parsed ", context_p -> tc_fd_file_s, " using profile ", profile_s, NULL);
+
+	if (context_p -> tc_single_page_flag)
+		{
+			snprintf (anchor_s, sizeof (anchor_s), "resource-%lu", (unsigned long) index);
+			PrintResourceStart (printer_p, anchor_s, name_s);
+		}
+	else
+		{
+			PrintHeader (printer_p, name_s, NULL);
+		}
+
+	ParsePackageFromSchema (resource_p, schema_p, profile_s, printer_p, context_p -> tc_schema_cache_p, context_p -> tc_full_flag, context_p -> tc_debug_flag, 0);
+
+	/*
+	 * Always print the footer, even without any text, as
+	 * the printer may need to close elements off.
+	 */
+	if (context_p -> tc_single_page_flag)
+		{
+			PrintResourceEnd (printer_p, footer_s);
+		}
+	else
+		{
+			PrintFooter (printer_p, footer_s);
+		}
+
+	if (footer_s)
+		{
+			FreeCopiedString (footer_s);
+		}
+
+	StopStatsTimer (stats_p, &timer, name_s);
+
+	if (stats_p)
+		{
+			const long end_pos = ftell (printer_p -> pr_out_f);
+
+			if (end_pos > start_pos)
+				{
+					stats_p -> ts_bytes_written += (size_t) (end_pos - start_pos);
+				}
+		}
+
+	/*
+	 * When splitting the document into pages, record which page the
+	 * resource is on for the index and start a new page once this one
+	 * is big enough. The new page isn't opened until there is another
+	 * resource to go on it.
+	 */
+	if (context_p -> tc_page_size > 0)
+		{
+			/* The pages are in the same directory as the index so use a relative link */
+			char *page_filename_s = GetPageFilename (context_p, NULL);
+
+			if (page_filename_s)
+				{
+					char *link_s = ConcatenateVarargsStrings (page_filename_s, "#", anchor_s, NULL);
+
+					FreeCopiedString (page_filename_s);
+
+					if (link_s)
+						{
+							char index_s [32];
+							json_t *entry_p = json_pack ("{s:s,s:s}", "title", name_s ? name_s : GetResourceIndexKey (resource_p, index, index_s, sizeof (index_s)), "link", link_s);
+
+							if (entry_p)
+								{
+									json_array_append_new (context_p -> tc_contents_p, entry_p);
+								}
+
+							FreeCopiedString (link_s);
+						}
+				}
+
+			if (ftell (printer_p -> pr_out_f) >= (long) (context_p -> tc_page_size))
+				{
+					context_p -> tc_page_full_flag = true;
+				}
+		}
+}
+
+/*
+ * Process each of the resources. If previous_index_p is set, only the
+ * resources that are not in it or that have changed, or that have had
+ * their filenames changed, are processed, unless all of the resources
+ * are being written to a single file in which case they all need
+ * writing again.
+ */
+static bool ProcessResources (ToolContext *context_p, const json_t *resources_p, const json_t *previous_index_p, size_t *num_processed_p)
+{
+	bool success_flag;
+	size_t num_processed = 0;
+	json_t *previous_files_p = NULL;
+	json_t *previous_stems_p = NULL;
+
+	if (previous_index_p)
+		{
+			/* Keep the stems that the resources had the last time to compare against */
+			previous_stems_p = context_p -> tc_resource_stems_p;
+			context_p -> tc_resource_stems_p = NULL;
+		}
+
+	success_flag = AssignResourceFilenames (context_p, resources_p);
+
+	if (success_flag && (context_p -> tc_file_index_p))
+		{
+			/* Any resources that aren't processed keep their previous entries */
+			previous_files_p = context_p -> tc_file_index_p;
+			context_p -> tc_file_index_p = json_object ();
+
+			if (! (context_p -> tc_file_index_p))
+				{
+					context_p -> tc_file_index_p = previous_files_p;
+					previous_files_p = NULL;
+					success_flag = false;
+				}
+		}
+
+	if (success_flag && (context_p -> tc_combined_filename_s))
+		{
+			previous_index_p = NULL;
+			success_flag = OpenCombinedOutput (context_p, resources_p);
+		}
+
+	if (success_flag)
+		{
+			size_t i;
+			const json_t *resource_p;
+
+			json_array_foreach (resources_p, i, resource_p)
+				{
+					bool process_flag = true;
+					char buffer_s [32];
+					const char *key_s = GetResourceIndexKey (resource_p, i, buffer_s, sizeof (buffer_s));
+
+					if (previous_index_p)
+						{
+							const json_t *previous_resource_p = json_object_get (previous_index_p, key_s);
+							const json_t *previous_stem_p = json_object_get (previous_stems_p, key_s);
+
+							if ((previous_resource_p) && (json_equal ((json_t *) previous_resource_p, (json_t *) resource_p)) &&
+									(previous_stem_p) && (json_equal ((json_t *) previous_stem_p, json_array_get (context_p -> tc_file_stems_p, i))))
+								{
+									process_flag = false;
+								}
+							else if (context_p -> tc_debug_flag)
+								{
+									printf ("Regenerating \"%s\"\n", key_s);
+								}
+						}
+
+					if (context_p -> tc_file_index_p)
+						{
+							/* If several resources have the same name, use their positions for the later ones */
+							if (json_object_get (context_p -> tc_file_index_p, key_s))
+								{
+									snprintf (buffer_s, sizeof (buffer_s), "#%lu", (unsigned long) i);
+									key_s = buffer_s;
+								}
+
+							if (process_flag)
+								{
+									context_p -> tc_resource_files_p = json_array ();
+								}
+							else
+								{
+									json_t *files_p = json_object_get (previous_files_p, key_s);
+
+									if (files_p)
+										{
+											json_object_set (context_p -> tc_file_index_p, key_s, files_p);
+										}
+								}
+						}
+
+					if (process_flag)
+						{
+							if (!ProcessResource (context_p, resource_p, i))
+								{
+									success_flag = false;
+								}
+
+							++ num_processed;
+
+							if (context_p -> tc_resource_files_p)
+								{
+									if (json_array_size (context_p -> tc_resource_files_p) > 0)
+										{
+											json_object_set (context_p -> tc_file_index_p, key_s, context_p -> tc_resource_files_p);
+										}
+
+									json_decref (context_p -> tc_resource_files_p);
+									context_p -> tc_resource_files_p = NULL;
+								}
+						}
+				}		/* json_array_foreach (resources_p, i, resource_p) */
+
+			if (context_p -> tc_combined_filename_s)
+				{
+					if (!CloseCombinedOutput (context_p))
+						{
+							success_flag = false;
+						}
+				}
+
+			if (context_p -> tc_file_index_p)
+				{
+					if (!SaveFileIndex (context_p))
+						{
+							success_flag = false;
+						}
+				}
+		}
+
+	if (previous_files_p)
+		{
+			json_decref (previous_files_p);
+		}
+
+	if (previous_stems_p)
+		{
+			json_decref (previous_stems_p);
+		}
+
+	if (num_processed_p)
+		{
+			*num_processed_p = num_processed;
+		}
+
+	return success_flag;
+}
+
+/*
+ * Name the combined output after the input file, so datapackage.json
+ * gives datapackage.ndjson, with an optional suffix for any pages
+ */
+static char *GetCombinedOutputFilename (const OutputDirectory *dir_p, const char *fd_file_s, const char *suffix_s, const char *extension_s)
+{
+	char *filename_s = NULL;
+	const char *start_s = fd_file_s;
+	const char *end_s;
+	const char *c_p;
+	char *stem_s;
+
+	for (c_p = fd_file_s; *c_p != '\0'; ++ c_p)
+		{
+			if ((*c_p == '/') || (*c_p == '\\'))
+				{
+					start_s = c_p + 1;
+				}
+		}
+
+	end_s = strrchr (start_s, '.');
+
+	if ((!end_s) || (end_s == start_s))
+		{
+			end_s = start_s + strlen (start_s);
+		}
+
+	stem_s = CopyToNewString (start_s, end_s - start_s, false);
+
+	if (stem_s)
+		{
+			if (suffix_s)
+				{
+					char *temp_s = ConcatenateStrings (stem_s, suffix_s);
+
+					FreeCopiedString (stem_s);
+					stem_s = temp_s;
+				}
+
+			if (stem_s)
+				{
+					/* These aren't sharded so that they are easy to find */
+					filename_s = GetOutputFilename (dir_p, stem_s, extension_s, false);
+					FreeCopiedString (stem_s);
+				}
+		}
+
+	return filename_s;
+}
+
+/*
+ * Open the file, or the first page, that all of the resources are written to.
+ */
+static bool OpenCombinedOutput (ToolContext *context_p, const json_t *resources_p)
+{
+	bool success_flag = false;
+
+	if (context_p -> tc_single_page_flag)
+		{
+			if (context_p -> tc_page_size > 0)
+				{
+					/* The contents are collected as the pages are written */
+					if (context_p -> tc_contents_p)
+						{
+							json_array_clear (context_p -> tc_contents_p);
+						}
+					else
+						{
+							context_p -> tc_contents_p = json_array ();
+						}
+
+					if (context_p -> tc_contents_p)
+						{
+							context_p -> tc_page_number = 0;
+							context_p -> tc_page_full_flag = false;
+
+							success_flag = OpenPage (context_p);
+						}
+				}
+			else
+				{
+					json_t *contents_p = GetContents (resources_p);
+
+					if (contents_p)
+						{
+							if (OpenCombinedOutputFile (context_p, context_p -> tc_combined_filename_s))
+								{
+									success_flag = PrintContents (context_p -> tc_printer_p, contents_p);
+								}
+
+							json_decref (contents_p);
+						}
+				}
+		}
+	else
+		{
+			success_flag = OpenFDPrinter (context_p -> tc_printer_p, context_p -> tc_combined_filename_s);
+
+			if (success_flag)
+				{
+					AddOutputFilename (context_p, context_p -> tc_combined_filename_s, true, false);
+				}
+			else
+				{
+					printf ("Failed to open \"%s\" for to write to.\n", context_p -> tc_combined_filename_s);
+				}
+		}
+
+	return success_flag;
+}
+
+/*
+ * Finish the combined output and, if it was split into pages,
+ * write the index with the contents.
+ */
+static bool CloseCombinedOutput (ToolContext *context_p)
+{
+	bool success_flag = CloseCombinedOutputFile (context_p, context_p -> tc_combined_filename_s);
+
+	if (success_flag && (context_p -> tc_page_size > 0))
+		{
+			success_flag = false;
+
+			if (OpenCombinedOutputFile (context_p, context_p -> tc_combined_filename_s))
+				{
+					if (PrintContents (context_p -> tc_printer_p, context_p -> tc_contents_p))
+						{
+							success_flag = CloseCombinedOutputFile (context_p, context_p -> tc_combined_filename_s);
+						}
+				}
+		}
+
+	return success_flag;
+}
+
+/*
+ * Open a file and, for a single page document, start it. The whole
+ * document goes through the one FILE so give it a bigger buffer.
+ */
+static bool OpenCombinedOutputFile (ToolContext *context_p, const char *filename_s)
+{
+	Printer *printer_p = context_p -> tc_printer_p;
+	bool success_flag = false;
+
+	if (OpenFDPrinter (printer_p, filename_s))
+		{
+			AddOutputFilename (context_p, filename_s, true, false);
+			setvbuf (printer_p -> pr_out_f, NULL, _IOFBF, 1 << 16);
+
+			if (context_p -> tc_single_page_flag)
+				{
+					success_flag = PrintDocumentStart (printer_p, context_p -> tc_document_title_s ? context_p -> tc_document_title_s : context_p -> tc_fd_file_s);
+				}
+			else
+				{
+					success_flag = true;
+				}
+		}
+	else
+		{
+			printf ("Failed to open \"%s\" for to write to.\n", filename_s);
+		}
+
+	return success_flag;
+}
+
+static bool CloseCombinedOutputFile (ToolContext *context_p, const char *filename_s)
+{
+	Printer *printer_p = context_p -> tc_printer_p;
+	StatsTimer timer;
+	bool success_flag = true;
+
+	if (context_p -> tc_single_page_flag && (printer_p -> pr_out_f))
+		{
+			success_flag = PrintDocumentEnd (printer_p);
+		}
+
+	StartStatsTimer (context_p -> tc_stats_p, &timer, SP_CLOSE);
+
+	if (!CloseFDPrinter (printer_p))
+		{
+			success_flag = false;
+		}
+
+	StopStatsTimer (context_p -> tc_stats_p, &timer, filename_s);
+
+	if (!success_flag)
+		{
+			printf ("Failed to write \"%s\"\n", filename_s ? filename_s : context_p -> tc_combined_filename_s);
+		}
+
+	return success_flag;
+}
+
+static bool OpenPage (ToolContext *context_p)
+{
+	bool success_flag = false;
+	char *filename_s;
+
+	++ (context_p -> tc_page_number);
+	context_p -> tc_page_full_flag = false;
+
+	filename_s = GetPageFilename (context_p, context_p -> tc_out_dir_p);
+
+	if (filename_s)
+		{
+			success_flag = OpenCombinedOutputFile (context_p, filename_s);
+			FreeCopiedString (filename_s);
+		}
+
+	return success_flag;
+}
+
+/*
+ * Get the filename of the current page, or just its name if dir_p is NULL.
+ */
+static char *GetPageFilename (const ToolContext *context_p, const OutputDirectory *dir_p)
+{
+	char suffix_s [32];
+
+	snprintf (suffix_s, sizeof (suffix_s), "_%lu", (unsigned long) (context_p -> tc_page_number));
+
+	return GetCombinedOutputFilename (dir_p, context_p -> tc_fd_file_s, suffix_s, context_p -> tc_data_ext_s);
+}
+
+/*
+ * Get the contents for a document with every resource that is
+ * rendered with a schema, linking to their anchors.
+ */
+static json_t *GetContents (const json_t *resources_p)
+{
+	json_t *contents_p = json_array ();
+
+	if (contents_p)
+		{
+			size_t i;
+			const json_t *resource_p;
+
+			json_array_foreach (resources_p, i, resource_p)
+				{
+					const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
+
+					if (profile_s && DoesStringStartWith (profile_s, "http"))
+						{
+							char buffer_s [32];
+							char link_s [32];
+							const char *title_s = GetResourceIndexKey (resource_p, i, buffer_s, sizeof (buffer_s));
+							json_t *entry_p;
+
+							snprintf (link_s, sizeof (link_s), "#resource-%lu", (unsigned long) i);
+
+							entry_p = json_pack ("{s:s,s:s}", "title", title_s, "link", link_s);
+
+							if (! ((entry_p) && (json_array_append_new (contents_p, entry_p) == 0)))
+								{
+									json_decref (contents_p);
+									return NULL;
+								}
+						}
+				}
+		}
+
+	return contents_p;
+}
+
+static const char *GetDocumentTitle (const json_t *fd_p)
+{
+	const char *title_s = GetJSONString (fd_p, FD_TITLE_S);
+
+	if (!title_s)
+		{
+			title_s = GetJSONString (fd_p, FD_NAME_S);
+		}
+
+	return title_s;
+}
+
+/*
+ * Allocate the printer for the data formats, which is a composite printer
+ * that passes everything on to a printer for each format if there is more
+ * than one. The formats' file extensions are written to data_exts_s.
+ */
+static Printer *AllocateToolPrinter (const PrinterFormat *formats_p, const size_t num_formats, const FDRenderOptions *options_p, PrinterTemplate **template_pp, const char **data_ext_ss, char *data_exts_s, const size_t data_exts_size)
+{
+	Printer *printer_p = NULL;
+	const char *data_ext_s = NULL;
+
+	*data_exts_s = '\0';
+
+	if (num_formats == 1)
+		{
+			printer_p = AllocatePrinterForFormat (formats_p [0], options_p -> ro_md_tables_flag, options_p -> ro_template_filename_s, template_pp, &data_ext_s);
+
+			if (data_ext_s)
+				{
+					strncat (data_exts_s, data_ext_s, data_exts_size - 1);
+				}
+		}
+	else
+		{
+			Printer *printers_pp [PRINTER_FORMAT_NUM_FORMATS];
+			const char *extensions_ss [PRINTER_FORMAT_NUM_FORMATS];
+			size_t num_printers = 0;
+			bool formats_ok_flag = true;
+
+			/*
+			 * Each resource is only traversed once and the composite
+			 * printer passes everything on to the printer for each format
+			 */
+			while ((num_printers < num_formats) && formats_ok_flag)
+				{
+					if (formats_p [num_printers] == PRINTER_FORMAT_NDJSON)
+						{
+							printf ("ndjson writes all of the resources to a single file so cannot be used with other formats\n");
+							formats_ok_flag = false;
+						}
+					else
+						{
+							printers_pp [num_printers] = AllocatePrinterForFormat (formats_p [num_printers], options_p -> ro_md_tables_flag, options_p -> ro_template_filename_s, template_pp, & (extensions_ss [num_printers]));
+
+							if (printers_pp [num_printers])
+								{
+									size_t j;
+
+									/* Each format needs its own files */
+									for (j = 0; j < num_printers; ++ j)
+										{
+											if (strcmp (extensions_ss [j], extensions_ss [num_printers]) == 0)
+												{
+													printf ("More than one of the data formats writes \".%s\" files\n", extensions_ss [j]);
+													formats_ok_flag = false;
+												}
+										}
+
+									if (num_printers > 0)
+										{
+											strncat (data_exts_s, ",", data_exts_size - strlen (data_exts_s) - 1);
+										}
+
+									strncat (data_exts_s, extensions_ss [num_printers], data_exts_size - strlen (data_exts_s) - 1);
+
+									++ num_printers;
+								}
+							else
+								{
+									formats_ok_flag = false;
+								}
+						}
+				}
+
+			if (formats_ok_flag)
+				{
+					printer_p = AllocateCompositePrinter (printers_pp, extensions_ss, num_printers);
+
+					if (printer_p)
+						{
+							data_ext_s = extensions_ss [0];
+						}
+				}
+
+			if (!printer_p)
+				{
+					while (num_printers > 0)
+						{
+							-- num_printers;
+							FreeFDPrinter (printers_pp [num_printers]);
+						}
+				}
+		}
+
+	if (printer_p)
+		{
+			SetFDPrinterJSONLimits (printer_p, options_p -> ro_json_max_size, options_p -> ro_json_collapse_size);
+			*data_ext_ss = data_ext_s;
+		}
+
+	return printer_p;
+}
+
+static Printer *AllocatePrinterForFormat (const PrinterFormat format, const bool md_tables_flag, const char *template_filename_s, PrinterTemplate **template_pp, const char **extension_ss)
+{
+	Printer *printer_p = NULL;
+
+	switch (format)
+		{
+			case PRINTER_FORMAT_HTML:
+				{
+					printer_p = AllocateHTMLPrinter ();
+					*extension_ss = "html";
+				}
+				break;
+
+			case PRINTER_FORMAT_MARKDOWN:
+				{
+					printer_p = AllocateMarkdownPrinter (md_tables_flag);
+					*extension_ss = "md";
+				}
+				break;
+
+			case PRINTER_FORMAT_JSON:
+				{
+					printer_p = AllocateJSONPrinter ();
+					*extension_ss = "json";
+				}
+				break;
+
+			case PRINTER_FORMAT_NDJSON:
+				{
+					printer_p = AllocateJSONPrinter ();
+					*extension_ss = "ndjson";
+				}
+				break;
+
+			case PRINTER_FORMAT_TEMPLATE:
+				{
+					if (template_filename_s)
+						{
+							/* The template is compiled once here and reused for every value */
+							PrinterTemplate *template_p = LoadPrinterTemplate (template_filename_s);
+
+							if (template_p)
+								{
+									printer_p = AllocateTemplatePrinter (template_p);
+
+									if (printer_p)
+										{
+											*extension_ss = template_p -> pt_extension_s;
+											*template_pp = template_p;
+										}
+									else
+										{
+											FreePrinterTemplate (template_p);
+										}
+								}
+							else
+								{
+									printf ("Failed to load the template \"%s\"\n", template_filename_s);
+								}
+						}
+					else
+						{
+							printf ("The template format needs a template file to be given with --template\n");
+						}
+				}
+				break;
+
+			default:
+				break;
+		}
+
+	return printer_p;
+}
+
+/*
+ * This is CreateCSVFile () split up so that the writing
+ * and closing of the file can be timed separately. If
+ * data_p is NULL, the data is read from the resource's path.
+ */
+static bool ExportCSVFile (ToolContext *context_p, const char *filename_s, const char *name_s, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *resource_p, const json_t *data_p)
+{
+	bool success_flag = false;
+	OutputSink *sink_p = NULL;
+	FILE *csv_f;
+
+	if (context_p -> tc_get_sink_fn)
+		{
+			sink_p = context_p -> tc_get_sink_fn (filename_s, context_p -> tc_get_sink_data_p);
+			csv_f = sink_p ? GetOutputSinkStream (sink_p) : NULL;
+		}
+	else
+		{
+			csv_f = OpenOutputDirectoryFile (context_p -> tc_out_dir_p, filename_s);
+		}
+
+	if (csv_f)
+		{
+			ToolStats *stats_p = context_p -> tc_stats_p;
+			StatsTimer timer;
+			size_t num_rows = 0;
+
+			StartStatsTimer (stats_p, &timer, SP_CSV_WRITE);
+
+			if (data_p)
+				{
+					success_flag = WriteCSVData (csv_f, col_sep_s, row_sep_s, headers_p, data_p);
+					num_rows = json_array_size (data_p);
+				}
+			else
+				{
+					success_flag = WriteCSVResourceData (csv_f, col_sep_s, row_sep_s, headers_p, resource_p, context_p -> tc_fd_file_s, context_p -> tc_num_jobs, &num_rows);
+				}
+
+			StopStatsTimer (stats_p, &timer, name_s);
+
+			if (stats_p)
+				{
+					const long size = ftell (csv_f);
+
+					if (size > 0)
+						{
+							stats_p -> ts_bytes_written += (size_t) size;
+						}
+
+					if (success_flag)
+						{
+							stats_p -> ts_rows_exported += num_rows;
+						}
+				}
+
+			StartStatsTimer (stats_p, &timer, SP_CLOSE);
+
+			/* An OutputSink belongs to whoever supplied it so it is only flushed */
+			if (sink_p ? !FlushOutputSink (sink_p) : !CloseOutputDirectoryFile (context_p -> tc_out_dir_p, csv_f, success_flag))
+				{
+					success_flag = false;
+				}
+
+			StopStatsTimer (stats_p, &timer, name_s);
+		}
+	else
+		{
+			fprintf (stderr, "Failed to open CSV output file \"%s\"\n", filename_s);
+		}
+
+	return success_flag;
+}
+
+/*
+ * For incremental builds, work out the digest for the resource and see
+ * whether its output file is already up to date. The digest is returned
+ * so that it can be recorded once the output file has been written.
+ */
+static char *CheckOutputCache (ToolContext *context_p, const json_t *resource_p, const char *schema_url_s, const char *filename_s, const bool data_flag, bool *up_to_date_flag_p)
+{
+	char *digest_s = NULL;
+	OutputCache *output_cache_p = context_p -> tc_output_cache_p;
+
+	*up_to_date_flag_p = false;
+
+	if (output_cache_p)
+		{
+			digest_s = GetResourceDigest (output_cache_p, resource_p, schema_url_s, context_p -> tc_schema_cache_p);
+
+			if (digest_s)
+				{
+					/* The digest is kept for the first data format's file but all of the formats' files are needed */
+					if ((IsOutputCurrent (output_cache_p, filename_s, digest_s)) && ((!data_flag) || (DoDataFilesExist (context_p, filename_s))))
+						{
+							++ (output_cache_p -> oc_num_skipped);
+							*up_to_date_flag_p = true;
+
+							if (context_p -> tc_debug_flag)
+								{
+									printf ("\"%s\" is up to date\n", filename_s);
+								}
+						}
+				}
+			else
+				{
+					fprintf (stderr, "Failed to calculate the digest for \"%s\"\n", filename_s);
+				}
+		}
+
+	return digest_s;
+}
+
+/*
+ * Check that the file for each of the data formats is there, swapping
+ * the extension in the same way as the composite printer.
+ */
+static bool DoDataFilesExist (const ToolContext *context_p, const char *filename_s)
+{
+	bool exist_flag = true;
+	const char *exts_s = context_p -> tc_data_exts_s;
+
+	if (exts_s && (strchr (exts_s, ',')))
+		{
+			const char *dot_s = strrchr (filename_s, '.');
+			const size_t stem_length = dot_s ? (size_t) (dot_s - filename_s) : strlen (filename_s);
+
+			while (exist_flag && (*exts_s != '\0'))
+				{
+					const char *sep_s = strchr (exts_s, ',');
+					const size_t ext_length = sep_s ? (size_t) (sep_s - exts_s) : strlen (exts_s);
+					char *output_s = (char *) malloc (stem_length + ext_length + 2);
+
+					if (output_s)
+						{
+							struct stat st;
+
+							memcpy (output_s, filename_s, stem_length);
+							* (output_s + stem_length) = '.';
+							memcpy (output_s + stem_length + 1, exts_s, ext_length);
+							* (output_s + stem_length + 1 + ext_length) = '\0';
+
+							if (stat (output_s, &st) != 0)
+								{
+									exist_flag = false;
+
+									if (context_p -> tc_debug_flag)
+										{
+											printf ("\"%s\" is missing\n", output_s);
+										}
+								}
+
+							free (output_s);
+						}
+					else
+						{
+							exist_flag = false;
+						}
+
+					exts_s += ext_length;
+
+					if (*exts_s == ',')
+						{
+							++ exts_s;
+						}
+				}
+		}
+
+	return exist_flag;
+}
+
+/*
+ * Use the stem that AssignResourceFilenames () gave the resource.
+ */
+static char *GetResourceFilename (const ToolContext *context_p, const size_t index, const char *extension_s)
+{
+	char *filename_s = NULL;
+	const char *stem_s = json_string_value (json_array_get (context_p -> tc_file_stems_p, index));
+
+	if (stem_s)
+		{
+			filename_s = GetOutputFilename (context_p -> tc_out_dir_p, stem_s, extension_s, true);
+		}
+
+	return filename_s;
+}
+
+/*
+ * Work out the stem of the filenames for each of the resources before
+ * any of them are written. Each resource uses its name if it has one,
+ * otherwise it falls back to its index within the package. If that
+ * gives the same filename as an earlier resource, _2, _3, etc. is
+ * added until it is unique. The filenames are compared ignoring their
+ * case so that the names are the same on every platform.
+ */
+static bool AssignResourceFilenames (ToolContext *context_p, const json_t *resources_p)
+{
+	bool success_flag = false;
+	json_t *used_p = json_object ();
+
+	if (context_p -> tc_file_stems_p)
+		{
+			json_array_clear (context_p -> tc_file_stems_p);
+		}
+	else
+		{
+			context_p -> tc_file_stems_p = json_array ();
+		}
+
+	if (context_p -> tc_resource_stems_p)
+		{
+			json_object_clear (context_p -> tc_resource_stems_p);
+		}
+	else
+		{
+			context_p -> tc_resource_stems_p = json_object ();
+		}
+
+	if (used_p && (context_p -> tc_file_stems_p) && (context_p -> tc_resource_stems_p))
+		{
+			size_t i;
+			const json_t *resource_p;
+
+			success_flag = true;
+
+			json_array_foreach (resources_p, i, resource_p)
+				{
+					const char *exts_s = NULL;
+					const char *name_s = GetResourceBaseName (context_p, resource_p, &exts_s);
+					char buffer_s [32];
+					const char *key_s = GetResourceIndexKey (resource_p, i, buffer_s, sizeof (buffer_s));
+					json_t *stem_p = NULL;
+
+					if (exts_s)
+						{
+							char *stem_s = name_s ? EasyCopyToNewString (name_s) : ConvertSizeTToString (i);
+
+							if (stem_s)
+								{
+									ReplaceNonFilenameCharacters (stem_s, strlen (stem_s));
+
+									if (CheckFilenameStem (used_p, stem_s, exts_s, false))
+										{
+											stem_p = json_string (stem_s);
+										}
+									else
+										{
+											size_t suffix = 2;
+
+											while ((!stem_p) && success_flag)
+												{
+													char suffix_s [32];
+													char *candidate_s;
+
+													snprintf (suffix_s, sizeof (suffix_s), "_%lu", (unsigned long) suffix);
+													candidate_s = ConcatenateStrings (stem_s, suffix_s);
+
+													if (candidate_s)
+														{
+															if (CheckFilenameStem (used_p, candidate_s, exts_s, false))
+																{
+																	stem_p = json_string (candidate_s);
+																}
+
+															FreeCopiedString (candidate_s);
+														}
+													else
+														{
+															success_flag = false;
+														}
+
+													++ suffix;
+												}
+
+											if (stem_p && (context_p -> tc_debug_flag))
+												{
+													printf ("Writing \"%s\" to \"%s\" as its filename is already in use\n", name_s ? name_s : stem_s, json_string_value (stem_p));
+												}
+										}
+
+									FreeCopiedString (stem_s);
+								}
+
+							if (stem_p)
+								{
+									CheckFilenameStem (used_p, json_string_value (stem_p), exts_s, true);
+								}
+							else
+								{
+									success_flag = false;
+								}
+						}
+					else
+						{
+							/* The resource doesn't have any files of its own */
+							stem_p = json_null ();
+						}
+
+					if ((!success_flag) || (json_object_set (context_p -> tc_resource_stems_p, key_s, stem_p) != 0) || (json_array_append_new (context_p -> tc_file_stems_p, stem_p) != 0))
+						{
+							success_flag = false;
+							break;
+						}
+
+				}		/* json_array_foreach (resources_p, i, resource_p) */
+
+		}
+
+	if (used_p)
+		{
+			json_decref (used_p);
+		}
+
+	if (!success_flag)
+		{
+			printf ("Failed to work out the output filenames for \"%s\"\n", context_p -> tc_fd_file_s);
+		}
+
+	return success_flag;
+}
+
+/*
+ * Get the name that ProcessResource () uses for a resource's files and
+ * the extensions of the files that it writes for it, separated by commas.
+ * If it doesn't write any files of its own for the resource, exts_ss is
+ * left as NULL.
+ */
+static const char *GetResourceBaseName (const ToolContext *context_p, const json_t *resource_p, const char **exts_ss)
+{
+	const char *name_s = NULL;
+	const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
+
+	if (profile_s)
+		{
+			name_s = GetJSONString (resource_p, FD_NAME_S);
+
+			if (!name_s)
+				{
+					name_s = GetJSONString (resource_p, FD_TABLE_FIELD_TITLE);
+				}
+
+			if (DoesStringStartWith (profile_s, "http"))
+				{
+					if (! (context_p -> tc_combined_filename_s))
+						{
+							*exts_ss = context_p -> tc_data_exts_s;
+						}
+				}
+			else if (strcmp (profile_s, FD_PROFILE_TABULAR_RESOURCE_S) == 0)
+				{
+					if ((json_object_get (resource_p, FD_DATA_S)) || (IsPathBasedResource (resource_p)))
+						{
+							if (!name_s)
+								{
+									name_s = GetJSONString (json_object_get (resource_p, FD_SCHEMA_S), FD_TITLE_S);
+								}
+
+							*exts_ss = context_p -> tc_table_format_s;
+						}
+				}
+		}
+
+	return name_s;
+}
+
+/*
+ * Check whether any of the files with the given stem and extensions have
+ * already been used and, if claim_flag is set, mark them all as used.
+ */
+static bool CheckFilenameStem (json_t *used_p, const char *stem_s, const char *exts_s, const bool claim_flag)
+{
+	const size_t stem_length = strlen (stem_s);
+	bool free_flag = true;
+
+	while (free_flag && (*exts_s != '\0'))
+		{
+			const char *sep_s = strchr (exts_s, ',');
+			const size_t ext_length = sep_s ? (size_t) (sep_s - exts_s) : strlen (exts_s);
+			char *filename_s = (char *) malloc (stem_length + ext_length + 2);
+
+			if (filename_s)
+				{
+					char *c_p;
+
+					memcpy (filename_s, stem_s, stem_length);
+					* (filename_s + stem_length) = '.';
+					memcpy (filename_s + stem_length + 1, exts_s, ext_length);
+					* (filename_s + stem_length + 1 + ext_length) = '\0';
+
+					for (c_p = filename_s; *c_p != '\0'; ++ c_p)
+						{
+							*c_p = (char) tolower ((unsigned char) *c_p);
+						}
+
+					if (claim_flag)
+						{
+							json_object_set_new (used_p, filename_s, json_true ());
+						}
+					else if (json_object_get (used_p, filename_s))
+						{
+							free_flag = false;
+						}
+
+					free (filename_s);
+				}
+			else
+				{
+					free_flag = false;
+				}
+
+			exts_s += ext_length;
+
+			if (*exts_s == ',')
+				{
+					++ exts_s;
+				}
+		}
+
+	return free_flag;
+}
+
+/*
+ * Replace any non file-system characters to
+ * make sure that it is a valid filename.
+ * The safest approach is to replace all
+ * non-alphanumeric characters with an
+ * underscore.
+ */
+static void ReplaceNonFilenameCharacters (char *value_s, size_t length)
+{
+	for ( ; length > 0; -- length, ++ value_s)
+		{
+			if (isalnum ((unsigned char) *value_s) == 0)
+				{
+					*value_s = '_';
+				}
+		}
+}
+
+/*
+ * Write the index of which files each resource was written to, with
+ * the filenames relative to the output directory.
+ */
+static bool SaveFileIndex (ToolContext *context_p)
+{
+	bool success_flag = false;
+	char *filename_s = GetOutputDirectoryFilename (context_p -> tc_out_dir_p, S_FILE_INDEX_FILENAME_S, false);
+
+	if (filename_s)
+		{
+			json_t *index_p = json_object ();
+
+			if (index_p)
+				{
+					if (SetJSONInteger (index_p, "version", S_FILE_INDEX_VERSION))
+						{
+							if (json_object_set (index_p, FD_RESOURCES_S, context_p -> tc_file_index_p) == 0)
+								{
+									success_flag = SaveOutputDirectoryJSON (context_p -> tc_out_dir_p, filename_s, index_p, JSON_INDENT (2) | JSON_SORT_KEYS);
+								}
+						}
+
+					json_decref (index_p);
+				}
+
+			if (!success_flag)
+				{
+					fprintf (stderr, "Failed to write the file index \"%s\"\n", filename_s);
+				}
+
+			FreeCopiedString (filename_s);
+		}
+
+	return success_flag;
+}
+
+/*
+ * Read back the index that SaveFileIndex () wrote. A missing or out of
+ * date index is left empty and just loses the entries for the resources
+ * that aren't written again.
+ */
+static bool LoadFileIndex (ToolContext *context_p)
+{
+	bool success_flag = false;
+	char *filename_s = GetOutputDirectoryFilename (context_p -> tc_out_dir_p, S_FILE_INDEX_FILENAME_S, false);
+
+	if (filename_s)
+		{
+			json_error_t err;
+			json_t *index_p = json_load_file (filename_s, 0, &err);
+
+			if (index_p)
+				{
+					json_int_t version;
+
+					if ((GetJSONInteger (index_p, "version", &version)) && (version == S_FILE_INDEX_VERSION))
+						{
+							json_t *files_p = json_object_get (index_p, FD_RESOURCES_S);
+
+							if (json_is_object (files_p))
+								{
+									success_flag = (json_object_update (context_p -> tc_file_index_p, files_p) == 0);
+								}
+						}
+
+					json_decref (index_p);
+				}
+
+			FreeCopiedString (filename_s);
+		}
+
+	return success_flag;
+}
+
+/*
+ * Keep the schemas and the current version of the package in memory
+ * and, each time the package file changes, only regenerate the output
+ * for the resources that have been added or modified.
+ */
+static bool WatchPackage (ToolContext *context_p, const json_t *fd_p)
+{
+	bool success_flag = false;
+	FileWatcher *watcher_p = AllocateFileWatcher (context_p -> tc_fd_file_s);
+
+	if (watcher_p)
+		{
+			const json_t *initial_resources_p = json_object_get (fd_p, FD_RESOURCES_S);
+			json_t *previous_index_p = GetResourcesIndex (initial_resources_p);
+
+			/* Get the stems that the initial render used so that any changes to them can be spotted */
+			if (previous_index_p && (!AssignResourceFilenames (context_p, initial_resources_p)))
+				{
+					json_decref (previous_index_p);
+					previous_index_p = NULL;
+				}
+
+			/* Only the changed resources are checked each time so the manifest keeps the others' outputs */
+			if (previous_index_p && (context_p -> tc_output_cache_p) && (!KeepPreviousOutputs (context_p -> tc_output_cache_p)))
+				{
+					json_decref (previous_index_p);
+					previous_index_p = NULL;
+				}
+
+			if (previous_index_p)
+				{
+					printf ("Watching \"%s\" for changes\n", context_p -> tc_fd_file_s);
+					fflush (stdout);
+
+					success_flag = true;
+
+					while (WaitForFileChange (watcher_p))
+						{
+							json_error_t err;
+							json_t *new_fd_p = json_load_file (context_p -> tc_fd_file_s, 0, &err);
+
+							/*
+							 * The file may be mid-edit so just wait for the next change
+							 */
+							if (new_fd_p)
+								{
+									const json_t *resources_p = json_object_get (new_fd_p, FD_RESOURCES_S);
+									json_t *new_index_p = GetResourcesIndex (resources_p);
+
+									if (new_index_p)
+										{
+											size_t num_rendered = 0;
+
+											context_p -> tc_document_title_s = GetDocumentTitle (new_fd_p);
+											ProcessResources (context_p, resources_p, previous_index_p, &num_rendered);
+
+											if (context_p -> tc_output_cache_p)
+												{
+													SaveOutputCache (context_p -> tc_output_cache_p, context_p -> tc_out_dir_p);
+												}
+
+											SyncOutputDirectory (context_p -> tc_out_dir_p);
+
+											printf ("Regenerated %lu of %lu resources\n", (unsigned long) num_rendered, (unsigned long) json_array_size (resources_p));
+											fflush (stdout);
+
+											json_decref (previous_index_p);
+											previous_index_p = new_index_p;
+										}		/* if (new_index_p) */
+
+									json_decref (new_fd_p);
+								}		/* if (new_fd_p) */
+							else
+								{
+									printf ("Failed to load %s as a JSON file, %s at line %d\n", context_p -> tc_fd_file_s, err.text, err.line);
+								}
+
+						}		/* while (WaitForFileChange (watcher_p)) */
+
+					json_decref (previous_index_p);
+				}		/* if (previous_index_p) */
+
+			FreeFileWatcher (watcher_p);
+		}		/* if (watcher_p) */
+	else
+		{
+			printf ("Failed to watch \"%s\" for changes\n", context_p -> tc_fd_file_s);
+		}
+
+	return success_flag;
+}
+
+/*
+ * Build a JSON object of the resources keyed by their names so that
+ * the resources in successive versions of a package can be matched
+ * even if they have been reordered.
+ */
+static json_t *GetResourcesIndex (const json_t *resources_p)
+{
+	json_t *index_p = json_object ();
+
+	if (index_p)
+		{
+			size_t i;
+			const json_t *resource_p;
+
+			json_array_foreach (resources_p, i, resource_p)
+				{
+					char buffer_s [32];
+					const char *key_s = GetResourceIndexKey (resource_p, i, buffer_s, sizeof (buffer_s));
+
+					if (json_object_set (index_p, key_s, (json_t *) resource_p) != 0)
+						{
+							json_decref (index_p);
+							return NULL;
+						}
+				}
+		}
+
+	return index_p;
+}
+
+/*
+ * Resources without a name fall back to their position within the package.
+ */
+static const char *GetResourceIndexKey (const json_t *resource_p, const size_t index, char *buffer_s, const size_t buffer_size)
+{
+	const char *key_s = GetJSONString (resource_p, FD_NAME_S);
+
+	if (!key_s)
+		{
+			key_s = GetJSONString (resource_p, FD_TABLE_FIELD_TITLE);
+
+			if (!key_s)
+				{
+					snprintf (buffer_s, buffer_size, "#%lu", (unsigned long) index);
+					key_s = buffer_s;
+				}
+		}
+
+	return key_s;
+}
+
+/*
+ * If dir_p is NULL, just the name of the file is returned.
+ */
+static char *GetOutputFilename (const OutputDirectory *dir_p, const char *name_s, const char *extension_s, const bool shard_flag)
+{
+	char *filename_s = NULL;
+	char *copied_name_s = ConcatenateVarargsStrings (name_s, ".", extension_s, NULL);
+
+	if (copied_name_s)
+		{
+			ReplaceNonFilenameCharacters (copied_name_s, strlen (name_s));
+
+			if (dir_p)
+				{
+					filename_s = GetOutputDirectoryFilename (dir_p, copied_name_s, shard_flag);
+					FreeCopiedString (copied_name_s);
+				}		/* if (dir_p) */
+			else
+				{
+					filename_s = copied_name_s;
+				}
+
+		}		/* if (copied_name_s) */
+
+	return filename_s;
+}
+
+/*
+ * Set up the combined output file and the incremental build manifest,
+ * if they are needed, for the data package in context_p.
+ */
+static bool OpenPackageOutputs (ToolContext *context_p, const bool combined_flag, const char *options_s)
+{
+	bool success_flag = true;
+
+	context_p -> tc_out_dir_p = AllocateOutputDirectory (context_p -> tc_out_dir_s, context_p -> tc_shard_depth, context_p -> tc_durability);
+
+	if (context_p -> tc_out_dir_p)
+		{
+			SetFDPrinterOutputDirectory (context_p -> tc_printer_p, context_p -> tc_out_dir_p);
+		}
+	else
+		{
+			success_flag = false;
+		}
+
+	if (success_flag && combined_flag)
+		{
+			context_p -> tc_combined_filename_s = GetCombinedOutputFilename (context_p -> tc_out_dir_p, context_p -> tc_fd_file_s, NULL, context_p -> tc_data_ext_s);
+
+			if (! (context_p -> tc_combined_filename_s))
+				{
+					printf ("Failed to get the output filename for \"%s\"\n", context_p -> tc_fd_file_s);
+					success_flag = false;
+				}
+		}
+
+	/* Like the output cache, the index relies on the files being in the output directory */
+	if (success_flag && (context_p -> tc_file_index_flag) && (! (context_p -> tc_get_sink_fn)))
+		{
+			context_p -> tc_file_index_p = json_object ();
+
+			if (! (context_p -> tc_file_index_p))
+				{
+					success_flag = false;
+				}
+		}
+
+	if (success_flag && options_s)
+		{
+			context_p -> tc_output_cache_p = AllocateOutputCache (context_p -> tc_out_dir_s, options_s);
+
+			if (! (context_p -> tc_output_cache_p))
+				{
+					printf ("Failed to set up the output manifest for an incremental build\n");
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+static void ClosePackageOutputs (ToolContext *context_p)
+{
+	if (context_p -> tc_output_cache_p)
+		{
+			FreeOutputCache (context_p -> tc_output_cache_p);
+			context_p -> tc_output_cache_p = NULL;
+		}
+
+	if (context_p -> tc_combined_filename_s)
+		{
+			FreeCopiedString (context_p -> tc_combined_filename_s);
+			context_p -> tc_combined_filename_s = NULL;
+		}
+
+	if (context_p -> tc_contents_p)
+		{
+			json_decref (context_p -> tc_contents_p);
+			context_p -> tc_contents_p = NULL;
+		}
+
+	if (context_p -> tc_file_stems_p)
+		{
+			json_decref (context_p -> tc_file_stems_p);
+			context_p -> tc_file_stems_p = NULL;
+		}
+
+	if (context_p -> tc_resource_stems_p)
+		{
+			json_decref (context_p -> tc_resource_stems_p);
+			context_p -> tc_resource_stems_p = NULL;
+		}
+
+	if (context_p -> tc_file_index_p)
+		{
+			json_decref (context_p -> tc_file_index_p);
+			context_p -> tc_file_index_p = NULL;
+		}
+
+	if (context_p -> tc_out_dir_p)
+		{
+			/* Make sure that nothing is still writing to the directory */
+			CloseFDPrinter (context_p -> tc_printer_p);
+
+			SetFDPrinterOutputDirectory (context_p -> tc_printer_p, NULL);
+			FreeOutputDirectory (context_p -> tc_out_dir_p);
+			context_p -> tc_out_dir_p = NULL;
+		}
+
+	context_p -> tc_document_title_s = NULL;
+	context_p -> tc_page_number = 0;
+	context_p -> tc_page_full_flag = false;
+}
+
+/*
+ * Export the resources of a data package that has already been loaded.
+ */
+static bool ExportPackageResources (ToolContext *context_p, const json_t *fd_p)
+{
+	const json_t *resources_p = json_object_get (fd_p, FD_RESOURCES_S);
+
+	context_p -> tc_document_title_s = GetDocumentTitle (fd_p);
+
+	if (resources_p)
+		{
+			ProcessResources (context_p, resources_p, NULL, NULL);
+
+			if (context_p -> tc_output_cache_p)
+				{
+					SaveOutputCache (context_p -> tc_output_cache_p, context_p -> tc_out_dir_p);
+
+					if (context_p -> tc_debug_flag)
+						{
+							printf ("Skipped %lu up to date resources\n", (unsigned long) (context_p -> tc_output_cache_p -> oc_num_skipped));
+						}
+				}
+
+			/* Any files still waiting to be synced haven't been written yet */
+			return SyncOutputDirectory (context_p -> tc_out_dir_p);
+		}		/* if (resources_p) */
+	else
+		{
+			printf ("%s does not contain a resources array so nothing to do!\n", context_p -> tc_fd_file_s);
+		}
+
+	return false;
+}
+
+/*
+ * Record a file that has been written if the names of the output files
+ * are being collected. Data files are written in each of the data formats
+ * by swapping the extension, in the same way as the composite printer.
+ */
+static void AddOutputFilename (ToolContext *context_p, const char *filename_s, const bool data_flag, const bool resource_flag)
+{
+	if ((context_p -> tc_outputs_p) || (resource_flag && (context_p -> tc_resource_files_p)))
+		{
+			const char *exts_s = context_p -> tc_data_exts_s;
+
+			if (data_flag && exts_s && (strchr (exts_s, ',')))
+				{
+					const char *dot_s = strrchr (filename_s, '.');
+					const size_t stem_length = dot_s ? (size_t) (dot_s - filename_s) : strlen (filename_s);
+
+					while (*exts_s != '\0')
+						{
+							const char *sep_s = strchr (exts_s, ',');
+							const size_t ext_length = sep_s ? (size_t) (sep_s - exts_s) : strlen (exts_s);
+							char *output_s = (char *) malloc (stem_length + ext_length + 2);
+
+							if (output_s)
+								{
+									memcpy (output_s, filename_s, stem_length);
+									* (output_s + stem_length) = '.';
+									memcpy (output_s + stem_length + 1, exts_s, ext_length);
+									* (output_s + stem_length + 1 + ext_length) = '\0';
+
+									RecordOutputFilename (context_p, output_s, resource_flag);
+									free (output_s);
+								}
+
+							exts_s += ext_length;
+
+							if (*exts_s == ',')
+								{
+									++ exts_s;
+								}
+						}
+				}
+			else
+				{
+					RecordOutputFilename (context_p, filename_s, resource_flag);
+				}
+		}
+}
+
+/*
+ * Add a file to the outputs that are being returned and, if resource_flag
+ * is set, to the list of files for the current resource.
+ */
+static void RecordOutputFilename (ToolContext *context_p, const char *filename_s, const bool resource_flag)
+{
+	if (context_p -> tc_outputs_p)
+		{
+			json_object_set_new (context_p -> tc_outputs_p, filename_s, json_true ());
+		}
+
+	if (resource_flag && (context_p -> tc_resource_files_p))
+		{
+			const char *relative_s = GetOutputDirectoryRelativeFilename (context_p -> tc_out_dir_p, filename_s);
+
+			json_array_append_new (context_p -> tc_resource_files_p, json_string (relative_s ? relative_s : filename_s));
+		}
+}
+
+
+/*
+ * Get the options that are part of the digests for incremental builds
+ * or NULL if it isn't one. The output cache relies on the files that it
+ * lists being in the output directory so isn't used with OutputSinks.
+ */
+static const char *GetDigestOptions (const FDRenderer *renderer_p)
+{
+	return (renderer_p -> fr_incremental_flag && ! (renderer_p -> fr_context.tc_get_sink_fn)) ? renderer_p -> fr_options_s : NULL;
+}
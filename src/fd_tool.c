@@ -29,46 +29,103 @@
 
 #include "typedefs.h"
 
-#include "frictionless_data_util.h"
-
-#include "printer.h"
 #include "json_util.h"
 #include "string_utils.h"
 #include "curl_tools.h"
 #include "filesystem_utils.h"
 
-#include "html_printer.h"
-#include "markdown_printer.h"
-#include "math_utils.h"
+#include "fd_renderer.h"
+#include "schema_cache.h"
+#include "tool_stats.h"
+#include "package_validator.h"
+#include "parallel_tasks.h"
+#include "package_list.h"
+#include "render_server.h"
+#include "output_sink.h"
+
+
+/*
+ * The shared state for the workers when processing
+ * several data packages at once.
+ */
+typedef struct
+{
+	const json_t *pb_packages_p;
+	const char *pb_out_dir_s;
+
+	/** The distinct name of each package's subdirectory of pb_out_dir_s */
+	json_t *pb_out_names_p;
 
+	/**
+	 * There is an FDRenderer for each worker and the ones that
+	 * aren't in use are the first pb_num_free_renderers entries.
+	 */
+	FDRenderer **pb_renderers_pp;
+	size_t pb_num_free_renderers;
 
+	/** This guards the free renderers */
+	TaskLock *pb_lock_p;
+
+	/** Whether each of the packages was exported successfully */
+	bool *pb_results_p;
+} PackageBatch;
+
+
+/*
+ * The shared state for the workers when running as a server.
+ */
 typedef struct
 {
-	const char *jp_key_s;
-	const json_t *jp_value_p;
-} JSONProperty;
+	const char *rv_out_dir_s;
+
+	/** There is an FDRenderer for each worker */
+	FDRenderer **rv_renderers_pp;
+} RenderService;
+
+
+/* The number of slowest resources listed in the stats if --slowest isn't given */
+static const size_t S_DEFAULT_NUM_SLOWEST = 10;
 
+static const size_t S_DEFAULT_MAX_ERRORS = 100;
 
-static const uint32 S_VERSION_MAJOR = 0;
-static const uint32 S_VERSION_MINOR = 9;
-static const uint32 S_VERSION_REV = 1;
+/*
+ * Rendering a request mostly waits on fetching schemas and
+ * writing files so the server always has a few workers.
+ */
+static const size_t S_MIN_SERVER_WORKERS = 4;
 
 
 /*
  * static declarations
  */
 
-static bool CreateCSVFile (const char *filename_s, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p);
+static bool GetPrinterFormat (const char *name_s, const size_t length, PrinterFormat *format_p);
+
+static bool AddSchemaMapArgument (SchemaCache *schema_cache_p, const char *schema_map_s);
+
+static bool ValidatePackageFiles (const json_t *packages_p, const char *report_file_s, const char *schema_map_s, const size_t num_threads, const size_t max_errors);
+
+static void WriteStatsReports (ToolStats *stats_p, const SchemaCache *schema_cache_p, const char *stats_file_s, const char *trace_file_s, const size_t num_slowest);
+
+static FDRenderer **AllocateWorkerRenderers (FDRenderer *renderer_p, const FDRenderOptions *options_p, SchemaCache *schema_cache_p, const size_t num_workers);
+
+static void FreeWorkerRenderers (FDRenderer **renderers_pp, const size_t num_workers, const FDRenderer *renderer_p);
+
+static bool ExportPackages (FDRenderer *renderer_p, const FDRenderOptions *options_p, SchemaCache *schema_cache_p, const json_t *packages_p, const char *out_dir_s, const size_t num_workers);
 
+static void ExportBatchPackage (void *data_p, const size_t task_index);
 
+static bool ServePackages (FDRenderer *renderer_p, const FDRenderOptions *options_p, SchemaCache *schema_cache_p, const char *socket_filename_s, const char *out_dir_s, const size_t num_workers);
 
-static int SortPropertiesByOrder (const void *v0_p, const void *v1_p);
+static bool RenderRequestedPackage (void *data_p, const size_t worker_index, const json_t *request_p, json_t *response_p);
 
-static bool ParsePackageFromSchema (const json_t *data_p, const json_t *schema_p, Printer *printer_p, const bool full_flag, const bool debug_flag, const size_t indent_level);
+static bool IsSafeRelativePath (const char *path_s);
 
-static char *GetOutputFilename (const char *dir_s, const char *name_s, const char *extension_s);
+static bool CheckRequestedResourcePaths (const json_t *package_p);
 
-static json_t *GetWebJSON (const char *url_s);
+static char *GetPackageOutputDirectory (const char *out_dir_s, const char *fd_file_s);
+
+static OutputSink *GetStandardOutputSink (const char *filename_s, void *data_p);
 
 
 /*
@@ -83,14 +140,39 @@ int main (int argc, char *argv [])
 		{
 			printf (
 					"USAGE: grassroots_fd_tool\n"
-					"\t--in <filename>, the Frictionless Data Package filename to extract the resources from.\n"
-					"\t--out-dir <directory>, the directory where the output files will be written to.\n"
-					"\t--data-fmt <format>, the format to write data resources in. Currently the options are:\n"
+					"\t--in <filename>, the Frictionless Data Package filename to extract the resources from. This can be given more than once and can be a directory of data packages or a file listing them prefixed with an @, e.g. @packages.txt\n"
+					"\t--out-dir <directory>, the directory where the output files will be written to. If this is \"-\", the output for a single data package is written to the standard output instead\n"
+					"\t--data-fmt <format>, the format to write data resources in. This can be a comma-separated list of formats to write at once. Currently the options are:\n"
 					"\t\thtml, write the files in html format (default).\n"
 					"\t\tmd, write the files in markdown format.\n"
+					"\t\tjson, write each resource to its own file as a single line of JSON.\n"
+					"\t\tndjson, write all of the resources to a single JSON Lines file named after the input file.\n"
+					"\t\ttemplate, write the files using the template given by --template.\n"
 					"\t--table-fmt <format>, the format to write data resources in. Currently the options are:\n"
 					"\t\tcsv, write the files in csv format (default).\n"
+					"\t--template <filename>, the template file to use for the template data format\n"
+					"\t--json-max-size <bytes>, truncate any embedded JSON values that are longer than this\n"
+					"\t--json-collapse-size <bytes>, in html, put the rest of any embedded JSON values that are longer than this in a collapsed \"Show more\" element\n"
+					"\t--md-tables, write the properties in markdown files as tables rather than lists\n"
 					"\t--full, show all properties even when the values are empty\n"
+					"\t--incremental, only regenerate the output files for resources that have changed since the previous run\n"
+					"\t--schema-map <prefix>=<replacement>, load any schemas whose urls start with prefix from replacement instead, e.g. a file:// url\n"
+					"\t--stats <filename>, write the timings of each phase of the run and other counters to this JSON file\n"
+					"\t--trace <filename>, write the timings of each phase of the run to this file in the Chrome trace event format\n"
+					"\t--slowest <n>, print the percentiles of the time taken to generate each resource and a table of the n slowest resources\n"
+					"\t--single-page, write all of the resources into a single document with a table of contents\n"
+					"\t--page-size <MB>, when using --single-page, split the document into pages of about this size with the table of contents in its own file\n"
+					"\t--shard-depth <n>, split each resource's output files between n levels of subdirectories, named after a hash of the resource's name, so that no directory holds too many files. This can be up to 4 and the default, 0, writes them all to the output directory\n"
+					"\t--file-index, write .grassroots_fd_files.json to the output directory listing the files that were written for each resource\n"
+					"\t--durability <mode>, how the output files are flushed to disk. Each file is always written to a temporary file that replaces it once it is complete. The options are:\n"
+					"\t\tnone, leave it to the operating system (default).\n"
+					"\t\tbatch, flush the files to disk in batches before replacing them.\n"
+					"\t\tstrict, flush each file to disk as soon as it has been written.\n"
+					"\t--watch, keep running and regenerate the output files for any resources that change when the input file is modified\n"
+					"\t--validate <filename>, rather than writing any output files, check each resource against its profile and write a JSON report of any errors to this file, or to the standard output if it is \"-\"\n"
+					"\t--serve <socket>, rather than exporting the --in files, run as a server that renders the data packages given in requests on this Unix domain socket\n"
+					"\t--jobs <n>, the number of threads to use when validating, when processing several data packages, for the requests when running as a server and when parsing large CSV files, the default is the number of processors\n"
+					"\t--max-errors <n>, the maximum number of errors to report for each resource when validating (default 100)\n"
 					"\t--ver, display program version information\n"
 					"\t--chatty, display program progress information\n"
 					);
@@ -100,19 +182,37 @@ int main (int argc, char *argv [])
 		{
 			int i = 1;
 			const char *fd_file_s = NULL;
+			char **inputs_ss = (char **) calloc (argc, sizeof (char *));
+			size_t num_inputs = 0;
+			json_t *packages_p = NULL;
+			size_t num_packages = 0;
 			const char *out_dir_s = NULL;
 			const char *table_format_s = "csv";
 			bool full_flag = false;
 			bool debug_flag = false;
-
-			typedef enum
-			{
-				PRINTER_FORMAT_HTML,
-				PRINTER_FORMAT_MARKDOWN
-			} PrinterFormat;
-
-			PrinterFormat data_format = PRINTER_FORMAT_HTML;
+			bool incremental_flag = false;
+			bool watch_flag = false;
+			bool md_tables_flag = false;
+			const char *template_filename_s = NULL;
+			size_t json_max_size = 0;
+			size_t json_collapse_size = 0;
+			bool single_page_flag = false;
+			double page_size_mb = 0.0;
+			uint32 shard_depth = 0;
+			bool file_index_flag = false;
+			OutputDurability durability = OD_DURABILITY_NONE;
+			const char *schema_map_s = NULL;
+			const char *stats_file_s = NULL;
+			const char *trace_file_s = NULL;
+			size_t num_slowest = 0;
+			const char *validate_file_s = NULL;
+			const char *serve_socket_s = NULL;
+			size_t num_jobs = 0;
+			size_t max_errors = S_DEFAULT_MAX_ERRORS;
+			PrinterFormat data_formats [PRINTER_FORMAT_NUM_FORMATS];
+			size_t num_data_formats = 0;
 			bool out_dir_ok_flag = false;
+			bool stdout_flag = false;
 
 			while (i < argc)
 				{
@@ -120,7 +220,12 @@ int main (int argc, char *argv [])
 						{
 							if ((i + 1) < argc)
 								{
-									fd_file_s = argv [++ i];
+									/* There can be several inputs for batch mode */
+									if (inputs_ss)
+										{
+											inputs_ss [num_inputs] = argv [++ i];
+											++ num_inputs;
+										}
 								}
 							else
 								{
@@ -142,21 +247,43 @@ int main (int argc, char *argv [])
 						{
 							if ((i + 1) < argc)
 								{
+									/* This can be a comma-separated list to write several formats at once */
 									const char *format_s = argv [++ i];
 
-									if (strcmp (format_s, "html") == 0)
-										{
-											data_format = PRINTER_FORMAT_HTML;
-										}
-									else if (strcmp (format_s, "markdown") == 0)
-										{
-											data_format = PRINTER_FORMAT_MARKDOWN;
-										}
-									else
+									num_data_formats = 0;
+
+									while (*format_s != '\0')
 										{
-											printf ("Unknown data format: \"%s\"\n", format_s);
-										}
+											const size_t length = strcspn (format_s, ",");
+											PrinterFormat format;
+
+											if (GetPrinterFormat (format_s, length, &format))
+												{
+													size_t j = 0;
+
+													while ((j < num_data_formats) && (data_formats [j] != format))
+														{
+															++ j;
+														}
+
+													if (j == num_data_formats)
+														{
+															data_formats [num_data_formats] = format;
+															++ num_data_formats;
+														}
+												}
+											else
+												{
+													printf ("Unknown data format: \"%.*s\"\n", (int) length, format_s);
+												}
 
+											format_s += length;
+
+											if (*format_s == ',')
+												{
+													++ format_s;
+												}
+										}
 								}
 							else
 								{
@@ -178,746 +305,1179 @@ int main (int argc, char *argv [])
 						{
 							full_flag = true;
 						}
-					else if (strcmp (argv [i], "--chatty") == 0)
+					else if (strcmp (argv [i], "--template") == 0)
 						{
-							debug_flag = true;
+							if ((i + 1) < argc)
+								{
+									template_filename_s = argv [++ i];
+								}
+							else
+								{
+									printf ("template argument missing");
+								}
 						}
-					else if (strcmp (argv [i], "--ver") == 0)
+					else if (strcmp (argv [i], "--json-max-size") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									json_max_size = (size_t) strtoul (argv [++ i], NULL, 10);
+								}
+							else
+								{
+									printf ("json max size argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--json-collapse-size") == 0)
 						{
-							printf ("VER: grassroots_fd_tool %u.%u.%u (%s)\n", S_VERSION_MAJOR, S_VERSION_MINOR, S_VERSION_REV, __DATE__);
+							if ((i + 1) < argc)
+								{
+									json_collapse_size = (size_t) strtoul (argv [++ i], NULL, 10);
+								}
+							else
+								{
+									printf ("json collapse size argument missing");
+								}
 						}
-					else
+					else if (strcmp (argv [i], "--md-tables") == 0)
 						{
-							printf ("Unknown argument: \"%s\"", argv [i]);
+							md_tables_flag = true;
 						}
-
-					++ i;
-				}
-
-			if (out_dir_s)
-				{
-					if (EnsureDirectoryExists (out_dir_s))
+					else if (strcmp (argv [i], "--incremental") == 0)
 						{
-							out_dir_ok_flag = true;
-						}		/* if (!EnsureDirectoryExists (out_dir_s)) */
-				}		/* if (out_dir_s) */
-			else
-				{
-					out_dir_ok_flag = true;
-				}
-
-			if (out_dir_ok_flag)
-				{
-					if (fd_file_s)
+							incremental_flag = true;
+						}
+					else if (strcmp (argv [i], "--schema-map") == 0)
 						{
-							Printer *printer_p = NULL;
-							const char *data_ext_s = NULL;
-
-							switch (data_format)
+							if ((i + 1) < argc)
 								{
-									case PRINTER_FORMAT_HTML:
+									schema_map_s = argv [++ i];
+								}
+							else
+								{
+									printf ("schema map argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--stats") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									stats_file_s = argv [++ i];
+								}
+							else
+								{
+									printf ("stats filename argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--trace") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									trace_file_s = argv [++ i];
+								}
+							else
+								{
+									printf ("trace filename argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--slowest") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									const int n = atoi (argv [++ i]);
+
+									if (n > 0)
 										{
-											printer_p = AllocateHTMLPrinter ();
-											data_ext_s = "html";
+											num_slowest = (size_t) n;
 										}
-										break;
-
-									case PRINTER_FORMAT_MARKDOWN:
+									else
 										{
-											printer_p = AllocateMarkdownPrinter ();
-											data_ext_s = "md";
+											printf ("Invalid number of slowest resources: \"%s\"\n", argv [i]);
 										}
-										break;
 								}
-
-
-							if (printer_p)
+							else
 								{
-									json_error_t err;
-									json_t *fd_p = json_load_file (fd_file_s, 0, &err);
+									printf ("slowest resources argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--single-page") == 0)
+						{
+							single_page_flag = true;
+						}
+					else if (strcmp (argv [i], "--page-size") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									page_size_mb = strtod (argv [++ i], NULL);
 
-									if (fd_p)
+									if (page_size_mb <= 0.0)
 										{
-											const json_t *resources_p = json_object_get (fd_p, FD_RESOURCES_S);
-
-											if (resources_p)
-												{
-													size_t j;
-													const json_t *resource_p;
-
-													json_array_foreach (resources_p, j, resource_p)
-														{
-															const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
-
-
-															if (profile_s)
-																{
-																	const char *name_s = GetJSONString (resource_p, FD_NAME_S);
-																	char *filename_s = NULL;
-
-																	if (!name_s)
-																		{
-																			name_s = GetJSONString (resource_p, FD_TABLE_FIELD_TITLE);
-																		}
-
-																	if (DoesStringStartWith (profile_s, "http"))
-																		{
-																			json_t *schema_p = GetWebJSON (profile_s);
-
-																			if (schema_p)
-																				{
-																					if (name_s)
-																						{
-																							filename_s = GetOutputFilename (out_dir_s, name_s, data_ext_s);
-																						}		/* if (name_s) */
-																					else
-																						{
-																							char *temp_s = ConvertSizeTToString (j);
-
-																							if (temp_s)
-																								{
-																									filename_s = GetOutputFilename (out_dir_s, temp_s, data_ext_s);
-																									FreeCopiedString (temp_s);
-																								}
-
-																						}
-
-																					if (filename_s)
-																						{
-																							if (OpenFDPrinter (printer_p, filename_s))
-																								{
-																									char *footer_s = ConcatenateVarargsStrings ("Parsed ", fd_file_s, " using profile ", profile_s, NULL);
-																									PrintHeader (printer_p, name_s, NULL);
-																									ParsePackageFromSchema (resource_p, schema_p, printer_p, full_flag, debug_flag, 0);
-
-
-																									if (footer_s)
-																										{
-																											PrintFooter (printer_p, footer_s);
-																											FreeCopiedString (footer_s);
-																										}
-
-																									CloseFDPrinter (printer_p);
-																								}		/* if (OpenPrinter (printer_p, filename_s)) */
-																							else
-																								{
-																									printf ("Failed to open \"%s\" for to write to.\n", filename_s);
-																								}
-
-																							FreeCopiedString (filename_s);
-																						}		/* if (filename_s) */
-
-																				}		/* if (schema_p) */
-																		}
-																	else if (strcmp (profile_s, FD_PROFILE_TABULAR_RESOURCE_S) == 0)
-																		{
-																			const json_t *schema_p = json_object_get (resource_p, FD_SCHEMA_S);
-																			const json_t *data_p = json_object_get (resource_p, FD_DATA_S);
-																			const json_t *headers_p = NULL;
-
-																			if (schema_p)
-																				{
-																					headers_p = json_object_get (schema_p, FD_TABLE_FIELDS_S);
-
-																					if (!name_s)
-																						{
-																							name_s = GetJSONString (schema_p, FD_TITLE_S);
-																						}
-
-																				}
-
-																			if (data_p)
-																				{
-																					const char *col_sep_s = ",";
-																					const char *row_sep_s = "\n";
-
-
-																					if (name_s)
-																						{
-																							filename_s = GetOutputFilename (out_dir_s, name_s, table_format_s);
-																						}		/* if (name_s) */
-																					else
-																						{
-																							char *temp_s = ConvertSizeTToString (j);
-
-																							if (temp_s)
-																								{
-																									filename_s = GetOutputFilename (out_dir_s, temp_s, table_format_s);
-																									FreeCopiedString (temp_s);
-																								}
-
-																						}
-
-																					if (filename_s)
-																						{
-
-																							if (CreateCSVFile (filename_s, col_sep_s, row_sep_s, headers_p, data_p))
-																								{
-
-																								}
-
-																							FreeCopiedString (filename_s);
-																						}		/* if (filename_s) */
-
-
-																				}
-
-
-																		}		/* if (strcmp (profile_s, FD_PROFILE_TABULAR_RESOURCE_S) == 0) */
-
-																}		/* if (profile_s) */
-
-
-														}		/* json_array_foreach (resources_p, i, resource_p) */
-
-												}		/* if (resources_p) */
-											else
-												{
-													printf ("%s does not contain a resources array so nothing to do!\n", fd_file_s);
-												}
+											printf ("Invalid page size: \"%s\"\n", argv [i]);
+											page_size_mb = 0.0;
+										}
+								}
+							else
+								{
+									printf ("page size argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--shard-depth") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									const int n = atoi (argv [++ i]);
 
-											json_decref (fd_p);
-										}		/* if (fd_p) */
+									if ((n >= 0) && (n <= OD_MAX_SHARD_DEPTH))
+										{
+											shard_depth = (uint32) n;
+										}
 									else
 										{
-											printf ("Failed to load %s as a JSON file\n", fd_file_s);
+											fprintf (stderr, "Invalid shard depth: \"%s\", it must be between 0 and %d\n", argv [i], OD_MAX_SHARD_DEPTH);
+											res = 1;
 										}
-
-
-									FreeFDPrinter (printer_p);
-								}		/* if (printer_p) */
-
-						}		/* if (fd_file_s) */
-					else
+								}
+							else
+								{
+									fprintf (stderr, "shard depth argument missing\n");
+									res = 1;
+								}
+						}
+					else if (strcmp (argv [i], "--file-index") == 0)
 						{
-							printf ("No intput file specified\n");
+							file_index_flag = true;
 						}
-
-				}		/* if (out_dir_ok_flag) */
-			else
-				{
-					printf ("Couldn't write to output directory \"%s\"\n", out_dir_s);
-				}
-
-
-		}		/* if (argc < 3) else */
-
-  return res;
-}
-
-
-/*
- * static definitions
- */
-
-
-
-static bool CreateCSVFile (const char *filename_s, const char *col_sep_s, const char *row_sep_s, const json_t *headers_p, const json_t *data_p)
-{
-	bool success_flag = false;
-	FILE *csv_f = fopen (filename_s, "w");
-
-	/* open the output file */
-	if (csv_f)
-		{
-			if (headers_p)
-				{
-					/*
-					 * write the column headers
-					 */
-					const size_t num_columns = json_array_size (headers_p);
-					size_t i;
-
-					success_flag = true;
-
-					for (i = 0; i < num_columns; ++ i)
+					else if (strcmp (argv [i], "--durability") == 0)
 						{
-							const json_t *header_p = json_array_get (headers_p, i);
-							const char *header_s = GetJSONString (header_p, FD_TABLE_FIELD_NAME);
-
-							if (header_s)
+							if ((i + 1) < argc)
 								{
-									const char *sep_s;
+									const char *durability_s = argv [++ i];
 
-									if (i == num_columns - 1)
+									if (strcmp (durability_s, "none") == 0)
+										{
+											durability = OD_DURABILITY_NONE;
+										}
+									else if (strcmp (durability_s, "batch") == 0)
+										{
+											durability = OD_DURABILITY_BATCH;
+										}
+									else if (strcmp (durability_s, "strict") == 0)
 										{
-											sep_s = row_sep_s;
+											durability = OD_DURABILITY_STRICT;
 										}
 									else
 										{
-											sep_s = col_sep_s;
+											printf ("Invalid durability: \"%s\"\n", durability_s);
 										}
-
-									fprintf (csv_f, "\"%s\"%s ", header_s, sep_s);
-								}		/* if (header_s) */
+								}
 							else
 								{
-									success_flag = false;
+									printf ("durability argument missing");
 								}
-
-						}		/* for (i = 0; i < num_columns; ++ i) */
-
-					/*
-					 * write the data in the same order as the headers
-					 */
-					if (success_flag)
+						}
+					else if (strcmp (argv [i], "--watch") == 0)
 						{
-							const size_t num_rows = json_array_size (data_p);
-
-							for (i = 0; i < num_rows; ++ i)
+							watch_flag = true;
+						}
+					else if (strcmp (argv [i], "--validate") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									validate_file_s = argv [++ i];
+								}
+							else
+								{
+									printf ("validation report filename argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--serve") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									serve_socket_s = argv [++ i];
+								}
+							else
+								{
+									printf ("server socket argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--jobs") == 0)
+						{
+							if ((i + 1) < argc)
 								{
-									const json_t *row_p = json_array_get (data_p, i);
-									size_t j;
-									bool add_sep_flag = false;
+									const int n = atoi (argv [++ i]);
 
-									for (j = 0; j < num_columns; ++ j)
+									if (n > 0)
 										{
-											const json_t *header_p = json_array_get (headers_p, j);
-											const char *header_s = GetJSONString (header_p, FD_TABLE_FIELD_NAME);
-
-											if (header_s)
-												{
-													const json_t *value_p = json_object_get (row_p, header_s);
+											num_jobs = (size_t) n;
+										}
+									else
+										{
+											printf ("Invalid number of jobs: \"%s\"\n", argv [i]);
+										}
+								}
+							else
+								{
+									printf ("jobs argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--max-errors") == 0)
+						{
+							if ((i + 1) < argc)
+								{
+									const int n = atoi (argv [++ i]);
+
+									if (n >= 0)
+										{
+											max_errors = (size_t) n;
+										}
+									else
+										{
+											printf ("Invalid maximum number of errors: \"%s\"\n", argv [i]);
+										}
+								}
+							else
+								{
+									printf ("max errors argument missing");
+								}
+						}
+					else if (strcmp (argv [i], "--chatty") == 0)
+						{
+							debug_flag = true;
+						}
+					else if (strcmp (argv [i], "--ver") == 0)
+						{
+							uint32 major;
+							uint32 minor;
+							uint32 rev;
+
+							GetFDRendererVersion (&major, &minor, &rev);
+							printf ("VER: grassroots_fd_tool %u.%u.%u (%s)\n", major, minor, rev, __DATE__);
+						}
+					else
+						{
+							printf ("Unknown argument: \"%s\"", argv [i]);
+						}
+
+					++ i;
+				}
+
+			if (num_inputs > 0)
+				{
+					packages_p = GetPackageFilenames (inputs_ss, num_inputs);
+					num_packages = json_array_size (packages_p);
+
+					if (num_packages == 1)
+						{
+							fd_file_s = json_string_value (json_array_get (packages_p, 0));
+						}
+					else if ((packages_p) && (num_packages == 0))
+						{
+							printf ("No data packages were found in the input\n");
+						}
+				}
+
+			if (out_dir_s && (strcmp (out_dir_s, "-") == 0) && (!validate_file_s))
+				{
+					/* The output files would be interleaved so only one of each can be written */
+					if ((num_packages > 1) || (serve_socket_s) || (num_data_formats > 1))
+						{
+							printf ("Only a single data package in a single data format can be written to the standard output\n");
+							res = 1;
+						}
+					else
+						{
+							stdout_flag = true;
+							out_dir_ok_flag = true;
+						}
+
+					out_dir_s = NULL;
+				}
+			else if (out_dir_s)
+				{
+					if (EnsureDirectoryExists (out_dir_s))
+						{
+							out_dir_ok_flag = true;
+						}		/* if (!EnsureDirectoryExists (out_dir_s)) */
+				}		/* if (out_dir_s) */
+			else
+				{
+					out_dir_ok_flag = true;
+				}
+
+			if (num_jobs == 0)
+				{
+					num_jobs = GetNumberOfProcessors ();
+
+					if ((serve_socket_s) && (num_jobs < S_MIN_SERVER_WORKERS))
+						{
+							num_jobs = S_MIN_SERVER_WORKERS;
+						}
+				}
+
+			if (validate_file_s)
+				{
+					if (num_packages > 0)
+						{
+							/* A non-zero exit code lets this be used as a check before committing */
+							if (!ValidatePackageFiles (packages_p, validate_file_s, schema_map_s, num_jobs, max_errors))
+								{
+									res = 1;
+								}
+						}
+					else
+						{
+							printf ("No intput file specified\n");
+						}
+				}
+			else if (res != 0)
+				{
+					/* The arguments have already been reported as not valid */
+				}
+			else if (out_dir_ok_flag)
+				{
+					if ((num_packages > 0) || (serve_socket_s))
+						{
+							SchemaCache *schema_cache_p = AllocateSchemaCache ();
+
+							if (schema_cache_p)
+								{
+									FDRenderOptions options;
+									ToolStats *stats_p = NULL;
+									size_t num_workers = (num_jobs < num_packages) ? num_jobs : num_packages;
+									bool cache_ok_flag = true;
+
+									if (schema_map_s)
+										{
+											cache_ok_flag = AddSchemaMapArgument (schema_cache_p, schema_map_s);
+										}
+
+									if (serve_socket_s)
+										{
+											num_workers = num_jobs;
+
+											if (num_packages > 0)
+												{
+													printf ("--in is ignored when running as a server\n");
+												}
+										}
+
+									if (stats_file_s || trace_file_s || (num_slowest > 0))
+										{
+											stats_p = AllocateToolStats (trace_file_s != NULL, (num_slowest > 0) ? num_slowest : S_DEFAULT_NUM_SLOWEST);
+
+											if (stats_p)
+												{
+													schema_cache_p -> sc_stats_p = stats_p;
+
+													/* The stats are collected by a single thread */
+													num_workers = 1;
+												}
+											else
+												{
+													printf ("Failed to set up the stats collection\n");
+													cache_ok_flag = false;
+												}
+										}
+
+									if (((num_packages > 1) || (serve_socket_s)) && watch_flag)
+										{
+											printf ("--watch is ignored when processing more than one data package\n");
+											watch_flag = false;
+										}
+
+									if (num_workers == 0)
+										{
+											num_workers = 1;
+										}
+
+									InitFDRenderOptions (&options);
+
+									options.ro_formats_p = data_formats;
+									options.ro_num_formats = num_data_formats;
+									options.ro_template_filename_s = template_filename_s;
+									options.ro_table_format_s = table_format_s;
+									options.ro_md_tables_flag = md_tables_flag;
+									options.ro_full_flag = full_flag;
+									options.ro_debug_flag = debug_flag;
+									options.ro_json_max_size = json_max_size;
+									options.ro_json_collapse_size = json_collapse_size;
+									options.ro_incremental_flag = incremental_flag;
+									options.ro_single_page_flag = single_page_flag;
+									options.ro_page_size = (size_t) (page_size_mb * 1024.0 * 1024.0);
+									options.ro_shard_depth = shard_depth;
+									options.ro_file_index_flag = file_index_flag;
+									options.ro_durability = durability;
+
+									/* Split the threads for parsing CSV files between the workers */
+									options.ro_num_jobs = num_jobs / num_workers;
+
+									if (cache_ok_flag)
+										{
+											FDRenderer *renderer_p = AllocateFDRenderer (&options, schema_cache_p);
+
+											if (renderer_p)
+												{
+													SetFDRendererStats (renderer_p, stats_p);
 
-													if (add_sep_flag)
+													if (serve_socket_s)
 														{
-															fprintf (csv_f, "%s ", col_sep_s);
+															if (!ServePackages (renderer_p, &options, schema_cache_p, serve_socket_s, out_dir_s, num_workers))
+																{
+																	res = 1;
+																}
 														}
-													else
+													else if (num_packages == 1)
 														{
-															add_sep_flag = true;
-														}
-
+															OutputSink *stdout_sink_p = NULL;
 
-													if (value_p)
-														{
-															if (json_is_string (value_p))
+															if (stdout_flag)
 																{
-																	const char *value_s = json_string_value (value_p);
+																	/* Make sure that any messages so far come before the output */
+																	fflush (stdout);
+
+																	stdout_sink_p = AllocateFDOutputSink (fileno (stdout));
 
-																	if (value_s)
+																	if (stdout_sink_p)
 																		{
-																			fprintf (csv_f, "\"%s\"", value_s);
+																			SetFDRendererOutputSinks (renderer_p, GetStandardOutputSink, stdout_sink_p);
 																		}
 																	else
 																		{
-																			fprintf (csv_f, " ");
+																			printf ("Failed to write to the standard output\n");
+																			res = 1;
 																		}
 																}
-															else if (json_is_integer (value_p))
+
+															if ((res == 0) && (RenderFDPackageFile (renderer_p, fd_file_s, out_dir_s, NULL)))
 																{
-																	const json_int_t value = json_integer_value (value_p);
+																	WriteStatsReports (stats_p, schema_cache_p, stats_file_s, trace_file_s, num_slowest);
 
-																	fprintf (csv_f, "%" JSON_INTEGER_FORMAT, value);
+																	if (watch_flag)
+																		{
+																			WatchFDPackageFile (renderer_p, fd_file_s, out_dir_s);
+																		}
 																}
-															else if (json_is_real (value_p))
-																{
-																	const double value = json_real_value (value_p);
 
-																	fprintf (csv_f, "%lf", value);
+															if (stdout_sink_p)
+																{
+																	FreeOutputSink (stdout_sink_p);
 																}
-															else
+														}
+													else
+														{
+															if (!ExportPackages (renderer_p, &options, schema_cache_p, packages_p, out_dir_s, num_workers))
 																{
-																	PrintJSON (stderr, value_p, "Unknown JSON type: ");
+																	res = 1;
 																}
 														}
 
-												}		/* if (header_s) */
+													if (serve_socket_s || (num_packages > 1))
+														{
+															WriteStatsReports (stats_p, schema_cache_p, stats_file_s, trace_file_s, num_slowest);
+														}
+
+													FreeFDRenderer (renderer_p);
+												}		/* if (renderer_p) */
 											else
 												{
-													success_flag = false;
+													/* The reason, e.g. a template that could not be loaded, has already been reported */
+													res = 1;
 												}
 
-										}		/* for (i = 0; i < num_columns; ++ i) */
+										}		/* if (cache_ok_flag) */
 
-									fprintf (csv_f, "%s", row_sep_s);
-								}
+									if (stats_p)
+										{
+											FreeToolStats (stats_p);
+										}
+
+									FreeSchemaCache (schema_cache_p);
+								}		/* if (schema_cache_p) */
 
+						}		/* if ((num_packages > 0) || (serve_socket_s)) */
+					else
+						{
+							printf ("No intput file specified\n");
 						}
 
-				}		/* if (headers_p) */
+				}		/* if (out_dir_ok_flag) */
 			else
 				{
-					/*
-					 * no headers so just write out in an arbitrary order
-					 */
+					printf ("Couldn't write to output directory \"%s\"\n", out_dir_s);
 				}
 
-			fclose (csv_f);
-		}		/* if (csv_f) */
-	else
-		{
-			fprintf (stderr, "Failed to open CSV output file \"%s\"\n", filename_s);
-		}
+			if (packages_p)
+				{
+					json_decref (packages_p);
+				}
 
-	return success_flag;
+			if (inputs_ss)
+				{
+					free (inputs_ss);
+				}
+
+		}		/* if (argc < 3) else */
+
+  return res;
 }
 
 
+/*
+ * static definitions
+ */
 
 
-static bool ParsePackageFromSchema (const json_t *data_p, const json_t *schema_p, Printer *printer_p, const bool full_flag, const bool debug_flag, const size_t indent_level)
+static bool GetPrinterFormat (const char *name_s, const size_t length, PrinterFormat *format_p)
 {
-	bool result = false;
-	const json_t *required_entries_p = json_object_get (schema_p, "required");
-	const json_t *properties_p = json_object_get (schema_p, "properties");
+	static const char * const names_ss [PRINTER_FORMAT_NUM_FORMATS] = { "html", "markdown", "json", "ndjson", "template" };
+	size_t i;
 
-	if (debug_flag)
+	for (i = 0; i < PRINTER_FORMAT_NUM_FORMATS; ++ i)
 		{
-			PrintJSON (stdout, data_p, "processing ");
-			PrintJSON (stdout, schema_p, "schema ");
+			if ((strlen (names_ss [i]) == length) && (strncmp (names_ss [i], name_s, length) == 0))
+				{
+					*format_p = (PrinterFormat) i;
+					return true;
+				}
 		}
 
-	if (properties_p)
-		{
+	return false;
+}
 
-			/*
-			 * Get the properties sorted by their propertyOrder values
-			 */
-			const size_t num_properties = json_object_size (properties_p);
-			JSONProperty *sorted_properties_p = calloc (num_properties, sizeof (JSONProperty));
-			size_t total_required_entries = json_array_size (required_entries_p);
+/*
+ * Add a mapping given as <prefix>=<replacement> to the SchemaCache
+ */
+static bool AddSchemaMapArgument (SchemaCache *schema_cache_p, const char *schema_map_s)
+{
+	bool success_flag = false;
+	const char *sep_s = strchr (schema_map_s, '=');
 
-			if (sorted_properties_p)
-				{
-					const char *key_s;
-					json_t *value_p;
-					JSONProperty *sorted_property_p = sorted_properties_p;
-					size_t i = num_properties;
-					size_t num_required_entries_found = 0;
+	if (sep_s)
+		{
+			char *prefix_s = CopyToNewString (schema_map_s, sep_s - schema_map_s, false);
 
-					json_object_foreach (properties_p, key_s, value_p)
-						{
-							sorted_property_p -> jp_key_s = key_s;
-							sorted_property_p -> jp_value_p = value_p;
+			if (prefix_s)
+				{
+					success_flag = AddSchemaMapping (schema_cache_p, prefix_s, sep_s + 1);
+					FreeCopiedString (prefix_s);
+				}
+		}
+	else
+		{
+			printf ("Invalid schema map \"%s\", it should be <prefix>=<replacement>\n", schema_map_s);
+		}
 
-							++ sorted_property_p;
-						}		/* json_object_foreach (properties_p, key_s, value_p) */
+	return success_flag;
+}
 
-					/*
-					 * Sort the keys into order
-					 */
-					qsort (sorted_properties_p, num_properties, sizeof (JSONProperty), SortPropertiesByOrder);
+/*
+ * Check the resources in the Data Packages and write the report
+ * of any errors, returning true if they are all valid. If there
+ * is more than one package, the report has an entry for each of them.
+ */
+static bool ValidatePackageFiles (const json_t *packages_p, const char *report_file_s, const char *schema_map_s, const size_t num_threads, const size_t max_errors)
+{
+	bool valid_flag = false;
+	SchemaCache *schema_cache_p = AllocateSchemaCache ();
 
+	if (schema_cache_p)
+		{
+			if ((!schema_map_s) || (AddSchemaMapArgument (schema_cache_p, schema_map_s)))
+				{
+					/* The validator and its compiled schemas are shared by all of the packages */
+					PackageValidator *validator_p = AllocatePackageValidator (schema_cache_p, num_threads, max_errors);
 
-					/*
-					 * Now read in the values in order
-					 */
-					for (sorted_property_p = sorted_properties_p; i > 0; -- i, ++ sorted_property_p)
+					if (validator_p)
 						{
-							const json_t *property_p = sorted_property_p -> jp_value_p;
-							const char *type_s;
+							const size_t num_packages = json_array_size (packages_p);
+							json_t *report_p = NULL;
+							json_t *reports_p = NULL;
+							json_int_t total_errors = 0;
+							const json_t *package_p;
+							size_t i;
+							bool success_flag = true;
 
-							key_s = sorted_property_p -> jp_key_s;
+							valid_flag = true;
 
-							type_s = GetJSONString (property_p, FD_TABLE_FIELD_TYPE);
+							if (num_packages > 1)
+								{
+									reports_p = json_array ();
 
-							if (type_s)
+									if (!reports_p)
+										{
+											success_flag = false;
+										}
+								}
+
+							for (i = 0; (i < num_packages) && success_flag; ++ i)
 								{
-									const char *format_s = GetJSONString (property_p, FD_TABLE_FIELD_FORMAT);
-									bool required_flag = false;
+									const char *fd_file_s;
+									json_error_t err;
+									json_t *fd_p;
 
-									if (required_entries_p)
+									package_p = json_array_get (packages_p, i);
+									fd_file_s = json_string_value (package_p);
+									fd_p = json_load_file (fd_file_s, 0, &err);
+
+									if (fd_p)
 										{
-											size_t j = 0;
+											bool package_valid_flag = false;
+											json_t *package_report_p = ValidatePackage (validator_p, fd_p, fd_file_s, &package_valid_flag);
 
-											for (j = 0; j < total_required_entries; ++ j)
+											if (package_report_p)
 												{
-													json_t *entry_p = json_array_get (required_entries_p, j);
+													if (!package_valid_flag)
+														{
+															valid_flag = false;
+														}
 
-													if (json_is_string (entry_p))
+													if (reports_p)
 														{
-															const char *req_s = json_string_value (entry_p);
+															json_int_t num_errors = 0;
 
-															if (strcmp (key_s, req_s) == 0)
+															GetJSONInteger (package_report_p, "num_errors", &num_errors);
+															total_errors += num_errors;
+
+															if ((json_object_set_new (package_report_p, "package", json_string (fd_file_s)) != 0) ||
+																	(json_array_append_new (reports_p, package_report_p) != 0))
 																{
-																	required_flag = true;
-																	j = total_required_entries;
+																	success_flag = false;
 																}
-
+														}
+													else
+														{
+															report_p = package_report_p;
 														}
 												}
+											else
+												{
+													printf ("Failed to validate %s\n", fd_file_s);
+													success_flag = false;
+												}
 
+											json_decref (fd_p);
 										}
-
-
-									if (strcmp (type_s, FD_TYPE_STRING) == 0)
+									else
 										{
-											const char *value_s = GetJSONString (data_p, key_s);
-
-											if (value_s || full_flag)
-												{
-													/*
-													 * profiles may be a url so check for this
-													 */
-													if ((strcmp (key_s, FD_PROFILE_S) == 0) && (DoesStringStartWith (value_s, "http")))
-														{
-															format_s = FD_TYPE_STRING_FORMAT_URI;
-														}
-
-													if (value_s && required_flag)
-														{
-															++ num_required_entries_found;
-														}
-
-													PrintString (printer_p, key_s, value_s, required_flag, format_s);
-												}
+											printf ("Failed to load %s as a JSON file\n", fd_file_s);
+											success_flag = false;
+										}
+								}
 
-										}		/* if (strcmp (type_s, FD_TYPE_STRING) == 0) */
-									else if (strcmp (type_s, FD_TYPE_INTEGER) == 0)
+							if (reports_p)
+								{
+									if (success_flag)
 										{
-											bool print_flag = full_flag;
-											json_int_t value;
-											json_int_t *int_value_p = NULL;
+											report_p = json_pack ("{s:b,s:I,s:I,s:o}", "valid", valid_flag ? 1 : 0, "num_packages", (json_int_t) num_packages, "num_errors", total_errors, "packages", reports_p);
+										}
+									else
+										{
+											json_decref (reports_p);
+										}
+								}
 
-											if (GetJSONInteger (data_p, key_s, &value))
-												{
-													int_value_p = &value;
-													print_flag = true;
+							if (report_p)
+								{
+									if (strcmp (report_file_s, "-") == 0)
+										{
+											json_dumpf (report_p, stdout, JSON_INDENT (2));
+											printf ("\n");
+										}
+									else if (json_dump_file (report_p, report_file_s, JSON_INDENT (2)) == 0)
+										{
+											json_int_t num_errors = 0;
 
-													if (required_flag)
-														{
-															++ num_required_entries_found;
-														}
+											GetJSONInteger (report_p, "num_errors", &num_errors);
 
+											if (num_packages > 1)
+												{
+													printf ("%lu data packages: %" JSON_INTEGER_FORMAT " errors, see \"%s\" for the details\n", (unsigned long) num_packages, num_errors, report_file_s);
 												}
-
-											if (print_flag)
+											else
 												{
-													PrintInteger (printer_p, key_s, int_value_p, required_flag, format_s);
+													printf ("%s: %" JSON_INTEGER_FORMAT " errors, see \"%s\" for the details\n", json_string_value (json_array_get (packages_p, 0)), num_errors, report_file_s);
 												}
-
-										}		/* else if (strcmp (type_s, FD_TYPE_INTEGER) == 0) */
-									else if (strcmp (type_s, FD_TYPE_NUMBER) == 0)
+										}
+									else
 										{
-											bool print_flag = full_flag;
-											double value;
-											double *number_value_p = NULL;
+											printf ("Failed to write the validation report to \"%s\"\n", report_file_s);
+											valid_flag = false;
+										}
 
-											if (GetJSONReal (data_p, key_s, &value))
-												{
-													number_value_p = &value;
-													print_flag = true;
+									json_decref (report_p);
+								}
+							else
+								{
+									valid_flag = false;
+								}
 
-													if (required_flag)
-														{
-															++ num_required_entries_found;
-														}
-												}
+							FreePackageValidator (validator_p);
+						}
 
-											if (print_flag)
-												{
-													PrintNumber (printer_p, key_s, number_value_p, required_flag, format_s);
-												}
+				}
 
-										}		/* else if (strcmp (type_s, FD_TYPE_NUMBER) == 0) */
-									else if (strcmp (type_s, FD_TYPE_BOOLEAN) == 0)
-										{
-											bool print_flag = full_flag;
-											bool value;
-											bool *bool_value_p = NULL;
+			FreeSchemaCache (schema_cache_p);
+		}
 
-											if (GetJSONBoolean (data_p, key_s, &value))
-												{
-													bool_value_p = &value;
-													print_flag = true;
+	return valid_flag;
+}
 
-													if (required_flag)
-														{
-															++ num_required_entries_found;
-														}
-												}
+static void WriteStatsReports (ToolStats *stats_p, const SchemaCache *schema_cache_p, const char *stats_file_s, const char *trace_file_s, const size_t num_slowest)
+{
+	if (stats_p)
+		{
+			stats_p -> ts_schema_fetches = schema_cache_p -> sc_num_fetches;
+			stats_p -> ts_schema_cache_hits = schema_cache_p -> sc_num_hits;
 
-											if (print_flag)
-												{
-													PrintBoolean (printer_p, key_s, bool_value_p, required_flag, format_s);
-												}
+			if (stats_file_s)
+				{
+					WriteToolStats (stats_p, stats_file_s);
+				}
 
-										}		/* else if (strcmp (type_s, FD_TYPE_BOOLEAN) == 0) */
-									else if (strcmp (type_s, FD_TYPE_JSON_ARRAY) == 0)
-										{
-											/*
-											 * Do we have a schema?
-											 */
-											const char *schema_uri_s = GetRefSchemaURI (property_p);
+			if (trace_file_s)
+				{
+					WriteToolStatsTrace (stats_p, trace_file_s);
+				}
 
-											if (schema_uri_s)
-												{
-													if (DoesStringStartWith (schema_uri_s, "http"))
-														{
-															json_t *child_schema_p = GetWebJSON (schema_uri_s);
+			if (num_slowest > 0)
+				{
+					PrintResourceTimings (stats_p, stdout);
+				}
+		}
+}
 
-															if (child_schema_p)
-																{
-																	const json_t *values_p = json_object_get (data_p, key_s);
 
-																	if (values_p)
-																		{
-																			if (json_is_array (values_p))
-																				{
-																					const json_t *entry_p;
-																					size_t j;
-																					const char *title_s = GetJSONString (property_p, key_s);
+/*
+ * Get an FDRenderer for each worker. The first one is renderer_p and
+ * the others share its SchemaCache, so each schema is only fetched and
+ * compiled once, but have their own printers.
+ */
+static FDRenderer **AllocateWorkerRenderers (FDRenderer *renderer_p, const FDRenderOptions *options_p, SchemaCache *schema_cache_p, const size_t num_workers)
+{
+	FDRenderer **renderers_pp = (FDRenderer **) calloc (num_workers, sizeof (FDRenderer *));
 
-																					if (!title_s)
-																						{
-																							title_s = key_s;
-																						}
+	if (renderers_pp)
+		{
+			size_t i;
 
-																					StartPrintSection (printer_p, title_s);
+			renderers_pp [0] = renderer_p;
 
-																					json_array_foreach (values_p, j, entry_p)
-																						{
-																							if (!ParsePackageFromSchema (entry_p, child_schema_p, printer_p, full_flag, debug_flag, indent_level + 1))
-																								{
-																									fprintf (stderr, "Failed to parse \"%s\"\n", key_s);
-																								}
+			for (i = 1; i < num_workers; ++ i)
+				{
+					renderers_pp [i] = AllocateFDRenderer (options_p, schema_cache_p);
 
-																						}
+					if (! (renderers_pp [i]))
+						{
+							FreeWorkerRenderers (renderers_pp, i, renderer_p);
+							return NULL;
+						}
+				}
+		}
 
-																					EndPrintSection (printer_p, NULL);
+	return renderers_pp;
+}
 
-																				}
-																		}
+
+static void FreeWorkerRenderers (FDRenderer **renderers_pp, const size_t num_workers, const FDRenderer *renderer_p)
+{
+	size_t i;
+
+	/* The workers can return the renderers in any order and the caller's one is not ours to free */
+	for (i = 0; i < num_workers; ++ i)
+		{
+			if (renderers_pp [i] != renderer_p)
+				{
+					FreeFDRenderer (renderers_pp [i]);
+				}
+		}
+
+	free (renderers_pp);
+}
 
 
-																	json_decref (child_schema_p);
-																}		/*if (child_schema_p) */
+/*
+ * Export each of the data packages into its own subdirectory of the
+ * output directory using a pool of workers.
+ */
+static bool ExportPackages (FDRenderer *renderer_p, const FDRenderOptions *options_p, SchemaCache *schema_cache_p, const json_t *packages_p, const char *out_dir_s, const size_t num_workers)
+{
+	bool success_flag = false;
+	const size_t num_packages = json_array_size (packages_p);
+	PackageBatch batch;
 
-														}		/* if (DoesStringStartWith (schema_uri_s, "http")) */
+	memset (&batch, 0, sizeof (PackageBatch));
 
-												}		/* if (schema_uri_s) */
+	batch.pb_packages_p = packages_p;
+	batch.pb_out_dir_s = out_dir_s;
+	batch.pb_renderers_pp = AllocateWorkerRenderers (renderer_p, options_p, schema_cache_p, num_workers);
+	batch.pb_num_free_renderers = num_workers;
+	batch.pb_results_p = (bool *) calloc (num_packages, sizeof (bool));
+	batch.pb_lock_p = AllocateTaskLock ();
 
+	/* Work these out before any of the workers start so that packages with the same name don't overwrite each other */
+	batch.pb_out_names_p = GetPackageOutputNames (packages_p);
 
-										}		/* else if (strcmp (type_s, FD_TYPE_JSON_ARRAY) == 0) */
+	if ((batch.pb_renderers_pp) && (batch.pb_results_p) && (batch.pb_lock_p) && (batch.pb_out_names_p))
+		{
+			size_t i;
+			size_t num_failed = 0;
 
-								}		/* if (type_s) */
+			/* This isn't thread-safe so must be done before any of the workers start */
+			curl_global_init (CURL_GLOBAL_DEFAULT);
 
-						}		/* for (sorted_key_pp = sorted_keys_pp; i > 0; -- i, ++ sorted_key_pp) */
+			RunParallelTasks (num_packages, num_workers, ExportBatchPackage, &batch);
 
-					/*
-					 * Did we get all of the required fields?
-					 */
-					if (num_required_entries_found == total_required_entries)
+			for (i = 0; i < num_packages; ++ i)
+				{
+					if (! (batch.pb_results_p [i]))
 						{
-							result = true;
+							++ num_failed;
 						}
+				}
+
+			if (num_failed == 0)
+				{
+					success_flag = true;
+				}
+			else
+				{
+					printf ("Failed to export %lu of the %lu data packages\n", (unsigned long) num_failed, (unsigned long) num_packages);
+				}
+
+			curl_global_cleanup ();
+		}
+	else
+		{
+			printf ("Failed to set up the workers for the data packages\n");
+		}
+
+	if (batch.pb_lock_p)
+		{
+			FreeTaskLock (batch.pb_lock_p);
+		}
 
-					free (sorted_properties_p);
-				}		/* if ((sorted_keys_pp) */
+	if (batch.pb_out_names_p)
+		{
+			json_decref (batch.pb_out_names_p);
+		}
 
-		}		/* if (properties_p) */
+	if (batch.pb_results_p)
+		{
+			free (batch.pb_results_p);
+		}
+
+	if (batch.pb_renderers_pp)
+		{
+			FreeWorkerRenderers (batch.pb_renderers_pp, num_workers, renderer_p);
+		}
 
-	return result;
+	return success_flag;
 }
 
 
-static int SortPropertiesByOrder (const void *v0_p, const void *v1_p)
+/*
+ * Export one of the data packages in a batch, which is run on one of the worker threads.
+ */
+static void ExportBatchPackage (void *data_p, const size_t task_index)
 {
-	int res = 0;
-	const JSONProperty *json_0_p = (const JSONProperty *) v0_p;
-	const JSONProperty *json_1_p = (const JSONProperty *) v1_p;
-
-	json_int_t prop_order_0;
+	PackageBatch *batch_p = (PackageBatch *) data_p;
+	const char *fd_file_s = json_string_value (json_array_get (batch_p -> pb_packages_p, task_index));
+	const char *name_s = json_string_value (json_array_get (batch_p -> pb_out_names_p, task_index));
+	char *out_dir_s = (batch_p -> pb_out_dir_s) ? MakeFilename (batch_p -> pb_out_dir_s, name_s) : EasyCopyToNewString (name_s);
+	bool success_flag = false;
 
-	if (GetJSONInteger (json_0_p -> jp_value_p, FD_PROFILE_PROPERTY_ORDER_S, &prop_order_0))
+	if (out_dir_s)
 		{
-			json_int_t prop_order_1;
+			if (EnsureDirectoryExists (out_dir_s))
+				{
+					FDRenderer *renderer_p;
 
-			if (GetJSONInteger (json_1_p -> jp_value_p, FD_PROFILE_PROPERTY_ORDER_S, &prop_order_1))
+					/* There is always a renderer free as there is one for each worker */
+					AcquireTaskLock (batch_p -> pb_lock_p);
+					-- (batch_p -> pb_num_free_renderers);
+					renderer_p = batch_p -> pb_renderers_pp [batch_p -> pb_num_free_renderers];
+					ReleaseTaskLock (batch_p -> pb_lock_p);
+
+					success_flag = RenderFDPackageFile (renderer_p, fd_file_s, out_dir_s, NULL);
+
+					AcquireTaskLock (batch_p -> pb_lock_p);
+					batch_p -> pb_renderers_pp [batch_p -> pb_num_free_renderers] = renderer_p;
+					++ (batch_p -> pb_num_free_renderers);
+					ReleaseTaskLock (batch_p -> pb_lock_p);
+				}
+			else
 				{
-					res = prop_order_0 - prop_order_1;
+					printf ("Couldn't write to output directory \"%s\"\n", out_dir_s);
 				}
 
+			FreeCopiedString (out_dir_s);
 		}
 
-	return res;
+	batch_p -> pb_results_p [task_index] = success_flag;
 }
 
 
+/*
+ * Run as a server, rendering the data packages given in requests on
+ * a Unix domain socket. The downloaded schemas are kept in the shared
+ * SchemaCache between requests and each worker has its own FDRenderer.
+ */
+static bool ServePackages (FDRenderer *renderer_p, const FDRenderOptions *options_p, SchemaCache *schema_cache_p, const char *socket_filename_s, const char *out_dir_s, const size_t num_workers)
+{
+	bool success_flag = false;
+	FDRenderOptions worker_options = *options_p;
+	RenderService service;
+
+	/* Leave the other processors for the other requests */
+	worker_options.ro_num_jobs = 1;
+
+	service.rv_out_dir_s = out_dir_s;
+	service.rv_renderers_pp = AllocateWorkerRenderers (renderer_p, &worker_options, schema_cache_p, num_workers);
+
+	if (service.rv_renderers_pp)
+		{
+			/* This isn't thread-safe so must be done before any of the workers start */
+			curl_global_init (CURL_GLOBAL_DEFAULT);
+
+			success_flag = RunRenderServer (socket_filename_s, num_workers, RenderRequestedPackage, &service);
+
+			curl_global_cleanup ();
 
-static char *GetOutputFilename (const char *dir_s, const char *name_s, const char *extension_s)
+			FreeWorkerRenderers (service.rv_renderers_pp, num_workers, renderer_p);
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Render the data package given in a request, either by its "path" or
+ * inline as "package". The files are written to the "out_dir" subdirectory
+ * of the output directory if it is given or to a subdirectory named after
+ * the package otherwise. As the requests can come from other programs, the
+ * "path" must be within the server's working directory, the files must stay
+ * within the output directory and the package's resources can only read
+ * local files from within the package's directory.
+ */
+static bool RenderRequestedPackage (void *data_p, const size_t worker_index, const json_t *request_p, json_t *response_p)
 {
-	char *filename_s = NULL;
-	char *copied_name_s = ConcatenateVarargsStrings (name_s, ".", extension_s, NULL);
+	RenderService *service_p = (RenderService *) data_p;
+	const json_t *package_p = json_object_get (request_p, "package");
+	const char *path_s = GetJSONString (request_p, "path");
+	const char *out_dir_s = GetJSONString (request_p, "out_dir");
+	const char *error_s = NULL;
+	char *fd_file_s = NULL;
+	json_t *loaded_package_p = NULL;
+	bool success_flag = false;
 
-	if (copied_name_s)
+	/* An inline package has no file so it is named for its output files */
+	if (json_is_object (package_p))
 		{
-			/*
-			 * Replace any non file-system characters to
-			 * make sure that it is a valid filename.
-			 * The safest approach is to replace all
-			 * non-alphanumeric characters with an
-			 * underscore.
-			 */
-			char *c_p = copied_name_s;
-			size_t i = strlen (name_s);
+			const char *name_s = GetJSONString (request_p, "name");
 
-			for ( ; i > 0; -- i, ++ c_p)
+			if ((!name_s) || ((IsSafeRelativePath (name_s)) && (!strpbrk (name_s, "/\\"))))
+				{
+					fd_file_s = ConcatenateStrings (name_s ? name_s : "datapackage", ".json");
+				}
+			else
+				{
+					error_s = "The \"name\" must be a filename without a directory";
+				}
+		}
+	else if (path_s)
+		{
+			if (IsSafeRelativePath (path_s))
 				{
-					if (isalnum (*c_p) == 0)
+					json_error_t err;
+
+					loaded_package_p = json_load_file (path_s, 0, &err);
+
+					if (loaded_package_p)
+						{
+							fd_file_s = EasyCopyToNewString (path_s);
+							package_p = loaded_package_p;
+						}
+					else
 						{
-							*c_p = '_';
+							error_s = "Failed to load the data package";
 						}
 				}
+			else
+				{
+					error_s = "The \"path\" must be a relative path within the server's directory";
+				}
+		}
+	else
+		{
+			error_s = "The request needs either a \"path\" or an inline \"package\"";
+		}
 
-			if (dir_s)
+	if (fd_file_s)
+		{
+			if ((out_dir_s) && (!IsSafeRelativePath (out_dir_s)))
+				{
+					error_s = "The \"out_dir\" must be a relative path within the output directory";
+				}
+			else if (!CheckRequestedResourcePaths (package_p))
 				{
-					if (EnsureDirectoryExists (dir_s))
+					error_s = "The resources' paths must be urls or relative paths within the data package's directory";
+				}
+			else
+				{
+					char *package_dir_s = NULL;
+
+					if (out_dir_s)
 						{
-							filename_s = MakeFilename (dir_s, copied_name_s);
+							package_dir_s = (service_p -> rv_out_dir_s) ? MakeFilename (service_p -> rv_out_dir_s, out_dir_s) : EasyCopyToNewString (out_dir_s);
 						}
 					else
 						{
-							fprintf (stderr, "Failed to create output directory \"%s\"\n", dir_s);
+							package_dir_s = GetPackageOutputDirectory (service_p -> rv_out_dir_s, fd_file_s);
 						}
 
-					FreeCopiedString (copied_name_s);
-				}		/* if (dir_s) */
-			else
-				{
-					filename_s = copied_name_s;
+					if (package_dir_s)
+						{
+							if (EnsureDirectoryExists (package_dir_s))
+								{
+									FDRenderer *renderer_p = service_p -> rv_renderers_pp [worker_index];
+									json_t *outputs_p = json_array ();
+
+									if (outputs_p)
+										{
+											success_flag = RenderFDPackage (renderer_p, package_p, fd_file_s, package_dir_s, outputs_p);
+
+											if (success_flag)
+												{
+													json_object_set_new (response_p, "outputs", outputs_p);
+												}
+											else
+												{
+													error_s = "Failed to render the data package";
+													json_decref (outputs_p);
+												}
+										}
+								}
+							else
+								{
+									error_s = "Couldn't write to the output directory";
+								}
+
+							FreeCopiedString (package_dir_s);
+						}
 				}
 
-		}		/* if (copied_name_s) */
+			FreeCopiedString (fd_file_s);
+		}
+
+	if (loaded_package_p)
+		{
+			json_decref (loaded_package_p);
+		}
 
-	return filename_s;
+	if (error_s)
+		{
+			json_object_set_new (response_p, "error", json_string (error_s));
+		}
+
+	return success_flag;
 }
 
 
-static json_t *GetWebJSON (const char *url_s)
+/*
+ * Check that a path from a request is relative and doesn't
+ * have any ".." segments that could take it out of its directory.
+ */
+static bool IsSafeRelativePath (const char *path_s)
 {
-	json_t *data_p = NULL;
-	CurlTool *curl_tool_p = AllocateMemoryCurlTool (0);
+	const char *segment_s = path_s;
+
+	if ((*path_s == '\0') || (*path_s == '/') || (*path_s == '\\') || (strchr (path_s, ':')))
+		{
+			return false;
+		}
 
-	if (curl_tool_p)
+	while (*segment_s != '\0')
 		{
-			if (SetUriForCurlTool (curl_tool_p, url_s))
+			const size_t length = strcspn (segment_s, "/\\");
+
+			if ((length == 2) && (strncmp (segment_s, "..", 2) == 0))
 				{
-					CURLcode res = RunCurlTool (curl_tool_p);
+					return false;
+				}
 
-					if (res == CURLE_OK)
-						{
-							const char *data_s = GetCurlToolData (curl_tool_p);
+			segment_s += length;
 
+			if (*segment_s != '\0')
+				{
+					++ segment_s;
+				}
+		}
 
-							if (data_s)
-								{
-									json_error_t err;
-									data_p = json_loads (data_s, 0, &err);
+	return true;
+}
 
-									//FreeCopiedString (data_s);
-								}
+
+/*
+ * The resources of a requested package can download their data from
+ * the web but any local files have to be within the package's directory.
+ */
+static bool CheckRequestedResourcePaths (const json_t *package_p)
+{
+	const json_t *resources_p = json_object_get (package_p, "resources");
+	const json_t *resource_p;
+	size_t i;
+
+	json_array_foreach (resources_p, i, resource_p)
+		{
+			const json_t *path_p = json_object_get (resource_p, "path");
+			const size_t num_parts = json_is_array (path_p) ? json_array_size (path_p) : 1;
+			size_t j;
+
+			for (j = 0; j < num_parts; ++ j)
+				{
+					const char *part_s = json_string_value (json_is_array (path_p) ? json_array_get (path_p, j) : path_p);
+
+					if ((part_s) && (!DoesStringStartWith (part_s, "http://")) && (!DoesStringStartWith (part_s, "https://")) && (!IsSafeRelativePath (part_s)))
+						{
+							return false;
 						}
 				}
-
-			FreeCurlTool (curl_tool_p);
 		}
 
-	return data_p;
+	return true;
 }
 
 
+/*
+ * Get the subdirectory of out_dir_s to write a data package's files to
+ * when there are several packages.
+ */
+static char *GetPackageOutputDirectory (const char *out_dir_s, const char *fd_file_s)
+{
+	char *package_dir_s = NULL;
+	char *name_s = GetPackageOutputName (fd_file_s);
+
+	if (name_s)
+		{
+			if (out_dir_s)
+				{
+					package_dir_s = MakeFilename (out_dir_s, name_s);
+					FreeCopiedString (name_s);
+				}
+			else
+				{
+					package_dir_s = name_s;
+				}
+		}
 
+	return package_dir_s;
+}
 
 
+/*
+ * Write every output file to the standard output one after another.
+ */
+static OutputSink *GetStandardOutputSink (const char *filename_s, void *data_p)
+{
+	return (OutputSink *) data_p;
+}
@@ -0,0 +1,303 @@
+/*
+ * file_watcher.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef LINUX
+	#include <limits.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#include <sys/inotify.h>
+#elif defined WINDOWS
+	#include <windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+#include "file_watcher.h"
+
+#include "string_utils.h"
+
+
+/*
+ * How long to wait for further changes before
+ * treating a burst of changes as complete.
+ */
+static const int S_SETTLE_TIME_MS = 100;
+
+#ifndef LINUX
+static const unsigned int S_POLL_INTERVAL_MS = 500;
+#endif
+
+
+struct FileWatcher
+{
+	char *fw_filename_s;
+
+#ifdef LINUX
+	/** The inotify instance. */
+	int fw_inotify_fd;
+
+	/**
+	 * The leaf name of the file. The parent directory is watched
+	 * rather than the file itself since editors often save by
+	 * writing a new file and renaming it over the original.
+	 */
+	const char *fw_leaf_name_s;
+#else
+	time_t fw_last_modified;
+	off_t fw_last_size;
+#endif
+};
+
+
+/*
+ * static declarations
+ */
+
+#ifdef LINUX
+static bool ReadWatchEvents (FileWatcher *watcher_p, const int timeout_ms);
+#else
+static void SleepMilliseconds (const unsigned int ms);
+#endif
+
+
+/*
+ * api definitions
+ */
+
+#ifdef LINUX
+
+FileWatcher *AllocateFileWatcher (const char *filename_s)
+{
+	FileWatcher *watcher_p = (FileWatcher *) malloc (sizeof (FileWatcher));
+
+	if (watcher_p)
+		{
+			watcher_p -> fw_filename_s = EasyCopyToNewString (filename_s);
+
+			if (watcher_p -> fw_filename_s)
+				{
+					char *dir_s = NULL;
+					char *sep_p = strrchr (watcher_p -> fw_filename_s, '/');
+
+					if (sep_p)
+						{
+							dir_s = CopyToNewString (watcher_p -> fw_filename_s, (sep_p == watcher_p -> fw_filename_s) ? 1 : sep_p - watcher_p -> fw_filename_s, false);
+							watcher_p -> fw_leaf_name_s = sep_p + 1;
+						}
+					else
+						{
+							dir_s = EasyCopyToNewString (".");
+							watcher_p -> fw_leaf_name_s = watcher_p -> fw_filename_s;
+						}
+
+					if (dir_s)
+						{
+							watcher_p -> fw_inotify_fd = inotify_init1 (IN_CLOEXEC);
+
+							if (watcher_p -> fw_inotify_fd != -1)
+								{
+									if (inotify_add_watch (watcher_p -> fw_inotify_fd, dir_s, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) != -1)
+										{
+											FreeCopiedString (dir_s);
+											return watcher_p;
+										}
+									else
+										{
+											fprintf (stderr, "Failed to watch directory \"%s\"\n", dir_s);
+										}
+
+									close (watcher_p -> fw_inotify_fd);
+								}
+							else
+								{
+									fprintf (stderr, "Failed to initialise inotify\n");
+								}
+
+							FreeCopiedString (dir_s);
+						}
+
+					FreeCopiedString (watcher_p -> fw_filename_s);
+				}
+
+			free (watcher_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeFileWatcher (FileWatcher *watcher_p)
+{
+	close (watcher_p -> fw_inotify_fd);
+	FreeCopiedString (watcher_p -> fw_filename_s);
+	free (watcher_p);
+}
+
+
+bool WaitForFileChange (FileWatcher *watcher_p)
+{
+	/*
+	 * Block until our file is touched and then keep
+	 * reading until things have gone quiet
+	 */
+	while (!ReadWatchEvents (watcher_p, -1))
+		{
+		}
+
+	while (ReadWatchEvents (watcher_p, S_SETTLE_TIME_MS))
+		{
+		}
+
+	return (watcher_p -> fw_inotify_fd != -1);
+}
+
+#else
+
+FileWatcher *AllocateFileWatcher (const char *filename_s)
+{
+	FileWatcher *watcher_p = (FileWatcher *) malloc (sizeof (FileWatcher));
+
+	if (watcher_p)
+		{
+			watcher_p -> fw_filename_s = EasyCopyToNewString (filename_s);
+
+			if (watcher_p -> fw_filename_s)
+				{
+					struct stat st;
+
+					if (stat (filename_s, &st) == 0)
+						{
+							watcher_p -> fw_last_modified = st.st_mtime;
+							watcher_p -> fw_last_size = st.st_size;
+
+							return watcher_p;
+						}
+					else
+						{
+							fprintf (stderr, "Failed to get the details of \"%s\"\n", filename_s);
+						}
+
+					FreeCopiedString (watcher_p -> fw_filename_s);
+				}
+
+			free (watcher_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeFileWatcher (FileWatcher *watcher_p)
+{
+	FreeCopiedString (watcher_p -> fw_filename_s);
+	free (watcher_p);
+}
+
+
+bool WaitForFileChange (FileWatcher *watcher_p)
+{
+	bool changed_flag = false;
+
+	while (!changed_flag)
+		{
+			struct stat st;
+
+			SleepMilliseconds (S_POLL_INTERVAL_MS);
+
+			if (stat (watcher_p -> fw_filename_s, &st) == 0)
+				{
+					if ((st.st_mtime != watcher_p -> fw_last_modified) || (st.st_size != watcher_p -> fw_last_size))
+						{
+							watcher_p -> fw_last_modified = st.st_mtime;
+							watcher_p -> fw_last_size = st.st_size;
+
+							changed_flag = true;
+						}
+				}
+		}
+
+	/* give the writer a chance to finish */
+	SleepMilliseconds (S_SETTLE_TIME_MS);
+
+	return changed_flag;
+}
+
+#endif
+
+
+/*
+ * static definitions
+ */
+
+#ifdef LINUX
+
+/*
+ * Read the pending inotify events, waiting for up to timeout_ms
+ * milliseconds, or indefinitely if it is negative, for some to
+ * arrive. Returns true if any of them were for our file.
+ */
+static bool ReadWatchEvents (FileWatcher *watcher_p, const int timeout_ms)
+{
+	bool matched_flag = false;
+	struct pollfd poll_fd;
+
+	poll_fd.fd = watcher_p -> fw_inotify_fd;
+	poll_fd.events = POLLIN;
+	poll_fd.revents = 0;
+
+	if (poll (&poll_fd, 1, timeout_ms) > 0)
+		{
+			char buffer [sizeof (struct inotify_event) + NAME_MAX + 1] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+			const ssize_t len = read (watcher_p -> fw_inotify_fd, buffer, sizeof (buffer));
+
+			if (len > 0)
+				{
+					const char *event_p = buffer;
+
+					while (event_p < buffer + len)
+						{
+							const struct inotify_event *inotify_event_p = (const struct inotify_event *) event_p;
+
+							if ((inotify_event_p -> len > 0) && (strcmp (inotify_event_p -> name, watcher_p -> fw_leaf_name_s) == 0))
+								{
+									matched_flag = true;
+								}
+
+							event_p += sizeof (struct inotify_event) + inotify_event_p -> len;
+						}
+				}
+			else
+				{
+					fprintf (stderr, "Failed to read file change events for \"%s\"\n", watcher_p -> fw_filename_s);
+
+					/* signal that we can't carry on */
+					close (watcher_p -> fw_inotify_fd);
+					watcher_p -> fw_inotify_fd = -1;
+					matched_flag = true;
+				}
+		}
+
+	return matched_flag;
+}
+
+#else
+
+static void SleepMilliseconds (const unsigned int ms)
+{
+	#ifdef WINDOWS
+	Sleep (ms);
+	#else
+	usleep (ms * 1000);
+	#endif
+}
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * html_escape.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define HE_USE_SSE2 (1)
+	#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+#include "html_escape.h"
+
+
+/*
+ * The characters that need escaping in each context
+ */
+static const bool S_TEXT_ESCAPES [256] =
+{
+	['&'] = true,
+	['<'] = true,
+	['>'] = true
+};
+
+static const bool S_ATTRIBUTE_ESCAPES [256] =
+{
+	['&'] = true,
+	['<'] = true,
+	['>'] = true,
+	['"'] = true,
+	['\''] = true
+};
+
+
+/*
+ * static declarations
+ */
+
+static size_t GetCleanRunLength (const char *value_s, const size_t length, const HTMLEscapeContext context);
+
+static const char *GetCharacterReference (const char c);
+
+#ifdef HE_USE_SSE2
+static int GetLowestSetBit (const unsigned int mask);
+#else
+static uint64_t HasByte (const uint64_t word, const unsigned char c);
+#endif
+
+
+/*
+ * api definitions
+ */
+
+bool WriteEscapedHTML (FILE *out_f, const char *value_s, const size_t length, const HTMLEscapeContext context)
+{
+	bool success_flag = true;
+	size_t offset = 0;
+
+	while (success_flag && (offset < length))
+		{
+			const size_t run_length = GetCleanRunLength (value_s + offset, length - offset, context);
+
+			if (run_length > 0)
+				{
+					success_flag = (fwrite (value_s + offset, 1, run_length, out_f) == run_length);
+					offset += run_length;
+				}
+
+			if (success_flag && (offset < length))
+				{
+					success_flag = (fputs (GetCharacterReference (value_s [offset]), out_f) >= 0);
+					++ offset;
+				}
+		}
+
+	return success_flag;
+}
+
+
+bool WriteEscapedHTMLString (FILE *out_f, const char *value_s, const HTMLEscapeContext context)
+{
+	return WriteEscapedHTML (out_f, value_s, strlen (value_s), context);
+}
+
+
+/*
+ * static definitions
+ */
+
+/*
+ * Get the number of bytes at the start of value_s that can be
+ * written as they are.
+ */
+static size_t GetCleanRunLength (const char *value_s, const size_t length, const HTMLEscapeContext context)
+{
+	const bool * const table_p = (context == HE_ATTRIBUTE) ? S_ATTRIBUTE_ESCAPES : S_TEXT_ESCAPES;
+	size_t i = 0;
+
+	#ifdef HE_USE_SSE2
+	{
+		const __m128i amp = _mm_set1_epi8 ('&');
+		const __m128i lt = _mm_set1_epi8 ('<');
+		const __m128i gt = _mm_set1_epi8 ('>');
+		const __m128i quot = _mm_set1_epi8 ('"');
+		const __m128i apos = _mm_set1_epi8 ('\'');
+
+		while ((i + 16) <= length)
+			{
+				const __m128i chunk = _mm_loadu_si128 ((const __m128i *) (value_s + i));
+				__m128i matches = _mm_or_si128 (_mm_cmpeq_epi8 (chunk, amp), _mm_or_si128 (_mm_cmpeq_epi8 (chunk, lt), _mm_cmpeq_epi8 (chunk, gt)));
+				int mask;
+
+				if (context == HE_ATTRIBUTE)
+					{
+						matches = _mm_or_si128 (matches, _mm_or_si128 (_mm_cmpeq_epi8 (chunk, quot), _mm_cmpeq_epi8 (chunk, apos)));
+					}
+
+				mask = _mm_movemask_epi8 (matches);
+
+				if (mask != 0)
+					{
+						return i + GetLowestSetBit ((unsigned int) mask);
+					}
+
+				i += 16;
+			}
+	}
+	#else
+	{
+		/* Check 8 bytes at a time and only look at the individual bytes of a word with a match */
+		while ((i + 8) <= length)
+			{
+				uint64_t word;
+				uint64_t matches;
+
+				memcpy (&word, value_s + i, sizeof (word));
+
+				matches = HasByte (word, '&') | HasByte (word, '<') | HasByte (word, '>');
+
+				if (context == HE_ATTRIBUTE)
+					{
+						matches |= HasByte (word, '"') | HasByte (word, '\'');
+					}
+
+				if (matches != 0)
+					{
+						break;
+					}
+
+				i += 8;
+			}
+	}
+	#endif
+
+	while ((i < length) && (! (table_p [(unsigned char) value_s [i]])))
+		{
+			++ i;
+		}
+
+	return i;
+}
+
+
+static const char *GetCharacterReference (const char c)
+{
+	const char *ref_s = "";
+
+	switch (c)
+		{
+			case '&':
+				ref_s = "&amp;";
+				break;
+
+			case '<':
+				ref_s = "&lt;";
+				break;
+
+			case '>':
+				ref_s = "&gt;";
+				break;
+
+			case '"':
+				ref_s = "&quot;";
+				break;
+
+			case '\'':
+				ref_s = "&#39;";
+				break;
+
+			default:
+				break;
+		}
+
+	return ref_s;
+}
+
+
+#ifdef HE_USE_SSE2
+static int GetLowestSetBit (const unsigned int mask)
+{
+	#if defined (__GNUC__)
+	return __builtin_ctz (mask);
+	#elif defined (_MSC_VER)
+	unsigned long index;
+
+	_BitScanForward (&index, mask);
+
+	return (int) index;
+	#else
+	int index = 0;
+
+	while (! (mask & (1u << index)))
+		{
+			++ index;
+		}
+
+	return index;
+	#endif
+}
+
+#else
+
+/*
+ * Get a non-zero value if any of the bytes in word are equal to c
+ */
+static uint64_t HasByte (const uint64_t word, const unsigned char c)
+{
+	const uint64_t ones = UINT64_C (0x0101010101010101);
+	const uint64_t highs = UINT64_C (0x8080808080808080);
+	const uint64_t x = word ^ (ones * c);
+
+	return (x - ones) & ~x & highs;
+}
+#endif
@@ -21,8 +21,10 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "html_printer.h"
+#include "html_escape.h"
 
 #include "json_util.h"
 
@@ -37,6 +39,19 @@ typedef struct
 } HTMLPrinter;
 
 
+/*
+ * The state for streaming a JSON value so we know
+ * when to start the collapsed part.
+ */
+typedef struct
+{
+	FILE *hjw_out_f;
+	size_t hjw_collapse_size;
+	size_t hjw_size;
+	bool hjw_collapsed_flag;
+} HTMLJSONWriter;
+
+
 /*
  * static declarations
  */
@@ -61,12 +76,30 @@ static void FreeHTMLPrinter (Printer *printer_p);
 
 static bool PrintEmptyHTMLValue (Printer *printer_p, const char *key_s);
 
+static bool PrintHTMLListItemStart (Printer *printer_p, const char *key_s, const char *req_s);
+
+static bool PrintHTMLListItemEnd (Printer *printer_p);
+
+static bool PrintHTMLLink (Printer *printer_p, const char *scheme_s, const char *value_s);
+
+static bool WriteHTMLJSONChunk (const char *chunk_s, const size_t length, void *data_p);
+
 
 
 static bool PrintHTMLSectionStart (Printer *printer_p, const char *value_s);
 
 static bool PrintHTMLSectionEnd (Printer *printer_p, const char *value_s);
 
+static bool PrintHTMLDocumentStart (Printer *printer_p, const char *title_s);
+
+static bool PrintHTMLContents (Printer *printer_p, const json_t *entries_p);
+
+static bool PrintHTMLResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s);
+
+static bool PrintHTMLResourceEnd (Printer *printer_p, const char *text_s);
+
+static bool PrintHTMLDocumentEnd (Printer *printer_p);
+
 /*
  * api definitions
  */
@@ -82,6 +115,9 @@ Printer *AllocateHTMLPrinter (void)
 										 PrintHTMLSectionEnd, PrintHTMLString,
 									 PrintHTMLInteger, PrintHTMLNumber, PrintHTMLBoolean, PrintHTMLJSON,  FreeHTMLPrinter);
 
+			SetFDPrinterDocumentFunctions (& (printer_p -> hp_printer), PrintHTMLDocumentStart, PrintHTMLContents, PrintHTMLResourceStart,
+																		 PrintHTMLResourceEnd, PrintHTMLDocumentEnd);
+
 			return (& (printer_p -> hp_printer));
 		}
 
@@ -107,25 +143,33 @@ static bool PrintHTMLString (Printer *printer_p, const char *key_s, const char *
 
 	if (value_s)
 		{
-			bool printed_flag = false;
-
-			if (format_s)
+			if (PrintHTMLListItemStart (printer_p, key_s, req_s))
 				{
-					if (strcmp (format_s, FD_TYPE_STRING_FORMAT_URI) == 0)
+					bool printed_flag = false;
+
+					if (format_s)
 						{
-							success_flag = (fprintf (printer_p -> pr_out_f, "<li><strong>%s%s</strong>: <a href =\"%s\">%s</a></li>\n", key_s, req_s, value_s, value_s) > 0);
-							printed_flag = true;
+							if (strcmp (format_s, FD_TYPE_STRING_FORMAT_URI) == 0)
+								{
+									success_flag = PrintHTMLLink (printer_p, "", value_s);
+									printed_flag = true;
+								}
+							else if (strcmp (format_s, FD_TYPE_STRING_FORMAT_EMAIL) == 0)
+								{
+									success_flag = PrintHTMLLink (printer_p, "mailto:", value_s);
+									printed_flag = true;
+								}
 						}
-					else if (strcmp (format_s, FD_TYPE_STRING_FORMAT_EMAIL) == 0)
+
+					if (!printed_flag)
 						{
-							success_flag = (fprintf (printer_p -> pr_out_f, "<li><strong>%s%s</strong>: <a href =\"mailto:%s\">%s</a></li>\n", key_s, req_s, value_s, value_s) > 0);
-							printed_flag = true;
+							success_flag = WriteEscapedHTMLString (printer_p -> pr_out_f, value_s, HE_TEXT);
 						}
-				}
 
-			if (!printed_flag)
-				{
-					success_flag = (fprintf (printer_p -> pr_out_f, "<li><strong>%s%s</strong>: %s</li>\n", key_s, req_s, value_s) > 0);
+					if (success_flag)
+						{
+							success_flag = PrintHTMLListItemEnd (printer_p);
+						}
 				}
 
 		}		/* if (value_s) */
@@ -148,7 +192,7 @@ static bool PrintHTMLInteger (Printer *printer_p, const char *key_s, const json_
 
 	if (value_p)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "<li><strong>%s</strong>: %" JSON_INTEGER_FORMAT "</li>\n", key_s, *value_p) > 0);
+			res = PrintHTMLListItemStart (printer_p, key_s, "") && (fprintf (printer_p -> pr_out_f, "%" JSON_INTEGER_FORMAT, *value_p) > 0) && PrintHTMLListItemEnd (printer_p);
 		}
 	else
 		{
@@ -165,7 +209,7 @@ static bool PrintHTMLNumber (Printer *printer_p, const char *key_s, const double
 
 	if (value_p)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "<li><strong>%s</strong>: %lf</li>\n", key_s, *value_p) > 0);
+			res = PrintHTMLListItemStart (printer_p, key_s, "") && (fprintf (printer_p -> pr_out_f, "%lf", *value_p) > 0) && PrintHTMLListItemEnd (printer_p);
 		}
 	else
 		{
@@ -182,7 +226,7 @@ static bool PrintHTMLBoolean (Printer *printer_p, const char *key_s, const bool
 
 	if (value_p)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "<li><strong>%s</strong>: %s</li>\n", key_s, *value_p ? "true" : "false") > 0);
+			res = PrintHTMLListItemStart (printer_p, key_s, "") && (fputs (*value_p ? "true" : "false", printer_p -> pr_out_f) >= 0) && PrintHTMLListItemEnd (printer_p);
 		}
 	else
 		{
@@ -199,14 +243,42 @@ static bool PrintHTMLJSON (Printer *printer_p, const char *key_s, const json_t *
 
 	if (value_p)
 		{
-			char *json_s = json_dumps (value_p, JSON_INDENT (2));
-
-			if (json_s)
+			if (PrintHTMLListItemStart (printer_p, key_s, ""))
 				{
-					success_flag = (fprintf (printer_p -> pr_out_f, "<li><strong>%s</strong>: %s</li>\n", key_s, json_s) > 0);
+					HTMLJSONWriter writer;
+					bool truncated_flag = false;
 
-					free (json_s);
-				}		/* if (json_s) */
+					writer.hjw_out_f = printer_p -> pr_out_f;
+					writer.hjw_collapse_size = printer_p -> pr_json_collapse_size;
+					writer.hjw_size = 0;
+					writer.hjw_collapsed_flag = false;
+
+					/* Write the value straight to the file rather than building the whole string first */
+					if ((fputs ("<pre>", writer.hjw_out_f) >= 0) && StreamJSONValue (value_p, JSON_INDENT (2) | JSON_ENCODE_ANY, printer_p -> pr_json_max_size, WriteHTMLJSONChunk, &writer, &truncated_flag))
+						{
+							success_flag = true;
+
+							if (truncated_flag)
+								{
+									success_flag = (fputs (" &hellip; <em>(truncated)</em>", writer.hjw_out_f) >= 0);
+								}
+
+							if (success_flag)
+								{
+									success_flag = (fputs ("</pre>", writer.hjw_out_f) >= 0);
+								}
+
+							if (success_flag && (writer.hjw_collapsed_flag))
+								{
+									success_flag = (fputs ("</details>", writer.hjw_out_f) >= 0);
+								}
+
+							if (success_flag)
+								{
+									success_flag = PrintHTMLListItemEnd (printer_p);
+								}
+						}
+				}
 		}
 	else
 		{
@@ -219,7 +291,37 @@ static bool PrintHTMLJSON (Printer *printer_p, const char *key_s, const json_t *
 
 static bool PrintEmptyHTMLValue (Printer *printer_p, const char *key_s)
 {
-	return (fprintf (printer_p -> pr_out_f, "<li><strong>%s</strong>: </li>\n", key_s) > 0);
+	return (PrintHTMLListItemStart (printer_p, key_s, "") && PrintHTMLListItemEnd (printer_p));
+}
+
+
+/*
+ * Print "<li><strong>key</strong>: "
+ */
+static bool PrintHTMLListItemStart (Printer *printer_p, const char *key_s, const char *req_s)
+{
+	FILE *out_f = printer_p -> pr_out_f;
+
+	return ((fputs ("<li><strong>", out_f) >= 0) && WriteEscapedHTMLString (out_f, key_s, HE_TEXT) && (fprintf (out_f, "%s</strong>: ", req_s) > 0));
+}
+
+
+static bool PrintHTMLListItemEnd (Printer *printer_p)
+{
+	return (fputs ("</li>\n", printer_p -> pr_out_f) >= 0);
+}
+
+
+/*
+ * Print a link to value_s, prefixed with scheme_s, with the value
+ * escaped for the href attribute and for the link text.
+ */
+static bool PrintHTMLLink (Printer *printer_p, const char *scheme_s, const char *value_s)
+{
+	FILE *out_f = printer_p -> pr_out_f;
+
+	return ((fprintf (out_f, "<a href =\"%s", scheme_s) > 0) && WriteEscapedHTMLString (out_f, value_s, HE_ATTRIBUTE)
+					&& (fputs ("\">", out_f) >= 0) && WriteEscapedHTMLString (out_f, value_s, HE_TEXT) && (fputs ("</a>", out_f) >= 0));
 }
 
 
@@ -235,15 +337,25 @@ static void FreeHTMLPrinter (Printer *printer_p)
 
 static bool PrintHTMLHeader (Printer *printer_p, const char *title_s, const char *text_s)
 {
+	FILE *out_f = printer_p -> pr_out_f;
 	bool res;
 
-	if (text_s)
+	if (!title_s)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n\t<title>%s</title>\n</head>\n<body><h1>%s</h1>\n<section>%s\n<ul>\n", title_s, title_s, text_s) > 0);
+			title_s = "";
 		}
-	else
+
+	res = (fputs ("<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n\t<title>", out_f) >= 0) && WriteEscapedHTMLString (out_f, title_s, HE_TEXT)
+		&& (fputs ("</title>\n</head>\n<body><h1>", out_f) >= 0) && WriteEscapedHTMLString (out_f, title_s, HE_TEXT) && (fputs ("</h1>\n<section>", out_f) >= 0);
+
+	if (res && text_s)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n\t<title>%s</title>\n</head>\n<body><h1>%s</h1>\n<section>\n<ul>\n", title_s, title_s) > 0);
+			res = WriteEscapedHTMLString (out_f, text_s, HE_TEXT);
+		}
+
+	if (res)
+		{
+			res = (fputs ("\n<ul>\n", out_f) >= 0);
 		}
 
 	return res;
@@ -252,15 +364,16 @@ static bool PrintHTMLHeader (Printer *printer_p, const char *title_s, const char
 
 static bool PrintHTMLFooter (Printer *printer_p, const char *value_s)
 {
+	FILE *out_f = printer_p -> pr_out_f;
 	bool res;
 
 	if (value_s)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "</ul>\n</section>\n<footer>\n%s\n</footer>\n</body>\n</html>\n", value_s) > 0);
+			res = (fputs ("</ul>\n</section>\n<footer>\n", out_f) >= 0) && WriteEscapedHTMLString (out_f, value_s, HE_TEXT) && (fputs ("\n</footer>\n</body>\n</html>\n", out_f) >= 0);
 		}
 	else
 		{
-			res = (fprintf (printer_p -> pr_out_f, "</ul>\n</section></body>\n</html>\n") > 0);
+			res = (fputs ("</ul>\n</section></body>\n</html>\n", out_f) >= 0);
 		}
 
 	return res;
@@ -269,7 +382,8 @@ static bool PrintHTMLFooter (Printer *printer_p, const char *value_s)
 
 static bool PrintHTMLText (Printer *printer_p, const char *value_s)
 {
-	bool res = (fprintf (printer_p -> pr_out_f, "<p>%s</p>\n", value_s) > 0);
+	FILE *out_f = printer_p -> pr_out_f;
+	bool res = (fputs ("<p>", out_f) >= 0) && WriteEscapedHTMLString (out_f, value_s, HE_TEXT) && (fputs ("</p>\n", out_f) >= 0);
 
 	return res;
 }
@@ -277,24 +391,145 @@ static bool PrintHTMLText (Printer *printer_p, const char *value_s)
 
 static bool PrintHTMLSectionStart (Printer *printer_p, const char *value_s)
 {
-	bool res = (fprintf (printer_p -> pr_out_f, "<section><h2>%s</h2>\n", value_s) > 0);
+	FILE *out_f = printer_p -> pr_out_f;
+	bool res = (fputs ("<section><h2>", out_f) >= 0) && WriteEscapedHTMLString (out_f, value_s, HE_TEXT) && (fputs ("</h2>\n", out_f) >= 0);
 
 	return res;
 }
 
 static bool PrintHTMLSectionEnd (Printer *printer_p, const char *value_s)
 {
+	FILE *out_f = printer_p -> pr_out_f;
 	bool res;
 
 	if (value_s)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "%s</section>\n", value_s) > 0);
+			res = WriteEscapedHTMLString (out_f, value_s, HE_TEXT) && (fputs ("</section>\n", out_f) >= 0);
 		}
 	else
 		{
-			res = (fprintf (printer_p -> pr_out_f, "</section>\n") > 0);
+			res = (fputs ("</section>\n", out_f) >= 0);
 		}
 
 	return res;
 }
 
+
+static bool PrintHTMLDocumentStart (Printer *printer_p, const char *title_s)
+{
+	FILE *out_f = printer_p -> pr_out_f;
+
+	return ((fputs ("<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n\t<title>", out_f) >= 0) && WriteEscapedHTMLString (out_f, title_s, HE_TEXT)
+					&& (fputs ("</title>\n</head>\n<body><h1>", out_f) >= 0) && WriteEscapedHTMLString (out_f, title_s, HE_TEXT) && (fputs ("</h1>\n", out_f) >= 0));
+}
+
+
+static bool PrintHTMLContents (Printer *printer_p, const json_t *entries_p)
+{
+	FILE *out_f = printer_p -> pr_out_f;
+	bool success_flag = (fputs ("<nav>\n<h2>Contents</h2>\n<ol>\n", out_f) >= 0);
+	size_t i;
+	const json_t *entry_p;
+
+	json_array_foreach (entries_p, i, entry_p)
+		{
+			const char *title_s = GetJSONString (entry_p, "title");
+			const char *link_s = GetJSONString (entry_p, "link");
+
+			if (success_flag && title_s && link_s)
+				{
+					success_flag = (fputs ("<li><a href=\"", out_f) >= 0) && WriteEscapedHTMLString (out_f, link_s, HE_ATTRIBUTE) && (fputs ("\">", out_f) >= 0)
+						&& WriteEscapedHTMLString (out_f, title_s, HE_TEXT) && (fputs ("</a></li>\n", out_f) >= 0);
+				}
+		}
+
+	if (success_flag)
+		{
+			success_flag = (fputs ("</ol>\n</nav>\n", out_f) >= 0);
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintHTMLResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s)
+{
+	FILE *out_f = printer_p -> pr_out_f;
+
+	return ((fputs ("<section id=\"", out_f) >= 0) && WriteEscapedHTMLString (out_f, anchor_s, HE_ATTRIBUTE) && (fputs ("\"><h2>", out_f) >= 0)
+					&& WriteEscapedHTMLString (out_f, title_s ? title_s : "", HE_TEXT) && (fputs ("</h2>\n<ul>\n", out_f) >= 0));
+}
+
+
+static bool PrintHTMLResourceEnd (Printer *printer_p, const char *text_s)
+{
+	FILE *out_f = printer_p -> pr_out_f;
+	bool res;
+
+	if (text_s)
+		{
+			res = (fputs ("</ul>\n<footer>", out_f) >= 0) && WriteEscapedHTMLString (out_f, text_s, HE_TEXT) && (fputs ("</footer>\n</section>\n", out_f) >= 0);
+		}
+	else
+		{
+			res = (fputs ("</ul>\n</section>\n", out_f) >= 0);
+		}
+
+	return res;
+}
+
+
+static bool PrintHTMLDocumentEnd (Printer *printer_p)
+{
+	return (fputs ("</body>\n</html>\n", printer_p -> pr_out_f) >= 0);
+}
+
+
+/*
+ * Escape each chunk of a JSON value and, once it has got past the collapse
+ * size, put the rest of it in a <details> element starting at a line break
+ * so the value is split at a sensible place. The <pre> that the value is in
+ * is closed first and a new one opened within the <details> as a <details>
+ * element is not allowed inside a <pre>.
+ */
+static bool WriteHTMLJSONChunk (const char *chunk_s, const size_t length, void *data_p)
+{
+	HTMLJSONWriter *writer_p = (HTMLJSONWriter *) data_p;
+	bool success_flag = true;
+	size_t head = length;
+
+	if ((writer_p -> hjw_collapse_size > 0) && (! (writer_p -> hjw_collapsed_flag)) && (writer_p -> hjw_size + length > writer_p -> hjw_collapse_size))
+		{
+			const size_t start = (writer_p -> hjw_size < writer_p -> hjw_collapse_size) ? writer_p -> hjw_collapse_size - writer_p -> hjw_size : 0;
+			const char *break_s = (const char *) memchr (chunk_s + start, '\n', length - start);
+
+			if (break_s)
+				{
+					head = break_s - chunk_s;
+				}
+		}
+
+	if (head > 0)
+		{
+			success_flag = WriteEscapedHTML (writer_p -> hjw_out_f, chunk_s, head, HE_TEXT);
+		}
+
+	if (success_flag && (head < length))
+		{
+			/* Skip the line break itself as it is where the two parts are split */
+			const size_t tail = head + 1;
+
+			success_flag = (fputs ("</pre><details><summary>Show more</summary><pre>", writer_p -> hjw_out_f) >= 0);
+
+			if (success_flag && (tail < length))
+				{
+					success_flag = WriteEscapedHTML (writer_p -> hjw_out_f, chunk_s + tail, length - tail, HE_TEXT);
+				}
+
+			writer_p -> hjw_collapsed_flag = true;
+		}
+
+	writer_p -> hjw_size += length;
+
+	return success_flag;
+}
@@ -0,0 +1,480 @@
+/*
+ * json_printer.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "json_printer.h"
+
+
+/*
+ * The nesting depth of sections within a resource
+ */
+#define JP_MAX_DEPTH (64)
+
+
+typedef struct
+{
+	Printer jp_printer;
+
+	/* The number of open objects and arrays below the top-level resource object */
+	size_t jp_depth;
+
+	/* Whether anything has been written at each depth yet, so we know when to add a comma */
+	bool jp_empty_flags [JP_MAX_DEPTH];
+
+	/* Whether each depth is an array rather than an object */
+	bool jp_array_flags [JP_MAX_DEPTH];
+} JSONPrinter;
+
+
+/*
+ * static declarations
+ */
+
+static bool PrintJSONHeader (Printer *printer_p, const char *title_s, const char *text_s);
+
+static bool PrintJSONFooter (Printer *printer_p, const char *text_s);
+
+static bool PrintJSONText (Printer *printer_p, const char *value_s);
+
+static bool PrintJSONString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s);
+
+static bool PrintJSONInteger (Printer *printer_p, const char *key_s, const json_int_t *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintJSONNumber (Printer *printer_p, const char *key_s, const double *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintJSONBoolean (Printer *printer_p, const char *key_s, const bool *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintJSONValue (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s);
+
+static void FreeJSONPrinter (Printer *printer_p);
+
+static bool PrintJSONSectionStart (Printer *printer_p, const char *value_s);
+
+static bool PrintJSONSectionEnd (Printer *printer_p, const char *value_s);
+
+static bool PrintJSONEntryStart (Printer *printer_p);
+
+static bool PrintJSONEntryEnd (Printer *printer_p);
+
+static bool PrintJSONObjectStart (Printer *printer_p, const char *key_s, const char *title_s);
+
+static bool PrintJSONObjectEnd (Printer *printer_p);
+
+static bool WriteJSONKey (JSONPrinter *printer_p, const char *key_s);
+
+static bool WriteJSONString (FILE *out_f, const char *value_s);
+
+static bool OpenJSONLevel (JSONPrinter *printer_p, const char *key_s, const bool array_flag);
+
+static bool CloseJSONLevel (JSONPrinter *printer_p);
+
+
+/*
+ * api definitions
+ */
+
+Printer *AllocateJSONPrinter (void)
+{
+	JSONPrinter *printer_p = (JSONPrinter *) malloc (sizeof (JSONPrinter));
+
+	if (printer_p)
+		{
+			InitFDPrinter (& (printer_p -> jp_printer), PrintJSONHeader, PrintJSONFooter, PrintJSONText,
+										 PrintJSONSectionStart, PrintJSONSectionEnd, PrintJSONString,
+										 PrintJSONInteger, PrintJSONNumber, PrintJSONBoolean, PrintJSONValue, FreeJSONPrinter);
+
+			SetFDPrinterEntryFunctions (& (printer_p -> jp_printer), PrintJSONEntryStart, PrintJSONEntryEnd);
+			SetFDPrinterObjectFunctions (& (printer_p -> jp_printer), PrintJSONObjectStart, PrintJSONObjectEnd);
+
+			printer_p -> jp_depth = 0;
+
+			return (& (printer_p -> jp_printer));
+		}
+
+	return NULL;
+}
+
+
+/*
+ * static definitions
+ */
+
+static bool PrintJSONHeader (Printer *printer_p, const char *title_s, const char *text_s)
+{
+	JSONPrinter *json_printer_p = (JSONPrinter *) printer_p;
+	FILE *out_f = printer_p -> pr_out_f;
+	bool success_flag = false;
+
+	json_printer_p -> jp_depth = 0;
+
+	if (fputs ("{\"name\":", out_f) >= 0)
+		{
+			if (title_s ? WriteJSONString (out_f, title_s) : (fputs ("null", out_f) >= 0))
+				{
+					success_flag = true;
+
+					if (text_s)
+						{
+							success_flag = (fputs (",\"text\":", out_f) >= 0) && WriteJSONString (out_f, text_s);
+						}
+
+					if (success_flag)
+						{
+							/* the properties are the first level */
+							json_printer_p -> jp_empty_flags [0] = false;
+							json_printer_p -> jp_array_flags [0] = false;
+							json_printer_p -> jp_depth = 1;
+
+							success_flag = OpenJSONLevel (json_printer_p, "properties", false);
+						}
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintJSONFooter (Printer *printer_p, const char *text_s)
+{
+	JSONPrinter *json_printer_p = (JSONPrinter *) printer_p;
+	FILE *out_f = printer_p -> pr_out_f;
+	bool success_flag = true;
+
+	/* Close anything left open, including the properties */
+	while ((json_printer_p -> jp_depth > 1) && success_flag)
+		{
+			success_flag = CloseJSONLevel (json_printer_p);
+		}
+
+	if (success_flag)
+		{
+			if (text_s)
+				{
+					success_flag = (fputs (",\"footer\":", out_f) >= 0) && WriteJSONString (out_f, text_s);
+				}
+
+			if (success_flag)
+				{
+					success_flag = (fputs ("}\n", out_f) >= 0);
+				}
+		}
+
+	json_printer_p -> jp_depth = 0;
+
+	return success_flag;
+}
+
+
+static bool PrintJSONText (Printer *printer_p, const char *value_s)
+{
+	JSONPrinter *json_printer_p = (JSONPrinter *) printer_p;
+
+	return (WriteJSONKey (json_printer_p, "text") && WriteJSONString (printer_p -> pr_out_f, value_s));
+}
+
+
+static bool PrintJSONString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s)
+{
+	bool success_flag = false;
+
+	if (WriteJSONKey ((JSONPrinter *) printer_p, key_s))
+		{
+			success_flag = value_s ? WriteJSONString (printer_p -> pr_out_f, value_s) : (fputs ("null", printer_p -> pr_out_f) >= 0);
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintJSONInteger (Printer *printer_p, const char *key_s, const json_int_t *value_p, const bool required_flag, const char *format_s)
+{
+	bool success_flag = false;
+
+	if (WriteJSONKey ((JSONPrinter *) printer_p, key_s))
+		{
+			if (value_p)
+				{
+					success_flag = (fprintf (printer_p -> pr_out_f, "%" JSON_INTEGER_FORMAT, *value_p) > 0);
+				}
+			else
+				{
+					success_flag = (fputs ("null", printer_p -> pr_out_f) >= 0);
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintJSONNumber (Printer *printer_p, const char *key_s, const double *value_p, const bool required_flag, const char *format_s)
+{
+	bool success_flag = false;
+
+	if (WriteJSONKey ((JSONPrinter *) printer_p, key_s))
+		{
+			/* JSON has no representation of infinities or NaNs */
+			if ((value_p) && (isfinite (*value_p)))
+				{
+					char buffer_s [32];
+
+					/* Use the shortest representation that reads back as the same value */
+					snprintf (buffer_s, sizeof (buffer_s), "%.15g", *value_p);
+
+					if (strtod (buffer_s, NULL) != *value_p)
+						{
+							snprintf (buffer_s, sizeof (buffer_s), "%.17g", *value_p);
+						}
+
+					success_flag = (fputs (buffer_s, printer_p -> pr_out_f) >= 0);
+				}
+			else
+				{
+					success_flag = (fputs ("null", printer_p -> pr_out_f) >= 0);
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintJSONBoolean (Printer *printer_p, const char *key_s, const bool *value_p, const bool required_flag, const char *format_s)
+{
+	bool success_flag = false;
+
+	if (WriteJSONKey ((JSONPrinter *) printer_p, key_s))
+		{
+			success_flag = (fputs (value_p ? (*value_p ? "true" : "false") : "null", printer_p -> pr_out_f) >= 0);
+		}
+
+	return success_flag;
+}
+
+
+static bool PrintJSONValue (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s)
+{
+	bool success_flag = false;
+
+	if (WriteJSONKey ((JSONPrinter *) printer_p, key_s))
+		{
+			if (value_p)
+				{
+					/* jansson writes this straight to the file */
+					success_flag = (json_dumpf (value_p, printer_p -> pr_out_f, JSON_COMPACT | JSON_ENCODE_ANY) == 0);
+				}
+			else
+				{
+					success_flag = (fputs ("null", printer_p -> pr_out_f) >= 0);
+				}
+		}
+
+	return success_flag;
+}
+
+
+static void FreeJSONPrinter (Printer *printer_p)
+{
+	JSONPrinter *json_printer_p = (JSONPrinter *) printer_p;
+
+	free (json_printer_p);
+}
+
+
+static bool PrintJSONSectionStart (Printer *printer_p, const char *value_s)
+{
+	return OpenJSONLevel ((JSONPrinter *) printer_p, value_s, true);
+}
+
+
+static bool PrintJSONSectionEnd (Printer *printer_p, const char *value_s)
+{
+	return CloseJSONLevel ((JSONPrinter *) printer_p);
+}
+
+
+static bool PrintJSONEntryStart (Printer *printer_p)
+{
+	return OpenJSONLevel ((JSONPrinter *) printer_p, NULL, false);
+}
+
+
+static bool PrintJSONEntryEnd (Printer *printer_p)
+{
+	return CloseJSONLevel ((JSONPrinter *) printer_p);
+}
+
+
+/*
+ * An object-typed value is written under its key rather than its title
+ * so that the output has the same shape as the data.
+ */
+static bool PrintJSONObjectStart (Printer *printer_p, const char *key_s, const char *title_s)
+{
+	return OpenJSONLevel ((JSONPrinter *) printer_p, key_s, false);
+}
+
+
+static bool PrintJSONObjectEnd (Printer *printer_p)
+{
+	return CloseJSONLevel ((JSONPrinter *) printer_p);
+}
+
+
+/*
+ * Write the separator and, if the current level is an object, the key.
+ */
+static bool WriteJSONKey (JSONPrinter *printer_p, const char *key_s)
+{
+	bool success_flag = false;
+
+	if (printer_p -> jp_depth > 0)
+		{
+			FILE *out_f = printer_p -> jp_printer.pr_out_f;
+			const size_t i = printer_p -> jp_depth - 1;
+
+			if ((printer_p -> jp_empty_flags [i]) || (fputc (',', out_f) != EOF))
+				{
+					printer_p -> jp_empty_flags [i] = false;
+
+					if (printer_p -> jp_array_flags [i])
+						{
+							success_flag = true;
+						}
+					else
+						{
+							success_flag = WriteJSONString (out_f, key_s ? key_s : "") && (fputc (':', out_f) != EOF);
+						}
+				}
+		}
+	else
+		{
+			fprintf (stderr, "Cannot print \"%s\" before the JSON header\n", key_s ? key_s : "");
+		}
+
+	return success_flag;
+}
+
+
+static bool OpenJSONLevel (JSONPrinter *printer_p, const char *key_s, const bool array_flag)
+{
+	bool success_flag = false;
+
+	if (printer_p -> jp_depth < JP_MAX_DEPTH)
+		{
+			if (WriteJSONKey (printer_p, key_s))
+				{
+					if (fputc (array_flag ? '[' : '{', printer_p -> jp_printer.pr_out_f) != EOF)
+						{
+							printer_p -> jp_empty_flags [printer_p -> jp_depth] = true;
+							printer_p -> jp_array_flags [printer_p -> jp_depth] = array_flag;
+							++ (printer_p -> jp_depth);
+
+							success_flag = true;
+						}
+				}
+		}
+	else
+		{
+			fprintf (stderr, "Sections are nested too deeply for the JSON printer, the limit is %d\n", JP_MAX_DEPTH);
+		}
+
+	return success_flag;
+}
+
+
+static bool CloseJSONLevel (JSONPrinter *printer_p)
+{
+	bool success_flag = false;
+
+	/* the top-level resource object is only closed by the footer */
+	if (printer_p -> jp_depth > 1)
+		{
+			-- (printer_p -> jp_depth);
+
+			success_flag = (fputc (printer_p -> jp_array_flags [printer_p -> jp_depth] ? ']' : '}', printer_p -> jp_printer.pr_out_f) != EOF);
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Write the string with any quotes, backslashes and control characters
+ * escaped, copying the runs of characters that don't need escaping in
+ * one go.
+ */
+static bool WriteJSONString (FILE *out_f, const char *value_s)
+{
+	const char *run_s = value_s;
+	const char *c_p = value_s;
+	bool success_flag = (fputc ('"', out_f) != EOF);
+
+	while (success_flag && *c_p)
+		{
+			const unsigned char c = (unsigned char) *c_p;
+
+			if ((c < 0x20) || (c == '"') || (c == '\\'))
+				{
+					char escape_s [8];
+
+					if (c_p > run_s)
+						{
+							success_flag = (fwrite (run_s, 1, c_p - run_s, out_f) == (size_t) (c_p - run_s));
+						}
+
+					switch (c)
+						{
+							case '"':
+								strcpy (escape_s, "\\\"");
+								break;
+
+							case '\\':
+								strcpy (escape_s, "\\\\");
+								break;
+
+							case '\n':
+								strcpy (escape_s, "\\n");
+								break;
+
+							case '\r':
+								strcpy (escape_s, "\\r");
+								break;
+
+							case '\t':
+								strcpy (escape_s, "\\t");
+								break;
+
+							default:
+								snprintf (escape_s, sizeof (escape_s), "\\u%04x", c);
+								break;
+						}
+
+					if (success_flag)
+						{
+							success_flag = (fputs (escape_s, out_f) >= 0);
+						}
+
+					run_s = c_p + 1;
+				}
+
+			++ c_p;
+		}
+
+	if (success_flag && (c_p > run_s))
+		{
+			success_flag = (fwrite (run_s, 1, c_p - run_s, out_f) == (size_t) (c_p - run_s));
+		}
+
+	if (success_flag)
+		{
+			success_flag = (fputc ('"', out_f) != EOF);
+		}
+
+	return success_flag;
+}
@@ -0,0 +1,185 @@
+/*
+ * key_table.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+
+#include "key_table.h"
+#include "parallel_tasks.h"
+
+#include "frictionless_data_util.h"
+
+#include "json_util.h"
+
+
+struct KeyTable
+{
+	/** The IDs of the keys, keyed by the keys themselves */
+	json_t *kt_ids_p;
+
+	/**
+	 * The keys in the order that they were added so that each one's
+	 * ID is its index. Each key's string is never moved once it has
+	 * been added, even when the array grows.
+	 */
+	json_t *kt_keys_p;
+
+	TaskLock *kt_lock_p;
+};
+
+
+/* These are in the same order as the PredefinedKeys */
+static const char * const S_PREDEFINED_KEYS_SS [KI_NUM_PREDEFINED_KEYS] =
+{
+	FD_NAME_S,
+	FD_TITLE_S,
+	FD_PROFILE_S,
+	FD_SCHEMA_S,
+	FD_DATA_S,
+	FD_RESOURCES_S,
+	FD_TABLE_FIELDS_S,
+	FD_TABLE_FIELD_TYPE,
+	FD_TABLE_FIELD_FORMAT
+};
+
+
+/*
+ * static declarations
+ */
+
+static const char *AddKey (KeyTable *table_p, const char *key_s, KeyID *id_p);
+
+
+/*
+ * api definitions
+ */
+
+KeyTable *AllocateKeyTable (void)
+{
+	KeyTable *table_p = (KeyTable *) malloc (sizeof (KeyTable));
+
+	if (table_p)
+		{
+			table_p -> kt_ids_p = json_object ();
+			table_p -> kt_keys_p = json_array ();
+			table_p -> kt_lock_p = AllocateTaskLock ();
+
+			if ((table_p -> kt_ids_p) && (table_p -> kt_keys_p) && (table_p -> kt_lock_p))
+				{
+					size_t i;
+
+					for (i = 0; i < KI_NUM_PREDEFINED_KEYS; ++ i)
+						{
+							KeyID id;
+
+							if (!AddKey (table_p, S_PREDEFINED_KEYS_SS [i], &id))
+								{
+									break;
+								}
+						}
+
+					if (i == KI_NUM_PREDEFINED_KEYS)
+						{
+							return table_p;
+						}
+				}
+
+			FreeKeyTable (table_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeKeyTable (KeyTable *table_p)
+{
+	if (table_p -> kt_ids_p)
+		{
+			json_decref (table_p -> kt_ids_p);
+		}
+
+	if (table_p -> kt_keys_p)
+		{
+			json_decref (table_p -> kt_keys_p);
+		}
+
+	if (table_p -> kt_lock_p)
+		{
+			FreeTaskLock (table_p -> kt_lock_p);
+		}
+
+	free (table_p);
+}
+
+
+const char *InternKey (KeyTable *table_p, const char *key_s, KeyID *id_p)
+{
+	const char *interned_key_s = NULL;
+	json_int_t id;
+
+	AcquireTaskLock (table_p -> kt_lock_p);
+
+	if (GetJSONInteger (table_p -> kt_ids_p, key_s, &id))
+		{
+			interned_key_s = json_string_value (json_array_get (table_p -> kt_keys_p, (size_t) id));
+			*id_p = (KeyID) id;
+		}
+	else
+		{
+			interned_key_s = AddKey (table_p, key_s, id_p);
+		}
+
+	ReleaseTaskLock (table_p -> kt_lock_p);
+
+	return interned_key_s;
+}
+
+
+size_t GetNumInternedKeys (KeyTable *table_p)
+{
+	size_t num_keys;
+
+	AcquireTaskLock (table_p -> kt_lock_p);
+	num_keys = json_array_size (table_p -> kt_keys_p);
+	ReleaseTaskLock (table_p -> kt_lock_p);
+
+	return num_keys;
+}
+
+
+/*
+ * static definitions
+ */
+
+/*
+ * Add a key that isn't in the table yet. This must be
+ * called with the table's lock held.
+ */
+static const char *AddKey (KeyTable *table_p, const char *key_s, KeyID *id_p)
+{
+	const KeyID id = (KeyID) json_array_size (table_p -> kt_keys_p);
+	json_t *key_p = json_string (key_s);
+
+	if (key_p)
+		{
+			if (json_array_append_new (table_p -> kt_keys_p, key_p) == 0)
+				{
+					if (json_object_set_new (table_p -> kt_ids_p, key_s, json_integer (id)) == 0)
+						{
+							*id_p = id;
+							return json_string_value (key_p);
+						}
+
+					json_array_remove (table_p -> kt_keys_p, id);
+				}
+			else
+				{
+					json_decref (key_p);
+				}
+		}
+
+	return NULL;
+}
@@ -0,0 +1,190 @@
+/*
+ * latency_histogram.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+
+#include "latency_histogram.h"
+
+
+/*
+ * Values below 2 ^ S_SUB_BUCKET_BITS each get their own bucket.
+ * Above that, each power of two gets S_HALF_COUNT buckets.
+ */
+#define S_SUB_BUCKET_BITS (7)
+#define S_SUB_BUCKET_COUNT (1 << S_SUB_BUCKET_BITS)
+#define S_HALF_COUNT (S_SUB_BUCKET_COUNT >> 1)
+
+#define S_NUM_BUCKETS (S_SUB_BUCKET_COUNT + ((64 - S_SUB_BUCKET_BITS) * S_HALF_COUNT))
+
+
+/*
+ * static declarations
+ */
+
+static size_t GetBucketIndex (const uint64_t value);
+
+static uint64_t GetBucketHighestValue (const size_t index);
+
+static int GetHighestBit (uint64_t value);
+
+
+/*
+ * api definitions
+ */
+
+LatencyHistogram *AllocateLatencyHistogram (void)
+{
+	LatencyHistogram *histogram_p = (LatencyHistogram *) malloc (sizeof (LatencyHistogram));
+
+	if (histogram_p)
+		{
+			histogram_p -> lh_counts_p = (uint64_t *) calloc (S_NUM_BUCKETS, sizeof (uint64_t));
+
+			if (histogram_p -> lh_counts_p)
+				{
+					histogram_p -> lh_num_buckets = S_NUM_BUCKETS;
+					histogram_p -> lh_total_count = 0;
+					histogram_p -> lh_min = UINT64_MAX;
+					histogram_p -> lh_max = 0;
+					histogram_p -> lh_sum = 0.0;
+
+					return histogram_p;
+				}
+
+			free (histogram_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeLatencyHistogram (LatencyHistogram *histogram_p)
+{
+	free (histogram_p -> lh_counts_p);
+	free (histogram_p);
+}
+
+
+void AddLatencyHistogramValue (LatencyHistogram *histogram_p, const uint64_t value)
+{
+	++ (histogram_p -> lh_counts_p [GetBucketIndex (value)]);
+	++ (histogram_p -> lh_total_count);
+
+	histogram_p -> lh_sum += (double) value;
+
+	if (value < histogram_p -> lh_min)
+		{
+			histogram_p -> lh_min = value;
+		}
+
+	if (value > histogram_p -> lh_max)
+		{
+			histogram_p -> lh_max = value;
+		}
+}
+
+
+uint64_t GetLatencyHistogramPercentile (const LatencyHistogram *histogram_p, const double percentile)
+{
+	uint64_t value = 0;
+
+	if (histogram_p -> lh_total_count > 0)
+		{
+			const double fraction = (percentile < 0.0) ? 0.0 : ((percentile > 100.0) ? 1.0 : (percentile / 100.0));
+			const double exact_rank = fraction * (double) (histogram_p -> lh_total_count);
+			uint64_t rank = (uint64_t) exact_rank;
+			uint64_t count = 0;
+			size_t i;
+
+			/* round up, and the lowest rank is the first value */
+			if ((rank == 0) || ((double) rank < exact_rank))
+				{
+					++ rank;
+				}
+
+			for (i = 0; i < histogram_p -> lh_num_buckets; ++ i)
+				{
+					count += histogram_p -> lh_counts_p [i];
+
+					if (count >= rank)
+						{
+							value = GetBucketHighestValue (i);
+							break;
+						}
+				}
+
+			/* The bucket may extend past anything that was actually recorded */
+			if (value > histogram_p -> lh_max)
+				{
+					value = histogram_p -> lh_max;
+				}
+		}
+
+	return value;
+}
+
+
+/*
+ * static definitions
+ */
+
+static size_t GetBucketIndex (const uint64_t value)
+{
+	size_t index;
+
+	if (value < S_SUB_BUCKET_COUNT)
+		{
+			index = (size_t) value;
+		}
+	else
+		{
+			/* the top S_SUB_BUCKET_BITS - 1 bits after the leading one select the sub-bucket */
+			const int magnitude = GetHighestBit (value);
+			const int shift = magnitude - (S_SUB_BUCKET_BITS - 1);
+			const size_t sub_bucket = (size_t) (value >> shift) - S_HALF_COUNT;
+
+			index = S_SUB_BUCKET_COUNT + ((size_t) (magnitude - S_SUB_BUCKET_BITS) * S_HALF_COUNT) + sub_bucket;
+		}
+
+	return index;
+}
+
+
+static uint64_t GetBucketHighestValue (const size_t index)
+{
+	uint64_t value;
+
+	if (index < S_SUB_BUCKET_COUNT)
+		{
+			value = (uint64_t) index;
+		}
+	else
+		{
+			const size_t offset = index - S_SUB_BUCKET_COUNT;
+			const int magnitude = (int) (offset / S_HALF_COUNT) + S_SUB_BUCKET_BITS;
+			const int shift = magnitude - (S_SUB_BUCKET_BITS - 1);
+			const uint64_t sub_bucket = (uint64_t) (offset % S_HALF_COUNT) + S_HALF_COUNT;
+
+			value = ((sub_bucket + 1) << shift) - 1;
+		}
+
+	return value;
+}
+
+
+static int GetHighestBit (uint64_t value)
+{
+	int bit = -1;
+
+	while (value)
+		{
+			value >>= 1;
+			++ bit;
+		}
+
+	return bit;
+}
@@ -7,20 +7,82 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "markdown_printer.h"
 
 #include "json_util.h"
+#include "byte_buffer.h"
 
 #include "frictionless_data_util.h"
 
 
+/*
+ * A row of a table, the offsets and lengths are within the
+ * printer's buffer and the widths are in characters.
+ */
+typedef struct
+{
+	size_t mr_key_start;
+	size_t mr_key_length;
+	size_t mr_key_width;
+	size_t mr_value_start;
+	size_t mr_value_length;
+	size_t mr_value_width;
+} MarkdownRow;
+
+
 typedef struct
 {
 	Printer mp_printer;
+
+	/** Write the properties as GitHub Flavored Markdown tables rather than lists */
+	bool mp_tables_flag;
+
+	/**
+	 * The escaped rows of the current section are collected here and
+	 * written in one go when the section changes. This is reused for
+	 * each section.
+	 */
+	ByteBuffer *mp_buffer_p;
+
+	/* The rows within mp_buffer_p when writing tables */
+	MarkdownRow *mp_rows_p;
+	size_t mp_num_rows;
+	size_t mp_rows_capacity;
+
+	/* The widths of the table columns */
+	size_t mp_key_width;
+	size_t mp_value_width;
 } MarkdownPrinter;
 
 
+/*
+ * The state for streaming a JSON value into the buffer or, if
+ * mjw_out_f is set, straight to the output file.
+ */
+typedef struct
+{
+	ByteBuffer *mjw_buffer_p;
+	FILE *mjw_out_f;
+	char mjw_separator;
+	const char *mjw_replacement_s;
+} MarkdownJSONWriter;
+
+
+/*
+ * The characters that have a meaning in Markdown or in GFM tables
+ * and so get escaped within keys and values.
+ */
+static const char * const S_MARKDOWN_SPECIAL_CHARS_S = "\\`*_[]<>|&#~\r\n";
+
+static const char * const S_KEY_COLUMN_HEADING_S = "Property";
+
+static const char * const S_VALUE_COLUMN_HEADING_S = "Value";
+
+static const size_t S_INITIAL_BUFFER_SIZE = 4096;
+
+
 /*
  * static declarations
  */
@@ -50,6 +112,38 @@ static bool PrintMarkdownSectionStart (Printer *printer_p, const char *value_s);
 
 static bool PrintMarkdownSectionEnd (Printer *printer_p, const char *value_s);
 
+static bool PrintMarkdownEntryBoundary (Printer *printer_p);
+
+static bool PrintMarkdownDocumentStart (Printer *printer_p, const char *title_s);
+
+static bool PrintMarkdownContents (Printer *printer_p, const json_t *entries_p);
+
+static bool PrintMarkdownResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s);
+
+static bool PrintMarkdownResourceEnd (Printer *printer_p, const char *text_s);
+
+static bool PrintMarkdownDocumentEnd (Printer *printer_p);
+
+
+static bool StartMarkdownRow (MarkdownPrinter *printer_p, const char *key_s, const char *req_s, const bool inline_flag);
+
+static bool EndMarkdownRow (MarkdownPrinter *printer_p);
+
+static bool FlushMarkdownRows (MarkdownPrinter *printer_p);
+
+static bool AppendEscapedMarkdown (MarkdownPrinter *printer_p, const char *value_s);
+
+static bool AppendMarkdownLink (MarkdownPrinter *printer_p, const char *scheme_s, const char *value_s, const char *text_s);
+
+static bool WriteEscapedMarkdown (MarkdownPrinter *printer_p, const char *value_s);
+
+static bool AppendMarkdownJSONChunk (const char *chunk_s, const size_t length, void *data_p);
+
+static bool WriteMarkdownJSON (MarkdownJSONWriter *writer_p, const char *value_s, const size_t length);
+
+static bool WritePadding (FILE *out_f, const char c, size_t count);
+
+static size_t GetDisplayWidth (const char *value_s, const size_t length);
 
 
 /*
@@ -57,17 +151,35 @@ static bool PrintMarkdownSectionEnd (Printer *printer_p, const char *value_s);
  */
 
 
-Printer *AllocateMarkdownPrinter (void)
+Printer *AllocateMarkdownPrinter (const bool tables_flag)
 {
 	MarkdownPrinter *printer_p = (MarkdownPrinter *) malloc (sizeof (MarkdownPrinter));
 
 	if (printer_p)
 		{
-			InitFDPrinter (& (printer_p -> mp_printer), PrintMarkdownHeader, PrintMarkdownFooter, PrintMarkdownText,
-										 PrintMarkdownSectionStart, PrintMarkdownSectionEnd, PrintMarkdownString,
-									 PrintMarkdownInteger, PrintMarkdownNumber, PrintMarkdownBoolean, PrintMarkdownJSON,  FreeMarkdownPrinter);
+			printer_p -> mp_buffer_p = AllocateByteBuffer (S_INITIAL_BUFFER_SIZE);
 
-			return (& (printer_p -> mp_printer));
+			if (printer_p -> mp_buffer_p)
+				{
+					InitFDPrinter (& (printer_p -> mp_printer), PrintMarkdownHeader, PrintMarkdownFooter, PrintMarkdownText,
+												 PrintMarkdownSectionStart, PrintMarkdownSectionEnd, PrintMarkdownString,
+											 PrintMarkdownInteger, PrintMarkdownNumber, PrintMarkdownBoolean, PrintMarkdownJSON,  FreeMarkdownPrinter);
+
+					SetFDPrinterEntryFunctions (& (printer_p -> mp_printer), PrintMarkdownEntryBoundary, PrintMarkdownEntryBoundary);
+					SetFDPrinterDocumentFunctions (& (printer_p -> mp_printer), PrintMarkdownDocumentStart, PrintMarkdownContents, PrintMarkdownResourceStart,
+																				 PrintMarkdownResourceEnd, PrintMarkdownDocumentEnd);
+
+					printer_p -> mp_tables_flag = tables_flag;
+					printer_p -> mp_rows_p = NULL;
+					printer_p -> mp_num_rows = 0;
+					printer_p -> mp_rows_capacity = 0;
+					printer_p -> mp_key_width = strlen (S_KEY_COLUMN_HEADING_S);
+					printer_p -> mp_value_width = strlen (S_VALUE_COLUMN_HEADING_S);
+
+					return (& (printer_p -> mp_printer));
+				}
+
+			free (printer_p);
 		}
 
 	return NULL;
@@ -78,9 +190,9 @@ Printer *AllocateMarkdownPrinter (void)
  * static definitions
  */
 
-
 static bool PrintMarkdownString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s)
 {
+	MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
 	bool success_flag = false;
 	const char *req_s = "";
 
@@ -91,25 +203,33 @@ static bool PrintMarkdownString (Printer *printer_p, const char *key_s, const ch
 
 	if (value_s)
 		{
-			bool printed_flag = false;
-
-			if (format_s)
+			if (StartMarkdownRow (md_printer_p, key_s, req_s, true))
 				{
-					if (strcmp (format_s, FD_TYPE_STRING_FORMAT_URI) == 0)
+					bool printed_flag = false;
+
+					if (format_s)
 						{
-							success_flag = (fprintf (printer_p -> pr_out_f, " * **%s**%s: [%s](%s)\n", key_s, req_s, value_s, value_s) > 0);
-							printed_flag = true;
+							if (strcmp (format_s, FD_TYPE_STRING_FORMAT_URI) == 0)
+								{
+									success_flag = AppendMarkdownLink (md_printer_p, "", value_s, value_s);
+									printed_flag = true;
+								}
+							else if (strcmp (format_s, FD_TYPE_STRING_FORMAT_EMAIL) == 0)
+								{
+									success_flag = AppendMarkdownLink (md_printer_p, "mailto:", value_s, value_s);
+									printed_flag = true;
+								}
 						}
-					else if (strcmp (format_s, FD_TYPE_STRING_FORMAT_EMAIL) == 0)
+
+					if (!printed_flag)
 						{
-							success_flag = (fprintf (printer_p -> pr_out_f, " * **%s**%s: [%s](mailto:%s)\n", key_s, req_s, value_s, value_s) > 0);
-							printed_flag = true;
+							success_flag = AppendEscapedMarkdown (md_printer_p, value_s);
 						}
-				}
 
-			if (!printed_flag)
-				{
-					success_flag = (fprintf (printer_p -> pr_out_f, " * **%s**%s: %s\n", key_s, req_s, value_s) > 0);
+					if (success_flag)
+						{
+							success_flag = EndMarkdownRow (md_printer_p);
+						}
 				}
 
 		}		/* if (value_s) */
@@ -130,7 +250,12 @@ static bool PrintMarkdownInteger (Printer *printer_p, const char *key_s, const j
 
 	if (value_p)
 		{
-			res = (fprintf (printer_p -> pr_out_f, " * **%s**: %" JSON_INTEGER_FORMAT "\n", key_s, *value_p) > 0);
+			MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+			char buffer_s [32];
+
+			snprintf (buffer_s, sizeof (buffer_s), "%" JSON_INTEGER_FORMAT, *value_p);
+
+			res = StartMarkdownRow (md_printer_p, key_s, "", true) && AppendStringToByteBuffer (md_printer_p -> mp_buffer_p, buffer_s) && EndMarkdownRow (md_printer_p);
 		}
 	else
 		{
@@ -147,7 +272,12 @@ static bool PrintMarkdownNumber (Printer *printer_p, const char *key_s, const do
 
 	if (value_p)
 		{
-			res = (fprintf (printer_p -> pr_out_f, " * **%s**: %lf\n", key_s, *value_p) > 0);
+			MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+			char buffer_s [64];
+
+			snprintf (buffer_s, sizeof (buffer_s), "%lf", *value_p);
+
+			res = StartMarkdownRow (md_printer_p, key_s, "", true) && AppendStringToByteBuffer (md_printer_p -> mp_buffer_p, buffer_s) && EndMarkdownRow (md_printer_p);
 		}
 	else
 		{
@@ -164,7 +294,9 @@ static bool PrintMarkdownBoolean (Printer *printer_p, const char *key_s, const b
 
 	if (value_p)
 		{
-			res = (fprintf (printer_p -> pr_out_f, " * **%s**: %s\n", key_s, *value_p ? "true" : "false") > 0);
+			MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+
+			res = StartMarkdownRow (md_printer_p, key_s, "", true) && AppendStringToByteBuffer (md_printer_p -> mp_buffer_p, *value_p ? "true" : "false") && EndMarkdownRow (md_printer_p);
 		}
 	else
 		{
@@ -175,20 +307,65 @@ static bool PrintMarkdownBoolean (Printer *printer_p, const char *key_s, const b
 }
 
 
+/*
+ * In lists, the JSON goes in a fenced code block indented to stay within
+ * the list item. Tables can't contain blocks so the compact JSON goes in
+ * a code span instead with any pipes escaped, which GFM allows within
+ * code spans in tables.
+ */
 static bool PrintMarkdownJSON (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s)
 {
 	bool success_flag = false;
 
 	if (value_p)
 		{
-			char *json_s = json_dumps (value_p, JSON_INDENT (2));
+			MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+			const bool tables_flag = md_printer_p -> mp_tables_flag;
 
-			if (json_s)
+			if (StartMarkdownRow (md_printer_p, key_s, "", tables_flag))
 				{
-					success_flag = (fprintf (printer_p -> pr_out_f, " * **%s**: ```json{%s}\n", key_s, json_s) > 0);
+					MarkdownJSONWriter writer;
+					bool truncated_flag = false;
+
+					writer.mjw_buffer_p = md_printer_p -> mp_buffer_p;
+					writer.mjw_out_f = NULL;
+					writer.mjw_separator = tables_flag ? '|' : '\n';
+					writer.mjw_replacement_s = tables_flag ? "\\|" : "\n   ";
+
+					success_flag = AppendStringToByteBuffer (writer.mjw_buffer_p, tables_flag ? "`` " : "\n   ```json\n   ");
+
+					/*
+					 * A list item is written out in order so, rather than holding
+					 * the whole value in the buffer, write what is already there
+					 * and then send the value straight to the file.
+					 */
+					if (success_flag && (!tables_flag))
+						{
+							success_flag = FlushMarkdownRows (md_printer_p);
+							writer.mjw_out_f = printer_p -> pr_out_f;
+						}
 
-					free (json_s);
-				}		/* if (json_s) */
+					if (success_flag)
+						{
+							success_flag = false;
+
+							/* Serialise the value straight into the row rather than building the whole string first */
+							if (StreamJSONValue (value_p, tables_flag ? (JSON_COMPACT | JSON_ENCODE_ANY) : (JSON_INDENT (2) | JSON_ENCODE_ANY), printer_p -> pr_json_max_size, AppendMarkdownJSONChunk, &writer, &truncated_flag))
+								{
+									success_flag = AppendStringToByteBuffer (writer.mjw_buffer_p, tables_flag ? " ``" : "\n   ```");
+
+									if (success_flag && truncated_flag)
+										{
+											success_flag = AppendStringToByteBuffer (writer.mjw_buffer_p, tables_flag ? " *(truncated)*" : "\n\n   *(truncated)*");
+										}
+
+									if (success_flag)
+										{
+											success_flag = EndMarkdownRow (md_printer_p);
+										}
+								}
+						}
+				}
 		}
 	else
 		{
@@ -201,7 +378,9 @@ static bool PrintMarkdownJSON (Printer *printer_p, const char *key_s, const json
 
 static bool PrintEmptyMarkdownValue (Printer *printer_p, const char *key_s)
 {
-	return (fprintf (printer_p -> pr_out_f, " * **%s**:\n", key_s) > 0);
+	MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+
+	return (StartMarkdownRow (md_printer_p, key_s, "", false) && EndMarkdownRow (md_printer_p));
 }
 
 
@@ -211,21 +390,31 @@ static void FreeMarkdownPrinter (Printer *printer_p)
 
 //ClosePrinter (printer_p);
 
+	FreeByteBuffer (markdown_printer_p -> mp_buffer_p);
+
+	if (markdown_printer_p -> mp_rows_p)
+		{
+			free (markdown_printer_p -> mp_rows_p);
+		}
+
 	free (markdown_printer_p);
 }
 
 
 static bool PrintMarkdownHeader (Printer *printer_p, const char *title_s, const char *text_s)
 {
+	MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
 	bool res;
 
-	if (text_s)
-		{
-			res = (fprintf (printer_p -> pr_out_f, "# %s\n\n %s", title_s, text_s) > 0);
-		}
-	else
+	/* Drop anything left over from a previous file */
+	ResetByteBuffer (md_printer_p -> mp_buffer_p);
+	md_printer_p -> mp_num_rows = 0;
+
+	res = (fputs ("# ", printer_p -> pr_out_f) >= 0) && WriteEscapedMarkdown (md_printer_p, title_s ? title_s : "") && (fputs ("\n\n", printer_p -> pr_out_f) >= 0);
+
+	if (res && text_s)
 		{
-			res = (fprintf (printer_p -> pr_out_f, "# %s\n\n", title_s) > 0);
+			res = WriteEscapedMarkdown (md_printer_p, text_s) && (fputs ("\n\n", printer_p -> pr_out_f) >= 0);
 		}
 
 	return res;
@@ -234,14 +423,15 @@ static bool PrintMarkdownHeader (Printer *printer_p, const char *title_s, const
 
 static bool PrintMarkdownFooter (Printer *printer_p, const char *value_s)
 {
-	return true;
+	return FlushMarkdownRows ((MarkdownPrinter *) printer_p);
 }
 
 
 
 static bool PrintMarkdownText(Printer *printer_p, const char *value_s)
 {
-	bool res = (fprintf (printer_p -> pr_out_f, "%s\n", value_s) > 0);
+	MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+	bool res = FlushMarkdownRows (md_printer_p) && WriteEscapedMarkdown (md_printer_p, value_s) && (fputs ("\n", printer_p -> pr_out_f) >= 0);
 
 	return res;
 }
@@ -250,12 +440,428 @@ static bool PrintMarkdownText(Printer *printer_p, const char *value_s)
 
 static bool PrintMarkdownSectionStart (Printer *printer_p, const char *value_s)
 {
-	bool res = (fprintf (printer_p -> pr_out_f, "\n\n## %s\n\n", value_s) > 0);
+	MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+	bool res = FlushMarkdownRows (md_printer_p) && (fputs ("\n\n## ", printer_p -> pr_out_f) >= 0) && WriteEscapedMarkdown (md_printer_p, value_s) && (fputs ("\n\n", printer_p -> pr_out_f) >= 0);
 
 	return res;
 }
 
 static bool PrintMarkdownSectionEnd (Printer *printer_p, const char *value_s)
 {
-	return true;
+	return FlushMarkdownRows ((MarkdownPrinter *) printer_p);
+}
+
+
+/*
+ * Each entry of an array gets its own table
+ */
+static bool PrintMarkdownEntryBoundary (Printer *printer_p)
+{
+	return FlushMarkdownRows ((MarkdownPrinter *) printer_p);
+}
+
+
+static bool PrintMarkdownDocumentStart (Printer *printer_p, const char *title_s)
+{
+	return PrintMarkdownHeader (printer_p, title_s, NULL);
+}
+
+
+static bool PrintMarkdownContents (Printer *printer_p, const json_t *entries_p)
+{
+	MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+	ByteBuffer *buffer_p = md_printer_p -> mp_buffer_p;
+	bool success_flag = FlushMarkdownRows (md_printer_p) && AppendStringToByteBuffer (buffer_p, "## Contents\n\n");
+	size_t i;
+	const json_t *entry_p;
+
+	json_array_foreach (entries_p, i, entry_p)
+		{
+			const char *title_s = GetJSONString (entry_p, "title");
+			const char *link_s = GetJSONString (entry_p, "link");
+
+			if (success_flag && title_s && link_s)
+				{
+					success_flag = AppendStringToByteBuffer (buffer_p, " 1. ") && AppendMarkdownLink (md_printer_p, "", link_s, title_s) && AppendStringToByteBuffer (buffer_p, "\n");
+				}
+		}
+
+	if (success_flag)
+		{
+			success_flag = AppendStringToByteBuffer (buffer_p, "\n");
+		}
+
+	/* the contents isn't a table so write it out as a list */
+	if (success_flag)
+		{
+			const size_t length = GetByteBufferSize (buffer_p);
+
+			success_flag = (fwrite (GetByteBufferData (buffer_p), 1, length, printer_p -> pr_out_f) == length);
+		}
+
+	ResetByteBuffer (buffer_p);
+
+	return success_flag;
+}
+
+
+/*
+ * GitHub and most other renderers keep the ids of html anchors
+ */
+static bool PrintMarkdownResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s)
+{
+	MarkdownPrinter *md_printer_p = (MarkdownPrinter *) printer_p;
+	FILE *out_f = printer_p -> pr_out_f;
+
+	return (FlushMarkdownRows (md_printer_p) && (fprintf (out_f, "\n<a id=\"%s\"></a>\n\n## ", anchor_s) > 0) && WriteEscapedMarkdown (md_printer_p, title_s ? title_s : "")
+					&& (fputs ("\n\n", out_f) >= 0));
+}
+
+
+static bool PrintMarkdownResourceEnd (Printer *printer_p, const char *text_s)
+{
+	return FlushMarkdownRows ((MarkdownPrinter *) printer_p);
+}
+
+
+static bool PrintMarkdownDocumentEnd (Printer *printer_p)
+{
+	return FlushMarkdownRows ((MarkdownPrinter *) printer_p);
+}
+
+
+/*
+ * Add the key to the buffer. For lists the line is written in full to the
+ * buffer, for tables the positions of the cells are recorded so that they
+ * can be padded to the column widths when they are written.
+ */
+static bool StartMarkdownRow (MarkdownPrinter *printer_p, const char *key_s, const char *req_s, const bool inline_flag)
+{
+	ByteBuffer *buffer_p = printer_p -> mp_buffer_p;
+	bool success_flag = false;
+
+	if (printer_p -> mp_tables_flag)
+		{
+			if (printer_p -> mp_num_rows == printer_p -> mp_rows_capacity)
+				{
+					const size_t new_capacity = (printer_p -> mp_rows_capacity > 0) ? (printer_p -> mp_rows_capacity << 1) : 16;
+					MarkdownRow *rows_p = (MarkdownRow *) realloc (printer_p -> mp_rows_p, new_capacity * sizeof (MarkdownRow));
+
+					if (rows_p)
+						{
+							printer_p -> mp_rows_p = rows_p;
+							printer_p -> mp_rows_capacity = new_capacity;
+						}
+				}
+
+			if (printer_p -> mp_num_rows < printer_p -> mp_rows_capacity)
+				{
+					MarkdownRow *row_p = printer_p -> mp_rows_p + printer_p -> mp_num_rows;
+
+					row_p -> mr_key_start = GetByteBufferSize (buffer_p);
+
+					if (AppendStringToByteBuffer (buffer_p, "**") && AppendEscapedMarkdown (printer_p, key_s) && AppendStringsToByteBuffer (buffer_p, "**", req_s, NULL))
+						{
+							row_p -> mr_key_length = GetByteBufferSize (buffer_p) - (row_p -> mr_key_start);
+							row_p -> mr_value_start = GetByteBufferSize (buffer_p);
+							success_flag = true;
+						}
+				}
+		}
+	else
+		{
+			success_flag = AppendStringToByteBuffer (buffer_p, " * **") && AppendEscapedMarkdown (printer_p, key_s)
+				&& AppendStringsToByteBuffer (buffer_p, "**", req_s, inline_flag ? ": " : ":", NULL);
+		}
+
+	return success_flag;
+}
+
+
+static bool EndMarkdownRow (MarkdownPrinter *printer_p)
+{
+	bool success_flag = false;
+
+	if (printer_p -> mp_tables_flag)
+		{
+			MarkdownRow *row_p = printer_p -> mp_rows_p + printer_p -> mp_num_rows;
+			const char *data_s = GetByteBufferData (printer_p -> mp_buffer_p);
+
+			row_p -> mr_value_length = GetByteBufferSize (printer_p -> mp_buffer_p) - (row_p -> mr_value_start);
+
+			/* Work out the column widths as the rows are added */
+			row_p -> mr_key_width = GetDisplayWidth (data_s + row_p -> mr_key_start, row_p -> mr_key_length);
+			row_p -> mr_value_width = GetDisplayWidth (data_s + row_p -> mr_value_start, row_p -> mr_value_length);
+
+			if (row_p -> mr_key_width > printer_p -> mp_key_width)
+				{
+					printer_p -> mp_key_width = row_p -> mr_key_width;
+				}
+
+			if (row_p -> mr_value_width > printer_p -> mp_value_width)
+				{
+					printer_p -> mp_value_width = row_p -> mr_value_width;
+				}
+
+			++ (printer_p -> mp_num_rows);
+			success_flag = true;
+		}
+	else
+		{
+			success_flag = AppendStringToByteBuffer (printer_p -> mp_buffer_p, "\n");
+		}
+
+	return success_flag;
+}
+
+
+static bool FlushMarkdownRows (MarkdownPrinter *printer_p)
+{
+	ByteBuffer *buffer_p = printer_p -> mp_buffer_p;
+	FILE *out_f = printer_p -> mp_printer.pr_out_f;
+	const char *data_s = GetByteBufferData (buffer_p);
+	bool success_flag = true;
+
+	if (printer_p -> mp_tables_flag)
+		{
+			if (printer_p -> mp_num_rows > 0)
+				{
+					const size_t key_width = printer_p -> mp_key_width;
+					const size_t value_width = printer_p -> mp_value_width;
+					size_t i;
+
+					success_flag = (fprintf (out_f, "| %s", S_KEY_COLUMN_HEADING_S) > 0) && WritePadding (out_f, ' ', key_width - strlen (S_KEY_COLUMN_HEADING_S))
+						&& (fprintf (out_f, " | %s", S_VALUE_COLUMN_HEADING_S) > 0) && WritePadding (out_f, ' ', value_width - strlen (S_VALUE_COLUMN_HEADING_S))
+						&& (fputs (" |\n| ", out_f) >= 0) && WritePadding (out_f, '-', key_width) && (fputs (" | ", out_f) >= 0) && WritePadding (out_f, '-', value_width)
+						&& (fputs (" |\n", out_f) >= 0);
+
+					for (i = 0; (i < printer_p -> mp_num_rows) && success_flag; ++ i)
+						{
+							const MarkdownRow *row_p = printer_p -> mp_rows_p + i;
+
+							success_flag = (fputs ("| ", out_f) >= 0) && (fwrite (data_s + row_p -> mr_key_start, 1, row_p -> mr_key_length, out_f) == row_p -> mr_key_length)
+								&& WritePadding (out_f, ' ', key_width - row_p -> mr_key_width) && (fputs (" | ", out_f) >= 0)
+								&& (fwrite (data_s + row_p -> mr_value_start, 1, row_p -> mr_value_length, out_f) == row_p -> mr_value_length)
+								&& WritePadding (out_f, ' ', value_width - row_p -> mr_value_width) && (fputs (" |\n", out_f) >= 0);
+						}
+
+					if (success_flag)
+						{
+							success_flag = (fputs ("\n", out_f) >= 0);
+						}
+				}
+
+			printer_p -> mp_num_rows = 0;
+			printer_p -> mp_key_width = strlen (S_KEY_COLUMN_HEADING_S);
+			printer_p -> mp_value_width = strlen (S_VALUE_COLUMN_HEADING_S);
+		}
+	else
+		{
+			const size_t length = GetByteBufferSize (buffer_p);
+
+			if (length > 0)
+				{
+					success_flag = (fwrite (data_s, 1, length, out_f) == length);
+				}
+		}
+
+	ResetByteBuffer (buffer_p);
+
+	return success_flag;
+}
+
+
+/*
+ * Append the value with a backslash before any Markdown punctuation.
+ * The runs of characters in between are found with strcspn () and
+ * copied in single appends. Line breaks can't appear within table cells
+ * or list items so they are replaced.
+ */
+static bool AppendEscapedMarkdown (MarkdownPrinter *printer_p, const char *value_s)
+{
+	ByteBuffer *buffer_p = printer_p -> mp_buffer_p;
+	bool success_flag = true;
+
+	while (success_flag && (*value_s != '\0'))
+		{
+			const size_t run_length = strcspn (value_s, S_MARKDOWN_SPECIAL_CHARS_S);
+
+			if (run_length > 0)
+				{
+					success_flag = AppendToByteBuffer (buffer_p, value_s, run_length);
+					value_s += run_length;
+				}
+
+			if (success_flag && (*value_s != '\0'))
+				{
+					const char c = *value_s;
+
+					if (c == '\n')
+						{
+							success_flag = AppendStringToByteBuffer (buffer_p, printer_p -> mp_tables_flag ? "<br>" : "<br>\n   ");
+						}
+					else if (c != '\r')
+						{
+							char escaped_s [3];
+
+							escaped_s [0] = '\\';
+							escaped_s [1] = c;
+							escaped_s [2] = '\0';
+
+							success_flag = AppendToByteBuffer (buffer_p, escaped_s, 2);
+						}
+
+					++ value_s;
+				}
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Append a link to value_s, prefixed with scheme_s, with the link destination
+ * percent-encoding anything that would end it early.
+ */
+static bool AppendMarkdownLink (MarkdownPrinter *printer_p, const char *scheme_s, const char *value_s, const char *text_s)
+{
+	ByteBuffer *buffer_p = printer_p -> mp_buffer_p;
+	bool success_flag = AppendStringToByteBuffer (buffer_p, "[") && AppendEscapedMarkdown (printer_p, text_s) && AppendStringsToByteBuffer (buffer_p, "](", scheme_s, NULL);
+
+	while (success_flag && (*value_s != '\0'))
+		{
+			const size_t run_length = strcspn (value_s, " ()<>|\r\n");
+
+			if (run_length > 0)
+				{
+					success_flag = AppendToByteBuffer (buffer_p, value_s, run_length);
+					value_s += run_length;
+				}
+
+			if (success_flag && (*value_s != '\0'))
+				{
+					char encoded_s [4];
+
+					snprintf (encoded_s, sizeof (encoded_s), "%%%02X", (unsigned char) *value_s);
+					success_flag = AppendToByteBuffer (buffer_p, encoded_s, 3);
+
+					++ value_s;
+				}
+		}
+
+	if (success_flag)
+		{
+			success_flag = AppendStringToByteBuffer (buffer_p, ")");
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Write an escaped value straight to the output, such as a heading,
+ * which is done using the buffer after any pending rows have been written.
+ */
+static bool WriteEscapedMarkdown (MarkdownPrinter *printer_p, const char *value_s)
+{
+	bool success_flag = false;
+
+	if (FlushMarkdownRows (printer_p))
+		{
+			if (AppendEscapedMarkdown (printer_p, value_s))
+				{
+					const size_t length = GetByteBufferSize (printer_p -> mp_buffer_p);
+
+					success_flag = (fwrite (GetByteBufferData (printer_p -> mp_buffer_p), 1, length, printer_p -> mp_printer.pr_out_f) == length);
+				}
+
+			ResetByteBuffer (printer_p -> mp_buffer_p);
+		}
+
+	return success_flag;
+}
+
+
+static bool WritePadding (FILE *out_f, const char c, size_t count)
+{
+	bool success_flag = true;
+
+	while ((count > 0) && success_flag)
+		{
+			success_flag = (fputc (c, out_f) != EOF);
+			-- count;
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Count the UTF-8 characters, i.e. all bytes other than continuation bytes.
+ */
+static size_t GetDisplayWidth (const char *value_s, const size_t length)
+{
+	size_t width = 0;
+	size_t i;
+
+	for (i = 0; i < length; ++ i)
+		{
+			if ((((unsigned char) value_s [i]) & 0xC0) != 0x80)
+				{
+					++ width;
+				}
+		}
+
+	return width;
+}
+
+
+/*
+ * Append a chunk of a JSON value, indenting each line to keep it within
+ * the list item or escaping the pipes for a table cell.
+ */
+static bool AppendMarkdownJSONChunk (const char *chunk_s, const size_t length, void *data_p)
+{
+	MarkdownJSONWriter *writer_p = (MarkdownJSONWriter *) data_p;
+	const char *start_s = chunk_s;
+	const char * const end_s = chunk_s + length;
+	bool success_flag = true;
+
+	while (success_flag && (start_s < end_s))
+		{
+			const char *separator_s = (const char *) memchr (start_s, writer_p -> mjw_separator, end_s - start_s);
+
+			if (separator_s)
+				{
+					success_flag = WriteMarkdownJSON (writer_p, start_s, separator_s - start_s) && WriteMarkdownJSON (writer_p, writer_p -> mjw_replacement_s, strlen (writer_p -> mjw_replacement_s));
+					start_s = separator_s + 1;
+				}
+			else
+				{
+					success_flag = WriteMarkdownJSON (writer_p, start_s, end_s - start_s);
+					start_s = end_s;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static bool WriteMarkdownJSON (MarkdownJSONWriter *writer_p, const char *value_s, const size_t length)
+{
+	bool success_flag = true;
+
+	if (length > 0)
+		{
+			if (writer_p -> mjw_out_f)
+				{
+					success_flag = (fwrite (value_s, 1, length, writer_p -> mjw_out_f) == length);
+				}
+			else
+				{
+					success_flag = AppendToByteBuffer (writer_p -> mjw_buffer_p, value_s, length);
+				}
+		}
+
+	return success_flag;
 }
@@ -0,0 +1,463 @@
+/*
+ * output_cache.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "output_cache.h"
+
+#include "frictionless_data_util.h"
+
+#include "json_util.h"
+#include "string_utils.h"
+#include "filesystem_utils.h"
+
+
+/*
+ * The digests are 64-bit FNV-1a hashes. These aren't cryptographic
+ * but we are only detecting changes between runs, not tampering.
+ */
+static const uint64_t S_FNV_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+static const uint64_t S_FNV_PRIME = 0x00000100000001B3ULL;
+
+static const char * const S_MANIFEST_FILENAME_S = ".grassroots_fd_manifest.json";
+static const char * const S_MANIFEST_VERSION_S = "version";
+static const char * const S_MANIFEST_OUTPUTS_S = "outputs";
+
+static const json_int_t S_MANIFEST_VERSION = 1;
+
+/*
+ * Guard against schemas that refer to an endless chain of others
+ */
+static const size_t S_MAX_SCHEMAS = 256;
+
+
+/*
+ * static declarations
+ */
+
+static void UpdateDigest (uint64_t *digest_p, const void *data_p, const size_t length);
+
+static int UpdateDigestFromJSON (const char *buffer_s, size_t size, void *data_p);
+
+static bool AddJSONToDigest (uint64_t *digest_p, const json_t *value_p);
+
+static const char *GetSchemaDigest (OutputCache *cache_p, const char *schema_url_s, SchemaCache *schema_cache_p);
+
+static bool AddSchemaRefs (const json_t *value_p, const char *schema_url_s, json_t *urls_p, json_t *pending_p);
+
+static int CompareURLs (const void *v0_p, const void *v1_p);
+
+static char *ConvertDigestToString (const uint64_t digest);
+
+
+/*
+ * api definitions
+ */
+
+OutputCache *AllocateOutputCache (const char *out_dir_s, const char *options_s)
+{
+	OutputCache *cache_p = (OutputCache *) calloc (1, sizeof (OutputCache));
+
+	if (cache_p)
+		{
+			if (out_dir_s)
+				{
+					cache_p -> oc_manifest_filename_s = MakeFilename (out_dir_s, S_MANIFEST_FILENAME_S);
+				}
+			else
+				{
+					cache_p -> oc_manifest_filename_s = EasyCopyToNewString (S_MANIFEST_FILENAME_S);
+				}
+
+			if (cache_p -> oc_manifest_filename_s)
+				{
+					cache_p -> oc_options_s = EasyCopyToNewString (options_s);
+
+					if (cache_p -> oc_options_s)
+						{
+							cache_p -> oc_current_outputs_p = json_object ();
+
+							if (cache_p -> oc_current_outputs_p)
+								{
+									cache_p -> oc_schema_digests_p = json_object ();
+
+									if (cache_p -> oc_schema_digests_p)
+										{
+											json_error_t err;
+											json_t *manifest_p = json_load_file (cache_p -> oc_manifest_filename_s, 0, &err);
+
+											/*
+											 * A missing or out of date manifest just means
+											 * that everything will get regenerated
+											 */
+											if (manifest_p)
+												{
+													json_int_t version;
+
+													if ((GetJSONInteger (manifest_p, S_MANIFEST_VERSION_S, &version)) && (version == S_MANIFEST_VERSION))
+														{
+															json_t *outputs_p = json_object_get (manifest_p, S_MANIFEST_OUTPUTS_S);
+
+															if (json_is_object (outputs_p))
+																{
+																	cache_p -> oc_previous_outputs_p = json_incref (outputs_p);
+																}
+														}
+
+													json_decref (manifest_p);
+												}
+
+											return cache_p;
+										}
+
+									json_decref (cache_p -> oc_current_outputs_p);
+								}
+
+							FreeCopiedString (cache_p -> oc_options_s);
+						}
+
+					FreeCopiedString (cache_p -> oc_manifest_filename_s);
+				}
+
+			free (cache_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeOutputCache (OutputCache *cache_p)
+{
+	json_decref (cache_p -> oc_previous_outputs_p);
+	json_decref (cache_p -> oc_current_outputs_p);
+	json_decref (cache_p -> oc_schema_digests_p);
+
+	FreeCopiedString (cache_p -> oc_options_s);
+	FreeCopiedString (cache_p -> oc_manifest_filename_s);
+
+	free (cache_p);
+}
+
+
+bool SaveOutputCache (OutputCache *cache_p, OutputDirectory *dir_p)
+{
+	bool success_flag = false;
+	json_t *manifest_p = json_object ();
+
+	if (manifest_p)
+		{
+			if (SetJSONInteger (manifest_p, S_MANIFEST_VERSION_S, S_MANIFEST_VERSION))
+				{
+					if (json_object_set (manifest_p, S_MANIFEST_OUTPUTS_S, cache_p -> oc_current_outputs_p) == 0)
+						{
+							if (SaveOutputDirectoryJSON (dir_p, cache_p -> oc_manifest_filename_s, manifest_p, JSON_INDENT (2) | JSON_SORT_KEYS))
+								{
+									success_flag = true;
+								}
+							else
+								{
+									fprintf (stderr, "Failed to write output manifest \"%s\"\n", cache_p -> oc_manifest_filename_s);
+								}
+						}
+				}
+
+			json_decref (manifest_p);
+		}
+
+	return success_flag;
+}
+
+
+char *GetResourceDigest (OutputCache *cache_p, const json_t *resource_p, const char *schema_url_s, SchemaCache *schema_cache_p)
+{
+	uint64_t digest = S_FNV_OFFSET_BASIS;
+
+	UpdateDigest (&digest, cache_p -> oc_options_s, strlen (cache_p -> oc_options_s));
+
+	if (AddJSONToDigest (&digest, resource_p))
+		{
+			if (schema_url_s)
+				{
+					const char *schema_digest_s = GetSchemaDigest (cache_p, schema_url_s, schema_cache_p);
+
+					if (schema_digest_s)
+						{
+							UpdateDigest (&digest, schema_digest_s, strlen (schema_digest_s));
+						}
+					else
+						{
+							return NULL;
+						}
+				}
+
+			return ConvertDigestToString (digest);
+		}
+
+	return NULL;
+}
+
+
+bool IsOutputCurrent (const OutputCache *cache_p, const char *filename_s, const char *digest_s)
+{
+	bool current_flag = false;
+
+	if (cache_p -> oc_previous_outputs_p)
+		{
+			const char *previous_digest_s = GetJSONString (cache_p -> oc_previous_outputs_p, filename_s);
+
+			if ((previous_digest_s) && (strcmp (previous_digest_s, digest_s) == 0))
+				{
+					struct stat st;
+
+					if (stat (filename_s, &st) == 0)
+						{
+							current_flag = true;
+						}
+				}
+		}
+
+	return current_flag;
+}
+
+
+bool SetOutputDigest (OutputCache *cache_p, const char *filename_s, const char *digest_s)
+{
+	return SetJSONString (cache_p -> oc_current_outputs_p, filename_s, digest_s);
+}
+
+
+bool KeepPreviousOutputs (OutputCache *cache_p)
+{
+	bool success_flag = true;
+
+	if (cache_p -> oc_previous_outputs_p)
+		{
+			const char *filename_s;
+			json_t *digest_p;
+
+			json_object_foreach (cache_p -> oc_previous_outputs_p, filename_s, digest_p)
+				{
+					/* Anything that has already been recorded during this run is newer */
+					if (!json_object_get (cache_p -> oc_current_outputs_p, filename_s))
+						{
+							if (json_object_set (cache_p -> oc_current_outputs_p, filename_s, digest_p) != 0)
+								{
+									success_flag = false;
+								}
+						}
+				}
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * static definitions
+ */
+
+
+static void UpdateDigest (uint64_t *digest_p, const void *data_p, const size_t length)
+{
+	const unsigned char *c_p = (const unsigned char *) data_p;
+	const unsigned char * const end_p = c_p + length;
+	uint64_t digest = *digest_p;
+
+	for ( ; c_p < end_p; ++ c_p)
+		{
+			digest ^= *c_p;
+			digest *= S_FNV_PRIME;
+		}
+
+	*digest_p = digest;
+}
+
+
+static int UpdateDigestFromJSON (const char *buffer_s, size_t size, void *data_p)
+{
+	UpdateDigest ((uint64_t *) data_p, buffer_s, size);
+
+	return 0;
+}
+
+
+/*
+ * Hash the canonical form of the JSON, i.e. compact with sorted keys,
+ * so that whitespace and key order changes don't count as edits. It is
+ * streamed into the digest so no serialised copy is built.
+ */
+static bool AddJSONToDigest (uint64_t *digest_p, const json_t *value_p)
+{
+	return (json_dump_callback (value_p, UpdateDigestFromJSON, digest_p, JSON_COMPACT | JSON_SORT_KEYS | JSON_ENCODE_ANY) == 0);
+}
+
+
+/*
+ * A schema's digest covers its own canonical JSON and that of every
+ * other schema that it refers to, directly or through them, since
+ * changes to those alter the generated output too. The schemas are
+ * hashed in order of their urls so that it doesn't matter where the
+ * refs are or whether they refer back to each other.
+ */
+static const char *GetSchemaDigest (OutputCache *cache_p, const char *schema_url_s, SchemaCache *schema_cache_p)
+{
+	const char *digest_s = GetJSONString (cache_p -> oc_schema_digests_p, schema_url_s);
+
+	if (!digest_s)
+		{
+			json_t *urls_p = json_object ();
+			json_t *pending_p = json_array ();
+
+			if (urls_p && pending_p && (json_object_set_new (urls_p, schema_url_s, json_true ()) == 0) && (json_array_append_new (pending_p, json_string (schema_url_s)) == 0))
+				{
+					bool success_flag = true;
+					size_t i;
+
+					/* The urls are added to pending_p as they are found so this visits each schema once */
+					for (i = 0; (i < json_array_size (pending_p)) && success_flag; ++ i)
+						{
+							const char *url_s = json_string_value (json_array_get (pending_p, i));
+							const json_t *schema_p = GetSchemaFromCache (schema_cache_p, url_s);
+
+							success_flag = (schema_p != NULL) && (AddSchemaRefs (schema_p, url_s, urls_p, pending_p));
+						}
+
+					if (success_flag)
+						{
+							const size_t num_urls = json_array_size (pending_p);
+							const char **urls_ss = (const char **) malloc (num_urls * sizeof (const char *));
+
+							if (urls_ss)
+								{
+									uint64_t digest = S_FNV_OFFSET_BASIS;
+
+									for (i = 0; i < num_urls; ++ i)
+										{
+											urls_ss [i] = json_string_value (json_array_get (pending_p, i));
+										}
+
+									qsort (urls_ss, num_urls, sizeof (const char *), CompareURLs);
+
+									for (i = 0; (i < num_urls) && success_flag; ++ i)
+										{
+											UpdateDigest (&digest, urls_ss [i], strlen (urls_ss [i]) + 1);
+											success_flag = AddJSONToDigest (&digest, GetSchemaFromCache (schema_cache_p, urls_ss [i]));
+										}
+
+									if (success_flag)
+										{
+											char *value_s = ConvertDigestToString (digest);
+
+											if (value_s)
+												{
+													if (SetJSONString (cache_p -> oc_schema_digests_p, schema_url_s, value_s))
+														{
+															digest_s = GetJSONString (cache_p -> oc_schema_digests_p, schema_url_s);
+														}
+
+													FreeCopiedString (value_s);
+												}
+										}
+
+									free (urls_ss);
+								}
+						}
+				}
+
+			json_decref (urls_p);
+			json_decref (pending_p);
+		}
+
+	return digest_s;
+}
+
+
+/*
+ * Find the refs to other schemas anywhere within a schema, be they in its
+ * properties, items, anyOf/oneOf/allOf branches or definitions. Local refs
+ * are already covered by the schema's own JSON. Each url that hasn't been
+ * seen before is added to urls_p and to the end of pending_p.
+ */
+static bool AddSchemaRefs (const json_t *value_p, const char *schema_url_s, json_t *urls_p, json_t *pending_p)
+{
+	bool success_flag = true;
+
+	if (json_is_object (value_p))
+		{
+			const char *ref_s = GetJSONString (value_p, "$ref");
+			const char *key_s;
+			json_t *child_p;
+
+			if ((ref_s) && (*ref_s != '#'))
+				{
+					char *child_url_s = GetAbsoluteSchemaURL (schema_url_s, ref_s);
+
+					if (child_url_s)
+						{
+							if (!json_object_get (urls_p, child_url_s))
+								{
+									if (json_array_size (pending_p) < S_MAX_SCHEMAS)
+										{
+											success_flag = (json_object_set_new (urls_p, child_url_s, json_true ()) == 0) && (json_array_append_new (pending_p, json_string (child_url_s)) == 0);
+										}
+									else
+										{
+											success_flag = false;
+										}
+								}
+
+							FreeCopiedString (child_url_s);
+						}
+					else
+						{
+							success_flag = false;
+						}
+				}
+
+			json_object_foreach ((json_t *) value_p, key_s, child_p)
+				{
+					if (success_flag && (json_is_object (child_p) || json_is_array (child_p)))
+						{
+							success_flag = AddSchemaRefs (child_p, schema_url_s, urls_p, pending_p);
+						}
+				}
+		}
+	else if (json_is_array (value_p))
+		{
+			size_t i;
+			const json_t *child_p;
+
+			json_array_foreach (value_p, i, child_p)
+				{
+					if (success_flag && (json_is_object (child_p) || json_is_array (child_p)))
+						{
+							success_flag = AddSchemaRefs (child_p, schema_url_s, urls_p, pending_p);
+						}
+				}
+		}
+
+	return success_flag;
+}
+
+
+static int CompareURLs (const void *v0_p, const void *v1_p)
+{
+	return strcmp (* ((const char * const *) v0_p), * ((const char * const *) v1_p));
+}
+
+
+static char *ConvertDigestToString (const uint64_t digest)
+{
+	char buffer_s [17];
+
+	snprintf (buffer_s, sizeof (buffer_s), "%016llx", (unsigned long long) digest);
+
+	return EasyCopyToNewString (buffer_s);
+}
@@ -0,0 +1,895 @@
+/*
+ * output_directory.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifdef LINUX
+	#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef LINUX
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/stat.h>
+#elif defined WINDOWS
+	#include <io.h>
+	#include <process.h>
+	#include <windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+#include "jansson.h"
+
+#include "output_directory.h"
+
+#include "string_utils.h"
+#include "filesystem_utils.h"
+
+
+/*
+ * A file that has been opened in an OutputDirectory but hasn't been put
+ * in place yet. On Linux the filenames are relative to the directory,
+ * elsewhere they are the full filenames.
+ */
+typedef struct OutputFile
+{
+	/** This is NULL once the file has been closed */
+	FILE *of_out_f;
+
+	/** The file is written to this until it is put in place */
+	char *of_temp_filename_s;
+
+	char *of_filename_s;
+} OutputFile;
+
+
+struct OutputDirectory
+{
+	/** This is NULL for the current directory */
+	char *od_path_s;
+
+	uint32 od_shard_depth;
+
+	/** The subdirectories that are known to exist, as keys */
+	json_t *od_known_dirs_p;
+
+	OutputDurability od_durability;
+
+	/**
+	 * The files that are open, followed by, for OD_DURABILITY_BATCH, the
+	 * ones that have been closed and are waiting to be synced. They are
+	 * in the order that they were opened.
+	 */
+	OutputFile *od_files_p;
+	size_t od_num_files;
+	size_t od_files_capacity;
+
+	/** The number of od_files_p that are waiting to be synced */
+	size_t od_num_pending_files;
+
+	/** This is used to give each temporary file a different name */
+	uint32 od_next_temp_id;
+
+#ifdef LINUX
+	/** The files are opened relative to this */
+	int od_fd;
+#endif
+};
+
+
+/*
+ * The hash of each name that picks its subdirectories is a 32-bit FNV-1a
+ * hash, with each level of subdirectories named after one of its bytes.
+ * Names often only differ in their last few characters, which barely
+ * changes the upper bytes of the hash, so it is mixed before use.
+ */
+static const uint32 S_FNV_OFFSET_BASIS = 0x811C9DC5UL;
+static const uint32 S_FNV_PRIME = 0x01000193UL;
+
+
+/*
+ * For OD_DURABILITY_BATCH, the number of closed files to wait for before
+ * syncing them. This limits how many are lost if the run is interrupted.
+ */
+static const size_t S_MAX_BATCH_SIZE = 1024;
+
+/* The number of names to try for a temporary file before giving up */
+static const uint32 S_MAX_TEMP_ATTEMPTS = 64;
+
+
+/*
+ * static declarations
+ */
+
+static bool EnsureSubdirectoryExists (OutputDirectory *dir_p, const char *relative_s, const size_t length);
+
+static OutputFile *AddOutputFile (OutputDirectory *dir_p, const char *filename_s);
+
+static OutputFile *FindOutputFile (OutputDirectory *dir_p, const FILE *out_f);
+
+static void RemoveClosedOutputFiles (OutputDirectory *dir_p);
+
+static FILE *CreateTemporaryFile (OutputDirectory *dir_p, OutputFile *file_p);
+
+static bool SyncFile (FILE *out_f);
+
+static bool PutOutputFileInPlace (OutputDirectory *dir_p, OutputFile *file_p);
+
+static void DeleteTemporaryFile (OutputDirectory *dir_p, OutputFile *file_p);
+
+#ifdef LINUX
+static bool SyncParentDirectory (OutputDirectory *dir_p, const char *relative_s);
+
+static bool SyncSubdirectory (OutputDirectory *dir_p, const char *relative_s, const size_t length);
+#endif
+
+
+/*
+ * api definitions
+ */
+
+OutputDirectory *AllocateOutputDirectory (const char *path_s, const uint32 shard_depth, const OutputDurability durability)
+{
+	OutputDirectory *dir_p = NULL;
+
+	if (shard_depth > OD_MAX_SHARD_DEPTH)
+		{
+			fprintf (stderr, "The output files can be sharded into at most %d levels of subdirectories\n", OD_MAX_SHARD_DEPTH);
+			return NULL;
+		}
+
+	if (path_s && (!EnsureDirectoryExists (path_s)))
+		{
+			fprintf (stderr, "Failed to create output directory \"%s\"\n", path_s);
+			return NULL;
+		}
+
+	dir_p = (OutputDirectory *) calloc (1, sizeof (OutputDirectory));
+
+	if (dir_p)
+		{
+			bool success_flag = true;
+
+			dir_p -> od_shard_depth = shard_depth;
+			dir_p -> od_durability = durability;
+
+#ifdef LINUX
+			dir_p -> od_fd = -1;
+#endif
+
+			if (path_s)
+				{
+					dir_p -> od_path_s = EasyCopyToNewString (path_s);
+
+					if (! (dir_p -> od_path_s))
+						{
+							success_flag = false;
+						}
+				}
+
+#ifdef LINUX
+			/* The current directory is opened too so that it can be synced */
+			if (success_flag)
+				{
+					dir_p -> od_fd = open (path_s ? path_s : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+					if (dir_p -> od_fd == -1)
+						{
+							fprintf (stderr, "Failed to open output directory \"%s\": %s\n", path_s ? path_s : ".", strerror (errno));
+							success_flag = false;
+						}
+				}
+#endif
+
+			if (success_flag)
+				{
+					dir_p -> od_known_dirs_p = json_object ();
+
+					if (dir_p -> od_known_dirs_p)
+						{
+							return dir_p;
+						}
+				}
+
+			FreeOutputDirectory (dir_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeOutputDirectory (OutputDirectory *dir_p)
+{
+	if (dir_p -> od_files_p)
+		{
+			size_t i;
+
+			SyncOutputDirectory (dir_p);
+
+			/* Anything left was never finished so it is thrown away */
+			for (i = 0; i < dir_p -> od_num_files; ++ i)
+				{
+					OutputFile *file_p = (dir_p -> od_files_p) + i;
+
+					if (file_p -> of_out_f)
+						{
+							fclose (file_p -> of_out_f);
+							file_p -> of_out_f = NULL;
+						}
+
+					DeleteTemporaryFile (dir_p, file_p);
+				}
+
+			RemoveClosedOutputFiles (dir_p);
+			free (dir_p -> od_files_p);
+		}
+
+#ifdef LINUX
+	if (dir_p -> od_fd != -1)
+		{
+			close (dir_p -> od_fd);
+		}
+#endif
+
+	if (dir_p -> od_known_dirs_p)
+		{
+			json_decref (dir_p -> od_known_dirs_p);
+		}
+
+	if (dir_p -> od_path_s)
+		{
+			FreeCopiedString (dir_p -> od_path_s);
+		}
+
+	free (dir_p);
+}
+
+
+char *GetOutputDirectoryFilename (const OutputDirectory *dir_p, const char *filename_s, const bool shard_flag)
+{
+	char *full_filename_s = NULL;
+	char *relative_s = NULL;
+
+	if (shard_flag && (dir_p -> od_shard_depth > 0))
+		{
+			/* Each level of subdirectories is two hex digits and a separator */
+			char shards_s [OD_MAX_SHARD_DEPTH * 3 + 1];
+			const char *dot_s = strrchr (filename_s, '.');
+			const char *c_p;
+			uint32 hash = S_FNV_OFFSET_BASIS;
+			uint32 i;
+
+			if (!dot_s)
+				{
+					dot_s = filename_s + strlen (filename_s);
+				}
+
+			for (c_p = filename_s; c_p < dot_s; ++ c_p)
+				{
+					hash ^= (uint32) (unsigned char) *c_p;
+					hash *= S_FNV_PRIME;
+				}
+
+			hash ^= hash >> 16;
+			hash *= 0x85EBCA6BUL;
+			hash ^= hash >> 13;
+			hash *= 0xC2B2AE35UL;
+			hash ^= hash >> 16;
+
+			for (i = 0; i < dir_p -> od_shard_depth; ++ i)
+				{
+					snprintf (shards_s + (i * 3), sizeof (shards_s) - (i * 3), "%02x/", (unsigned int) ((hash >> (24 - (i * 8))) & 0xFF));
+				}
+
+			relative_s = ConcatenateStrings (shards_s, filename_s);
+		}
+	else
+		{
+			relative_s = EasyCopyToNewString (filename_s);
+		}
+
+	if (relative_s)
+		{
+			if (dir_p -> od_path_s)
+				{
+					full_filename_s = MakeFilename (dir_p -> od_path_s, relative_s);
+					FreeCopiedString (relative_s);
+				}
+			else
+				{
+					full_filename_s = relative_s;
+				}
+		}
+
+	return full_filename_s;
+}
+
+
+FILE *OpenOutputDirectoryFile (OutputDirectory *dir_p, const char *filename_s)
+{
+	FILE *out_f = NULL;
+	const char *relative_s = GetOutputDirectoryRelativeFilename (dir_p, filename_s);
+
+	if (relative_s)
+		{
+			const char *sep_s = strrchr (relative_s, '/');
+			OutputFile *file_p;
+
+			if (sep_s && (!EnsureSubdirectoryExists (dir_p, relative_s, sep_s - relative_s)))
+				{
+					return NULL;
+				}
+
+#ifdef LINUX
+			file_p = AddOutputFile (dir_p, relative_s);
+#else
+			file_p = AddOutputFile (dir_p, filename_s);
+#endif
+
+			if (file_p)
+				{
+					out_f = CreateTemporaryFile (dir_p, file_p);
+
+					if (!out_f)
+						{
+							RemoveClosedOutputFiles (dir_p);
+						}
+				}
+		}
+	else
+		{
+			out_f = fopen (filename_s, "w");
+		}
+
+	return out_f;
+}
+
+
+bool CloseOutputDirectoryFile (OutputDirectory *dir_p, FILE *out_f, const bool keep_flag)
+{
+	bool success_flag = false;
+	OutputFile *file_p = FindOutputFile (dir_p, out_f);
+
+	if (file_p)
+		{
+			success_flag = keep_flag && (ferror (out_f) == 0);
+
+			/* Without syncfs (), a batch has to be flushed a file at a time */
+#ifdef LINUX
+			if (success_flag && (dir_p -> od_durability == OD_DURABILITY_STRICT))
+#else
+			if (success_flag && (dir_p -> od_durability != OD_DURABILITY_NONE))
+#endif
+				{
+					success_flag = SyncFile (out_f);
+				}
+
+			if (fclose (out_f) != 0)
+				{
+					success_flag = false;
+				}
+
+			file_p -> of_out_f = NULL;
+
+			if (success_flag)
+				{
+					if (dir_p -> od_durability == OD_DURABILITY_BATCH)
+						{
+							++ (dir_p -> od_num_pending_files);
+
+							if (dir_p -> od_num_pending_files >= S_MAX_BATCH_SIZE)
+								{
+									success_flag = SyncOutputDirectory (dir_p);
+								}
+						}
+					else
+						{
+							success_flag = PutOutputFileInPlace (dir_p, file_p);
+							RemoveClosedOutputFiles (dir_p);
+						}
+				}
+			else
+				{
+					fprintf (stderr, "Failed to write \"%s\", keeping any previous version of it\n", file_p -> of_filename_s);
+					DeleteTemporaryFile (dir_p, file_p);
+					RemoveClosedOutputFiles (dir_p);
+				}
+		}
+	else
+		{
+			success_flag = (fclose (out_f) == 0);
+		}
+
+	return success_flag;
+}
+
+
+bool SaveOutputDirectoryJSON (OutputDirectory *dir_p, const char *filename_s, const json_t *value_p, const size_t flags)
+{
+	bool success_flag = false;
+	FILE *out_f = OpenOutputDirectoryFile (dir_p, filename_s);
+
+	if (out_f)
+		{
+			const bool written_flag = (json_dumpf (value_p, out_f, flags) == 0);
+
+			success_flag = CloseOutputDirectoryFile (dir_p, out_f, written_flag);
+		}
+
+	return success_flag;
+}
+
+
+bool SyncOutputDirectory (OutputDirectory *dir_p)
+{
+	bool success_flag = true;
+
+	if (dir_p -> od_num_pending_files > 0)
+		{
+			bool synced_flag = true;
+			size_t i;
+
+#ifdef LINUX
+			/*
+			 * Flush the whole batch with a single call. If it fails, none
+			 * of the files can be relied upon so they are all thrown away
+			 * and the previous versions are kept.
+			 */
+			if (syncfs (dir_p -> od_fd) != 0)
+				{
+					fprintf (stderr, "Failed to sync the output files, keeping any previous versions of them: %s\n", strerror (errno));
+					synced_flag = false;
+					success_flag = false;
+				}
+#endif
+
+			for (i = 0; i < dir_p -> od_num_files; ++ i)
+				{
+					OutputFile *file_p = (dir_p -> od_files_p) + i;
+
+					if (! (file_p -> of_out_f))
+						{
+							if (!synced_flag)
+								{
+									DeleteTemporaryFile (dir_p, file_p);
+								}
+							else if (!PutOutputFileInPlace (dir_p, file_p))
+								{
+									success_flag = false;
+								}
+						}
+				}
+
+#ifdef LINUX
+			/* ... and then the renames */
+			if (synced_flag && (syncfs (dir_p -> od_fd) != 0))
+				{
+					fprintf (stderr, "Failed to sync the output files: %s\n", strerror (errno));
+					success_flag = false;
+				}
+#endif
+
+			dir_p -> od_num_pending_files = 0;
+			RemoveClosedOutputFiles (dir_p);
+		}
+
+	return success_flag;
+}
+
+
+const char *GetOutputDirectoryRelativeFilename (const OutputDirectory *dir_p, const char *filename_s)
+{
+	const char *relative_s = filename_s;
+
+	if (dir_p -> od_path_s)
+		{
+			const size_t length = strlen (dir_p -> od_path_s);
+
+			if (strncmp (filename_s, dir_p -> od_path_s, length) == 0)
+				{
+					relative_s = filename_s + length;
+
+					while ((*relative_s == '/') || (*relative_s == '\\'))
+						{
+							++ relative_s;
+						}
+
+					/* Make sure that it didn't just start with the same characters */
+					if ((relative_s == filename_s + length) && (length > 0) && (* (relative_s - 1) != '/') && (* (relative_s - 1) != '\\'))
+						{
+							relative_s = NULL;
+						}
+				}
+			else
+				{
+					relative_s = NULL;
+				}
+		}
+
+	return relative_s;
+}
+
+
+/*
+ * static definitions
+ */
+
+/*
+ * Create the subdirectory made up of the first length characters
+ * of relative_s unless it has already been done.
+ */
+static bool EnsureSubdirectoryExists (OutputDirectory *dir_p, const char *relative_s, const size_t length)
+{
+	bool success_flag = false;
+	char *subdir_s = CopyToNewString (relative_s, length, false);
+
+	if (subdir_s)
+		{
+			if (json_object_get (dir_p -> od_known_dirs_p, subdir_s))
+				{
+					success_flag = true;
+				}
+			else
+				{
+#ifdef LINUX
+					char *c_p = subdir_s;
+
+					success_flag = true;
+
+					/* Create each level in turn */
+					while (success_flag && c_p)
+						{
+							c_p = strchr (c_p, '/');
+
+							if (c_p)
+								{
+									*c_p = '\0';
+								}
+
+							if (mkdirat (dir_p -> od_fd, subdir_s, 0777) == 0)
+								{
+									/* A new directory is only there after a crash once its parent has been synced */
+									if (dir_p -> od_durability == OD_DURABILITY_STRICT)
+										{
+											const char *sep_s = strrchr (subdir_s, '/');
+
+											success_flag = SyncSubdirectory (dir_p, subdir_s, sep_s ? (size_t) (sep_s - subdir_s) : 0);
+										}
+								}
+							else if (errno != EEXIST)
+								{
+									fprintf (stderr, "Failed to create output directory \"%s\": %s\n", subdir_s, strerror (errno));
+									success_flag = false;
+								}
+
+							if (c_p)
+								{
+									*c_p = '/';
+									++ c_p;
+								}
+						}
+#else
+					char *full_subdir_s = dir_p -> od_path_s ? MakeFilename (dir_p -> od_path_s, subdir_s) : subdir_s;
+
+					if (full_subdir_s)
+						{
+							success_flag = EnsureDirectoryExists (full_subdir_s);
+
+							if (!success_flag)
+								{
+									fprintf (stderr, "Failed to create output directory \"%s\"\n", full_subdir_s);
+								}
+
+							if (full_subdir_s != subdir_s)
+								{
+									FreeCopiedString (full_subdir_s);
+								}
+						}
+#endif
+
+					if (success_flag)
+						{
+							json_object_set_new (dir_p -> od_known_dirs_p, subdir_s, json_true ());
+						}
+				}
+
+			FreeCopiedString (subdir_s);
+		}
+
+	return success_flag;
+}
+
+
+static OutputFile *AddOutputFile (OutputDirectory *dir_p, const char *filename_s)
+{
+	OutputFile *file_p = NULL;
+
+	if (dir_p -> od_num_files == dir_p -> od_files_capacity)
+		{
+			const size_t capacity = (dir_p -> od_files_capacity > 0) ? (dir_p -> od_files_capacity << 1) : 16;
+			OutputFile *files_p = (OutputFile *) realloc (dir_p -> od_files_p, capacity * sizeof (OutputFile));
+
+			if (!files_p)
+				{
+					return NULL;
+				}
+
+			dir_p -> od_files_p = files_p;
+			dir_p -> od_files_capacity = capacity;
+		}
+
+	file_p = (dir_p -> od_files_p) + (dir_p -> od_num_files);
+	file_p -> of_out_f = NULL;
+	file_p -> of_temp_filename_s = NULL;
+	file_p -> of_filename_s = EasyCopyToNewString (filename_s);
+
+	if (file_p -> of_filename_s)
+		{
+			++ (dir_p -> od_num_files);
+			return file_p;
+		}
+
+	return NULL;
+}
+
+/*
+ * The files that are open are the most recent ones so start at the end.
+ */
+static OutputFile *FindOutputFile (OutputDirectory *dir_p, const FILE *out_f)
+{
+	size_t i = dir_p -> od_num_files;
+
+	while (i > 0)
+		{
+			OutputFile *file_p = (dir_p -> od_files_p) + (-- i);
+
+			if (file_p -> of_out_f == out_f)
+				{
+					return file_p;
+				}
+		}
+
+	return NULL;
+}
+
+/*
+ * Free the closed files that aren't waiting to be synced, keeping
+ * the rest in the same order. This includes a file that has been
+ * added but whose temporary file couldn't be created.
+ */
+static void RemoveClosedOutputFiles (OutputDirectory *dir_p)
+{
+	size_t i;
+	size_t num_kept = 0;
+
+	for (i = 0; i < dir_p -> od_num_files; ++ i)
+		{
+			OutputFile *file_p = (dir_p -> od_files_p) + i;
+
+			if ((file_p -> of_out_f) || ((dir_p -> od_num_pending_files > 0) && (file_p -> of_temp_filename_s)))
+				{
+					if (num_kept != i)
+						{
+							dir_p -> od_files_p [num_kept] = *file_p;
+						}
+
+					++ num_kept;
+				}
+			else
+				{
+					if (file_p -> of_temp_filename_s)
+						{
+							FreeCopiedString (file_p -> of_temp_filename_s);
+						}
+
+					FreeCopiedString (file_p -> of_filename_s);
+				}
+		}
+
+	dir_p -> od_num_files = num_kept;
+}
+
+/*
+ * Create a new temporary file next to where file_p will be put. Its name
+ * is the filename followed by the process ID and a number so that several
+ * of them for the same file, even from runs at the same time, don't clash.
+ */
+static FILE *CreateTemporaryFile (OutputDirectory *dir_p, OutputFile *file_p)
+{
+	uint32 i;
+
+	for (i = 0; i < S_MAX_TEMP_ATTEMPTS; ++ i)
+		{
+			char suffix_s [64];
+			char *temp_filename_s;
+
+#ifdef WINDOWS
+			const unsigned long pid = (unsigned long) _getpid ();
+#else
+			const unsigned long pid = (unsigned long) getpid ();
+#endif
+
+			snprintf (suffix_s, sizeof (suffix_s), ".%lu.%lu.tmp", pid, (unsigned long) ((dir_p -> od_next_temp_id) ++));
+			temp_filename_s = ConcatenateStrings (file_p -> of_filename_s, suffix_s);
+
+			if (temp_filename_s)
+				{
+					int err;
+
+#ifdef LINUX
+					int fd = openat (dir_p -> od_fd, temp_filename_s, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+
+					err = errno;
+
+					if (fd != -1)
+						{
+							file_p -> of_out_f = fdopen (fd, "w");
+
+							if (! (file_p -> of_out_f))
+								{
+									err = errno;
+									close (fd);
+									unlinkat (dir_p -> od_fd, temp_filename_s, 0);
+								}
+						}
+#else
+					file_p -> of_out_f = fopen (temp_filename_s, "wx");
+					err = errno;
+#endif
+
+					if (file_p -> of_out_f)
+						{
+							file_p -> of_temp_filename_s = temp_filename_s;
+							return file_p -> of_out_f;
+						}
+
+					FreeCopiedString (temp_filename_s);
+
+					if (err != EEXIST)
+						{
+							fprintf (stderr, "Failed to create temporary file for \"%s\": %s\n", file_p -> of_filename_s, strerror (err));
+							return NULL;
+						}
+				}
+			else
+				{
+					return NULL;
+				}
+		}
+
+	fprintf (stderr, "Failed to find an unused temporary filename for \"%s\"\n", file_p -> of_filename_s);
+
+	return NULL;
+}
+
+static bool SyncFile (FILE *out_f)
+{
+	bool success_flag = (fflush (out_f) == 0);
+
+	if (success_flag)
+		{
+#ifdef LINUX
+			success_flag = (fdatasync (fileno (out_f)) == 0);
+#elif defined WINDOWS
+			success_flag = (_commit (_fileno (out_f)) == 0);
+#endif
+		}
+
+	return success_flag;
+}
+
+/*
+ * Replace the file with the temporary file that it was written to.
+ */
+static bool PutOutputFileInPlace (OutputDirectory *dir_p, OutputFile *file_p)
+{
+	bool success_flag = false;
+
+#ifdef LINUX
+	if (renameat (dir_p -> od_fd, file_p -> of_temp_filename_s, dir_p -> od_fd, file_p -> of_filename_s) == 0)
+		{
+			success_flag = (dir_p -> od_durability == OD_DURABILITY_STRICT) ? SyncParentDirectory (dir_p, file_p -> of_filename_s) : true;
+		}
+#elif defined WINDOWS
+	/* Unlike rename (), this replaces any existing file */
+	DWORD flags = MOVEFILE_REPLACE_EXISTING;
+
+	if (dir_p -> od_durability != OD_DURABILITY_NONE)
+		{
+			flags |= MOVEFILE_WRITE_THROUGH;
+		}
+
+	success_flag = (MoveFileExA (file_p -> of_temp_filename_s, file_p -> of_filename_s, flags) != 0);
+#else
+	success_flag = (rename (file_p -> of_temp_filename_s, file_p -> of_filename_s) == 0);
+#endif
+
+	if (success_flag)
+		{
+			FreeCopiedString (file_p -> of_temp_filename_s);
+			file_p -> of_temp_filename_s = NULL;
+		}
+	else
+		{
+			fprintf (stderr, "Failed to replace \"%s\" with \"%s\"\n", file_p -> of_filename_s, file_p -> of_temp_filename_s);
+			DeleteTemporaryFile (dir_p, file_p);
+		}
+
+	return success_flag;
+}
+
+static void DeleteTemporaryFile (OutputDirectory *dir_p, OutputFile *file_p)
+{
+	if (file_p -> of_temp_filename_s)
+		{
+#ifdef LINUX
+			unlinkat (dir_p -> od_fd, file_p -> of_temp_filename_s, 0);
+#else
+			remove (file_p -> of_temp_filename_s);
+#endif
+
+			FreeCopiedString (file_p -> of_temp_filename_s);
+			file_p -> of_temp_filename_s = NULL;
+		}
+}
+
+
+#ifdef LINUX
+
+/*
+ * Sync the directory containing a file so that the file's new name survives a crash.
+ */
+static bool SyncParentDirectory (OutputDirectory *dir_p, const char *relative_s)
+{
+	const char *sep_s = strrchr (relative_s, '/');
+
+	return SyncSubdirectory (dir_p, relative_s, sep_s ? (size_t) (sep_s - relative_s) : 0);
+}
+
+/*
+ * Sync the subdirectory made up of the first length characters of
+ * relative_s or, if length is 0, the output directory itself.
+ */
+static bool SyncSubdirectory (OutputDirectory *dir_p, const char *relative_s, const size_t length)
+{
+	bool success_flag = false;
+
+	if (length > 0)
+		{
+			char *subdir_s = CopyToNewString (relative_s, length, false);
+
+			if (subdir_s)
+				{
+					int fd = openat (dir_p -> od_fd, subdir_s, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+					if (fd != -1)
+						{
+							success_flag = (fsync (fd) == 0);
+							close (fd);
+						}
+
+					FreeCopiedString (subdir_s);
+				}
+		}
+	else
+		{
+			success_flag = (fsync (dir_p -> od_fd) == 0);
+		}
+
+	if (!success_flag)
+		{
+			fprintf (stderr, "Failed to sync the directory for \"%s\": %s\n", relative_s, strerror (errno));
+		}
+
+	return success_flag;
+}
+
+#endif
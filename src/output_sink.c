@@ -0,0 +1,376 @@
+/*
+ * output_sink.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#ifdef LINUX
+	#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WINDOWS
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+#include "output_sink.h"
+
+#include "byte_buffer.h"
+
+
+struct OutputSink
+{
+	FILE *os_out_f;
+
+	/* These are only set for callback and memory sinks */
+	OutputSinkWriteFn os_write_fn;
+	void *os_write_data_p;
+
+	/* This is only set for memory sinks */
+	ByteBuffer *os_buffer_p;
+
+	/* The number of bytes that have been passed to os_write_fn */
+	size_t os_size;
+
+	bool os_error_flag;
+};
+
+
+static const size_t S_MEMORY_SINK_INITIAL_SIZE = 4096;
+
+
+/*
+ * static declarations
+ */
+
+static OutputSink *AllocateOutputSink (FILE *out_f);
+
+static bool AppendToMemorySink (const char *data_s, const size_t length, void *data_p);
+
+#ifdef LINUX
+
+static ssize_t WriteSinkCookie (void *cookie_p, const char *buffer_s, size_t size);
+
+static int SeekSinkCookie (void *cookie_p, off64_t *offset_p, int whence);
+
+#else
+
+static bool PassOnTemporaryOutput (OutputSink *sink_p);
+
+#endif
+
+
+/*
+ * api definitions
+ */
+
+OutputSink *AllocateFileOutputSink (const char *filename_s)
+{
+	FILE *out_f = fopen (filename_s, "w");
+
+	if (out_f)
+		{
+			OutputSink *sink_p = AllocateOutputSink (out_f);
+
+			if (sink_p)
+				{
+					return sink_p;
+				}
+
+			fclose (out_f);
+		}
+
+	return NULL;
+}
+
+
+OutputSink *AllocateFDOutputSink (const int fd)
+{
+	/* Use a copy of the descriptor so that closing the stream leaves fd open */
+#ifdef WINDOWS
+	int copy_fd = _dup (fd);
+#else
+	int copy_fd = dup (fd);
+#endif
+
+	if (copy_fd != -1)
+		{
+#ifdef WINDOWS
+			FILE *out_f = _fdopen (copy_fd, "wb");
+#else
+			FILE *out_f = fdopen (copy_fd, "w");
+#endif
+
+			if (out_f)
+				{
+					OutputSink *sink_p = AllocateOutputSink (out_f);
+
+					if (sink_p)
+						{
+							return sink_p;
+						}
+
+					fclose (out_f);
+				}
+			else
+				{
+#ifdef WINDOWS
+					_close (copy_fd);
+#else
+					close (copy_fd);
+#endif
+				}
+		}
+
+	return NULL;
+}
+
+
+OutputSink *AllocateMemoryOutputSink (void)
+{
+	ByteBuffer *buffer_p = AllocateByteBuffer (S_MEMORY_SINK_INITIAL_SIZE);
+
+	if (buffer_p)
+		{
+			OutputSink *sink_p = AllocateCallbackOutputSink (AppendToMemorySink, buffer_p);
+
+			if (sink_p)
+				{
+					sink_p -> os_buffer_p = buffer_p;
+					return sink_p;
+				}
+
+			FreeByteBuffer (buffer_p);
+		}
+
+	return NULL;
+}
+
+
+OutputSink *AllocateCallbackOutputSink (OutputSinkWriteFn write_fn, void *data_p)
+{
+	OutputSink *sink_p = AllocateOutputSink (NULL);
+
+	if (sink_p)
+		{
+#ifdef LINUX
+			cookie_io_functions_t functions;
+
+			memset (&functions, 0, sizeof (cookie_io_functions_t));
+			functions.write = WriteSinkCookie;
+			functions.seek = SeekSinkCookie;
+
+			sink_p -> os_out_f = fopencookie (sink_p, "w", functions);
+#else
+			/*
+			 * Without custom streams, the output goes to a temporary
+			 * file and is passed on each time that the sink is flushed.
+			 */
+			sink_p -> os_out_f = tmpfile ();
+#endif
+
+			if (sink_p -> os_out_f)
+				{
+					sink_p -> os_write_fn = write_fn;
+					sink_p -> os_write_data_p = data_p;
+
+					return sink_p;
+				}
+
+			free (sink_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeOutputSink (OutputSink *sink_p)
+{
+	if (sink_p -> os_out_f)
+		{
+#ifndef LINUX
+			if (sink_p -> os_write_fn)
+				{
+					PassOnTemporaryOutput (sink_p);
+				}
+#endif
+
+			fclose (sink_p -> os_out_f);
+		}
+
+	if (sink_p -> os_buffer_p)
+		{
+			FreeByteBuffer (sink_p -> os_buffer_p);
+		}
+
+	free (sink_p);
+}
+
+
+FILE *GetOutputSinkStream (OutputSink *sink_p)
+{
+	return sink_p -> os_out_f;
+}
+
+
+bool FlushOutputSink (OutputSink *sink_p)
+{
+	bool success_flag = (fflush (sink_p -> os_out_f) == 0);
+
+#ifndef LINUX
+	if (success_flag && (sink_p -> os_write_fn))
+		{
+			success_flag = PassOnTemporaryOutput (sink_p);
+		}
+#endif
+
+	if (ferror (sink_p -> os_out_f) || (sink_p -> os_error_flag))
+		{
+			success_flag = false;
+		}
+
+	return success_flag;
+}
+
+
+const char *GetOutputSinkData (const OutputSink *sink_p, size_t *length_p)
+{
+	if (sink_p -> os_buffer_p)
+		{
+			*length_p = GetByteBufferSize (sink_p -> os_buffer_p);
+
+			if (*length_p > 0)
+				{
+					return GetByteBufferData (sink_p -> os_buffer_p);
+				}
+		}
+
+	*length_p = 0;
+
+	return NULL;
+}
+
+
+void ResetOutputSinkData (OutputSink *sink_p)
+{
+	if (sink_p -> os_buffer_p)
+		{
+			ResetByteBuffer (sink_p -> os_buffer_p);
+		}
+}
+
+
+/*
+ * static definitions
+ */
+
+static OutputSink *AllocateOutputSink (FILE *out_f)
+{
+	OutputSink *sink_p = (OutputSink *) malloc (sizeof (OutputSink));
+
+	if (sink_p)
+		{
+			sink_p -> os_out_f = out_f;
+			sink_p -> os_write_fn = NULL;
+			sink_p -> os_write_data_p = NULL;
+			sink_p -> os_buffer_p = NULL;
+			sink_p -> os_size = 0;
+			sink_p -> os_error_flag = false;
+		}
+
+	return sink_p;
+}
+
+
+static bool AppendToMemorySink (const char *data_s, const size_t length, void *data_p)
+{
+	return AppendToByteBuffer ((ByteBuffer *) data_p, data_s, length);
+}
+
+
+#ifdef LINUX
+
+static ssize_t WriteSinkCookie (void *cookie_p, const char *buffer_s, size_t size)
+{
+	OutputSink *sink_p = (OutputSink *) cookie_p;
+
+	if (sink_p -> os_write_fn (buffer_s, size, sink_p -> os_write_data_p))
+		{
+			sink_p -> os_size += size;
+			return (ssize_t) size;
+		}
+
+	sink_p -> os_error_flag = true;
+
+	return 0;
+}
+
+
+/*
+ * The stream can't be repositioned, but ftell () still needs
+ * to be able to get its current position.
+ */
+static int SeekSinkCookie (void *cookie_p, off64_t *offset_p, int whence)
+{
+	OutputSink *sink_p = (OutputSink *) cookie_p;
+
+	if ((whence == SEEK_CUR) && (*offset_p == 0))
+		{
+			*offset_p = (off64_t) (sink_p -> os_size);
+			return 0;
+		}
+
+	return -1;
+}
+
+#else
+
+/*
+ * Pass any output in the temporary file that hasn't been
+ * passed on yet to the sink's function.
+ */
+static bool PassOnTemporaryOutput (OutputSink *sink_p)
+{
+	FILE *out_f = sink_p -> os_out_f;
+	bool success_flag = (fseek (out_f, (long) (sink_p -> os_size), SEEK_SET) == 0);
+
+	while (success_flag)
+		{
+			char buffer [8192];
+			const size_t length = fread (buffer, 1, sizeof (buffer), out_f);
+
+			if (length > 0)
+				{
+					if (sink_p -> os_write_fn (buffer, length, sink_p -> os_write_data_p))
+						{
+							sink_p -> os_size += length;
+						}
+					else
+						{
+							sink_p -> os_error_flag = true;
+							success_flag = false;
+						}
+				}
+			else
+				{
+					success_flag = (ferror (out_f) == 0);
+					break;
+				}
+		}
+
+	/* Carry on writing at the end of the file */
+	if (fseek (out_f, 0, SEEK_END) != 0)
+		{
+			success_flag = false;
+		}
+
+	return success_flag;
+}
+
+#endif
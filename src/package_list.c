@@ -0,0 +1,519 @@
+/*
+ * package_list.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef WINDOWS
+	#include <windows.h>
+#else
+	#include <dirent.h>
+#endif
+
+#include "package_list.h"
+
+#include "filesystem_utils.h"
+#include "string_utils.h"
+
+
+/*
+ * Manifests can list other manifests, so stop
+ * at this depth in case one lists itself.
+ */
+static const size_t S_MAX_MANIFEST_DEPTH = 8;
+
+static const char * const S_PACKAGE_FILENAME_S = "datapackage.json";
+
+
+/*
+ * static declarations
+ */
+
+static bool AddPackageInput (json_t *filenames_p, const char *input_s, const char *base_dir_s, const size_t depth);
+
+static bool AddManifestPackages (json_t *filenames_p, const char *manifest_s, const size_t depth);
+
+static bool ClaimOutputName (json_t *used_p, const char *name_s);
+
+static bool AddDirectoryPackages (json_t *filenames_p, const char *dir_s);
+
+static bool AddDirectoryEntry (json_t *entries_p, const char *dir_s, const char *name_s, const bool dir_flag);
+
+static int CompareFilenames (const void *v0_p, const void *v1_p);
+
+static bool IsDirectory (const char *path_s);
+
+static const char *GetLeafName (const char *path_s);
+
+
+/*
+ * api definitions
+ */
+
+json_t *GetPackageFilenames (char **inputs_ss, const size_t num_inputs)
+{
+	json_t *filenames_p = json_array ();
+
+	if (filenames_p)
+		{
+			size_t i;
+
+			for (i = 0; i < num_inputs; ++ i)
+				{
+					if (!AddPackageInput (filenames_p, inputs_ss [i], NULL, 0))
+						{
+							json_decref (filenames_p);
+							return NULL;
+						}
+				}
+		}
+
+	return filenames_p;
+}
+
+
+char *GetPackageOutputName (const char *fd_file_s)
+{
+	const char *leaf_s = GetLeafName (fd_file_s);
+	const char *extension_s = strrchr (leaf_s, '.');
+	size_t length = extension_s ? (size_t) (extension_s - leaf_s) : strlen (leaf_s);
+
+	if ((strcmp (leaf_s, S_PACKAGE_FILENAME_S) == 0) && (leaf_s > fd_file_s))
+		{
+			/* Use the name of the package's directory */
+			const char *dir_end_s = leaf_s - 1;
+			const char *dir_s = dir_end_s;
+
+			while ((dir_s > fd_file_s) && (* (dir_s - 1) != '/') && (* (dir_s - 1) != '\\'))
+				{
+					-- dir_s;
+				}
+
+			if ((dir_end_s > dir_s) && (! ((dir_end_s - dir_s == 1) && (*dir_s == '.'))))
+				{
+					leaf_s = dir_s;
+					length = dir_end_s - dir_s;
+				}
+		}
+
+	return CopyToNewString (leaf_s, length, false);
+}
+
+
+json_t *GetPackageOutputNames (const json_t *filenames_p)
+{
+	json_t *names_p = json_array ();
+	json_t *used_p = json_object ();
+	bool success_flag = false;
+
+	if (names_p && used_p)
+		{
+			size_t i;
+			const json_t *filename_p;
+
+			success_flag = true;
+
+			json_array_foreach (filenames_p, i, filename_p)
+				{
+					const char *fd_file_s = json_string_value (filename_p);
+					char *name_s = GetPackageOutputName (fd_file_s);
+					json_t *name_p = NULL;
+
+					if (name_s)
+						{
+							if (ClaimOutputName (used_p, name_s))
+								{
+									name_p = json_string (name_s);
+								}
+							else
+								{
+									size_t suffix = 2;
+
+									while ((!name_p) && success_flag)
+										{
+											char suffix_s [32];
+											char *candidate_s;
+
+											snprintf (suffix_s, sizeof (suffix_s), "_%lu", (unsigned long) suffix);
+											candidate_s = ConcatenateStrings (name_s, suffix_s);
+
+											if (candidate_s)
+												{
+													if (ClaimOutputName (used_p, candidate_s))
+														{
+															name_p = json_string (candidate_s);
+														}
+
+													FreeCopiedString (candidate_s);
+												}
+											else
+												{
+													success_flag = false;
+												}
+
+											++ suffix;
+										}
+
+									if (name_p)
+										{
+											printf ("Writing \"%s\" to \"%s\" as its output directory name is already in use\n", fd_file_s, json_string_value (name_p));
+										}
+								}
+
+							FreeCopiedString (name_s);
+						}
+
+					if ((!name_p) || (json_array_append_new (names_p, name_p) != 0))
+						{
+							success_flag = false;
+							break;
+						}
+				}
+		}
+
+	if (used_p)
+		{
+			json_decref (used_p);
+		}
+
+	if ((!success_flag) && names_p)
+		{
+			json_decref (names_p);
+			names_p = NULL;
+		}
+
+	return names_p;
+}
+
+
+/*
+ * static definitions
+ */
+
+static bool AddPackageInput (json_t *filenames_p, const char *input_s, const char *base_dir_s, const size_t depth)
+{
+	bool success_flag = false;
+	char *path_s = NULL;
+	const char *value_s = (*input_s == '@') ? input_s + 1 : input_s;
+
+	if ((base_dir_s) && (*value_s != '/') && (*value_s != '\\') && (! ((*value_s != '\0') && (* (value_s + 1) == ':'))))
+		{
+			path_s = MakeFilename (base_dir_s, value_s);
+		}
+	else
+		{
+			path_s = EasyCopyToNewString (value_s);
+		}
+
+	if (path_s)
+		{
+			if (*input_s == '@')
+				{
+					success_flag = AddManifestPackages (filenames_p, path_s, depth + 1);
+				}
+			else if (IsDirectory (path_s))
+				{
+					success_flag = AddDirectoryPackages (filenames_p, path_s);
+				}
+			else
+				{
+					/* Any files that don't exist are reported when they are loaded */
+					success_flag = (json_array_append_new (filenames_p, json_string (path_s)) == 0);
+				}
+
+			FreeCopiedString (path_s);
+		}
+
+	return success_flag;
+}
+
+
+static bool AddManifestPackages (json_t *filenames_p, const char *manifest_s, const size_t depth)
+{
+	bool success_flag = false;
+
+	if (depth <= S_MAX_MANIFEST_DEPTH)
+		{
+			FILE *manifest_f = fopen (manifest_s, "r");
+
+			if (manifest_f)
+				{
+					const char *leaf_s = GetLeafName (manifest_s);
+					char *dir_s = (leaf_s > manifest_s) ? CopyToNewString (manifest_s, leaf_s - manifest_s, false) : NULL;
+					char line_s [4096];
+
+					success_flag = true;
+
+					while (success_flag && (fgets (line_s, sizeof (line_s), manifest_f)))
+						{
+							char *start_s = line_s;
+							char *end_s = line_s + strlen (line_s);
+
+							while ((*start_s == ' ') || (*start_s == '\t'))
+								{
+									++ start_s;
+								}
+
+							while ((end_s > start_s) && ((* (end_s - 1) == '\n') || (* (end_s - 1) == '\r') || (* (end_s - 1) == ' ') || (* (end_s - 1) == '\t')))
+								{
+									-- end_s;
+								}
+
+							*end_s = '\0';
+
+							if ((*start_s != '\0') && (*start_s != '#'))
+								{
+									success_flag = AddPackageInput (filenames_p, start_s, dir_s, depth);
+								}
+						}
+
+					if (dir_s)
+						{
+							FreeCopiedString (dir_s);
+						}
+
+					fclose (manifest_f);
+				}
+			else
+				{
+					printf ("Failed to open the manifest \"%s\"\n", manifest_s);
+				}
+		}
+	else
+		{
+			printf ("The manifest \"%s\" is nested too deeply\n", manifest_s);
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Add a directory's .json files and the datapackage.json files
+ * of its subdirectories in alphabetical order
+ */
+static bool AddDirectoryPackages (json_t *filenames_p, const char *dir_s)
+{
+	bool success_flag = false;
+	json_t *entries_p = json_array ();
+
+	if (entries_p)
+		{
+#ifdef WINDOWS
+			char *pattern_s = MakeFilename (dir_s, "*");
+
+			if (pattern_s)
+				{
+					WIN32_FIND_DATAA data;
+					HANDLE find_handle = FindFirstFileA (pattern_s, &data);
+
+					if (find_handle != INVALID_HANDLE_VALUE)
+						{
+							success_flag = true;
+
+							do
+								{
+									success_flag = AddDirectoryEntry (entries_p, dir_s, data.cFileName, (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0);
+								}
+							while (success_flag && FindNextFileA (find_handle, &data));
+
+							FindClose (find_handle);
+						}
+
+					FreeCopiedString (pattern_s);
+				}
+#else
+			DIR *dir_p = opendir (dir_s);
+
+			if (dir_p)
+				{
+					struct dirent *entry_p;
+
+					success_flag = true;
+
+					while (success_flag && ((entry_p = readdir (dir_p)) != NULL))
+						{
+							char *path_s = MakeFilename (dir_s, entry_p -> d_name);
+
+							if (path_s)
+								{
+									success_flag = AddDirectoryEntry (entries_p, dir_s, entry_p -> d_name, IsDirectory (path_s));
+									FreeCopiedString (path_s);
+								}
+							else
+								{
+									success_flag = false;
+								}
+						}
+
+					closedir (dir_p);
+				}
+#endif
+
+			if (success_flag)
+				{
+					const size_t num_entries = json_array_size (entries_p);
+
+					if (num_entries > 0)
+						{
+							const char **paths_ss = (const char **) malloc (num_entries * sizeof (const char *));
+
+							if (paths_ss)
+								{
+									size_t i;
+
+									for (i = 0; i < num_entries; ++ i)
+										{
+											paths_ss [i] = json_string_value (json_array_get (entries_p, i));
+										}
+
+									qsort (paths_ss, num_entries, sizeof (const char *), CompareFilenames);
+
+									for (i = 0; (i < num_entries) && success_flag; ++ i)
+										{
+											success_flag = (json_array_append_new (filenames_p, json_string (paths_ss [i])) == 0);
+										}
+
+									free (paths_ss);
+								}
+							else
+								{
+									success_flag = false;
+								}
+						}
+				}
+			else
+				{
+					printf ("Failed to read the directory \"%s\"\n", dir_s);
+				}
+
+			json_decref (entries_p);
+		}
+
+	return success_flag;
+}
+
+
+static bool AddDirectoryEntry (json_t *entries_p, const char *dir_s, const char *name_s, const bool dir_flag)
+{
+	bool success_flag = true;
+
+	if (*name_s != '.')
+		{
+			char *path_s = NULL;
+
+			if (dir_flag)
+				{
+					char *subdir_s = MakeFilename (dir_s, name_s);
+
+					if (subdir_s)
+						{
+							path_s = MakeFilename (subdir_s, S_PACKAGE_FILENAME_S);
+							FreeCopiedString (subdir_s);
+
+							if (path_s)
+								{
+									struct stat st;
+
+									/* Subdirectories without a package are skipped */
+									if (stat (path_s, &st) != 0)
+										{
+											FreeCopiedString (path_s);
+											return true;
+										}
+								}
+						}
+				}
+			else
+				{
+					const size_t length = strlen (name_s);
+
+					if ((length <= 5) || (strcmp (name_s + length - 5, ".json") != 0))
+						{
+							return true;
+						}
+
+					path_s = MakeFilename (dir_s, name_s);
+				}
+
+			if (path_s)
+				{
+					success_flag = (json_array_append_new (entries_p, json_string (path_s)) == 0);
+					FreeCopiedString (path_s);
+				}
+			else
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static int CompareFilenames (const void *v0_p, const void *v1_p)
+{
+	return strcmp (* ((const char * const *) v0_p), * ((const char * const *) v1_p));
+}
+
+
+static bool IsDirectory (const char *path_s)
+{
+	struct stat st;
+
+	return ((stat (path_s, &st) == 0) && ((st.st_mode & S_IFMT) == S_IFDIR));
+}
+
+
+static const char *GetLeafName (const char *path_s)
+{
+	const char *leaf_s = path_s;
+	const char *c_p;
+
+	for (c_p = path_s; *c_p != '\0'; ++ c_p)
+		{
+			if ((*c_p == '/') || (*c_p == '\\'))
+				{
+					leaf_s = c_p + 1;
+				}
+		}
+
+	return leaf_s;
+}
+
+
+/*
+ * Mark a directory name as used if it isn't already, ignoring
+ * case as the filesystem might do.
+ */
+static bool ClaimOutputName (json_t *used_p, const char *name_s)
+{
+	bool claimed_flag = false;
+	char *key_s = EasyCopyToNewString (name_s);
+
+	if (key_s)
+		{
+			char *c_p;
+
+			for (c_p = key_s; *c_p != '\0'; ++ c_p)
+				{
+					*c_p = (char) tolower ((unsigned char) *c_p);
+				}
+
+			if (!json_object_get (used_p, key_s))
+				{
+					claimed_flag = (json_object_set_new (used_p, key_s, json_true ()) == 0);
+				}
+
+			FreeCopiedString (key_s);
+		}
+
+	return claimed_flag;
+}
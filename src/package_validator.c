@@ -0,0 +1,3411 @@
+/*
+ * package_validator.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WINDOWS
+	#include <regex.h>
+#endif
+
+#include "package_validator.h"
+#include "parallel_tasks.h"
+#include "csv_reader.h"
+
+#include "frictionless_data_util.h"
+
+#include "byte_buffer.h"
+#include "json_util.h"
+#include "string_utils.h"
+
+
+/*
+ * The JSON types that a value can have, as bit flags
+ * so that a schema can allow more than one of them.
+ */
+typedef enum
+{
+	VT_NULL = 1 << 0,
+	VT_BOOLEAN = 1 << 1,
+	VT_INTEGER = 1 << 2,
+	VT_NUMBER = 1 << 3,
+	VT_STRING = 1 << 4,
+	VT_ARRAY = 1 << 5,
+	VT_OBJECT = 1 << 6
+} ValueType;
+
+
+/*
+ * The checks on a single value that are shared by
+ * JSON schemas and the fields of tabular data.
+ */
+typedef struct
+{
+	/** The allowed ValueTypes or 0 for any type. */
+	uint32 vc_types;
+
+	const char *vc_format_s;
+
+	bool vc_minimum_flag;
+	double vc_minimum;
+
+	bool vc_maximum_flag;
+	double vc_maximum;
+
+	size_t vc_min_length;
+
+	bool vc_max_length_flag;
+	size_t vc_max_length;
+
+	const json_t *vc_enum_p;
+
+	const char *vc_pattern_s;
+
+#ifndef WINDOWS
+	regex_t *vc_pattern_p;
+#endif
+} ValueConstraints;
+
+
+typedef struct
+{
+	const char *sp_key_s;
+	SchemaNode *sp_node_p;
+} SchemaProperty;
+
+
+struct SchemaNode
+{
+	/** If the schema is just a ref, this is the schema that it refers to. */
+	SchemaNode *sn_ref_p;
+
+	ValueConstraints sn_constraints;
+
+	SchemaProperty *sn_properties_p;
+	size_t sn_num_properties;
+
+	const char **sn_required_ss;
+	size_t sn_num_required;
+
+	SchemaNode *sn_items_p;
+
+	/** The schemas from an anyOf or oneOf. */
+	SchemaNode **sn_alternatives_pp;
+	size_t sn_num_alternatives;
+	bool sn_one_of_flag;
+
+	/** This is set if the schema could not be compiled, e.g. a ref that could not be resolved. */
+	char *sn_error_s;
+};
+
+
+typedef enum
+{
+	TFT_STRING,
+	TFT_INTEGER,
+	TFT_NUMBER,
+	TFT_BOOLEAN,
+	TFT_DATE,
+	TFT_ANY
+} TableFieldType;
+
+
+typedef enum
+{
+	CS_MISSING,
+	CS_PRESENT,
+	CS_INVALID
+} CellState;
+
+
+/*
+ * The values of a field converted to its type. Only the array
+ * for the field's type is allocated, with strings used for dates
+ * and fields of any type.
+ */
+typedef struct
+{
+	/** The CellState of each value. */
+	uint8 *tc_states_p;
+	int64 *tc_integers_p;
+	double *tc_numbers_p;
+	uint8 *tc_booleans_p;
+
+	/** These point into the package rather than being copies. */
+	const char **tc_strings_p;
+} TableColumn;
+
+
+typedef struct
+{
+	const char *tf_name_s;
+	TableFieldType tf_type;
+	ValueConstraints tf_constraints;
+	bool tf_required_flag;
+	bool tf_unique_flag;
+	const json_t *tf_true_values_p;
+	const json_t *tf_false_values_p;
+	TableColumn tf_column;
+
+	/** The allowed values converted to the field's type. */
+	TableColumn tf_enum;
+	size_t tf_num_enum_values;
+	bool tf_enum_flag;
+
+	/** The position of the field's value in rows that are arrays, or -1 if they don't have it. */
+	long tf_data_column;
+} TableField;
+
+
+typedef struct
+{
+	TableField *ts_fields_p;
+	size_t ts_num_fields;
+	size_t ts_num_unique_fields;
+	size_t ts_num_rows;
+
+	/** The index of the first row in ts_data_p, for tables that are checked a chunk at a time. */
+	size_t ts_first_row;
+
+	/** The indexes of the fields that make up the primary key. */
+	size_t *ts_primary_key_p;
+	size_t ts_primary_key_size;
+	const json_t *ts_missing_values_p;
+	const json_t *ts_data_p;
+
+	/**
+	 * If the inline data is given as arrays, this is its first row which has
+	 * the names of the columns rather than values so it isn't checked.
+	 */
+	const json_t *ts_header_p;
+} TableSchema;
+
+
+typedef enum
+{
+	/** Check a resource against its profile. */
+	TT_SCHEMA,
+
+	/** Convert and check a range of the rows of a field of a table. */
+	TT_COLUMN,
+
+	/** Check that a field of a table has unique values. */
+	TT_UNIQUE,
+
+	/** Check that the primary key of a table is unique. */
+	TT_PRIMARY_KEY,
+
+	/** Read and check a table from its external CSV files a chunk of rows at a time. */
+	TT_CSV_TABLE
+} ValidationTaskType;
+
+
+typedef struct
+{
+	ValidationTaskType vt_type;
+	size_t vt_resource;
+	size_t vt_field;
+	size_t vt_first_row;
+	size_t vt_last_row;
+	json_t *vt_errors_p;
+	size_t vt_num_errors;
+} ValidationTask;
+
+
+typedef struct
+{
+	const json_t *rc_resource_p;
+	const char *rc_name_s;
+	const char *rc_profile_s;
+	SchemaNode *rc_node_p;
+	TableSchema *rc_table_p;
+
+	/** Whether the table's data is read from its path rather than being inline. */
+	bool rc_path_flag;
+	const char *rc_error_s;
+	bool rc_checked_flag;
+	size_t rc_first_task;
+	size_t rc_num_tasks;
+} ResourceCheck;
+
+
+typedef struct
+{
+	PackageValidator *vr_validator_p;
+	ResourceCheck *vr_checks_p;
+	ValidationTask *vr_tasks_p;
+
+	/** The indexes of the tasks that are being run. */
+	const size_t *vr_task_indices_p;
+
+	/** The filename of the package that the paths of resources are relative to. */
+	const char *vr_package_file_s;
+} ValidationRun;
+
+
+typedef struct
+{
+	/** If this is NULL, the errors are only counted. */
+	json_t *er_errors_p;
+	size_t er_num_errors;
+	size_t er_max_errors;
+} ErrorReporter;
+
+
+/*
+ * The state for checking a table that is read from CSV files
+ */
+typedef struct
+{
+	TableSchema *ct_table_p;
+
+	/** The index of the CSV column for each of the table's fields, or -1 if it is not in the CSV. */
+	long *ct_columns_p;
+
+	/** The number of values that each row should have. */
+	size_t ct_num_columns;
+
+	/** The keys seen so far for each unique field followed by the primary key. */
+	json_t **ct_seen_keys_pp;
+	ByteBuffer *ct_key_buffer_p;
+	ErrorReporter *ct_reporter_p;
+} CSVTableCheck;
+
+
+/*
+ * A chunk of the rows of a table from CSV files, which has its
+ * own columns and errors so that it can be checked on any thread.
+ */
+typedef struct
+{
+	const CSVTableCheck *ck_check_p;
+
+	/** The table's schema compiled again with columns for the chunk's rows. */
+	TableSchema *ck_table_p;
+
+	/** The rows, each an array of strings in the same order as the table's fields. */
+	json_t *ck_rows_p;
+
+	/** The number of rows that the columns can hold. */
+	size_t ck_capacity;
+
+	/** The errors with row numbers relative to the start of the chunk. */
+	ErrorReporter ck_reporter;
+	bool ck_success_flag;
+} CSVTableChunk;
+
+
+/*
+ * The JSON pointer to the value being checked
+ */
+typedef struct
+{
+	char pb_path_s [512];
+	size_t pb_length;
+} PathBuffer;
+
+
+/*
+ * Tables are split into chunks of this many rows
+ * so that large ones can be checked in parallel.
+ */
+static const size_t S_ROWS_PER_TASK = 65536;
+
+static const size_t S_MAX_DEPTH = 64;
+
+static const char * const S_DEFAULT_TRUE_VALUES_SS [] = { "true", "True", "TRUE", "1", NULL };
+static const char * const S_DEFAULT_FALSE_VALUES_SS [] = { "false", "False", "FALSE", "0", NULL };
+
+/* These are in the same order as TableFieldType */
+static const char * const S_TABLE_FIELD_TYPES_SS [] = { FD_TYPE_STRING, FD_TYPE_INTEGER, FD_TYPE_NUMBER, FD_TYPE_BOOLEAN, "date", "any" };
+
+
+/*
+ * static declarations
+ */
+
+static bool PrepareResourceCheck (PackageValidator *validator_p, const json_t *resource_p, ResourceCheck *check_p, size_t *num_tasks_p);
+
+static size_t GetNumTableTasks (const TableSchema *table_p);
+
+static void InitTableTasks (const TableSchema *table_p, ValidationTask *tasks_p);
+
+static bool IsTableCheckTask (const ValidationTask *task_p);
+
+static void RunValidationTask (void *data_p, const size_t task_index);
+
+static json_t *GetResourceReport (const ResourceCheck *check_p, const size_t index, const ValidationTask *tasks_p, const size_t max_errors, size_t *num_errors_p);
+
+static SchemaNode *CompileSchema (PackageValidator *validator_p, const json_t *schema_p, const json_t *document_p, const char *url_s);
+
+static void CompileSchemaNode (PackageValidator *validator_p, SchemaNode *node_p, const json_t *schema_p, const json_t *document_p, const char *url_s);
+
+static SchemaNode *AddSchemaNode (PackageValidator *validator_p, const char *key_s);
+
+static void FreeSchemaNode (SchemaNode *node_p);
+
+static TableSchema *CompileTableSchema (const json_t *schema_p, const json_t *data_p, const size_t num_rows);
+
+static void FreeTableSchema (TableSchema *table_p);
+
+static bool AllocateTableColumn (TableColumn *column_p, const TableFieldType type, const size_t num_rows);
+
+static void FreeTableColumn (TableColumn *column_p);
+
+static bool CompileTableEnum (TableField *field_p);
+
+static bool SetPrimaryKey (TableSchema *table_p, const json_t *primary_key_p);
+
+static void SetConstraints (ValueConstraints *constraints_p, const json_t *source_p, const bool anchored_flag);
+
+static void ClearConstraints (ValueConstraints *constraints_p);
+
+static bool GetConstraintNumber (const json_t *source_p, const char *key_s, double *value_p);
+
+static void ValidateValue (const SchemaNode *node_p, const json_t *value_p, PathBuffer *path_p, ErrorReporter *reporter_p, const size_t depth);
+
+static void CheckCSVTable (TableSchema *table_p, const json_t *resource_p, const char *package_file_s, const size_t num_threads, ErrorReporter *reporter_p);
+
+static bool MapCSVTableColumns (void *data_p, const size_t row, char **values_ss, const size_t num_values);
+
+static bool AddCSVTableRow (void *data_p, const size_t row, char **values_ss, const size_t num_values);
+
+static void CheckCSVTableChunk (void *chunk_data_p, const size_t num_rows);
+
+static bool MergeCSVTableChunk (void *data_p, void *chunk_data_p, const size_t first_row, const size_t num_rows);
+
+static void ResetCSVTableChunk (void *chunk_data_p);
+
+static void MergeTableErrors (const ErrorReporter *chunk_reporter_p, const size_t first_row, ErrorReporter *reporter_p);
+
+static bool ResizeTableColumns (TableSchema *table_p, const size_t num_rows);
+
+static void ConvertTableColumn (const TableSchema *table_p, const size_t field_index, const size_t first_row, const size_t last_row, ErrorReporter *reporter_p);
+
+static bool ConvertTableValue (const TableField *field_p, const json_t *value_p, const TableColumn *column_p, const size_t index);
+
+static void CheckTableColumn (const TableSchema *table_p, const size_t field_index, const size_t first_row, const size_t last_row, ErrorReporter *reporter_p);
+
+static bool IsInTableEnum (const TableField *field_p, const size_t row);
+
+static void ReportTableEnumError (const TableSchema *table_p, const TableField *field_p, const size_t row, ErrorReporter *reporter_p);
+
+static void CheckUniqueRows (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const bool primary_key_flag, ErrorReporter *reporter_p);
+
+static void CheckStreamedUniqueRows (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const bool primary_key_flag, json_t *seen_keys_p, ByteBuffer *buffer_p, ErrorReporter *reporter_p);
+
+static bool IsTableKeyPresent (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row, const bool primary_key_flag, ErrorReporter *reporter_p);
+
+static bool AppendTableKey (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row, ByteBuffer *buffer_p);
+
+static uint64 HashTableRow (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row);
+
+static bool AreTableRowsEqual (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row_0, const size_t row_1);
+
+static const json_t *GetCell (const json_t *row_p, const TableField *field_p);
+
+static long GetHeaderColumn (const json_t *header_p, const char *name_s);
+
+static bool IsMissingValue (const TableSchema *table_p, const json_t *cell_p);
+
+static void CheckStringConstraints (const ValueConstraints *constraints_p, const char *value_s, const char *path_s, const size_t row, const char *field_s, ErrorReporter *reporter_p);
+
+static void CheckNumberConstraints (const ValueConstraints *constraints_p, const double value, const char *path_s, const size_t row, const char *field_s, ErrorReporter *reporter_p);
+
+static bool IsValidFormat (const char *format_s, const char *value_s);
+
+static bool IsValidDate (const char *value_s);
+
+static bool ParseTableNumber (const json_t *cell_p, const bool integer_flag, double *value_p);
+
+static bool ParseTableInteger (const json_t *cell_p, int64 *value_p);
+
+static bool IsStringInList (const char *value_s, const json_t *values_p, const char * const *default_values_ss);
+
+static uint32 GetValueTypes (const json_t *type_p);
+
+static uint32 GetValueType (const json_t *value_p);
+
+static void GetValueTypeNames (const uint32 types, char *buffer_s, const size_t buffer_size);
+
+static size_t GetUTF8Length (const char *value_s);
+
+static void ReportError (ErrorReporter *reporter_p, const char *path_s, const size_t row, const char *field_s, const char *format_s, ...);
+
+static const char *GetValueExcerpt (const char *value_s, char *buffer_s, const size_t buffer_size);
+
+static void TrimToUTF8Boundary (char *value_s);
+
+static size_t AppendPathKey (PathBuffer *path_p, const char *key_s);
+
+static size_t AppendPathIndex (PathBuffer *path_p, const size_t index);
+
+static void RestorePath (PathBuffer *path_p, const size_t length);
+
+
+/*
+ * api definitions
+ */
+
+PackageValidator *AllocatePackageValidator (SchemaCache *schema_cache_p, const size_t num_threads, const size_t max_errors)
+{
+	json_t *compiled_p = json_object ();
+
+	if (compiled_p)
+		{
+			PackageValidator *validator_p = (PackageValidator *) malloc (sizeof (PackageValidator));
+
+			if (validator_p)
+				{
+					validator_p -> pv_schema_cache_p = schema_cache_p;
+					validator_p -> pv_num_threads = num_threads;
+					validator_p -> pv_max_errors = max_errors;
+					validator_p -> pv_nodes_pp = NULL;
+					validator_p -> pv_num_nodes = 0;
+					validator_p -> pv_nodes_capacity = 0;
+					validator_p -> pv_compiled_p = compiled_p;
+
+					return validator_p;
+				}
+
+			json_decref (compiled_p);
+		}
+
+	return NULL;
+}
+
+
+void FreePackageValidator (PackageValidator *validator_p)
+{
+	size_t i;
+
+	for (i = 0; i < validator_p -> pv_num_nodes; ++ i)
+		{
+			FreeSchemaNode (validator_p -> pv_nodes_pp [i]);
+		}
+
+	if (validator_p -> pv_nodes_pp)
+		{
+			free (validator_p -> pv_nodes_pp);
+		}
+
+	json_decref (validator_p -> pv_compiled_p);
+	free (validator_p);
+}
+
+
+json_t *ValidatePackage (PackageValidator *validator_p, const json_t *fd_p, const char *fd_file_s, bool *valid_flag_p)
+{
+	/* The totals are filled in at the end but are added first so that they come before the resources */
+	json_t *report_p = json_pack ("{s:b,s:i,s:i}", "valid", 0, "num_resources", 0, "num_errors", 0);
+
+	if (report_p)
+		{
+			json_t *resource_reports_p = json_array ();
+
+			if (resource_reports_p)
+				{
+					if (json_object_set_new (report_p, FD_RESOURCES_S, resource_reports_p) == 0)
+						{
+							const json_t *resources_p = json_object_get (fd_p, FD_RESOURCES_S);
+							const size_t num_resources = json_array_size (resources_p);
+							ResourceCheck *checks_p = (ResourceCheck *) calloc (num_resources + 1, sizeof (ResourceCheck));
+							bool success_flag = false;
+
+							if (checks_p)
+								{
+									size_t num_tasks = 0;
+									size_t i;
+
+									success_flag = true;
+
+									/*
+									 * Load and compile all of the schemas up front as the
+									 * SchemaCache can't be used by more than one thread.
+									 */
+									for (i = 0; i < num_resources; ++ i)
+										{
+											ResourceCheck *check_p = checks_p + i;
+
+											check_p -> rc_first_task = num_tasks;
+
+											if (!PrepareResourceCheck (validator_p, json_array_get (resources_p, i), check_p, &num_tasks))
+												{
+													success_flag = false;
+												}
+										}
+
+									if (success_flag)
+										{
+											ValidationTask *tasks_p = (ValidationTask *) calloc (num_tasks + 1, sizeof (ValidationTask));
+
+											success_flag = false;
+
+											if (tasks_p)
+												{
+													size_t num_errors = 0;
+
+													success_flag = true;
+
+													for (i = 0; i < num_resources; ++ i)
+														{
+															const ResourceCheck *check_p = checks_p + i;
+															ValidationTask *task_p = tasks_p + check_p -> rc_first_task;
+															size_t j;
+
+															for (j = 0; j < check_p -> rc_num_tasks; ++ j, ++ task_p)
+																{
+																	task_p -> vt_resource = i;
+
+																	/* The arrays are made here rather than by each thread */
+																	task_p -> vt_errors_p = json_array ();
+
+																	if (! (task_p -> vt_errors_p))
+																		{
+																			success_flag = false;
+																		}
+																}
+
+															if (check_p -> rc_node_p)
+																{
+																	tasks_p [check_p -> rc_first_task].vt_type = TT_SCHEMA;
+																}
+															else if (check_p -> rc_path_flag)
+																{
+																	tasks_p [check_p -> rc_first_task].vt_type = TT_CSV_TABLE;
+																}
+															else if (check_p -> rc_table_p)
+																{
+																	InitTableTasks (check_p -> rc_table_p, tasks_p + check_p -> rc_first_task);
+																}
+														}
+
+													if (success_flag)
+														{
+															size_t *indices_p = (size_t *) calloc (num_tasks + 1, sizeof (size_t));
+
+															success_flag = false;
+
+															if (indices_p)
+																{
+																	ValidationRun run;
+																	size_t num_check_tasks = 0;
+																	size_t num_unique_tasks = 0;
+
+																	/*
+																	 * The uniqueness checks need all of the columns of their tables
+																	 * to have been converted, so they are run after everything else.
+																	 */
+																	for (i = 0; i < num_tasks; ++ i)
+																		{
+																			if (IsTableCheckTask (tasks_p + i))
+																				{
+																					indices_p [num_check_tasks] = i;
+																					++ num_check_tasks;
+																				}
+																		}
+
+																	for (i = 0; i < num_tasks; ++ i)
+																		{
+																			if (!IsTableCheckTask (tasks_p + i))
+																				{
+																					indices_p [num_check_tasks + num_unique_tasks] = i;
+																					++ num_unique_tasks;
+																				}
+																		}
+
+																	run.vr_validator_p = validator_p;
+																	run.vr_checks_p = checks_p;
+																	run.vr_tasks_p = tasks_p;
+																	run.vr_task_indices_p = indices_p;
+																	run.vr_package_file_s = fd_file_s;
+
+																	if (RunParallelTasks (num_check_tasks, validator_p -> pv_num_threads, RunValidationTask, &run))
+																		{
+																			run.vr_task_indices_p = indices_p + num_check_tasks;
+
+																			success_flag = RunParallelTasks (num_unique_tasks, validator_p -> pv_num_threads, RunValidationTask, &run);
+																		}
+
+																	free (indices_p);
+																}
+														}
+
+													/*
+													 * Collect the errors for each resource in order
+													 */
+													for (i = 0; i < num_resources; ++ i)
+														{
+															if (success_flag)
+																{
+																	size_t num_resource_errors = 0;
+																	json_t *resource_report_p = GetResourceReport (checks_p + i, i, tasks_p, validator_p -> pv_max_errors, &num_resource_errors);
+
+																	num_errors += num_resource_errors;
+
+																	if ((!resource_report_p) || (json_array_append_new (resource_reports_p, resource_report_p) != 0))
+																		{
+																			success_flag = false;
+																		}
+																}
+														}
+
+													for (i = 0; i < num_tasks; ++ i)
+														{
+															if (tasks_p [i].vt_errors_p)
+																{
+																	json_decref (tasks_p [i].vt_errors_p);
+																}
+														}
+
+													free (tasks_p);
+
+													if (success_flag)
+														{
+															if ((json_object_set_new (report_p, "valid", json_boolean (num_errors == 0)) != 0) ||
+																	(json_object_set_new (report_p, "num_resources", json_integer (num_resources)) != 0) ||
+																	(json_object_set_new (report_p, "num_errors", json_integer (num_errors)) != 0))
+																{
+																	success_flag = false;
+																}
+
+															if (valid_flag_p)
+																{
+																	*valid_flag_p = (num_errors == 0);
+																}
+														}
+												}
+										}
+
+									for (i = 0; i < num_resources; ++ i)
+										{
+											if (checks_p [i].rc_table_p)
+												{
+													FreeTableSchema (checks_p [i].rc_table_p);
+												}
+										}
+
+									free (checks_p);
+								}
+
+							if (success_flag)
+								{
+									return report_p;
+								}
+						}
+					else
+						{
+							json_decref (resource_reports_p);
+						}
+				}
+
+			json_decref (report_p);
+		}
+
+	return NULL;
+}
+
+
+/*
+ * static definitions
+ */
+
+static bool PrepareResourceCheck (PackageValidator *validator_p, const json_t *resource_p, ResourceCheck *check_p, size_t *num_tasks_p)
+{
+	bool success_flag = true;
+	const char *profile_s = GetJSONString (resource_p, FD_PROFILE_S);
+
+	check_p -> rc_resource_p = resource_p;
+	check_p -> rc_profile_s = profile_s;
+	check_p -> rc_name_s = GetJSONString (resource_p, FD_NAME_S);
+
+	if (! (check_p -> rc_name_s))
+		{
+			check_p -> rc_name_s = GetJSONString (resource_p, FD_TABLE_FIELD_TITLE);
+		}
+
+	if (profile_s)
+		{
+			if (DoesStringStartWith (profile_s, "http"))
+				{
+					const json_t *schema_p = GetSchemaFromCache (validator_p -> pv_schema_cache_p, profile_s);
+
+					check_p -> rc_checked_flag = true;
+
+					if (schema_p)
+						{
+							check_p -> rc_node_p = CompileSchema (validator_p, schema_p, schema_p, profile_s);
+
+							if (check_p -> rc_node_p)
+								{
+									check_p -> rc_num_tasks = 1;
+								}
+							else
+								{
+									success_flag = false;
+								}
+						}
+					else
+						{
+							check_p -> rc_error_s = "the profile could not be loaded";
+						}
+				}
+			else if (strcmp (profile_s, FD_PROFILE_TABULAR_RESOURCE_S) == 0)
+				{
+					const json_t *schema_p = json_object_get (resource_p, FD_SCHEMA_S);
+					const json_t *data_p = json_object_get (resource_p, FD_DATA_S);
+
+					if (json_is_object (schema_p) && (json_is_array (data_p) || IsPathBasedResource (resource_p)))
+						{
+							check_p -> rc_checked_flag = true;
+
+							if (data_p)
+								{
+									check_p -> rc_table_p = CompileTableSchema (schema_p, data_p, json_array_size (data_p));
+								}
+							else
+								{
+									/* The rows are checked in chunks that have their own columns */
+									check_p -> rc_path_flag = true;
+									check_p -> rc_table_p = CompileTableSchema (schema_p, NULL, 0);
+								}
+
+							if (check_p -> rc_table_p)
+								{
+									check_p -> rc_num_tasks = (check_p -> rc_path_flag) ? 1 : GetNumTableTasks (check_p -> rc_table_p);
+
+									if (! (check_p -> rc_name_s))
+										{
+											check_p -> rc_name_s = GetJSONString (schema_p, FD_TITLE_S);
+										}
+								}
+							else
+								{
+									success_flag = false;
+								}
+						}
+				}
+		}
+
+	*num_tasks_p += check_p -> rc_num_tasks;
+
+	return success_flag;
+}
+
+
+/*
+ * Each table has a task for each range of rows of each of its fields
+ * followed by one for each unique field and one for its primary key.
+ */
+static size_t GetNumTableTasks (const TableSchema *table_p)
+{
+	const size_t num_ranges = (table_p -> ts_num_rows + S_ROWS_PER_TASK - 1) / S_ROWS_PER_TASK;
+	size_t num_tasks = (num_ranges * table_p -> ts_num_fields) + table_p -> ts_num_unique_fields;
+
+	if (table_p -> ts_primary_key_size > 0)
+		{
+			++ num_tasks;
+		}
+
+	return num_tasks;
+}
+
+
+static void InitTableTasks (const TableSchema *table_p, ValidationTask *tasks_p)
+{
+	const size_t num_ranges = (table_p -> ts_num_rows + S_ROWS_PER_TASK - 1) / S_ROWS_PER_TASK;
+	ValidationTask *task_p = tasks_p;
+	size_t i;
+
+	/* Go through the ranges first so that the errors are roughly in row order */
+	for (i = 0; i < num_ranges; ++ i)
+		{
+			size_t j;
+
+			for (j = 0; j < table_p -> ts_num_fields; ++ j, ++ task_p)
+				{
+					task_p -> vt_type = TT_COLUMN;
+					task_p -> vt_field = j;
+					task_p -> vt_first_row = i * S_ROWS_PER_TASK;
+					task_p -> vt_last_row = task_p -> vt_first_row + S_ROWS_PER_TASK;
+
+					if (task_p -> vt_last_row > table_p -> ts_num_rows)
+						{
+							task_p -> vt_last_row = table_p -> ts_num_rows;
+						}
+				}
+		}
+
+	for (i = 0; i < table_p -> ts_num_fields; ++ i)
+		{
+			if (table_p -> ts_fields_p [i].tf_unique_flag)
+				{
+					task_p -> vt_type = TT_UNIQUE;
+					task_p -> vt_field = i;
+					++ task_p;
+				}
+		}
+
+	if (table_p -> ts_primary_key_size > 0)
+		{
+			task_p -> vt_type = TT_PRIMARY_KEY;
+		}
+}
+
+
+static bool IsTableCheckTask (const ValidationTask *task_p)
+{
+	return ((task_p -> vt_type != TT_UNIQUE) && (task_p -> vt_type != TT_PRIMARY_KEY));
+}
+
+
+static void RunValidationTask (void *data_p, const size_t task_index)
+{
+	ValidationRun *run_p = (ValidationRun *) data_p;
+	ValidationTask *task_p = run_p -> vr_tasks_p + run_p -> vr_task_indices_p [task_index];
+	const ResourceCheck *check_p = run_p -> vr_checks_p + task_p -> vt_resource;
+	ErrorReporter reporter;
+
+	reporter.er_errors_p = task_p -> vt_errors_p;
+	reporter.er_num_errors = 0;
+	reporter.er_max_errors = run_p -> vr_validator_p -> pv_max_errors;
+
+	switch (task_p -> vt_type)
+		{
+			case TT_SCHEMA:
+				{
+					PathBuffer path;
+
+					* (path.pb_path_s) = '\0';
+					path.pb_length = 0;
+
+					ValidateValue (check_p -> rc_node_p, check_p -> rc_resource_p, &path, &reporter, 0);
+				}
+				break;
+
+			case TT_COLUMN:
+				ConvertTableColumn (check_p -> rc_table_p, task_p -> vt_field, task_p -> vt_first_row, task_p -> vt_last_row, &reporter);
+				CheckTableColumn (check_p -> rc_table_p, task_p -> vt_field, task_p -> vt_first_row, task_p -> vt_last_row, &reporter);
+				break;
+
+			case TT_UNIQUE:
+				CheckUniqueRows (check_p -> rc_table_p, & (task_p -> vt_field), 1, false, &reporter);
+				break;
+
+			case TT_PRIMARY_KEY:
+				CheckUniqueRows (check_p -> rc_table_p, check_p -> rc_table_p -> ts_primary_key_p, check_p -> rc_table_p -> ts_primary_key_size, true, &reporter);
+				break;
+
+			case TT_CSV_TABLE:
+				CheckCSVTable (check_p -> rc_table_p, check_p -> rc_resource_p, run_p -> vr_package_file_s, run_p -> vr_validator_p -> pv_num_threads, &reporter);
+				break;
+		}
+
+	task_p -> vt_num_errors = reporter.er_num_errors;
+}
+
+
+static json_t *GetResourceReport (const ResourceCheck *check_p, const size_t index, const ValidationTask *tasks_p, const size_t max_errors, size_t *num_errors_p)
+{
+	json_t *report_p = json_object ();
+
+	if (report_p)
+		{
+			bool success_flag = (json_object_set_new (report_p, "index", json_integer (index)) == 0);
+
+			if (success_flag && (check_p -> rc_name_s))
+				{
+					success_flag = (json_object_set_new (report_p, FD_NAME_S, json_string (check_p -> rc_name_s)) == 0);
+				}
+
+			if (success_flag && (check_p -> rc_profile_s))
+				{
+					success_flag = (json_object_set_new (report_p, FD_PROFILE_S, json_string (check_p -> rc_profile_s)) == 0);
+				}
+
+			if (success_flag)
+				{
+					if (check_p -> rc_checked_flag)
+						{
+							json_t *errors_p = json_array ();
+
+							if (errors_p)
+								{
+									size_t num_errors = 0;
+									size_t i;
+
+									if (check_p -> rc_error_s)
+										{
+											json_t *error_p = json_pack ("{s:s}", "message", check_p -> rc_error_s);
+
+											if ((!error_p) || (json_array_append_new (errors_p, error_p) != 0))
+												{
+													success_flag = false;
+												}
+
+											++ num_errors;
+										}
+
+									for (i = 0; i < check_p -> rc_num_tasks; ++ i)
+										{
+											const ValidationTask *task_p = tasks_p + check_p -> rc_first_task + i;
+											const json_t *error_p;
+											size_t j;
+
+											json_array_foreach (task_p -> vt_errors_p, j, error_p)
+												{
+													if (json_array_size (errors_p) < max_errors)
+														{
+															if (json_array_append (errors_p, (json_t *) error_p) != 0)
+																{
+																	success_flag = false;
+																}
+														}
+												}
+
+											num_errors += task_p -> vt_num_errors;
+										}
+
+									if (success_flag)
+										{
+											if ((json_object_set_new (report_p, "valid", json_boolean (num_errors == 0)) != 0) ||
+													(json_object_set_new (report_p, "num_errors", json_integer (num_errors)) != 0))
+												{
+													success_flag = false;
+												}
+										}
+
+									if (json_object_set_new (report_p, "errors", errors_p) != 0)
+										{
+											success_flag = false;
+										}
+
+									*num_errors_p = num_errors;
+								}
+							else
+								{
+									success_flag = false;
+								}
+						}
+					else
+						{
+							success_flag = (json_object_set_new (report_p, "checked", json_false ()) == 0);
+						}
+				}
+
+			if (success_flag)
+				{
+					return report_p;
+				}
+
+			json_decref (report_p);
+		}
+
+	return NULL;
+}
+
+
+static SchemaNode *CompileSchema (PackageValidator *validator_p, const json_t *schema_p, const json_t *document_p, const char *url_s)
+{
+	SchemaNode *node_p = NULL;
+	char key_s [32];
+	json_int_t index;
+
+	snprintf (key_s, sizeof (key_s), "%p", (const void *) schema_p);
+
+	/*
+	 * Has the schema already been compiled, either by a previous
+	 * resource or because it refers to itself?
+	 */
+	if (GetJSONInteger (validator_p -> pv_compiled_p, key_s, &index))
+		{
+			node_p = validator_p -> pv_nodes_pp [index];
+		}
+	else
+		{
+			/* The node is added before its children are compiled so that any recursive refs find it */
+			node_p = AddSchemaNode (validator_p, key_s);
+
+			if (node_p)
+				{
+					const char *ref_s = GetJSONString (schema_p, "$ref");
+					const char *type_s = GetJSONString (schema_p, FD_TABLE_FIELD_TYPE);
+
+					/*
+					 * As with ParsePackageFromSchema (), a $ref alongside a type
+					 * of array is the schema for the array's entries.
+					 */
+					if ((ref_s) && ! ((type_s) && (strcmp (type_s, FD_TYPE_JSON_ARRAY) == 0)))
+						{
+							const json_t *ref_document_p = NULL;
+							const char *ref_url_s = NULL;
+							const json_t *ref_schema_p = ResolveSchemaRef (validator_p -> pv_schema_cache_p, document_p, url_s, ref_s, &ref_document_p, &ref_url_s);
+
+							if (ref_schema_p)
+								{
+									node_p -> sn_ref_p = CompileSchema (validator_p, ref_schema_p, ref_document_p, ref_url_s);
+								}
+
+							if (! (node_p -> sn_ref_p))
+								{
+									node_p -> sn_error_s = ConcatenateVarargsStrings ("the schema \"", ref_s, "\" could not be loaded", NULL);
+								}
+						}
+					else
+						{
+							CompileSchemaNode (validator_p, node_p, schema_p, document_p, url_s);
+						}
+				}
+		}
+
+	return node_p;
+}
+
+
+static void CompileSchemaNode (PackageValidator *validator_p, SchemaNode *node_p, const json_t *schema_p, const json_t *document_p, const char *url_s)
+{
+	const json_t *properties_p = json_object_get (schema_p, "properties");
+	const json_t *required_p = json_object_get (schema_p, "required");
+	const json_t *items_p = json_object_get (schema_p, "items");
+	const json_t *alternatives_p = json_object_get (schema_p, "anyOf");
+
+	node_p -> sn_constraints.vc_types = GetValueTypes (json_object_get (schema_p, FD_TABLE_FIELD_TYPE));
+	SetConstraints (& (node_p -> sn_constraints), schema_p, false);
+	node_p -> sn_constraints.vc_format_s = GetJSONString (schema_p, FD_TABLE_FIELD_FORMAT);
+
+	if (json_is_object (properties_p) && (json_object_size (properties_p) > 0))
+		{
+			node_p -> sn_properties_p = (SchemaProperty *) calloc (json_object_size (properties_p), sizeof (SchemaProperty));
+
+			if (node_p -> sn_properties_p)
+				{
+					const char *key_s;
+					json_t *property_p;
+
+					json_object_foreach ((json_t *) properties_p, key_s, property_p)
+						{
+							SchemaNode *property_node_p = CompileSchema (validator_p, property_p, document_p, url_s);
+
+							if (property_node_p)
+								{
+									SchemaProperty *schema_property_p = node_p -> sn_properties_p + node_p -> sn_num_properties;
+
+									schema_property_p -> sp_key_s = key_s;
+									schema_property_p -> sp_node_p = property_node_p;
+									++ (node_p -> sn_num_properties);
+								}
+						}
+				}
+		}
+
+	if (json_is_array (required_p) && (json_array_size (required_p) > 0))
+		{
+			node_p -> sn_required_ss = (const char **) calloc (json_array_size (required_p), sizeof (const char *));
+
+			if (node_p -> sn_required_ss)
+				{
+					const json_t *entry_p;
+					size_t i;
+
+					json_array_foreach (required_p, i, entry_p)
+						{
+							if (json_is_string (entry_p))
+								{
+									node_p -> sn_required_ss [node_p -> sn_num_required] = json_string_value (entry_p);
+									++ (node_p -> sn_num_required);
+								}
+						}
+				}
+		}
+
+	if (json_is_object (items_p))
+		{
+			node_p -> sn_items_p = CompileSchema (validator_p, items_p, document_p, url_s);
+		}
+	else
+		{
+			const char *ref_s = GetJSONString (schema_p, "$ref");
+
+			if (ref_s)
+				{
+					const json_t *ref_document_p = NULL;
+					const char *ref_url_s = NULL;
+					const json_t *ref_schema_p = ResolveSchemaRef (validator_p -> pv_schema_cache_p, document_p, url_s, ref_s, &ref_document_p, &ref_url_s);
+
+					if (ref_schema_p)
+						{
+							node_p -> sn_items_p = CompileSchema (validator_p, ref_schema_p, ref_document_p, ref_url_s);
+						}
+					else
+						{
+							node_p -> sn_error_s = ConcatenateVarargsStrings ("the schema \"", ref_s, "\" could not be loaded", NULL);
+						}
+				}
+		}
+
+	if (!alternatives_p)
+		{
+			alternatives_p = json_object_get (schema_p, "oneOf");
+			node_p -> sn_one_of_flag = (alternatives_p != NULL);
+		}
+
+	if (json_is_array (alternatives_p) && (json_array_size (alternatives_p) > 0))
+		{
+			node_p -> sn_alternatives_pp = (SchemaNode **) calloc (json_array_size (alternatives_p), sizeof (SchemaNode *));
+
+			if (node_p -> sn_alternatives_pp)
+				{
+					const json_t *alternative_p;
+					size_t i;
+
+					json_array_foreach (alternatives_p, i, alternative_p)
+						{
+							SchemaNode *alternative_node_p = CompileSchema (validator_p, alternative_p, document_p, url_s);
+
+							if (alternative_node_p)
+								{
+									node_p -> sn_alternatives_pp [node_p -> sn_num_alternatives] = alternative_node_p;
+									++ (node_p -> sn_num_alternatives);
+								}
+						}
+				}
+		}
+}
+
+
+static SchemaNode *AddSchemaNode (PackageValidator *validator_p, const char *key_s)
+{
+	SchemaNode *node_p;
+
+	if (validator_p -> pv_num_nodes == validator_p -> pv_nodes_capacity)
+		{
+			const size_t new_capacity = (validator_p -> pv_nodes_capacity > 0) ? (validator_p -> pv_nodes_capacity << 1) : 64;
+			SchemaNode **nodes_pp = (SchemaNode **) realloc (validator_p -> pv_nodes_pp, new_capacity * sizeof (SchemaNode *));
+
+			if (!nodes_pp)
+				{
+					return NULL;
+				}
+
+			validator_p -> pv_nodes_pp = nodes_pp;
+			validator_p -> pv_nodes_capacity = new_capacity;
+		}
+
+	node_p = (SchemaNode *) calloc (1, sizeof (SchemaNode));
+
+	if (node_p)
+		{
+			if (json_object_set_new (validator_p -> pv_compiled_p, key_s, json_integer (validator_p -> pv_num_nodes)) == 0)
+				{
+					validator_p -> pv_nodes_pp [validator_p -> pv_num_nodes] = node_p;
+					++ (validator_p -> pv_num_nodes);
+
+					return node_p;
+				}
+
+			free (node_p);
+		}
+
+	return NULL;
+}
+
+
+static void FreeSchemaNode (SchemaNode *node_p)
+{
+	ClearConstraints (& (node_p -> sn_constraints));
+
+	if (node_p -> sn_properties_p)
+		{
+			free (node_p -> sn_properties_p);
+		}
+
+	if (node_p -> sn_required_ss)
+		{
+			free (node_p -> sn_required_ss);
+		}
+
+	if (node_p -> sn_alternatives_pp)
+		{
+			free (node_p -> sn_alternatives_pp);
+		}
+
+	if (node_p -> sn_error_s)
+		{
+			FreeCopiedString (node_p -> sn_error_s);
+		}
+
+	free (node_p);
+}
+
+
+/*
+ * The columns are allocated for num_rows rows, which can be less
+ * than the size of data_p for tables checked a chunk at a time.
+ */
+static TableSchema *CompileTableSchema (const json_t *schema_p, const json_t *data_p, const size_t num_rows)
+{
+	TableSchema *table_p = (TableSchema *) calloc (1, sizeof (TableSchema));
+
+	if (table_p)
+		{
+			const json_t *fields_p = json_object_get (schema_p, FD_TABLE_FIELDS_S);
+			const size_t num_fields = json_array_size (fields_p);
+
+			table_p -> ts_data_p = data_p;
+			table_p -> ts_num_rows = num_rows;
+
+			if (json_is_array (json_array_get (data_p, 0)))
+				{
+					table_p -> ts_header_p = json_array_get (data_p, 0);
+
+					if (table_p -> ts_num_rows > 0)
+						{
+							-- (table_p -> ts_num_rows);
+						}
+				}
+			table_p -> ts_missing_values_p = json_object_get (schema_p, "missingValues");
+			table_p -> ts_fields_p = (TableField *) calloc (num_fields + 1, sizeof (TableField));
+
+			if (table_p -> ts_fields_p)
+				{
+					const json_t *field_json_p;
+					size_t i;
+					bool success_flag = true;
+
+					table_p -> ts_num_fields = num_fields;
+
+					json_array_foreach (fields_p, i, field_json_p)
+						{
+							TableField *field_p = table_p -> ts_fields_p + i;
+							const char *type_s = GetJSONString (field_json_p, FD_TABLE_FIELD_TYPE);
+							const json_t *constraints_p = json_object_get (field_json_p, "constraints");
+
+							field_p -> tf_name_s = GetJSONString (field_json_p, FD_TABLE_FIELD_NAME);
+							field_p -> tf_type = TFT_ANY;
+							field_p -> tf_data_column = (table_p -> ts_header_p) ? GetHeaderColumn (table_p -> ts_header_p, field_p -> tf_name_s) : (long) i;
+
+							if ((!type_s) || (strcmp (type_s, FD_TYPE_STRING) == 0))
+								{
+									field_p -> tf_type = TFT_STRING;
+								}
+							else if (strcmp (type_s, FD_TYPE_INTEGER) == 0)
+								{
+									field_p -> tf_type = TFT_INTEGER;
+								}
+							else if (strcmp (type_s, FD_TYPE_NUMBER) == 0)
+								{
+									field_p -> tf_type = TFT_NUMBER;
+								}
+							else if (strcmp (type_s, FD_TYPE_BOOLEAN) == 0)
+								{
+									field_p -> tf_type = TFT_BOOLEAN;
+								}
+							else if (strcmp (type_s, "date") == 0)
+								{
+									field_p -> tf_type = TFT_DATE;
+								}
+
+							/* The string formats are the same as in JSON schemas */
+							if (field_p -> tf_type == TFT_STRING)
+								{
+									field_p -> tf_constraints.vc_format_s = GetJSONString (field_json_p, FD_TABLE_FIELD_FORMAT);
+								}
+
+							field_p -> tf_true_values_p = json_object_get (field_json_p, "trueValues");
+							field_p -> tf_false_values_p = json_object_get (field_json_p, "falseValues");
+
+							if (constraints_p)
+								{
+									/* Table schema patterns must match the whole value */
+									SetConstraints (& (field_p -> tf_constraints), constraints_p, true);
+									GetJSONBoolean (constraints_p, "required", & (field_p -> tf_required_flag));
+									GetJSONBoolean (constraints_p, "unique", & (field_p -> tf_unique_flag));
+
+									if (field_p -> tf_unique_flag)
+										{
+											++ (table_p -> ts_num_unique_fields);
+										}
+
+									if (field_p -> tf_constraints.vc_enum_p)
+										{
+											if (!CompileTableEnum (field_p))
+												{
+													success_flag = false;
+												}
+										}
+								}
+
+							if (!AllocateTableColumn (& (field_p -> tf_column), field_p -> tf_type, table_p -> ts_num_rows))
+								{
+									success_flag = false;
+								}
+						}
+
+					if (success_flag)
+						{
+							success_flag = SetPrimaryKey (table_p, json_object_get (schema_p, "primaryKey"));
+						}
+
+					if (success_flag)
+						{
+							return table_p;
+						}
+				}
+
+			FreeTableSchema (table_p);
+		}
+
+	return NULL;
+}
+
+
+static void FreeTableSchema (TableSchema *table_p)
+{
+	if (table_p -> ts_fields_p)
+		{
+			size_t i;
+
+			for (i = 0; i < table_p -> ts_num_fields; ++ i)
+				{
+					TableField *field_p = table_p -> ts_fields_p + i;
+
+					ClearConstraints (& (field_p -> tf_constraints));
+					FreeTableColumn (& (field_p -> tf_enum));
+					FreeTableColumn (& (field_p -> tf_column));
+				}
+
+			free (table_p -> ts_fields_p);
+		}
+
+	if (table_p -> ts_primary_key_p)
+		{
+			free (table_p -> ts_primary_key_p);
+		}
+
+	free (table_p);
+}
+
+
+/*
+ * Allocate the buffer for the values of a field in its type
+ */
+static bool AllocateTableColumn (TableColumn *column_p, const TableFieldType type, const size_t num_rows)
+{
+	const size_t n = num_rows + 1;
+
+	column_p -> tc_states_p = (uint8 *) calloc (n, sizeof (uint8));
+
+	if (column_p -> tc_states_p)
+		{
+			switch (type)
+				{
+					case TFT_INTEGER:
+						column_p -> tc_integers_p = (int64 *) malloc (n * sizeof (int64));
+						return (column_p -> tc_integers_p != NULL);
+
+					case TFT_NUMBER:
+						column_p -> tc_numbers_p = (double *) malloc (n * sizeof (double));
+						return (column_p -> tc_numbers_p != NULL);
+
+					case TFT_BOOLEAN:
+						column_p -> tc_booleans_p = (uint8 *) malloc (n * sizeof (uint8));
+						return (column_p -> tc_booleans_p != NULL);
+
+					default:
+						column_p -> tc_strings_p = (const char **) calloc (n, sizeof (const char *));
+						return (column_p -> tc_strings_p != NULL);
+				}
+		}
+
+	return false;
+}
+
+
+static void FreeTableColumn (TableColumn *column_p)
+{
+	if (column_p -> tc_states_p)
+		{
+			free (column_p -> tc_states_p);
+		}
+
+	if (column_p -> tc_integers_p)
+		{
+			free (column_p -> tc_integers_p);
+		}
+
+	if (column_p -> tc_numbers_p)
+		{
+			free (column_p -> tc_numbers_p);
+		}
+
+	if (column_p -> tc_booleans_p)
+		{
+			free (column_p -> tc_booleans_p);
+		}
+
+	if (column_p -> tc_strings_p)
+		{
+			free ((void *) (column_p -> tc_strings_p));
+		}
+}
+
+
+/*
+ * Convert the allowed values of a field to the field's type
+ * so they can be compared directly with the column's values.
+ */
+static bool CompileTableEnum (TableField *field_p)
+{
+	const json_t *enum_p = field_p -> tf_constraints.vc_enum_p;
+	TableColumn *values_p = & (field_p -> tf_enum);
+	const size_t num_entries = json_array_size (enum_p);
+
+	if (AllocateTableColumn (values_p, field_p -> tf_type, num_entries))
+		{
+			const json_t *entry_p;
+			size_t i;
+
+			field_p -> tf_num_enum_values = 0;
+
+			json_array_foreach (enum_p, i, entry_p)
+				{
+					if (ConvertTableValue (field_p, entry_p, values_p, field_p -> tf_num_enum_values))
+						{
+							++ (field_p -> tf_num_enum_values);
+						}
+				}
+
+			field_p -> tf_enum_flag = true;
+
+			return true;
+		}
+
+	return false;
+}
+
+
+static bool SetPrimaryKey (TableSchema *table_p, const json_t *primary_key_p)
+{
+	bool success_flag = true;
+
+	if (primary_key_p)
+		{
+			const size_t num_keys = json_is_array (primary_key_p) ? json_array_size (primary_key_p) : 1;
+
+			table_p -> ts_primary_key_p = (size_t *) calloc (num_keys, sizeof (size_t));
+
+			if (table_p -> ts_primary_key_p)
+				{
+					size_t i;
+
+					for (i = 0; i < num_keys; ++ i)
+						{
+							const json_t *key_p = json_is_array (primary_key_p) ? json_array_get (primary_key_p, i) : primary_key_p;
+
+							if (json_is_string (key_p))
+								{
+									const char *key_s = json_string_value (key_p);
+									size_t j;
+
+									for (j = 0; j < table_p -> ts_num_fields; ++ j)
+										{
+											const char *name_s = table_p -> ts_fields_p [j].tf_name_s;
+
+											if ((name_s) && (strcmp (name_s, key_s) == 0))
+												{
+													table_p -> ts_primary_key_p [table_p -> ts_primary_key_size] = j;
+													++ (table_p -> ts_primary_key_size);
+													break;
+												}
+										}
+
+									if (j == table_p -> ts_num_fields)
+										{
+											fprintf (stderr, "The primary key field \"%s\" is not in the schema so it will be ignored\n", key_s);
+										}
+								}
+						}
+				}
+			else
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+static void SetConstraints (ValueConstraints *constraints_p, const json_t *source_p, const bool anchored_flag)
+{
+	json_int_t length;
+	const char *pattern_s = GetJSONString (source_p, "pattern");
+
+	constraints_p -> vc_minimum_flag = GetConstraintNumber (source_p, "minimum", & (constraints_p -> vc_minimum));
+	constraints_p -> vc_maximum_flag = GetConstraintNumber (source_p, "maximum", & (constraints_p -> vc_maximum));
+
+	if (GetJSONInteger (source_p, "minLength", &length) && (length > 0))
+		{
+			constraints_p -> vc_min_length = (size_t) length;
+		}
+
+	if (GetJSONInteger (source_p, "maxLength", &length) && (length >= 0))
+		{
+			constraints_p -> vc_max_length = (size_t) length;
+			constraints_p -> vc_max_length_flag = true;
+		}
+
+	constraints_p -> vc_enum_p = json_object_get (source_p, "enum");
+
+	if (! (json_is_array (constraints_p -> vc_enum_p)))
+		{
+			constraints_p -> vc_enum_p = NULL;
+		}
+
+	if (pattern_s)
+		{
+			constraints_p -> vc_pattern_s = pattern_s;
+
+#ifndef WINDOWS
+			constraints_p -> vc_pattern_p = (regex_t *) malloc (sizeof (regex_t));
+
+			if (constraints_p -> vc_pattern_p)
+				{
+					char *regex_s = anchored_flag ? ConcatenateVarargsStrings ("^(", pattern_s, ")$", NULL) : EasyCopyToNewString (pattern_s);
+					bool compiled_flag = false;
+
+					if (regex_s)
+						{
+							compiled_flag = (regcomp (constraints_p -> vc_pattern_p, regex_s, REG_EXTENDED | REG_NOSUB) == 0);
+							FreeCopiedString (regex_s);
+						}
+
+					if (!compiled_flag)
+						{
+							fprintf (stderr, "Failed to compile the pattern \"%s\" so it will not be checked\n", pattern_s);
+							free (constraints_p -> vc_pattern_p);
+							constraints_p -> vc_pattern_p = NULL;
+						}
+				}
+#endif
+		}
+}
+
+
+static void ClearConstraints (ValueConstraints *constraints_p)
+{
+#ifndef WINDOWS
+	if (constraints_p -> vc_pattern_p)
+		{
+			regfree (constraints_p -> vc_pattern_p);
+			free (constraints_p -> vc_pattern_p);
+			constraints_p -> vc_pattern_p = NULL;
+		}
+#endif
+}
+
+
+/*
+ * Table schemas can give numeric constraints as strings
+ */
+static bool GetConstraintNumber (const json_t *source_p, const char *key_s, double *value_p)
+{
+	bool success_flag = false;
+	const json_t *constraint_p = json_object_get (source_p, key_s);
+
+	if (json_is_number (constraint_p))
+		{
+			*value_p = json_number_value (constraint_p);
+			success_flag = true;
+		}
+	else if (json_is_string (constraint_p))
+		{
+			success_flag = ParseTableNumber (constraint_p, false, value_p);
+		}
+
+	return success_flag;
+}
+
+
+static void ValidateValue (const SchemaNode *node_p, const json_t *value_p, PathBuffer *path_p, ErrorReporter *reporter_p, const size_t depth)
+{
+	const char *path_s = path_p -> pb_path_s;
+	size_t num_refs = 0;
+
+	while ((node_p -> sn_ref_p) && (num_refs < S_MAX_DEPTH))
+		{
+			node_p = node_p -> sn_ref_p;
+			++ num_refs;
+		}
+
+	if (node_p -> sn_error_s)
+		{
+			ReportError (reporter_p, path_s, 0, NULL, "%s", node_p -> sn_error_s);
+		}
+	else if ((depth > S_MAX_DEPTH) || (node_p -> sn_ref_p))
+		{
+			ReportError (reporter_p, path_s, 0, NULL, "the value is nested too deeply to check");
+		}
+	else
+		{
+			const ValueConstraints *constraints_p = & (node_p -> sn_constraints);
+			const uint32 type = GetValueType (value_p);
+
+			if ((constraints_p -> vc_types != 0) && ! ((constraints_p -> vc_types & type) || ((type == VT_INTEGER) && (constraints_p -> vc_types & VT_NUMBER))))
+				{
+					char expected_s [128];
+					char actual_s [32];
+
+					GetValueTypeNames (constraints_p -> vc_types, expected_s, sizeof (expected_s));
+					GetValueTypeNames (type, actual_s, sizeof (actual_s));
+
+					ReportError (reporter_p, path_s, 0, NULL, "expected %s but got %s", expected_s, actual_s);
+					return;
+				}
+
+			switch (type)
+				{
+					case VT_STRING:
+						CheckStringConstraints (constraints_p, json_string_value (value_p), path_s, 0, NULL, reporter_p);
+						break;
+
+					case VT_INTEGER:
+					case VT_NUMBER:
+						CheckNumberConstraints (constraints_p, json_number_value (value_p), path_s, 0, NULL, reporter_p);
+						break;
+
+					case VT_OBJECT:
+						{
+							size_t i;
+
+							for (i = 0; i < node_p -> sn_num_required; ++ i)
+								{
+									if (!json_object_get (value_p, node_p -> sn_required_ss [i]))
+										{
+											ReportError (reporter_p, path_s, 0, NULL, "the required property \"%s\" is missing", node_p -> sn_required_ss [i]);
+										}
+								}
+
+							for (i = 0; i < node_p -> sn_num_properties; ++ i)
+								{
+									const SchemaProperty *property_p = node_p -> sn_properties_p + i;
+									const json_t *child_p = json_object_get (value_p, property_p -> sp_key_s);
+
+									if (child_p)
+										{
+											const size_t length = AppendPathKey (path_p, property_p -> sp_key_s);
+
+											ValidateValue (property_p -> sp_node_p, child_p, path_p, reporter_p, depth + 1);
+											RestorePath (path_p, length);
+										}
+								}
+						}
+						break;
+
+					case VT_ARRAY:
+						if (node_p -> sn_items_p)
+							{
+								const json_t *entry_p;
+								size_t i;
+
+								json_array_foreach (value_p, i, entry_p)
+									{
+										const size_t length = AppendPathIndex (path_p, i);
+
+										ValidateValue (node_p -> sn_items_p, entry_p, path_p, reporter_p, depth + 1);
+										RestorePath (path_p, length);
+									}
+							}
+						break;
+
+					default:
+						break;
+				}
+
+			if (constraints_p -> vc_enum_p)
+				{
+					const json_t *entry_p;
+					size_t i;
+					bool found_flag = false;
+
+					json_array_foreach (constraints_p -> vc_enum_p, i, entry_p)
+						{
+							if (json_equal ((json_t *) entry_p, (json_t *) value_p))
+								{
+									found_flag = true;
+									break;
+								}
+						}
+
+					if (!found_flag)
+						{
+							ReportError (reporter_p, path_s, 0, NULL, "the value is not one of the allowed values");
+						}
+				}
+
+			if (node_p -> sn_num_alternatives > 0)
+				{
+					size_t num_matches = 0;
+					size_t i;
+
+					for (i = 0; i < node_p -> sn_num_alternatives; ++ i)
+						{
+							/* Only count the errors for each of the alternatives */
+							ErrorReporter counter;
+
+							counter.er_errors_p = NULL;
+							counter.er_num_errors = 0;
+							counter.er_max_errors = 0;
+
+							ValidateValue (node_p -> sn_alternatives_pp [i], value_p, path_p, &counter, depth + 1);
+
+							if (counter.er_num_errors == 0)
+								{
+									++ num_matches;
+
+									if (! (node_p -> sn_one_of_flag))
+										{
+											break;
+										}
+								}
+						}
+
+					if (num_matches == 0)
+						{
+							ReportError (reporter_p, path_s, 0, NULL, "the value does not match any of the schemas in %s", node_p -> sn_one_of_flag ? "oneOf" : "anyOf");
+						}
+					else if ((num_matches > 1) && (node_p -> sn_one_of_flag))
+						{
+							ReportError (reporter_p, path_s, 0, NULL, "the value matches %lu of the schemas in oneOf rather than just one", (unsigned long) num_matches);
+						}
+				}
+		}
+}
+
+
+/*
+ * Check a table whose data is in external CSV files. The rows are read into
+ * chunks which are converted and checked on a pool of threads in the same way
+ * as inline data. The chunks are then merged in order, which is where the
+ * unique values and primary keys are checked as these need all of the rows
+ * before them, so only a few chunks are held in memory at a time.
+ */
+static void CheckCSVTable (TableSchema *table_p, const json_t *resource_p, const char *package_file_s, const size_t num_threads, ErrorReporter *reporter_p)
+{
+	const json_t *schema_p = json_object_get (resource_p, FD_SCHEMA_S);
+	const size_t num_key_sets = table_p -> ts_num_unique_fields + 1;
+	const size_t num_chunks = (num_threads > 1) ? (num_threads << 1) : 1;
+	CSVTableChunk *chunks_p = (CSVTableChunk *) calloc (num_chunks, sizeof (CSVTableChunk));
+	void **chunks_pp = (void **) calloc (num_chunks, sizeof (void *));
+	CSVTableCheck check;
+	bool success_flag = false;
+	size_t i;
+
+	check.ct_table_p = table_p;
+	check.ct_reporter_p = reporter_p;
+	check.ct_num_columns = table_p -> ts_num_fields;
+	check.ct_columns_p = (long *) malloc ((table_p -> ts_num_fields + 1) * sizeof (long));
+	check.ct_seen_keys_pp = (json_t **) calloc (num_key_sets, sizeof (json_t *));
+	check.ct_key_buffer_p = AllocateByteBuffer (1024);
+
+	if ((chunks_p) && (chunks_pp) && (check.ct_columns_p) && (check.ct_seen_keys_pp) && (check.ct_key_buffer_p))
+		{
+			success_flag = true;
+
+			for (i = 0; i < num_key_sets; ++ i)
+				{
+					if (! (check.ct_seen_keys_pp [i] = json_object ()))
+						{
+							success_flag = false;
+						}
+				}
+
+			/* Without a header row, the columns are in the same order as the fields */
+			for (i = 0; i < table_p -> ts_num_fields; ++ i)
+				{
+					check.ct_columns_p [i] = (long) i;
+				}
+
+			/* Each chunk has its own columns and errors so they can be checked independently */
+			for (i = 0; (i < num_chunks) && success_flag; ++ i)
+				{
+					CSVTableChunk *chunk_p = chunks_p + i;
+
+					chunk_p -> ck_check_p = &check;
+					chunk_p -> ck_success_flag = true;
+					chunk_p -> ck_capacity = S_ROWS_PER_TASK;
+					chunk_p -> ck_table_p = CompileTableSchema (schema_p, NULL, chunk_p -> ck_capacity);
+					chunk_p -> ck_rows_p = json_array ();
+					chunk_p -> ck_reporter.er_errors_p = (reporter_p -> er_errors_p) ? json_array () : NULL;
+					chunk_p -> ck_reporter.er_num_errors = 0;
+					chunk_p -> ck_reporter.er_max_errors = reporter_p -> er_max_errors;
+					chunks_pp [i] = chunk_p;
+
+					if ((! (chunk_p -> ck_table_p)) || (! (chunk_p -> ck_rows_p)) || ((reporter_p -> er_errors_p) && (! (chunk_p -> ck_reporter.er_errors_p))))
+						{
+							success_flag = false;
+						}
+				}
+
+			if (success_flag)
+				{
+					CSVChunkFunctions functions;
+
+					functions.cf_row_fn = AddCSVTableRow;
+					functions.cf_end_fn = CheckCSVTableChunk;
+					functions.cf_merge_fn = MergeCSVTableChunk;
+					functions.cf_reset_fn = ResetCSVTableChunk;
+
+					if (!ReadCSVResource (resource_p, package_file_s, MapCSVTableColumns, &functions, chunks_pp, num_chunks, num_threads, &check))
+						{
+							ReportError (reporter_p, NULL, 0, NULL, "the data could not be read from the resource's path");
+						}
+				}
+		}
+
+	if (!success_flag)
+		{
+			ReportError (reporter_p, NULL, 0, NULL, "there was not enough memory to check the table");
+		}
+
+	if (chunks_p)
+		{
+			for (i = 0; i < num_chunks; ++ i)
+				{
+					CSVTableChunk *chunk_p = chunks_p + i;
+
+					if (chunk_p -> ck_table_p)
+						{
+							FreeTableSchema (chunk_p -> ck_table_p);
+						}
+
+					if (chunk_p -> ck_rows_p)
+						{
+							json_decref (chunk_p -> ck_rows_p);
+						}
+
+					if (chunk_p -> ck_reporter.er_errors_p)
+						{
+							json_decref (chunk_p -> ck_reporter.er_errors_p);
+						}
+				}
+
+			free (chunks_p);
+		}
+
+	if (chunks_pp)
+		{
+			free (chunks_pp);
+		}
+
+	if (check.ct_seen_keys_pp)
+		{
+			for (i = 0; i < num_key_sets; ++ i)
+				{
+					if (check.ct_seen_keys_pp [i])
+						{
+							json_decref (check.ct_seen_keys_pp [i]);
+						}
+				}
+
+			free (check.ct_seen_keys_pp);
+		}
+
+	if (check.ct_key_buffer_p)
+		{
+			FreeByteBuffer (check.ct_key_buffer_p);
+		}
+
+	if (check.ct_columns_p)
+		{
+			free (check.ct_columns_p);
+		}
+}
+
+
+/*
+ * Match the header row's columns to the fields by name
+ */
+static bool MapCSVTableColumns (void *data_p, const size_t row, char **values_ss, const size_t num_values)
+{
+	CSVTableCheck *check_p = (CSVTableCheck *) data_p;
+	const TableSchema *table_p = check_p -> ct_table_p;
+	size_t i;
+
+	for (i = 0; i < table_p -> ts_num_fields; ++ i)
+		{
+			const char *name_s = table_p -> ts_fields_p [i].tf_name_s;
+			size_t j;
+
+			check_p -> ct_columns_p [i] = -1;
+
+			for (j = 0; j < num_values; ++ j)
+				{
+					if ((name_s) && (strcmp (values_ss [j], name_s) == 0))
+						{
+							check_p -> ct_columns_p [i] = (long) j;
+							break;
+						}
+				}
+
+			if (check_p -> ct_columns_p [i] == -1)
+				{
+					ReportError (check_p -> ct_reporter_p, NULL, 0, name_s, "the field is not in the header row");
+				}
+		}
+
+	check_p -> ct_num_columns = num_values;
+
+	return true;
+}
+
+
+/*
+ * Add a row to a chunk, which can be on a worker thread. The row
+ * numbers are relative to the start of the chunk.
+ */
+static bool AddCSVTableRow (void *data_p, const size_t row, char **values_ss, const size_t num_values)
+{
+	CSVTableChunk *chunk_p = (CSVTableChunk *) data_p;
+	const CSVTableCheck *check_p = chunk_p -> ck_check_p;
+	json_t *row_p = json_array ();
+	bool success_flag = false;
+
+	if (num_values != check_p -> ct_num_columns)
+		{
+			ReportError (& (chunk_p -> ck_reporter), NULL, row, NULL, "the row has %lu values rather than %lu", (unsigned long) num_values, (unsigned long) (check_p -> ct_num_columns));
+		}
+
+	if (row_p)
+		{
+			size_t i;
+
+			success_flag = true;
+
+			for (i = 0; (i < check_p -> ct_table_p -> ts_num_fields) && success_flag; ++ i)
+				{
+					const long column = check_p -> ct_columns_p [i];
+
+					/* The values aren't checked for valid UTF-8 as they are only used here */
+					json_t *value_p = ((column >= 0) && ((size_t) column < num_values)) ? json_string_nocheck (values_ss [column]) : json_null ();
+
+					if ((!value_p) || (json_array_append_new (row_p, value_p) != 0))
+						{
+							success_flag = false;
+						}
+				}
+
+			if (json_array_append_new (chunk_p -> ck_rows_p, row_p) != 0)
+				{
+					success_flag = false;
+				}
+		}
+
+	if (!success_flag)
+		{
+			chunk_p -> ck_success_flag = false;
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Convert and check the columns of a chunk once all of its rows have been read
+ */
+static void CheckCSVTableChunk (void *chunk_data_p, const size_t num_rows)
+{
+	CSVTableChunk *chunk_p = (CSVTableChunk *) chunk_data_p;
+	TableSchema *table_p = chunk_p -> ck_table_p;
+	size_t i;
+
+	/* A chunk can have more rows than expected if they are short */
+	if (num_rows > chunk_p -> ck_capacity)
+		{
+			if (ResizeTableColumns (table_p, num_rows))
+				{
+					chunk_p -> ck_capacity = num_rows;
+				}
+			else
+				{
+					chunk_p -> ck_success_flag = false;
+				}
+		}
+
+	if (chunk_p -> ck_success_flag)
+		{
+			table_p -> ts_data_p = chunk_p -> ck_rows_p;
+			table_p -> ts_num_rows = num_rows;
+			table_p -> ts_first_row = 0;
+
+			for (i = 0; i < table_p -> ts_num_fields; ++ i)
+				{
+					ConvertTableColumn (table_p, i, 0, num_rows, & (chunk_p -> ck_reporter));
+					CheckTableColumn (table_p, i, 0, num_rows, & (chunk_p -> ck_reporter));
+				}
+		}
+}
+
+
+/*
+ * Add a chunk's errors to the table's and then check its unique values and
+ * primary keys against the rows before it. This is called for each chunk in order.
+ */
+static bool MergeCSVTableChunk (void *data_p, void *chunk_data_p, const size_t first_row, const size_t num_rows)
+{
+	CSVTableCheck *check_p = (CSVTableCheck *) data_p;
+	CSVTableChunk *chunk_p = (CSVTableChunk *) chunk_data_p;
+	TableSchema *table_p = chunk_p -> ck_table_p;
+	const bool success_flag = chunk_p -> ck_success_flag;
+
+	if (success_flag)
+		{
+			json_t **seen_keys_pp = check_p -> ct_seen_keys_pp;
+			size_t i;
+
+			MergeTableErrors (& (chunk_p -> ck_reporter), first_row, check_p -> ct_reporter_p);
+
+			table_p -> ts_first_row = first_row;
+
+			for (i = 0; i < table_p -> ts_num_fields; ++ i)
+				{
+					if (table_p -> ts_fields_p [i].tf_unique_flag)
+						{
+							CheckStreamedUniqueRows (table_p, &i, 1, false, *seen_keys_pp, check_p -> ct_key_buffer_p, check_p -> ct_reporter_p);
+							++ seen_keys_pp;
+						}
+				}
+
+			if (table_p -> ts_primary_key_size > 0)
+				{
+					CheckStreamedUniqueRows (table_p, table_p -> ts_primary_key_p, table_p -> ts_primary_key_size, true, *seen_keys_pp, check_p -> ct_key_buffer_p, check_p -> ct_reporter_p);
+				}
+		}
+
+	ResetCSVTableChunk (chunk_p);
+
+	return success_flag;
+}
+
+
+static void ResetCSVTableChunk (void *chunk_data_p)
+{
+	CSVTableChunk *chunk_p = (CSVTableChunk *) chunk_data_p;
+
+	json_array_clear (chunk_p -> ck_rows_p);
+
+	if (chunk_p -> ck_reporter.er_errors_p)
+		{
+			json_array_clear (chunk_p -> ck_reporter.er_errors_p);
+		}
+
+	chunk_p -> ck_reporter.er_num_errors = 0;
+	chunk_p -> ck_table_p -> ts_data_p = NULL;
+	chunk_p -> ck_table_p -> ts_num_rows = 0;
+	chunk_p -> ck_success_flag = true;
+}
+
+
+/*
+ * Add the errors from a chunk of a table to the table's errors, with the
+ * chunk's row numbers offset by the number of rows before it.
+ */
+static void MergeTableErrors (const ErrorReporter *chunk_reporter_p, const size_t first_row, ErrorReporter *reporter_p)
+{
+	if ((reporter_p -> er_errors_p) && (chunk_reporter_p -> er_errors_p))
+		{
+			json_t *error_p;
+			size_t i;
+
+			json_array_foreach (chunk_reporter_p -> er_errors_p, i, error_p)
+				{
+					json_t *row_p = json_object_get (error_p, "row");
+
+					if (json_array_size (reporter_p -> er_errors_p) == reporter_p -> er_max_errors)
+						{
+							break;
+						}
+
+					if (row_p)
+						{
+							json_integer_set (row_p, json_integer_value (row_p) + (json_int_t) first_row);
+						}
+
+					json_array_append (reporter_p -> er_errors_p, error_p);
+				}
+		}
+
+	reporter_p -> er_num_errors += chunk_reporter_p -> er_num_errors;
+}
+
+
+/*
+ * Make the columns of a table big enough for the given number of rows
+ */
+static bool ResizeTableColumns (TableSchema *table_p, const size_t num_rows)
+{
+	size_t i;
+
+	for (i = 0; i < table_p -> ts_num_fields; ++ i)
+		{
+			TableField *field_p = table_p -> ts_fields_p + i;
+
+			FreeTableColumn (& (field_p -> tf_column));
+			memset (& (field_p -> tf_column), 0, sizeof (TableColumn));
+
+			if (!AllocateTableColumn (& (field_p -> tf_column), field_p -> tf_type, num_rows))
+				{
+					return false;
+				}
+		}
+
+	return true;
+}
+
+
+/*
+ * Convert a range of the rows of a field into its column, reporting
+ * any values that aren't of the field's type.
+ */
+static void ConvertTableColumn (const TableSchema *table_p, const size_t field_index, const size_t first_row, const size_t last_row, ErrorReporter *reporter_p)
+{
+	const TableField *field_p = table_p -> ts_fields_p + field_index;
+	const TableColumn *column_p = & (field_p -> tf_column);
+	uint8 *state_p = column_p -> tc_states_p + first_row;
+	size_t i;
+
+	for (i = first_row; i < last_row; ++ i, ++ state_p)
+		{
+			/* Skip over any header row */
+			const json_t *row_p = json_array_get (table_p -> ts_data_p, (table_p -> ts_header_p) ? (i + 1) : i);
+
+			if (json_is_object (row_p) || json_is_array (row_p))
+				{
+					const json_t *cell_p = GetCell (row_p, field_p);
+
+					if (IsMissingValue (table_p, cell_p))
+						{
+							*state_p = CS_MISSING;
+						}
+					else if (ConvertTableValue (field_p, cell_p, column_p, i))
+						{
+							*state_p = CS_PRESENT;
+						}
+					else
+						{
+							*state_p = CS_INVALID;
+
+							if (json_is_string (cell_p))
+								{
+									char excerpt_s [80];
+
+									ReportError (reporter_p, NULL, table_p -> ts_first_row + i + 1, field_p -> tf_name_s, "\"%s\" is not a valid %s", GetValueExcerpt (json_string_value (cell_p), excerpt_s, sizeof (excerpt_s)), S_TABLE_FIELD_TYPES_SS [field_p -> tf_type]);
+								}
+							else
+								{
+									ReportError (reporter_p, NULL, table_p -> ts_first_row + i + 1, field_p -> tf_name_s, "the value is not a valid %s", S_TABLE_FIELD_TYPES_SS [field_p -> tf_type]);
+								}
+						}
+				}
+			else
+				{
+					*state_p = CS_INVALID;
+
+					/* Only report this once for each row */
+					if (field_index == 0)
+						{
+							ReportError (reporter_p, NULL, table_p -> ts_first_row + i + 1, NULL, "the row is not an object or an array");
+						}
+				}
+		}
+}
+
+
+/*
+ * Convert a value that isn't missing to the field's type
+ */
+static bool ConvertTableValue (const TableField *field_p, const json_t *value_p, const TableColumn *column_p, const size_t index)
+{
+	bool success_flag = false;
+
+	switch (field_p -> tf_type)
+		{
+			case TFT_INTEGER:
+				success_flag = ParseTableInteger (value_p, column_p -> tc_integers_p + index);
+				break;
+
+			case TFT_NUMBER:
+				success_flag = ParseTableNumber (value_p, false, column_p -> tc_numbers_p + index);
+				break;
+
+			case TFT_BOOLEAN:
+				if (json_is_boolean (value_p))
+					{
+						column_p -> tc_booleans_p [index] = json_is_true (value_p) ? 1 : 0;
+						success_flag = true;
+					}
+				else if (json_is_string (value_p))
+					{
+						const char *value_s = json_string_value (value_p);
+
+						if (IsStringInList (value_s, field_p -> tf_true_values_p, S_DEFAULT_TRUE_VALUES_SS))
+							{
+								column_p -> tc_booleans_p [index] = 1;
+								success_flag = true;
+							}
+						else if (IsStringInList (value_s, field_p -> tf_false_values_p, S_DEFAULT_FALSE_VALUES_SS))
+							{
+								column_p -> tc_booleans_p [index] = 0;
+								success_flag = true;
+							}
+					}
+				break;
+
+			case TFT_STRING:
+				if (json_is_string (value_p))
+					{
+						column_p -> tc_strings_p [index] = json_string_value (value_p);
+						success_flag = true;
+					}
+				break;
+
+			case TFT_DATE:
+				if (json_is_string (value_p) && IsValidDate (json_string_value (value_p)))
+					{
+						column_p -> tc_strings_p [index] = json_string_value (value_p);
+						success_flag = true;
+					}
+				break;
+
+			case TFT_ANY:
+				/* Only strings are kept for checking uniqueness */
+				column_p -> tc_strings_p [index] = json_is_string (value_p) ? json_string_value (value_p) : NULL;
+				success_flag = true;
+				break;
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Run the required, range, length, pattern and enum checks over a range
+ * of a column once it has been converted. Each check is a separate loop
+ * over the column so that it only touches the values that it needs.
+ */
+static void CheckTableColumn (const TableSchema *table_p, const size_t field_index, const size_t first_row, const size_t last_row, ErrorReporter *reporter_p)
+{
+	const TableField *field_p = table_p -> ts_fields_p + field_index;
+	const TableColumn *column_p = & (field_p -> tf_column);
+	const ValueConstraints *constraints_p = & (field_p -> tf_constraints);
+	const uint8 *states_p = column_p -> tc_states_p;
+	const char *field_s = field_p -> tf_name_s;
+	size_t i;
+
+	if (field_p -> tf_required_flag)
+		{
+			for (i = first_row; i < last_row; ++ i)
+				{
+					if (states_p [i] == CS_MISSING)
+						{
+							ReportError (reporter_p, NULL, table_p -> ts_first_row + i + 1, field_s, "a value is required");
+						}
+				}
+		}
+
+	switch (field_p -> tf_type)
+		{
+			case TFT_INTEGER:
+				if ((constraints_p -> vc_minimum_flag) || (constraints_p -> vc_maximum_flag))
+					{
+						const int64 *values_p = column_p -> tc_integers_p;
+						const double minimum = (constraints_p -> vc_minimum_flag) ? constraints_p -> vc_minimum : -HUGE_VAL;
+						const double maximum = (constraints_p -> vc_maximum_flag) ? constraints_p -> vc_maximum : HUGE_VAL;
+
+						for (i = first_row; i < last_row; ++ i)
+							{
+								const double value = (double) values_p [i];
+
+								if ((states_p [i] == CS_PRESENT) && ((value < minimum) || (value > maximum)))
+									{
+										CheckNumberConstraints (constraints_p, value, NULL, table_p -> ts_first_row + i + 1, field_s, reporter_p);
+									}
+							}
+					}
+				break;
+
+			case TFT_NUMBER:
+				if ((constraints_p -> vc_minimum_flag) || (constraints_p -> vc_maximum_flag))
+					{
+						const double *values_p = column_p -> tc_numbers_p;
+						const double minimum = (constraints_p -> vc_minimum_flag) ? constraints_p -> vc_minimum : -HUGE_VAL;
+						const double maximum = (constraints_p -> vc_maximum_flag) ? constraints_p -> vc_maximum : HUGE_VAL;
+
+						for (i = first_row; i < last_row; ++ i)
+							{
+								if ((states_p [i] == CS_PRESENT) && ((values_p [i] < minimum) || (values_p [i] > maximum)))
+									{
+										CheckNumberConstraints (constraints_p, values_p [i], NULL, table_p -> ts_first_row + i + 1, field_s, reporter_p);
+									}
+							}
+					}
+				break;
+
+			case TFT_STRING:
+				if ((constraints_p -> vc_min_length > 0) || (constraints_p -> vc_max_length_flag) || (constraints_p -> vc_format_s) || (constraints_p -> vc_pattern_s))
+					{
+						const char **values_ss = column_p -> tc_strings_p;
+
+						for (i = first_row; i < last_row; ++ i)
+							{
+								if (states_p [i] == CS_PRESENT)
+									{
+										CheckStringConstraints (constraints_p, values_ss [i], NULL, table_p -> ts_first_row + i + 1, field_s, reporter_p);
+									}
+							}
+					}
+				break;
+
+			default:
+				break;
+		}
+
+	if (field_p -> tf_enum_flag)
+		{
+			for (i = first_row; i < last_row; ++ i)
+				{
+					if ((states_p [i] == CS_PRESENT) && (!IsInTableEnum (field_p, i)))
+						{
+							ReportTableEnumError (table_p, field_p, i, reporter_p);
+						}
+				}
+		}
+}
+
+
+static void ReportTableEnumError (const TableSchema *table_p, const TableField *field_p, const size_t row, ErrorReporter *reporter_p)
+{
+	const TableColumn *column_p = & (field_p -> tf_column);
+	const char *field_s = field_p -> tf_name_s;
+
+	switch (field_p -> tf_type)
+		{
+			case TFT_INTEGER:
+				ReportError (reporter_p, NULL, table_p -> ts_first_row + row + 1, field_s, "%lld is not one of the allowed values", (long long) (column_p -> tc_integers_p [row]));
+				break;
+
+			case TFT_NUMBER:
+				ReportError (reporter_p, NULL, table_p -> ts_first_row + row + 1, field_s, "%g is not one of the allowed values", column_p -> tc_numbers_p [row]);
+				break;
+
+			case TFT_BOOLEAN:
+				ReportError (reporter_p, NULL, table_p -> ts_first_row + row + 1, field_s, "%s is not one of the allowed values", (column_p -> tc_booleans_p [row]) ? "true" : "false");
+				break;
+
+			default:
+				{
+					char excerpt_s [80];
+
+					ReportError (reporter_p, NULL, table_p -> ts_first_row + row + 1, field_s, "\"%s\" is not one of the allowed values", GetValueExcerpt (column_p -> tc_strings_p [row], excerpt_s, sizeof (excerpt_s)));
+				}
+				break;
+		}
+}
+
+
+static bool IsInTableEnum (const TableField *field_p, const size_t row)
+{
+	const TableColumn *column_p = & (field_p -> tf_column);
+	const TableColumn *enum_p = & (field_p -> tf_enum);
+	const size_t num_values = field_p -> tf_num_enum_values;
+	size_t i;
+
+	switch (field_p -> tf_type)
+		{
+			case TFT_INTEGER:
+				for (i = 0; i < num_values; ++ i)
+					{
+						if (enum_p -> tc_integers_p [i] == column_p -> tc_integers_p [row])
+							{
+								return true;
+							}
+					}
+				break;
+
+			case TFT_NUMBER:
+				for (i = 0; i < num_values; ++ i)
+					{
+						if (enum_p -> tc_numbers_p [i] == column_p -> tc_numbers_p [row])
+							{
+								return true;
+							}
+					}
+				break;
+
+			case TFT_BOOLEAN:
+				for (i = 0; i < num_values; ++ i)
+					{
+						if (enum_p -> tc_booleans_p [i] == column_p -> tc_booleans_p [row])
+							{
+								return true;
+							}
+					}
+				break;
+
+			default:
+				{
+					const char *value_s = column_p -> tc_strings_p [row];
+
+					if (!value_s)
+						{
+							/* Non-string values of fields of any type aren't kept so can't be compared */
+							return true;
+						}
+
+					for (i = 0; i < num_values; ++ i)
+						{
+							if ((enum_p -> tc_strings_p [i]) && (strcmp (enum_p -> tc_strings_p [i], value_s) == 0))
+								{
+									return true;
+								}
+						}
+				}
+				break;
+		}
+
+	return false;
+}
+
+
+/*
+ * Check that the combinations of the values in the given fields are
+ * unique using a hash set of row indexes, which is used for both unique
+ * fields and primary keys. This must only be run once all of the fields'
+ * columns have been converted.
+ */
+static void CheckUniqueRows (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const bool primary_key_flag, ErrorReporter *reporter_p)
+{
+	const size_t num_rows = table_p -> ts_num_rows;
+	size_t capacity = 16;
+	size_t *slots_p;
+
+	/* Keep the set at most half full */
+	while (capacity < (num_rows << 1))
+		{
+			capacity <<= 1;
+		}
+
+	slots_p = (size_t *) calloc (capacity, sizeof (size_t));
+
+	if (slots_p)
+		{
+			const size_t mask = capacity - 1;
+			const char *field_s = (num_fields == 1) ? table_p -> ts_fields_p [*fields_p].tf_name_s : NULL;
+			size_t row;
+
+			for (row = 0; row < num_rows; ++ row)
+				{
+					if (IsTableKeyPresent (table_p, fields_p, num_fields, row, primary_key_flag, reporter_p))
+						{
+							size_t slot = (size_t) HashTableRow (table_p, fields_p, num_fields, row) & mask;
+
+							/* The slots store the row index plus 1 so that 0 is empty */
+							while (slots_p [slot] != 0)
+								{
+									const size_t other_row = slots_p [slot] - 1;
+
+									if (AreTableRowsEqual (table_p, fields_p, num_fields, row, other_row))
+										{
+											ReportError (reporter_p, NULL, row + 1, field_s, "the %s is the same as in row %lu", primary_key_flag ? "primary key" : "value", (unsigned long) (other_row + 1));
+											break;
+										}
+
+									slot = (slot + 1) & mask;
+								}
+
+							if (slots_p [slot] == 0)
+								{
+									slots_p [slot] = row + 1;
+								}
+						}
+				}
+
+			free (slots_p);
+		}
+	else
+		{
+			ReportError (reporter_p, NULL, 0, NULL, "there was not enough memory to check the unique values");
+		}
+}
+
+
+/*
+ * Tables that are read from CSV files a chunk of rows at a time need to
+ * remember the values from the previous chunks, so the values are copied
+ * as text keys into a JSON object rather than using the row indexes.
+ */
+static void CheckStreamedUniqueRows (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const bool primary_key_flag, json_t *seen_keys_p, ByteBuffer *buffer_p, ErrorReporter *reporter_p)
+{
+	const char *field_s = (num_fields == 1) ? table_p -> ts_fields_p [*fields_p].tf_name_s : NULL;
+	size_t row;
+
+	for (row = 0; row < table_p -> ts_num_rows; ++ row)
+		{
+			if (IsTableKeyPresent (table_p, fields_p, num_fields, row, primary_key_flag, reporter_p))
+				{
+					if (AppendTableKey (table_p, fields_p, num_fields, row, buffer_p))
+						{
+							const char *key_s = GetByteBufferData (buffer_p);
+							const json_t *other_row_p = json_object_get (seen_keys_p, key_s);
+
+							if (other_row_p)
+								{
+									ReportError (reporter_p, NULL, table_p -> ts_first_row + row + 1, field_s, "the %s is the same as in row %" JSON_INTEGER_FORMAT, primary_key_flag ? "primary key" : "value", json_integer_value (other_row_p));
+								}
+							else
+								{
+									json_object_set_new (seen_keys_p, key_s, json_integer (table_p -> ts_first_row + row + 1));
+								}
+						}
+				}
+		}
+}
+
+
+/*
+ * Check that each of the given fields has a valid value in a row,
+ * reporting any missing values for primary keys.
+ */
+static bool IsTableKeyPresent (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row, const bool primary_key_flag, ErrorReporter *reporter_p)
+{
+	bool present_flag = true;
+	size_t i;
+
+	for (i = 0; i < num_fields; ++ i)
+		{
+			const uint8 state = table_p -> ts_fields_p [fields_p [i]].tf_column.tc_states_p [row];
+
+			if (state != CS_PRESENT)
+				{
+					/* Each field of a primary key must have a value */
+					if (primary_key_flag && (state == CS_MISSING))
+						{
+							ReportError (reporter_p, NULL, table_p -> ts_first_row + row + 1, table_p -> ts_fields_p [fields_p [i]].tf_name_s, "a value is required as it is part of the primary key");
+						}
+
+					present_flag = false;
+				}
+		}
+
+	return present_flag;
+}
+
+
+/*
+ * Write the values of the given fields of a row as text, in their
+ * converted form so that equal values have equal keys.
+ */
+static bool AppendTableKey (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row, ByteBuffer *buffer_p)
+{
+	bool success_flag = true;
+	size_t i;
+
+	ResetByteBuffer (buffer_p);
+
+	for (i = 0; (i < num_fields) && success_flag; ++ i)
+		{
+			const TableField *field_p = table_p -> ts_fields_p + fields_p [i];
+			const TableColumn *column_p = & (field_p -> tf_column);
+			char value_s [32];
+			const char *key_s = value_s;
+
+			switch (field_p -> tf_type)
+				{
+					case TFT_INTEGER:
+						snprintf (value_s, sizeof (value_s), "%lld", (long long) (column_p -> tc_integers_p [row]));
+						break;
+
+					case TFT_NUMBER:
+						/* 0.0 and -0.0 are equal so need the same key */
+						snprintf (value_s, sizeof (value_s), "%.17g", (column_p -> tc_numbers_p [row] == 0.0) ? 0.0 : column_p -> tc_numbers_p [row]);
+						break;
+
+					case TFT_BOOLEAN:
+						key_s = (column_p -> tc_booleans_p [row]) ? "true" : "false";
+						break;
+
+					default:
+						key_s = column_p -> tc_strings_p [row];
+
+						if (!key_s)
+							{
+								/* Non-string values of fields of any type aren't kept so can't be compared */
+								return false;
+							}
+						break;
+				}
+
+			/* Separate the values with a unit separator */
+			if (i > 0)
+				{
+					success_flag = AppendToByteBuffer (buffer_p, "\x1f", 1);
+				}
+
+			if (success_flag)
+				{
+					success_flag = AppendStringToByteBuffer (buffer_p, key_s);
+				}
+		}
+
+	return success_flag;
+}
+
+
+static uint64 HashTableRow (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row)
+{
+	uint64 hash = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < num_fields; ++ i)
+		{
+			const TableField *field_p = table_p -> ts_fields_p + fields_p [i];
+			const TableColumn *column_p = & (field_p -> tf_column);
+			uint64 value = 0;
+
+			switch (field_p -> tf_type)
+				{
+					case TFT_INTEGER:
+						value = (uint64) column_p -> tc_integers_p [row];
+						break;
+
+					case TFT_NUMBER:
+						{
+							/* 0.0 and -0.0 are equal so need the same hash */
+							const double d = (column_p -> tc_numbers_p [row] == 0.0) ? 0.0 : column_p -> tc_numbers_p [row];
+
+							memcpy (&value, &d, sizeof (value));
+						}
+						break;
+
+					case TFT_BOOLEAN:
+						value = column_p -> tc_booleans_p [row];
+						break;
+
+					default:
+						{
+							const unsigned char *c_p = (const unsigned char *) column_p -> tc_strings_p [row];
+
+							value = 0xcbf29ce484222325ULL;
+
+							if (c_p)
+								{
+									while (*c_p)
+										{
+											value = (value ^ *c_p) * 0x100000001b3ULL;
+											++ c_p;
+										}
+								}
+						}
+						break;
+				}
+
+			hash = (hash ^ value) * 0x9e3779b97f4a7c15ULL;
+			hash ^= hash >> 32;
+		}
+
+	return hash;
+}
+
+
+static bool AreTableRowsEqual (const TableSchema *table_p, const size_t *fields_p, const size_t num_fields, const size_t row_0, const size_t row_1)
+{
+	size_t i;
+
+	for (i = 0; i < num_fields; ++ i)
+		{
+			const TableField *field_p = table_p -> ts_fields_p + fields_p [i];
+			const TableColumn *column_p = & (field_p -> tf_column);
+
+			switch (field_p -> tf_type)
+				{
+					case TFT_INTEGER:
+						if (column_p -> tc_integers_p [row_0] != column_p -> tc_integers_p [row_1])
+							{
+								return false;
+							}
+						break;
+
+					case TFT_NUMBER:
+						if (column_p -> tc_numbers_p [row_0] != column_p -> tc_numbers_p [row_1])
+							{
+								return false;
+							}
+						break;
+
+					case TFT_BOOLEAN:
+						if (column_p -> tc_booleans_p [row_0] != column_p -> tc_booleans_p [row_1])
+							{
+								return false;
+							}
+						break;
+
+					default:
+						{
+							const char *value_0_s = column_p -> tc_strings_p [row_0];
+							const char *value_1_s = column_p -> tc_strings_p [row_1];
+
+							/* Non-string values of fields of any type aren't kept so are treated as different */
+							if ((!value_0_s) || (!value_1_s) || (strcmp (value_0_s, value_1_s) != 0))
+								{
+									return false;
+								}
+						}
+						break;
+				}
+		}
+
+	return true;
+}
+
+
+static const json_t *GetCell (const json_t *row_p, const TableField *field_p)
+{
+	const json_t *cell_p = NULL;
+
+	if (json_is_object (row_p))
+		{
+			if (field_p -> tf_name_s)
+				{
+					cell_p = json_object_get (row_p, field_p -> tf_name_s);
+				}
+		}
+	else if (json_is_array (row_p))
+		{
+			if (field_p -> tf_data_column >= 0)
+				{
+					cell_p = json_array_get (row_p, (size_t) (field_p -> tf_data_column));
+				}
+		}
+
+	return cell_p;
+}
+
+
+/*
+ * Find the position of a field in a header row
+ */
+static long GetHeaderColumn (const json_t *header_p, const char *name_s)
+{
+	if (name_s)
+		{
+			const json_t *column_p;
+			size_t i;
+
+			json_array_foreach (header_p, i, column_p)
+				{
+					if (json_is_string (column_p) && (strcmp (json_string_value (column_p), name_s) == 0))
+						{
+							return (long) i;
+						}
+				}
+		}
+
+	return -1;
+}
+
+
+static bool IsMissingValue (const TableSchema *table_p, const json_t *cell_p)
+{
+	bool missing_flag = true;
+
+	if ((cell_p) && (!json_is_null (cell_p)))
+		{
+			missing_flag = false;
+
+			if (json_is_string (cell_p))
+				{
+					const char *value_s = json_string_value (cell_p);
+
+					if (table_p -> ts_missing_values_p)
+						{
+							missing_flag = IsStringInList (value_s, table_p -> ts_missing_values_p, NULL);
+						}
+					else
+						{
+							missing_flag = (*value_s == '\0');
+						}
+				}
+		}
+
+	return missing_flag;
+}
+
+
+static void CheckStringConstraints (const ValueConstraints *constraints_p, const char *value_s, const char *path_s, const size_t row, const char *field_s, ErrorReporter *reporter_p)
+{
+	if ((constraints_p -> vc_min_length > 0) || (constraints_p -> vc_max_length_flag))
+		{
+			const size_t length = GetUTF8Length (value_s);
+
+			if (length < constraints_p -> vc_min_length)
+				{
+					ReportError (reporter_p, path_s, row, field_s, "the value is shorter than the minimum length of %lu", (unsigned long) (constraints_p -> vc_min_length));
+				}
+			else if ((constraints_p -> vc_max_length_flag) && (length > constraints_p -> vc_max_length))
+				{
+					ReportError (reporter_p, path_s, row, field_s, "the value is longer than the maximum length of %lu", (unsigned long) (constraints_p -> vc_max_length));
+				}
+		}
+
+#ifndef WINDOWS
+	if (constraints_p -> vc_pattern_p)
+		{
+			if (regexec (constraints_p -> vc_pattern_p, value_s, 0, NULL, 0) != 0)
+				{
+					char excerpt_s [80];
+
+					ReportError (reporter_p, path_s, row, field_s, "\"%s\" does not match the pattern \"%s\"", GetValueExcerpt (value_s, excerpt_s, sizeof (excerpt_s)), constraints_p -> vc_pattern_s);
+				}
+		}
+#endif
+
+	if ((constraints_p -> vc_format_s) && (!IsValidFormat (constraints_p -> vc_format_s, value_s)))
+		{
+			char excerpt_s [80];
+
+			ReportError (reporter_p, path_s, row, field_s, "\"%s\" is not a valid %s", GetValueExcerpt (value_s, excerpt_s, sizeof (excerpt_s)), constraints_p -> vc_format_s);
+		}
+}
+
+
+static void CheckNumberConstraints (const ValueConstraints *constraints_p, const double value, const char *path_s, const size_t row, const char *field_s, ErrorReporter *reporter_p)
+{
+	if ((constraints_p -> vc_minimum_flag) && (value < constraints_p -> vc_minimum))
+		{
+			ReportError (reporter_p, path_s, row, field_s, "%g is less than the minimum of %g", value, constraints_p -> vc_minimum);
+		}
+	else if ((constraints_p -> vc_maximum_flag) && (value > constraints_p -> vc_maximum))
+		{
+			ReportError (reporter_p, path_s, row, field_s, "%g is greater than the maximum of %g", value, constraints_p -> vc_maximum);
+		}
+}
+
+
+/*
+ * These are quick sanity checks rather than full parsers
+ */
+static bool IsValidFormat (const char *format_s, const char *value_s)
+{
+	bool valid_flag = true;
+
+	if (strcmp (format_s, FD_TYPE_STRING_FORMAT_EMAIL) == 0)
+		{
+			const char *at_s = strchr (value_s, '@');
+
+			valid_flag = (at_s != NULL) && (at_s != value_s) && (* (at_s + 1) != '\0') && (!strchr (at_s + 1, '@'));
+		}
+	else if (strcmp (format_s, FD_TYPE_STRING_FORMAT_URI) == 0)
+		{
+			const char *c_s = value_s;
+
+			/* A scheme followed by a colon */
+			while (((*c_s >= 'a') && (*c_s <= 'z')) || ((*c_s >= 'A') && (*c_s <= 'Z')) || ((c_s != value_s) && (((*c_s >= '0') && (*c_s <= '9')) || (*c_s == '+') || (*c_s == '-') || (*c_s == '.'))))
+				{
+					++ c_s;
+				}
+
+			valid_flag = (c_s != value_s) && (*c_s == ':');
+		}
+	else if (strcmp (format_s, "date") == 0)
+		{
+			valid_flag = IsValidDate (value_s);
+		}
+
+	return valid_flag;
+}
+
+
+/*
+ * Check for YYYY-MM-DD and that the day exists in that month
+ */
+static bool IsValidDate (const char *value_s)
+{
+	static const int days_in_months [12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	static const char * const pattern_s = "dddd-dd-dd";
+	const char *c_s = pattern_s;
+	int year;
+	int month;
+	int day;
+	int max_day;
+
+	while (*c_s)
+		{
+			if (*c_s == 'd')
+				{
+					if ((*value_s < '0') || (*value_s > '9'))
+						{
+							return false;
+						}
+				}
+			else if (*value_s != *c_s)
+				{
+					return false;
+				}
+
+			++ c_s;
+			++ value_s;
+		}
+
+	if (*value_s != '\0')
+		{
+			return false;
+		}
+
+	year = ((* (value_s - 10) - '0') * 1000) + ((* (value_s - 9) - '0') * 100) + ((* (value_s - 8) - '0') * 10) + (* (value_s - 7) - '0');
+	month = ((* (value_s - 5) - '0') * 10) + (* (value_s - 4) - '0');
+	day = ((* (value_s - 2) - '0') * 10) + (* (value_s - 1) - '0');
+
+	if ((month < 1) || (month > 12))
+		{
+			return false;
+		}
+
+	max_day = days_in_months [month - 1];
+
+	if ((month == 2) && ((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0)))
+		{
+			max_day = 29;
+		}
+
+	return (day >= 1) && (day <= max_day);
+}
+
+
+/*
+ * Tabular values can be numbers or strings containing them
+ */
+static bool ParseTableNumber (const json_t *cell_p, const bool integer_flag, double *value_p)
+{
+	bool success_flag = false;
+
+	if (json_is_integer (cell_p))
+		{
+			*value_p = (double) json_integer_value (cell_p);
+			success_flag = true;
+		}
+	else if (json_is_real (cell_p))
+		{
+			if (!integer_flag)
+				{
+					*value_p = json_real_value (cell_p);
+					success_flag = true;
+				}
+		}
+	else if (json_is_string (cell_p))
+		{
+			const char *value_s = json_string_value (cell_p);
+			char *end_s = NULL;
+
+			if (integer_flag)
+				{
+					const long long value = strtoll (value_s, &end_s, 10);
+
+					*value_p = (double) value;
+				}
+			else
+				{
+					*value_p = strtod (value_s, &end_s);
+				}
+
+			success_flag = (end_s != value_s) && (*end_s == '\0');
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Integers are kept exactly rather than as doubles so that large
+ * values can still be compared for uniqueness.
+ */
+static bool ParseTableInteger (const json_t *cell_p, int64 *value_p)
+{
+	bool success_flag = false;
+
+	if (json_is_integer (cell_p))
+		{
+			*value_p = (int64) json_integer_value (cell_p);
+			success_flag = true;
+		}
+	else if (json_is_string (cell_p))
+		{
+			const char *value_s = json_string_value (cell_p);
+			char *end_s = NULL;
+
+			errno = 0;
+			*value_p = (int64) strtoll (value_s, &end_s, 10);
+
+			success_flag = (end_s != value_s) && (*end_s == '\0') && (errno != ERANGE);
+		}
+
+	return success_flag;
+}
+
+
+static bool IsStringInList (const char *value_s, const json_t *values_p, const char * const *default_values_ss)
+{
+	if (json_is_array (values_p))
+		{
+			const json_t *entry_p;
+			size_t i;
+
+			json_array_foreach (values_p, i, entry_p)
+				{
+					if (json_is_string (entry_p) && (strcmp (json_string_value (entry_p), value_s) == 0))
+						{
+							return true;
+						}
+				}
+		}
+	else if (default_values_ss)
+		{
+			while (*default_values_ss)
+				{
+					if (strcmp (*default_values_ss, value_s) == 0)
+						{
+							return true;
+						}
+
+					++ default_values_ss;
+				}
+		}
+
+	return false;
+}
+
+
+static uint32 GetValueTypes (const json_t *type_p)
+{
+	uint32 types = 0;
+
+	if (json_is_array (type_p))
+		{
+			const json_t *entry_p;
+			size_t i;
+
+			json_array_foreach (type_p, i, entry_p)
+				{
+					types |= GetValueTypes (entry_p);
+				}
+		}
+	else if (json_is_string (type_p))
+		{
+			const char *type_s = json_string_value (type_p);
+
+			if (strcmp (type_s, FD_TYPE_STRING) == 0)
+				{
+					types = VT_STRING;
+				}
+			else if (strcmp (type_s, FD_TYPE_INTEGER) == 0)
+				{
+					types = VT_INTEGER;
+				}
+			else if (strcmp (type_s, FD_TYPE_NUMBER) == 0)
+				{
+					types = VT_NUMBER;
+				}
+			else if (strcmp (type_s, FD_TYPE_BOOLEAN) == 0)
+				{
+					types = VT_BOOLEAN;
+				}
+			else if (strcmp (type_s, FD_TYPE_JSON_ARRAY) == 0)
+				{
+					types = VT_ARRAY;
+				}
+			else if (strcmp (type_s, "object") == 0)
+				{
+					types = VT_OBJECT;
+				}
+			else if (strcmp (type_s, "null") == 0)
+				{
+					types = VT_NULL;
+				}
+		}
+
+	return types;
+}
+
+
+static uint32 GetValueType (const json_t *value_p)
+{
+	uint32 type = VT_NULL;
+
+	switch (json_typeof (value_p))
+		{
+			case JSON_OBJECT:
+				type = VT_OBJECT;
+				break;
+
+			case JSON_ARRAY:
+				type = VT_ARRAY;
+				break;
+
+			case JSON_STRING:
+				type = VT_STRING;
+				break;
+
+			case JSON_INTEGER:
+				type = VT_INTEGER;
+				break;
+
+			case JSON_REAL:
+				type = VT_NUMBER;
+				break;
+
+			case JSON_TRUE:
+			case JSON_FALSE:
+				type = VT_BOOLEAN;
+				break;
+
+			default:
+				break;
+		}
+
+	return type;
+}
+
+
+static void GetValueTypeNames (const uint32 types, char *buffer_s, const size_t buffer_size)
+{
+	static const char * const names_ss [] = { "null", FD_TYPE_BOOLEAN, FD_TYPE_INTEGER, FD_TYPE_NUMBER, FD_TYPE_STRING, FD_TYPE_JSON_ARRAY, "object" };
+	size_t i;
+	size_t length = 0;
+
+	*buffer_s = '\0';
+
+	for (i = 0; i < sizeof (names_ss) / sizeof (names_ss [0]); ++ i)
+		{
+			if (types & (1 << i))
+				{
+					length += snprintf (buffer_s + length, buffer_size - length, "%s%s", (length > 0) ? " or " : "", names_ss [i]);
+
+					if (length >= buffer_size)
+						{
+							break;
+						}
+				}
+		}
+}
+
+
+static size_t GetUTF8Length (const char *value_s)
+{
+	size_t length = 0;
+
+	while (*value_s)
+		{
+			/* Don't count continuation bytes */
+			if ((*value_s & 0xC0) != 0x80)
+				{
+					++ length;
+				}
+
+			++ value_s;
+		}
+
+	return length;
+}
+
+
+static void ReportError (ErrorReporter *reporter_p, const char *path_s, const size_t row, const char *field_s, const char *format_s, ...)
+{
+	++ (reporter_p -> er_num_errors);
+
+	/* Only build the errors that will be reported */
+	if ((reporter_p -> er_errors_p) && (json_array_size (reporter_p -> er_errors_p) < reporter_p -> er_max_errors))
+		{
+			json_t *error_p = json_object ();
+
+			if (error_p)
+				{
+					char message_s [512];
+					va_list args;
+					bool success_flag = true;
+
+					va_start (args, format_s);
+					vsnprintf (message_s, sizeof (message_s), format_s, args);
+					va_end (args);
+
+					TrimToUTF8Boundary (message_s);
+
+					if (path_s)
+						{
+							success_flag = (json_object_set_new (error_p, "path", json_string (path_s)) == 0);
+						}
+
+					if (success_flag && (row > 0))
+						{
+							success_flag = (json_object_set_new (error_p, "row", json_integer (row)) == 0);
+						}
+
+					if (success_flag && (field_s))
+						{
+							success_flag = (json_object_set_new (error_p, "field", json_string (field_s)) == 0);
+						}
+
+					if (success_flag)
+						{
+							success_flag = (json_object_set_new (error_p, "message", json_string (message_s)) == 0);
+						}
+
+					if (success_flag)
+						{
+							json_array_append_new (reporter_p -> er_errors_p, error_p);
+						}
+					else
+						{
+							json_decref (error_p);
+						}
+				}
+		}
+}
+
+
+/*
+ * Values in messages are cut short so that a long value doesn't swamp the report
+ */
+static const char *GetValueExcerpt (const char *value_s, char *buffer_s, const size_t buffer_size)
+{
+	const size_t length = strlen (value_s);
+
+	if (length < buffer_size)
+		{
+			return value_s;
+		}
+
+	memcpy (buffer_s, value_s, buffer_size - 4);
+	* (buffer_s + buffer_size - 4) = '\0';
+	TrimToUTF8Boundary (buffer_s);
+	strcat (buffer_s, "...");
+
+	return buffer_s;
+}
+
+
+/*
+ * Remove any incomplete multi-byte character from the end of a string
+ */
+static void TrimToUTF8Boundary (char *value_s)
+{
+	size_t length = strlen (value_s);
+	size_t i = length;
+
+	/* Find the start of the last character */
+	while ((i > 0) && ((value_s [i - 1] & 0xC0) == 0x80))
+		{
+			-- i;
+		}
+
+	if (i > 0)
+		{
+			const unsigned char lead = (unsigned char) value_s [i - 1];
+			size_t expected = 1;
+
+			if ((lead & 0xE0) == 0xC0)
+				{
+					expected = 2;
+				}
+			else if ((lead & 0xF0) == 0xE0)
+				{
+					expected = 3;
+				}
+			else if ((lead & 0xF8) == 0xF0)
+				{
+					expected = 4;
+				}
+
+			if (length - (i - 1) < expected)
+				{
+					value_s [i - 1] = '\0';
+				}
+		}
+}
+
+
+/*
+ * Add a key to the path, escaping it as a JSON pointer, returning
+ * the previous length to pass to RestorePath ().
+ */
+static size_t AppendPathKey (PathBuffer *path_p, const char *key_s)
+{
+	const size_t length = path_p -> pb_length;
+	char *out_p = path_p -> pb_path_s + length;
+	const char *end_p = path_p -> pb_path_s + sizeof (path_p -> pb_path_s) - 3;
+
+	if (out_p < end_p)
+		{
+			*out_p = '/';
+			++ out_p;
+
+			while ((*key_s) && (out_p < end_p))
+				{
+					if (*key_s == '~')
+						{
+							*out_p = '~';
+							* (++ out_p) = '0';
+						}
+					else if (*key_s == '/')
+						{
+							*out_p = '~';
+							* (++ out_p) = '1';
+						}
+					else
+						{
+							*out_p = *key_s;
+						}
+
+					++ out_p;
+					++ key_s;
+				}
+
+			*out_p = '\0';
+			TrimToUTF8Boundary (path_p -> pb_path_s + length);
+			path_p -> pb_length = strlen (path_p -> pb_path_s);
+		}
+
+	return length;
+}
+
+
+static size_t AppendPathIndex (PathBuffer *path_p, const size_t index)
+{
+	const size_t length = path_p -> pb_length;
+	const size_t available = sizeof (path_p -> pb_path_s) - length;
+	const int res = snprintf (path_p -> pb_path_s + length, available, "/%lu", (unsigned long) index);
+
+	if ((res > 0) && ((size_t) res < available))
+		{
+			path_p -> pb_length += res;
+		}
+	else
+		{
+			* (path_p -> pb_path_s + length) = '\0';
+		}
+
+	return length;
+}
+
+
+static void RestorePath (PathBuffer *path_p, const size_t length)
+{
+	path_p -> pb_length = length;
+	* (path_p -> pb_path_s + length) = '\0';
+}
@@ -0,0 +1,381 @@
+/*
+ * parallel_tasks.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+
+#ifdef WINDOWS
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+#include "parallel_tasks.h"
+
+
+typedef struct
+{
+	ParallelTaskFn tp_task_fn;
+	void *tp_data_p;
+	size_t tp_num_tasks;
+
+	/** The next task to be started, guarded by tp_lock. */
+	size_t tp_next_task;
+
+#ifdef WINDOWS
+	CRITICAL_SECTION tp_lock;
+#else
+	pthread_mutex_t tp_lock;
+#endif
+} TaskPool;
+
+
+struct TaskLock
+{
+#ifdef WINDOWS
+	CRITICAL_SECTION tl_lock;
+#else
+	pthread_mutex_t tl_lock;
+#endif
+};
+
+
+struct TaskCondition
+{
+#ifdef WINDOWS
+	CONDITION_VARIABLE tc_condition;
+#else
+	pthread_cond_t tc_condition;
+#endif
+};
+
+
+/*
+ * static declarations
+ */
+
+static bool GetNextTask (TaskPool *pool_p, size_t *task_index_p);
+
+static void RunTasks (TaskPool *pool_p);
+
+#ifdef WINDOWS
+static DWORD WINAPI RunTasksThread (LPVOID data_p);
+#else
+static void *RunTasksThread (void *data_p);
+#endif
+
+
+/*
+ * api definitions
+ */
+
+bool RunParallelTasks (const size_t num_tasks, const size_t num_threads, ParallelTaskFn task_fn, void *data_p)
+{
+	bool success_flag = false;
+
+	if ((num_threads <= 1) || (num_tasks <= 1))
+		{
+			size_t i;
+
+			for (i = 0; i < num_tasks; ++ i)
+				{
+					task_fn (data_p, i);
+				}
+
+			success_flag = true;
+		}
+	else
+		{
+			/* There's no point having more threads than tasks */
+			const size_t num_extra_threads = ((num_threads < num_tasks) ? num_threads : num_tasks) - 1;
+			TaskPool pool;
+#ifdef WINDOWS
+			HANDLE *threads_p = (HANDLE *) malloc (num_extra_threads * sizeof (HANDLE));
+#else
+			pthread_t *threads_p = (pthread_t *) malloc (num_extra_threads * sizeof (pthread_t));
+#endif
+
+			pool.tp_task_fn = task_fn;
+			pool.tp_data_p = data_p;
+			pool.tp_num_tasks = num_tasks;
+			pool.tp_next_task = 0;
+
+#ifdef WINDOWS
+			if (threads_p)
+				{
+					size_t num_started = 0;
+
+					InitializeCriticalSection (& (pool.tp_lock));
+
+					while (num_started < num_extra_threads)
+						{
+							threads_p [num_started] = CreateThread (NULL, 0, RunTasksThread, &pool, 0, NULL);
+
+							if (threads_p [num_started])
+								{
+									++ num_started;
+								}
+							else
+								{
+									/* Make do with the threads that we have got */
+									break;
+								}
+						}
+
+					/* This thread does its share of the work too */
+					RunTasks (&pool);
+
+					while (num_started > 0)
+						{
+							-- num_started;
+							WaitForSingleObject (threads_p [num_started], INFINITE);
+							CloseHandle (threads_p [num_started]);
+						}
+
+					DeleteCriticalSection (& (pool.tp_lock));
+					free (threads_p);
+
+					success_flag = true;
+				}
+#else
+			if (threads_p)
+				{
+					if (pthread_mutex_init (& (pool.tp_lock), NULL) == 0)
+						{
+							size_t num_started = 0;
+
+							while (num_started < num_extra_threads)
+								{
+									if (pthread_create (threads_p + num_started, NULL, RunTasksThread, &pool) == 0)
+										{
+											++ num_started;
+										}
+									else
+										{
+											/* Make do with the threads that we have got */
+											break;
+										}
+								}
+
+							/* This thread does its share of the work too */
+							RunTasks (&pool);
+
+							while (num_started > 0)
+								{
+									-- num_started;
+									pthread_join (threads_p [num_started], NULL);
+								}
+
+							pthread_mutex_destroy (& (pool.tp_lock));
+
+							success_flag = true;
+						}
+
+					free (threads_p);
+				}
+#endif
+		}
+
+	return success_flag;
+}
+
+
+size_t GetNumberOfProcessors (void)
+{
+	size_t num_processors = 1;
+
+#ifdef WINDOWS
+	SYSTEM_INFO info;
+
+	GetSystemInfo (&info);
+
+	if (info.dwNumberOfProcessors > 0)
+		{
+			num_processors = (size_t) info.dwNumberOfProcessors;
+		}
+#else
+	const long res = sysconf (_SC_NPROCESSORS_ONLN);
+
+	if (res > 0)
+		{
+			num_processors = (size_t) res;
+		}
+#endif
+
+	return num_processors;
+}
+
+
+TaskLock *AllocateTaskLock (void)
+{
+	TaskLock *lock_p = (TaskLock *) malloc (sizeof (TaskLock));
+
+	if (lock_p)
+		{
+#ifdef WINDOWS
+			InitializeCriticalSection (& (lock_p -> tl_lock));
+			return lock_p;
+#else
+			if (pthread_mutex_init (& (lock_p -> tl_lock), NULL) == 0)
+				{
+					return lock_p;
+				}
+#endif
+
+			free (lock_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeTaskLock (TaskLock *lock_p)
+{
+#ifdef WINDOWS
+	DeleteCriticalSection (& (lock_p -> tl_lock));
+#else
+	pthread_mutex_destroy (& (lock_p -> tl_lock));
+#endif
+
+	free (lock_p);
+}
+
+
+void AcquireTaskLock (TaskLock *lock_p)
+{
+#ifdef WINDOWS
+	EnterCriticalSection (& (lock_p -> tl_lock));
+#else
+	pthread_mutex_lock (& (lock_p -> tl_lock));
+#endif
+}
+
+
+void ReleaseTaskLock (TaskLock *lock_p)
+{
+#ifdef WINDOWS
+	LeaveCriticalSection (& (lock_p -> tl_lock));
+#else
+	pthread_mutex_unlock (& (lock_p -> tl_lock));
+#endif
+}
+
+
+TaskCondition *AllocateTaskCondition (void)
+{
+	TaskCondition *condition_p = (TaskCondition *) malloc (sizeof (TaskCondition));
+
+	if (condition_p)
+		{
+#ifdef WINDOWS
+			InitializeConditionVariable (& (condition_p -> tc_condition));
+			return condition_p;
+#else
+			if (pthread_cond_init (& (condition_p -> tc_condition), NULL) == 0)
+				{
+					return condition_p;
+				}
+#endif
+
+			free (condition_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeTaskCondition (TaskCondition *condition_p)
+{
+#ifndef WINDOWS
+	pthread_cond_destroy (& (condition_p -> tc_condition));
+#endif
+
+	free (condition_p);
+}
+
+
+void WaitForTaskCondition (TaskCondition *condition_p, TaskLock *lock_p)
+{
+#ifdef WINDOWS
+	SleepConditionVariableCS (& (condition_p -> tc_condition), & (lock_p -> tl_lock), INFINITE);
+#else
+	pthread_cond_wait (& (condition_p -> tc_condition), & (lock_p -> tl_lock));
+#endif
+}
+
+
+void SignalTaskCondition (TaskCondition *condition_p)
+{
+#ifdef WINDOWS
+	WakeAllConditionVariable (& (condition_p -> tc_condition));
+#else
+	pthread_cond_broadcast (& (condition_p -> tc_condition));
+#endif
+}
+
+
+/*
+ * static definitions
+ */
+
+static bool GetNextTask (TaskPool *pool_p, size_t *task_index_p)
+{
+	bool got_task_flag = false;
+
+#ifdef WINDOWS
+	EnterCriticalSection (& (pool_p -> tp_lock));
+#else
+	pthread_mutex_lock (& (pool_p -> tp_lock));
+#endif
+
+	if (pool_p -> tp_next_task < pool_p -> tp_num_tasks)
+		{
+			*task_index_p = pool_p -> tp_next_task;
+			++ (pool_p -> tp_next_task);
+			got_task_flag = true;
+		}
+
+#ifdef WINDOWS
+	LeaveCriticalSection (& (pool_p -> tp_lock));
+#else
+	pthread_mutex_unlock (& (pool_p -> tp_lock));
+#endif
+
+	return got_task_flag;
+}
+
+
+static void RunTasks (TaskPool *pool_p)
+{
+	size_t task_index;
+
+	while (GetNextTask (pool_p, &task_index))
+		{
+			pool_p -> tp_task_fn (pool_p -> tp_data_p, task_index);
+		}
+}
+
+
+#ifdef WINDOWS
+
+static DWORD WINAPI RunTasksThread (LPVOID data_p)
+{
+	RunTasks ((TaskPool *) data_p);
+
+	return 0;
+}
+
+#else
+
+static void *RunTasksThread (void *data_p)
+{
+	RunTasks ((TaskPool *) data_p);
+
+	return NULL;
+}
+
+#endif
@@ -9,6 +9,20 @@
 #include "printer.h"
 
 
+typedef struct
+{
+	JSONChunkWriter jsd_writer_fn;
+	void *jsd_writer_data_p;
+	size_t jsd_max_size;
+	size_t jsd_size;
+	bool jsd_truncated_flag;
+	bool jsd_error_flag;
+} JSONStreamData;
+
+
+static int WriteJSONChunk (const char *buffer_s, size_t size, void *data_p);
+
+
 
 void InitFDPrinter (Printer *printer_p,
 									bool (*print_header_fn) (Printer *printer_p, const char *title_s, const char *text_s),
@@ -40,6 +54,87 @@ void InitFDPrinter (Printer *printer_p,
 	printer_p -> pr_print_boolean_fn = print_boolean_fn;
 	printer_p -> pr_print_json_fn = print_json_fn;
 	printer_p -> pr_free_fn = free_fn;
+
+	printer_p -> pr_print_entry_start_fn = NULL;
+	printer_p -> pr_print_entry_end_fn = NULL;
+
+	SetFDPrinterObjectFunctions (printer_p, NULL, NULL);
+
+	SetFDPrinterDocumentFunctions (printer_p, NULL, NULL, NULL, NULL, NULL);
+	SetFDPrinterJSONLimits (printer_p, 0, 0);
+	SetFDPrinterFileFunctions (printer_p, NULL, NULL);
+	SetFDPrinterOutputSinks (printer_p, NULL, NULL);
+	SetFDPrinterOutputDirectory (printer_p, NULL);
+	printer_p -> pr_sink_p = NULL;
+}
+
+
+void SetFDPrinterFileFunctions (Printer *printer_p,
+																bool (*open_fn) (Printer *printer_p, const char *filename_s),
+																bool (*close_fn) (Printer *printer_p))
+{
+	printer_p -> pr_open_fn = open_fn;
+	printer_p -> pr_close_fn = close_fn;
+}
+
+
+void SetFDPrinterOutputSinks (Printer *printer_p, GetOutputSinkFn get_sink_fn, void *get_sink_data_p)
+{
+	printer_p -> pr_get_sink_fn = get_sink_fn;
+	printer_p -> pr_get_sink_data_p = get_sink_data_p;
+}
+
+
+void SetFDPrinterOutputDirectory (Printer *printer_p, OutputDirectory *out_dir_p)
+{
+	printer_p -> pr_out_dir_p = out_dir_p;
+}
+
+
+void SetFDPrinterJSONLimits (Printer *printer_p, const size_t max_size, const size_t collapse_size)
+{
+	printer_p -> pr_json_max_size = max_size;
+	printer_p -> pr_json_collapse_size = collapse_size;
+}
+
+
+void SetFDPrinterEntryFunctions (Printer *printer_p,
+																 bool (*print_entry_start_fn) (Printer *printer_p),
+																 bool (*print_entry_end_fn) (Printer *printer_p))
+{
+	printer_p -> pr_print_entry_start_fn = print_entry_start_fn;
+	printer_p -> pr_print_entry_end_fn = print_entry_end_fn;
+}
+
+
+void SetFDPrinterObjectFunctions (Printer *printer_p,
+																	bool (*print_object_start_fn) (Printer *printer_p, const char *key_s, const char *title_s),
+																	bool (*print_object_end_fn) (Printer *printer_p))
+{
+	printer_p -> pr_print_object_start_fn = print_object_start_fn;
+	printer_p -> pr_print_object_end_fn = print_object_end_fn;
+}
+
+
+void SetFDPrinterDocumentFunctions (Printer *printer_p,
+																		bool (*print_document_start_fn) (Printer *printer_p, const char *title_s),
+																		bool (*print_contents_fn) (Printer *printer_p, const json_t *entries_p),
+																		bool (*print_resource_start_fn) (Printer *printer_p, const char *anchor_s, const char *title_s),
+																		bool (*print_resource_end_fn) (Printer *printer_p, const char *text_s),
+																		bool (*print_document_end_fn) (Printer *printer_p))
+{
+	printer_p -> pr_print_document_start_fn = print_document_start_fn;
+	printer_p -> pr_print_contents_fn = print_contents_fn;
+	printer_p -> pr_print_resource_start_fn = print_resource_start_fn;
+	printer_p -> pr_print_resource_end_fn = print_resource_end_fn;
+	printer_p -> pr_print_document_end_fn = print_document_end_fn;
+}
+
+
+bool DoesFDPrinterSupportDocuments (const Printer *printer_p)
+{
+	return ((printer_p -> pr_print_document_start_fn != NULL) && (printer_p -> pr_print_contents_fn != NULL) && (printer_p -> pr_print_resource_start_fn != NULL)
+					&& (printer_p -> pr_print_resource_end_fn != NULL) && (printer_p -> pr_print_document_end_fn != NULL));
 }
 
 
@@ -49,11 +144,28 @@ bool OpenFDPrinter (Printer *printer_p, const char *filename_s)
 
 	if (CloseFDPrinter (printer_p))
 		{
-			printer_p -> pr_out_f = fopen (filename_s, "w");
+			if (printer_p -> pr_open_fn)
+				{
+					success_flag = printer_p -> pr_open_fn (printer_p, filename_s);
+				}
+			else if (printer_p -> pr_get_sink_fn)
+				{
+					printer_p -> pr_sink_p = printer_p -> pr_get_sink_fn (filename_s, printer_p -> pr_get_sink_data_p);
 
-			if (printer_p -> pr_out_f)
+					if (printer_p -> pr_sink_p)
+						{
+							printer_p -> pr_out_f = GetOutputSinkStream (printer_p -> pr_sink_p);
+							success_flag = true;
+						}
+				}
+			else
 				{
-					success_flag = true;
+					printer_p -> pr_out_f = (printer_p -> pr_out_dir_p) ? OpenOutputDirectoryFile (printer_p -> pr_out_dir_p, filename_s) : fopen (filename_s, "w");
+
+					if (printer_p -> pr_out_f)
+						{
+							success_flag = true;
+						}
 				}
 		}
 
@@ -65,13 +177,32 @@ bool CloseFDPrinter (Printer *printer_p)
 {
 	bool success_flag = true;
 
-	if (printer_p -> pr_out_f)
+	if (printer_p -> pr_close_fn)
 		{
-			int res = fclose (printer_p -> pr_out_f);
+			success_flag = printer_p -> pr_close_fn (printer_p);
+		}
+	else if (printer_p -> pr_sink_p)
+		{
+			/* The OutputSink belongs to whoever supplied it so it is only flushed */
+			success_flag = FlushOutputSink (printer_p -> pr_sink_p);
 
-			if (res != 0)
+			printer_p -> pr_sink_p = NULL;
+			printer_p -> pr_out_f = NULL;
+		}
+	else if (printer_p -> pr_out_f)
+		{
+			if (printer_p -> pr_out_dir_p)
 				{
-					success_flag = false;
+					success_flag = CloseOutputDirectoryFile (printer_p -> pr_out_dir_p, printer_p -> pr_out_f, true);
+				}
+			else
+				{
+					int res = fclose (printer_p -> pr_out_f);
+
+					if (res != 0)
+						{
+							success_flag = false;
+						}
 				}
 
 			printer_p -> pr_out_f = NULL;
@@ -94,6 +225,97 @@ bool EndPrintSection (Printer *printer_p, const char *value_s)
 }
 
 
+bool StartPrintEntry (Printer *printer_p)
+{
+	return (printer_p -> pr_print_entry_start_fn ? printer_p -> pr_print_entry_start_fn (printer_p) : true);
+}
+
+
+bool EndPrintEntry (Printer *printer_p)
+{
+	return (printer_p -> pr_print_entry_end_fn ? printer_p -> pr_print_entry_end_fn (printer_p) : true);
+}
+
+
+bool StartPrintObject (Printer *printer_p, const char *key_s, const char *title_s)
+{
+	bool success_flag;
+
+	if (printer_p -> pr_print_object_start_fn)
+		{
+			success_flag = printer_p -> pr_print_object_start_fn (printer_p, key_s, title_s);
+		}
+	else
+		{
+			success_flag = StartPrintSection (printer_p, title_s);
+
+			if (!StartPrintEntry (printer_p))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+bool EndPrintObject (Printer *printer_p)
+{
+	bool success_flag;
+
+	if (printer_p -> pr_print_object_end_fn)
+		{
+			success_flag = printer_p -> pr_print_object_end_fn (printer_p);
+		}
+	else
+		{
+			/* Close both levels even if one of them fails so the nesting stays balanced */
+			success_flag = EndPrintEntry (printer_p);
+
+			if (!EndPrintSection (printer_p, NULL))
+				{
+					success_flag = false;
+				}
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Callers check DoesFDPrinterSupportDocuments () before using these
+ */
+
+bool PrintDocumentStart (Printer *printer_p, const char *title_s)
+{
+	return (printer_p -> pr_print_document_start_fn (printer_p, title_s));
+}
+
+
+bool PrintContents (Printer *printer_p, const json_t *entries_p)
+{
+	return (printer_p -> pr_print_contents_fn (printer_p, entries_p));
+}
+
+
+bool PrintResourceStart (Printer *printer_p, const char *anchor_s, const char *title_s)
+{
+	return (printer_p -> pr_print_resource_start_fn (printer_p, anchor_s, title_s));
+}
+
+
+bool PrintResourceEnd (Printer *printer_p, const char *text_s)
+{
+	return (printer_p -> pr_print_resource_end_fn (printer_p, text_s));
+}
+
+
+bool PrintDocumentEnd (Printer *printer_p)
+{
+	return (printer_p -> pr_print_document_end_fn (printer_p));
+}
+
+
 
 bool PrintHeader (Printer *printer_p, const char *title_s, const char *text_s)
 {
@@ -107,6 +329,12 @@ bool PrintFooter (Printer *printer_p, const char *text_s)
 }
 
 
+bool PrintText (Printer *printer_p, const char *value_s)
+{
+	return (printer_p -> pr_print_text_fn (printer_p, value_s));
+}
+
+
 bool PrintString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s)
 {
 	return (printer_p -> pr_print_string_fn (printer_p, key_s, value_s, required_flag, format_s));
@@ -142,3 +370,73 @@ void FreeFDPrinter (Printer *printer_p)
 {
 	printer_p -> pr_free_fn (printer_p);
 }
+
+
+bool StreamJSONValue (const json_t *value_p, const size_t flags, const size_t max_size, JSONChunkWriter writer_fn, void *writer_data_p, bool *truncated_flag_p)
+{
+	JSONStreamData data;
+	bool success_flag;
+
+	data.jsd_writer_fn = writer_fn;
+	data.jsd_writer_data_p = writer_data_p;
+	data.jsd_max_size = max_size;
+	data.jsd_size = 0;
+	data.jsd_truncated_flag = false;
+	data.jsd_error_flag = false;
+
+	/*
+	 * Stopping at the limit makes jansson report an error
+	 * so check why it stopped
+	 */
+	if (json_dump_callback (value_p, WriteJSONChunk, &data, flags) == 0)
+		{
+			success_flag = true;
+		}
+	else
+		{
+			success_flag = (data.jsd_truncated_flag && (!data.jsd_error_flag));
+		}
+
+	if (truncated_flag_p)
+		{
+			*truncated_flag_p = data.jsd_truncated_flag;
+		}
+
+	return success_flag;
+}
+
+
+static int WriteJSONChunk (const char *buffer_s, size_t size, void *data_p)
+{
+	JSONStreamData *stream_data_p = (JSONStreamData *) data_p;
+	int res = 0;
+
+	if ((stream_data_p -> jsd_max_size > 0) && (stream_data_p -> jsd_size + size > stream_data_p -> jsd_max_size))
+		{
+			size = stream_data_p -> jsd_max_size - stream_data_p -> jsd_size;
+
+			/* Don't split a multi-byte character */
+			while ((size > 0) && ((((unsigned char) buffer_s [size]) & 0xC0) == 0x80))
+				{
+					-- size;
+				}
+
+			stream_data_p -> jsd_truncated_flag = true;
+			res = -1;
+		}
+
+	if (size > 0)
+		{
+			if (stream_data_p -> jsd_writer_fn (buffer_s, size, stream_data_p -> jsd_writer_data_p))
+				{
+					stream_data_p -> jsd_size += size;
+				}
+			else
+				{
+					stream_data_p -> jsd_error_flag = true;
+					res = -1;
+				}
+		}
+
+	return res;
+}
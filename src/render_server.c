@@ -0,0 +1,586 @@
+/*
+ * render_server.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifndef WINDOWS
+	#include <poll.h>
+	#include <unistd.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+#endif
+
+#include "render_server.h"
+#include "parallel_tasks.h"
+#include "tool_stats.h"
+
+#include "string_utils.h"
+
+
+#ifndef WINDOWS
+
+/*
+ * Inline data packages can be big but there
+ * needs to be some limit on a single request.
+ */
+static const size_t S_MAX_REQUEST_SIZE = 64 << 20;
+
+static const size_t S_READ_BUFFER_SIZE = 1 << 16;
+
+/*
+ * How often the workers that are waiting for a request
+ * on an open connection check whether to stop.
+ */
+static const int S_POLL_INTERVAL_MS = 250;
+
+static const int S_LISTEN_BACKLOG = 64;
+
+#ifdef MSG_NOSIGNAL
+static const int S_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int S_SEND_FLAGS = 0;
+#endif
+
+
+typedef struct
+{
+	int rs_socket_fd;
+	RenderRequestFn rs_request_fn;
+	void *rs_data_p;
+
+	/** This guards rs_stop_flag */
+	TaskLock *rs_lock_p;
+	bool rs_stop_flag;
+} RenderServer;
+
+
+/*
+ * static declarations
+ */
+
+static void ServeConnections (void *data_p, const size_t worker_index);
+
+static void HandleConnection (RenderServer *server_p, const int client_fd, const size_t worker_index);
+
+static bool HandleRequest (RenderServer *server_p, const int client_fd, const char *request_s, const size_t length, const size_t worker_index);
+
+static bool AddOutputSizes (json_t *response_p);
+
+static bool StreamOutputs (const int client_fd, const json_t *outputs_p);
+
+static bool SendData (const int client_fd, const char *data_s, size_t length);
+
+static bool IsServerStopping (RenderServer *server_p);
+
+static void StopServer (RenderServer *server_p);
+
+static bool IsSocketInUse (const struct sockaddr_un *address_p);
+
+#endif
+
+
+/*
+ * api definitions
+ */
+
+#ifdef WINDOWS
+
+bool RunRenderServer (const char *socket_filename_s, const size_t num_workers, RenderRequestFn request_fn, void *data_p)
+{
+	printf ("The render server is not supported on this platform\n");
+
+	return false;
+}
+
+#else
+
+bool RunRenderServer (const char *socket_filename_s, const size_t num_workers, RenderRequestFn request_fn, void *data_p)
+{
+	bool success_flag = false;
+	struct sockaddr_un address;
+	struct stat st;
+	RenderServer server;
+
+	if (strlen (socket_filename_s) >= sizeof (address.sun_path))
+		{
+			printf ("The socket filename \"%s\" is too long\n", socket_filename_s);
+			return false;
+		}
+
+	memset (&address, 0, sizeof (address));
+	address.sun_family = AF_UNIX;
+	strcpy (address.sun_path, socket_filename_s);
+
+	/* Replace any socket left behind by a previous server but nothing else */
+	if (stat (socket_filename_s, &st) == 0)
+		{
+			if (!S_ISSOCK (st.st_mode))
+				{
+					printf ("\"%s\" already exists and is not a socket\n", socket_filename_s);
+					return false;
+				}
+			else if (IsSocketInUse (&address))
+				{
+					printf ("Another server is already listening on \"%s\"\n", socket_filename_s);
+					return false;
+				}
+			else
+				{
+					unlink (socket_filename_s);
+				}
+		}
+
+	server.rs_socket_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	server.rs_request_fn = request_fn;
+	server.rs_data_p = data_p;
+	server.rs_lock_p = NULL;
+	server.rs_stop_flag = false;
+
+	if (server.rs_socket_fd >= 0)
+		{
+			if (bind (server.rs_socket_fd, (struct sockaddr *) &address, sizeof (address)) == 0)
+				{
+					if (listen (server.rs_socket_fd, S_LISTEN_BACKLOG) == 0)
+						{
+							server.rs_lock_p = AllocateTaskLock ();
+
+							if (server.rs_lock_p)
+								{
+									const size_t n = (num_workers > 0) ? num_workers : 1;
+
+									printf ("Listening for render requests on \"%s\" with %lu workers\n", socket_filename_s, (unsigned long) n);
+									fflush (stdout);
+
+									/* Each worker accepts and serves its own connections until the server is stopped */
+									success_flag = RunParallelTasks (n, n, ServeConnections, &server);
+
+									FreeTaskLock (server.rs_lock_p);
+								}
+						}
+					else
+						{
+							printf ("Failed to listen on \"%s\": %s\n", socket_filename_s, strerror (errno));
+						}
+
+					unlink (socket_filename_s);
+				}
+			else
+				{
+					printf ("Failed to bind to \"%s\": %s\n", socket_filename_s, strerror (errno));
+				}
+
+			close (server.rs_socket_fd);
+		}
+	else
+		{
+			printf ("Failed to create a socket: %s\n", strerror (errno));
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * static definitions
+ */
+
+static void ServeConnections (void *data_p, const size_t worker_index)
+{
+	RenderServer *server_p = (RenderServer *) data_p;
+
+	while (!IsServerStopping (server_p))
+		{
+			const int client_fd = accept (server_p -> rs_socket_fd, NULL, NULL);
+
+			if (client_fd >= 0)
+				{
+					HandleConnection (server_p, client_fd, worker_index);
+					close (client_fd);
+				}
+			else if ((errno != EINTR) && (errno != ECONNABORTED))
+				{
+					/* Stopping the server shuts the socket down which wakes up any workers waiting here */
+					if (!IsServerStopping (server_p))
+						{
+							printf ("Failed to accept a connection: %s\n", strerror (errno));
+						}
+
+					break;
+				}
+		}
+}
+
+
+/*
+ * Read each line from the connection and handle it as a request until
+ * the client closes the connection or the server is stopped.
+ */
+static void HandleConnection (RenderServer *server_p, const int client_fd, const size_t worker_index)
+{
+	size_t buffer_size = S_READ_BUFFER_SIZE;
+	char *buffer_s = (char *) malloc (buffer_size);
+	size_t length = 0;
+	bool open_flag = (buffer_s != NULL);
+
+	while (open_flag)
+		{
+			struct pollfd poll_fd;
+			int res;
+
+			poll_fd.fd = client_fd;
+			poll_fd.events = POLLIN;
+			poll_fd.revents = 0;
+
+			res = poll (&poll_fd, 1, S_POLL_INTERVAL_MS);
+
+			if (res > 0)
+				{
+					ssize_t num_read;
+
+					if (length == buffer_size)
+						{
+							char *new_buffer_s = NULL;
+
+							if (buffer_size < S_MAX_REQUEST_SIZE)
+								{
+									new_buffer_s = (char *) realloc (buffer_s, buffer_size << 1);
+								}
+
+							if (new_buffer_s)
+								{
+									buffer_s = new_buffer_s;
+									buffer_size <<= 1;
+								}
+							else
+								{
+									fprintf (stderr, "Closing a connection with a request of more than %lu bytes\n", (unsigned long) buffer_size);
+									break;
+								}
+						}
+
+					num_read = read (client_fd, buffer_s + length, buffer_size - length);
+
+					if (num_read > 0)
+						{
+							const char *start_s = buffer_s;
+							const char *end_s = buffer_s + length + num_read;
+							const char *new_line_s = (const char *) memchr (buffer_s + length, '\n', num_read);
+
+							/* Handle each of the complete requests */
+							while (new_line_s && open_flag)
+								{
+									if (new_line_s > start_s)
+										{
+											open_flag = HandleRequest (server_p, client_fd, start_s, new_line_s - start_s, worker_index);
+										}
+
+									start_s = new_line_s + 1;
+									new_line_s = (const char *) memchr (start_s, '\n', end_s - start_s);
+								}
+
+							/* Keep any partial request for the next read */
+							length = end_s - start_s;
+
+							if ((length > 0) && (start_s > buffer_s))
+								{
+									memmove (buffer_s, start_s, length);
+								}
+						}
+					else if ((num_read == 0) || (errno != EINTR))
+						{
+							open_flag = false;
+						}
+				}
+			else if ((res < 0) && (errno != EINTR))
+				{
+					open_flag = false;
+				}
+
+			if (open_flag && IsServerStopping (server_p))
+				{
+					open_flag = false;
+				}
+		}
+
+	if (buffer_s)
+		{
+			free (buffer_s);
+		}
+}
+
+
+/*
+ * Carry out a request and send the response, returning false
+ * if the connection should be closed.
+ */
+static bool HandleRequest (RenderServer *server_p, const int client_fd, const char *request_s, const size_t length, const size_t worker_index)
+{
+	bool open_flag = false;
+	json_t *response_p = json_object ();
+
+	if (response_p)
+		{
+			const double start_time = GetWallClockTime ();
+			json_error_t err;
+			json_t *request_p = json_loadb (request_s, length, 0, &err);
+			char *response_s;
+			bool success_flag = false;
+			bool stream_flag = false;
+
+			if (json_is_object (request_p))
+				{
+					const json_t *command_p = json_object_get (request_p, "command");
+
+					if ((json_is_string (command_p)) && (strcmp (json_string_value (command_p), "stop") == 0))
+						{
+							StopServer (server_p);
+							success_flag = true;
+						}
+					else
+						{
+							success_flag = server_p -> rs_request_fn (server_p -> rs_data_p, worker_index, request_p, response_p);
+
+							if (success_flag)
+								{
+									success_flag = AddOutputSizes (response_p);
+									stream_flag = success_flag && (json_is_true (json_object_get (request_p, "stream")));
+								}
+						}
+				}
+			else
+				{
+					json_object_set_new (response_p, "error", json_string (request_p ? "The request must be a JSON object" : err.text));
+				}
+
+			if (!success_flag)
+				{
+					json_object_del (response_p, "outputs");
+				}
+
+			json_object_set_new (response_p, "success", json_boolean (success_flag));
+			json_object_set_new (response_p, "time_ms", json_real ((GetWallClockTime () - start_time) * 1000.0));
+
+			response_s = json_dumps (response_p, JSON_COMPACT);
+
+			if (response_s)
+				{
+					/* The compact form has no new lines so the client can read up to the first one */
+					open_flag = SendData (client_fd, response_s, strlen (response_s)) && SendData (client_fd, "\n", 1);
+
+					if (open_flag && stream_flag)
+						{
+							open_flag = StreamOutputs (client_fd, json_object_get (response_p, "outputs"));
+						}
+
+					free (response_s);
+				}
+
+			if (request_p)
+				{
+					json_decref (request_p);
+				}
+
+			json_decref (response_p);
+		}
+
+	return open_flag;
+}
+
+
+/*
+ * Replace each of the output filenames with an object
+ * with its filename and size.
+ */
+static bool AddOutputSizes (json_t *response_p)
+{
+	json_t *outputs_p = json_object_get (response_p, "outputs");
+	json_t *output_p;
+	size_t i;
+
+	if (!outputs_p)
+		{
+			outputs_p = json_array ();
+
+			if ((!outputs_p) || (json_object_set_new (response_p, "outputs", outputs_p) != 0))
+				{
+					return false;
+				}
+		}
+
+	json_array_foreach (outputs_p, i, output_p)
+		{
+			if (json_is_string (output_p))
+				{
+					const char *filename_s = json_string_value (output_p);
+					struct stat st;
+
+					if (stat (filename_s, &st) == 0)
+						{
+							json_t *entry_p = json_pack ("{s:s,s:I}", "file", filename_s, "size", (json_int_t) st.st_size);
+
+							if ((!entry_p) || (json_array_set_new (outputs_p, i, entry_p) != 0))
+								{
+									return false;
+								}
+						}
+					else
+						{
+							char *error_s = ConcatenateVarargsStrings ("Failed to get the size of \"", filename_s, "\"", NULL);
+
+							if (error_s)
+								{
+									json_object_set_new (response_p, "error", json_string (error_s));
+									FreeCopiedString (error_s);
+								}
+
+							return false;
+						}
+				}
+		}
+
+	return true;
+}
+
+
+/*
+ * Send exactly the number of bytes given in the response for
+ * each file so that the client can split the stream up.
+ */
+static bool StreamOutputs (const int client_fd, const json_t *outputs_p)
+{
+	bool success_flag = true;
+	char *buffer_s = (char *) malloc (S_READ_BUFFER_SIZE);
+
+	if (buffer_s)
+		{
+			const json_t *output_p;
+			size_t i;
+
+			json_array_foreach (outputs_p, i, output_p)
+				{
+					const char *filename_s = json_string_value (json_object_get (output_p, "file"));
+					size_t remaining = (size_t) json_integer_value (json_object_get (output_p, "size"));
+					FILE *in_f = fopen (filename_s, "rb");
+
+					if (in_f)
+						{
+							while ((remaining > 0) && success_flag)
+								{
+									const size_t num_read = fread (buffer_s, 1, (remaining < S_READ_BUFFER_SIZE) ? remaining : S_READ_BUFFER_SIZE, in_f);
+
+									if (num_read > 0)
+										{
+											success_flag = SendData (client_fd, buffer_s, num_read);
+											remaining -= num_read;
+										}
+									else
+										{
+											/* The file has changed so the client can't tell where the rest of the stream starts */
+											fprintf (stderr, "\"%s\" was shorter than expected when streaming it\n", filename_s);
+											success_flag = false;
+										}
+								}
+
+							fclose (in_f);
+						}
+					else
+						{
+							fprintf (stderr, "Failed to open \"%s\" to stream it\n", filename_s);
+							success_flag = false;
+						}
+
+					if (!success_flag)
+						{
+							break;
+						}
+				}
+
+			free (buffer_s);
+		}
+	else
+		{
+			success_flag = false;
+		}
+
+	return success_flag;
+}
+
+
+static bool SendData (const int client_fd, const char *data_s, size_t length)
+{
+	while (length > 0)
+		{
+			const ssize_t num_sent = send (client_fd, data_s, length, S_SEND_FLAGS);
+
+			if (num_sent > 0)
+				{
+					data_s += num_sent;
+					length -= num_sent;
+				}
+			else if ((num_sent < 0) && (errno == EINTR))
+				{
+					continue;
+				}
+			else
+				{
+					return false;
+				}
+		}
+
+	return true;
+}
+
+
+static bool IsServerStopping (RenderServer *server_p)
+{
+	bool stop_flag;
+
+	AcquireTaskLock (server_p -> rs_lock_p);
+	stop_flag = server_p -> rs_stop_flag;
+	ReleaseTaskLock (server_p -> rs_lock_p);
+
+	return stop_flag;
+}
+
+
+static void StopServer (RenderServer *server_p)
+{
+	AcquireTaskLock (server_p -> rs_lock_p);
+	server_p -> rs_stop_flag = true;
+	ReleaseTaskLock (server_p -> rs_lock_p);
+
+	/* Wake up any workers waiting for a connection */
+	shutdown (server_p -> rs_socket_fd, SHUT_RDWR);
+}
+
+
+/*
+ * A socket is only left behind by a server that has gone if nothing accepts a connection to it
+ */
+static bool IsSocketInUse (const struct sockaddr_un *address_p)
+{
+	bool in_use_flag = false;
+	const int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+
+	if (fd >= 0)
+		{
+			if (connect (fd, (const struct sockaddr *) address_p, sizeof (struct sockaddr_un)) == 0)
+				{
+					in_use_flag = true;
+				}
+
+			close (fd);
+		}
+
+	return in_use_flag;
+}
+
+#endif
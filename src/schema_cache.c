@@ -0,0 +1,629 @@
+/*
+ * schema_cache.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "schema_cache.h"
+
+#include "curl_tools.h"
+#include "json_util.h"
+#include "string_utils.h"
+
+
+/* The number of seconds allowed for connecting to a server and for the whole download of a schema */
+static const long S_CONNECT_TIMEOUT = 10L;
+
+static const long S_FETCH_TIMEOUT = 60L;
+
+
+/*
+ * static declarations
+ */
+
+static const json_t *GetCachedSchema (SchemaCache *cache_p, const char *url_s);
+
+static json_t *GetWebJSON (const char *url_s, ToolStats *stats_p);
+
+static bool SetWebJSONTimeouts (CurlTool *curl_tool_p);
+
+static char *GetMappedURL (const SchemaCache *cache_p, const char *url_s);
+
+static const json_t *GetLocalSchemaRef (SchemaCache *cache_p, const json_t *document_p, const char *url_s, const char *ref_s);
+
+static json_t *GetSchemaRefIndex (const json_t *document_p);
+
+static const json_t *GetJSONPointerValue (const json_t *document_p, const char *pointer_s);
+
+static char *RemoveDotSegments (const char *path_s);
+
+
+/*
+ * api definitions
+ */
+
+SchemaCache *AllocateSchemaCache (void)
+{
+	SchemaCache *cache_p = (SchemaCache *) calloc (1, sizeof (SchemaCache));
+
+	if (cache_p)
+		{
+			cache_p -> sc_schemas_p = json_object ();
+			cache_p -> sc_mappings_p = json_object ();
+			cache_p -> sc_refs_p = json_object ();
+			cache_p -> sc_fetching_p = json_object ();
+			cache_p -> sc_lock_p = AllocateTaskLock ();
+			cache_p -> sc_fetched_p = AllocateTaskCondition ();
+			cache_p -> sc_keys_p = AllocateKeyTable ();
+
+			if ((cache_p -> sc_schemas_p) && (cache_p -> sc_mappings_p) && (cache_p -> sc_refs_p) && (cache_p -> sc_fetching_p) &&
+					(cache_p -> sc_lock_p) && (cache_p -> sc_fetched_p) && (cache_p -> sc_keys_p))
+				{
+					return cache_p;
+				}
+
+			FreeSchemaCache (cache_p);
+		}
+
+	return NULL;
+}
+
+
+void FreeSchemaCache (SchemaCache *cache_p)
+{
+	json_decref (cache_p -> sc_schemas_p);
+	json_decref (cache_p -> sc_mappings_p);
+	json_decref (cache_p -> sc_refs_p);
+	json_decref (cache_p -> sc_fetching_p);
+
+	if (cache_p -> sc_lock_p)
+		{
+			FreeTaskLock (cache_p -> sc_lock_p);
+		}
+
+	if (cache_p -> sc_fetched_p)
+		{
+			FreeTaskCondition (cache_p -> sc_fetched_p);
+		}
+
+	if (cache_p -> sc_keys_p)
+		{
+			FreeKeyTable (cache_p -> sc_keys_p);
+		}
+
+	free (cache_p);
+}
+
+
+const json_t *GetSchemaFromCache (SchemaCache *cache_p, const char *url_s)
+{
+	const json_t *schema_p;
+
+	AcquireTaskLock (cache_p -> sc_lock_p);
+	schema_p = GetCachedSchema (cache_p, url_s);
+	ReleaseTaskLock (cache_p -> sc_lock_p);
+
+	return schema_p;
+}
+
+
+bool AddSchemaMapping (SchemaCache *cache_p, const char *prefix_s, const char *replacement_s)
+{
+	return SetJSONString (cache_p -> sc_mappings_p, prefix_s, replacement_s);
+}
+
+
+const json_t *ResolveSchemaRef (SchemaCache *cache_p, const json_t *document_p, const char *url_s, const char *ref_s, const json_t **document_pp, const char **document_url_ss)
+{
+	const json_t *schema_p = NULL;
+	const char *fragment_s = strchr (ref_s, '#');
+
+	/* The local refs' index is added to as well as the schemas */
+	AcquireTaskLock (cache_p -> sc_lock_p);
+
+	if (*ref_s != '#')
+		{
+			/* It's in a different schema */
+			char *absolute_url_s = GetAbsoluteSchemaURL (url_s, ref_s);
+
+			document_p = NULL;
+			url_s = NULL;
+
+			if (absolute_url_s)
+				{
+					document_p = GetCachedSchema (cache_p, absolute_url_s);
+
+					if (document_p)
+						{
+							/* Use the cache's copy of the url so that it lasts as long as the schema */
+							url_s = json_object_iter_key (json_object_iter_at (cache_p -> sc_schemas_p, absolute_url_s));
+						}
+
+					FreeCopiedString (absolute_url_s);
+				}
+		}
+
+	if (document_p)
+		{
+			if ((fragment_s) && (* (fragment_s + 1) != '\0'))
+				{
+					schema_p = GetLocalSchemaRef (cache_p, document_p, url_s, fragment_s);
+				}
+			else
+				{
+					schema_p = document_p;
+				}
+		}
+
+	ReleaseTaskLock (cache_p -> sc_lock_p);
+
+	if (schema_p)
+		{
+			if (document_pp)
+				{
+					*document_pp = document_p;
+				}
+
+			if (document_url_ss)
+				{
+					*document_url_ss = url_s;
+				}
+		}
+
+	return schema_p;
+}
+
+
+char *GetAbsoluteSchemaURL (const char *base_url_s, const char *ref_s)
+{
+	char *url_s = NULL;
+	const char *fragment_s = strchr (ref_s, '#');
+	const size_t ref_length = fragment_s ? (size_t) (fragment_s - ref_s) : strlen (ref_s);
+	const char *scheme_s = strstr (ref_s, "://");
+
+	if (ref_length > 0)
+		{
+			if ((scheme_s) && (scheme_s < ref_s + ref_length))
+				{
+					url_s = CopyToNewString (ref_s, ref_length, false);
+				}
+			else if (base_url_s)
+				{
+					const char *base_scheme_s = strstr (base_url_s, "://");
+
+					if (base_scheme_s)
+						{
+							const char *base_path_s = strchr (base_scheme_s + 3, '/');
+							char *path_s = NULL;
+
+							if (!base_path_s)
+								{
+									base_path_s = base_url_s + strlen (base_url_s);
+								}
+
+							if (*ref_s == '/')
+								{
+									path_s = CopyToNewString (ref_s, ref_length, false);
+								}
+							else
+								{
+									/* Replace the last segment of the base url's path */
+									const char *dir_end_s = strrchr (base_path_s, '/');
+									char *dir_s = dir_end_s ? CopyToNewString (base_path_s, dir_end_s + 1 - base_path_s, false) : EasyCopyToNewString ("/");
+
+									if (dir_s)
+										{
+											char *ref_path_s = CopyToNewString (ref_s, ref_length, false);
+
+											if (ref_path_s)
+												{
+													path_s = ConcatenateStrings (dir_s, ref_path_s);
+													FreeCopiedString (ref_path_s);
+												}
+
+											FreeCopiedString (dir_s);
+										}
+								}
+
+							if (path_s)
+								{
+									char *normalised_path_s = RemoveDotSegments (path_s);
+
+									if (normalised_path_s)
+										{
+											char *host_s = CopyToNewString (base_url_s, base_path_s - base_url_s, false);
+
+											if (host_s)
+												{
+													url_s = ConcatenateStrings (host_s, normalised_path_s);
+													FreeCopiedString (host_s);
+												}
+
+											FreeCopiedString (normalised_path_s);
+										}
+
+									FreeCopiedString (path_s);
+								}
+						}
+				}
+		}
+
+	return url_s;
+}
+
+
+/*
+ * static definitions
+ */
+
+/*
+ * Get a schema, downloading it if needed. This is called while holding the
+ * cache's lock, which is released during the download so that other threads
+ * can use the cache. Any that want the same schema wait for the download.
+ */
+static const json_t *GetCachedSchema (SchemaCache *cache_p, const char *url_s)
+{
+	const json_t *schema_p = json_object_get (cache_p -> sc_schemas_p, url_s);
+
+	while ((!schema_p) && (json_object_get (cache_p -> sc_fetching_p, url_s)))
+		{
+			WaitForTaskCondition (cache_p -> sc_fetched_p, cache_p -> sc_lock_p);
+			schema_p = json_object_get (cache_p -> sc_schemas_p, url_s);
+		}
+
+	if (schema_p)
+		{
+			++ (cache_p -> sc_num_hits);
+		}
+	else
+		{
+			json_t *downloaded_schema_p = NULL;
+			char *mapped_url_s = GetMappedURL (cache_p, url_s);
+			char *fetch_url_s = mapped_url_s ? mapped_url_s : EasyCopyToNewString (url_s);
+
+			++ (cache_p -> sc_num_fetches);
+			json_object_set_new (cache_p -> sc_fetching_p, url_s, json_true ());
+
+			if (fetch_url_s)
+				{
+					ReleaseTaskLock (cache_p -> sc_lock_p);
+					downloaded_schema_p = GetWebJSON (fetch_url_s, cache_p -> sc_stats_p);
+					AcquireTaskLock (cache_p -> sc_lock_p);
+
+					FreeCopiedString (fetch_url_s);
+				}
+
+			json_object_del (cache_p -> sc_fetching_p, url_s);
+
+			/*
+			 * Store failures too so that we don't keep
+			 * trying to download a broken url
+			 */
+			if (!downloaded_schema_p)
+				{
+					downloaded_schema_p = json_null ();
+				}
+
+			if (json_object_set_new (cache_p -> sc_schemas_p, url_s, downloaded_schema_p) == 0)
+				{
+					schema_p = downloaded_schema_p;
+				}
+			else
+				{
+					fprintf (stderr, "Failed to cache schema from \"%s\"\n", url_s);
+				}
+
+			SignalTaskCondition (cache_p -> sc_fetched_p);
+		}
+
+	if (json_is_null (schema_p))
+		{
+			schema_p = NULL;
+		}
+
+	return schema_p;
+}
+
+
+static char *GetMappedURL (const SchemaCache *cache_p, const char *url_s)
+{
+	const char *prefix_s;
+	json_t *replacement_p;
+
+	json_object_foreach (cache_p -> sc_mappings_p, prefix_s, replacement_p)
+		{
+			if (DoesStringStartWith (url_s, prefix_s))
+				{
+					return ConcatenateStrings (json_string_value (replacement_p), url_s + strlen (prefix_s));
+				}
+		}
+
+	return NULL;
+}
+
+
+static json_t *GetWebJSON (const char *url_s, ToolStats *stats_p)
+{
+	json_t *data_p = NULL;
+	StatsTimer timer;
+	CurlTool *curl_tool_p;
+
+	StartStatsTimer (stats_p, &timer, SP_SCHEMA_FETCH);
+
+	curl_tool_p = AllocateMemoryCurlTool (0);
+
+	if (curl_tool_p)
+		{
+			if (SetUriForCurlTool (curl_tool_p, url_s) && SetWebJSONTimeouts (curl_tool_p))
+				{
+					CURLcode res = RunCurlTool (curl_tool_p);
+
+					if (res == CURLE_OK)
+						{
+							const char *data_s = GetCurlToolData (curl_tool_p);
+
+
+							if (data_s)
+								{
+									json_error_t err;
+									StatsTimer parse_timer;
+
+									StartStatsTimer (stats_p, &parse_timer, SP_SCHEMA_PARSE);
+									data_p = json_loads (data_s, 0, &err);
+									StopStatsTimer (stats_p, &parse_timer, url_s);
+								}
+						}
+				}
+
+			FreeCurlTool (curl_tool_p);
+		}
+
+	StopStatsTimer (stats_p, &timer, url_s);
+
+	return data_p;
+}
+
+
+/*
+ * Stop a slow or unreachable server from holding up the packages that use its schemas
+ */
+static bool SetWebJSONTimeouts (CurlTool *curl_tool_p)
+{
+	return ((curl_easy_setopt (curl_tool_p -> ct_curl_p, CURLOPT_CONNECTTIMEOUT, S_CONNECT_TIMEOUT) == CURLE_OK) &&
+			(curl_easy_setopt (curl_tool_p -> ct_curl_p, CURLOPT_TIMEOUT, S_FETCH_TIMEOUT) == CURLE_OK));
+}
+
+
+/*
+ * Look up a local ref in the schema's index, adding it
+ * if it isn't a definition that is already there.
+ */
+static const json_t *GetLocalSchemaRef (SchemaCache *cache_p, const json_t *document_p, const char *url_s, const char *ref_s)
+{
+	const json_t *schema_p = NULL;
+
+	if (url_s)
+		{
+			json_t *index_p = json_object_get (cache_p -> sc_refs_p, url_s);
+
+			if (!index_p)
+				{
+					index_p = GetSchemaRefIndex (document_p);
+
+					if (index_p)
+						{
+							if (json_object_set_new (cache_p -> sc_refs_p, url_s, index_p) != 0)
+								{
+									index_p = NULL;
+								}
+						}
+				}
+
+			if (index_p)
+				{
+					schema_p = json_object_get (index_p, ref_s);
+
+					if (!schema_p)
+						{
+							schema_p = GetJSONPointerValue (document_p, ref_s + 1);
+
+							/* Store failures too so that we don't walk the schema for them again */
+							if (schema_p)
+								{
+									json_object_set (index_p, ref_s, (json_t *) schema_p);
+								}
+							else
+								{
+									json_object_set_new (index_p, ref_s, json_null ());
+								}
+						}
+
+					if (json_is_null (schema_p))
+						{
+							schema_p = NULL;
+						}
+				}
+		}
+	else
+		{
+			schema_p = GetJSONPointerValue (document_p, ref_s + 1);
+		}
+
+	return schema_p;
+}
+
+
+/*
+ * Index all of a schema's definitions by their refs in one go
+ */
+static json_t *GetSchemaRefIndex (const json_t *document_p)
+{
+	json_t *index_p = json_object ();
+
+	if (index_p)
+		{
+			const char * const sections_ss [] = { "definitions", "$defs", NULL };
+			const char * const *section_ss;
+
+			for (section_ss = sections_ss; *section_ss; ++ section_ss)
+				{
+					const json_t *definitions_p = json_object_get (document_p, *section_ss);
+
+					if (json_is_object (definitions_p))
+						{
+							const char *name_s;
+							json_t *definition_p;
+
+							json_object_foreach ((json_t *) definitions_p, name_s, definition_p)
+								{
+									/* Names that would need escaping are left for GetJSONPointerValue () */
+									if (!strpbrk (name_s, "/~"))
+										{
+											char *ref_s = ConcatenateVarargsStrings ("#/", *section_ss, "/", name_s, NULL);
+
+											if (ref_s)
+												{
+													json_object_set (index_p, ref_s, definition_p);
+													FreeCopiedString (ref_s);
+												}
+										}
+								}
+						}
+				}
+		}
+
+	return index_p;
+}
+
+
+/*
+ * Get the value at a JSON pointer such as "/definitions/plot"
+ */
+static const json_t *GetJSONPointerValue (const json_t *document_p, const char *pointer_s)
+{
+	const json_t *value_p = document_p;
+	const char *segment_s = pointer_s;
+
+	while (value_p && (*segment_s == '/'))
+		{
+			const char *end_s;
+			char *key_s;
+			size_t length;
+
+			++ segment_s;
+			end_s = strchr (segment_s, '/');
+			length = end_s ? (size_t) (end_s - segment_s) : strlen (segment_s);
+
+			key_s = CopyToNewString (segment_s, length, false);
+
+			if (key_s)
+				{
+					/* Unescape "~1" to "/" and "~0" to "~" */
+					char *in_p = key_s;
+					char *out_p = key_s;
+
+					while (*in_p)
+						{
+							if ((*in_p == '~') && ((* (in_p + 1) == '0') || (* (in_p + 1) == '1')))
+								{
+									*out_p = (* (in_p + 1) == '0') ? '~' : '/';
+									in_p += 2;
+								}
+							else
+								{
+									*out_p = *in_p;
+									++ in_p;
+								}
+
+							++ out_p;
+						}
+
+					*out_p = '\0';
+
+					if (json_is_array (value_p))
+						{
+							char *index_end_s;
+							const unsigned long index = strtoul (key_s, &index_end_s, 10);
+
+							value_p = ((*key_s != '\0') && (*index_end_s == '\0')) ? json_array_get (value_p, index) : NULL;
+						}
+					else
+						{
+							value_p = json_object_get (value_p, key_s);
+						}
+
+					FreeCopiedString (key_s);
+				}
+			else
+				{
+					value_p = NULL;
+				}
+
+			segment_s += length;
+		}
+
+	return value_p;
+}
+
+
+/*
+ * Remove any "." and ".." segments from a url path
+ */
+static char *RemoveDotSegments (const char *path_s)
+{
+	char *result_s = (char *) malloc (strlen (path_s) + 2);
+
+	if (result_s)
+		{
+			/* The output holds "/segment" for each segment that is kept */
+			char *out_p = result_s;
+			const char *segment_s = path_s;
+			bool directory_flag = true;
+
+			while (*segment_s)
+				{
+					const char *end_s;
+					size_t length;
+
+					if (*segment_s == '/')
+						{
+							++ segment_s;
+						}
+
+					end_s = strchr (segment_s, '/');
+					length = end_s ? (size_t) (end_s - segment_s) : strlen (segment_s);
+					directory_flag = true;
+
+					if ((length == 2) && (strncmp (segment_s, "..", 2) == 0))
+						{
+							while ((out_p > result_s) && (* (-- out_p) != '/'))
+								{
+								}
+						}
+					else if ((length > 1) || ((length == 1) && (*segment_s != '.')))
+						{
+							*out_p = '/';
+							memcpy (++ out_p, segment_s, length);
+							out_p += length;
+
+							directory_flag = false;
+						}
+
+					segment_s += length;
+				}
+
+			if (directory_flag)
+				{
+					*out_p = '/';
+					++ out_p;
+				}
+
+			*out_p = '\0';
+		}
+
+	return result_s;
+}
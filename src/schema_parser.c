@@ -0,0 +1,976 @@
+/*
+ * schema_parser.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "schema_parser.h"
+
+#include "frictionless_data_util.h"
+
+#include "json_util.h"
+#include "string_utils.h"
+
+
+typedef enum
+{
+	ST_NONE,
+	ST_OBJECT,
+	ST_ARRAY,
+	ST_STRING,
+	ST_INTEGER,
+	ST_NUMBER,
+	ST_BOOLEAN,
+
+	/** A type that isn't printed such as "null" */
+	ST_OTHER
+} SchemaType;
+
+
+/*
+ * A property of an object schema with everything about it that
+ * doesn't depend upon the data worked out once rather than for
+ * every object that uses the schema.
+ */
+typedef struct
+{
+	/** The property's name, which is interned in the SchemaCache's KeyTable */
+	const char *lp_key_s;
+	KeyID lp_key_id;
+
+	const json_t *lp_schema_p;
+
+	/** The $ref to follow before printing the property or NULL if there isn't one */
+	const char *lp_ref_s;
+
+	bool lp_required_flag;
+
+	/** Whether lp_schema_p has an anyOf or oneOf */
+	bool lp_select_flag;
+
+	bool lp_order_flag;
+	json_int_t lp_order;
+} LayoutProperty;
+
+
+/*
+ * The properties of an object schema in the order that they are printed.
+ */
+typedef struct
+{
+	LayoutProperty *ol_properties_p;
+	size_t ol_num_properties;
+	size_t ol_num_required;
+} ObjectLayout;
+
+
+/*
+ * The ObjectLayouts for the schemas that have been used while walking
+ * a resource, so that any arrays of objects only work them out once.
+ */
+typedef struct
+{
+	/** The indexes of the layouts keyed by their schema's address */
+	json_t *lc_indexes_p;
+
+	ObjectLayout **lc_layouts_pp;
+	size_t lc_num_layouts;
+	size_t lc_capacity;
+} LayoutCache;
+
+
+/*
+ * The settings that stay the same while walking a resource
+ */
+typedef struct
+{
+	Printer *sp_printer_p;
+	SchemaCache *sp_schema_cache_p;
+	bool sp_full_flag;
+	bool sp_debug_flag;
+	LayoutCache *sp_layouts_p;
+} SchemaParser;
+
+
+/*
+ * A schema along with the document that it is part of, which
+ * is needed to resolve any refs within it.
+ */
+typedef struct
+{
+	const json_t *ss_schema_p;
+	const json_t *ss_document_p;
+	const char *ss_url_s;
+} SchemaScope;
+
+
+static const char * const S_TYPE_OBJECT_S = "object";
+static const char * const S_REF_S = "$ref";
+static const char * const S_ITEMS_S = "items";
+static const char * const S_PROPERTIES_S = "properties";
+static const char * const S_REQUIRED_S = "required";
+static const char * const S_ANY_OF_S = "anyOf";
+static const char * const S_ONE_OF_S = "oneOf";
+
+
+/*
+ * static declarations
+ */
+
+static int SortPropertiesByOrder (const void *v0_p, const void *v1_p);
+
+static const ObjectLayout *GetObjectLayout (const json_t *schema_p, const SchemaParser *parser_p);
+
+static ObjectLayout *AllocateObjectLayout (const json_t *schema_p, KeyTable *keys_p);
+
+static void FreeObjectLayout (ObjectLayout *layout_p);
+
+static void ClearLayoutCache (LayoutCache *cache_p);
+
+static bool ParseObject (const json_t *data_p, const SchemaScope *scope_p, const SchemaParser *parser_p, const size_t indent_level);
+
+static bool ParseProperty (const json_t *data_p, const LayoutProperty *property_p, const SchemaScope *property_scope_p, const SchemaParser *parser_p, const size_t indent_level);
+
+static void ParseArray (const char *key_s, const KeyID key_id, const json_t *values_p, const json_t *property_p, const SchemaScope *items_scope_p, const SchemaParser *parser_p, const size_t indent_level);
+
+static void ParseEntry (const char *key_s, const KeyID key_id, const json_t *value_p, const SchemaScope *scope_p, const bool required_flag, const SchemaParser *parser_p, const size_t indent_level);
+
+static void PrintValue (const char *key_s, const KeyID key_id, const json_t *value_p, const SchemaType type, const char *format_s, const bool required_flag, const SchemaParser *parser_p);
+
+static bool ResolveScope (SchemaScope *scope_p, const char *ref_s, const SchemaParser *parser_p);
+
+static void SelectSubschema (SchemaScope *scope_p, const json_t *value_p, const SchemaParser *parser_p);
+
+static bool DoesSchemaMatchValue (const SchemaScope *scope_p, const json_t *value_p, const SchemaParser *parser_p);
+
+static SchemaType GetSchemaType (const json_t *schema_p, const json_t *value_p);
+
+static SchemaType GetSchemaTypeFromName (const char *type_s);
+
+static bool DoesTypeMatchValue (const SchemaType type, const json_t *value_p);
+
+
+/*
+ * api definitions
+ */
+
+bool ParsePackageFromSchema (const json_t *data_p, const json_t *schema_p, const char *schema_url_s, Printer *printer_p, SchemaCache *schema_cache_p, const bool full_flag, const bool debug_flag, const size_t indent_level)
+{
+	bool success_flag = false;
+	SchemaParser parser;
+	SchemaScope scope;
+	LayoutCache layouts;
+
+	memset (&layouts, 0, sizeof (LayoutCache));
+	layouts.lc_indexes_p = json_object ();
+
+	if (layouts.lc_indexes_p)
+		{
+			parser.sp_printer_p = printer_p;
+			parser.sp_schema_cache_p = schema_cache_p;
+			parser.sp_full_flag = full_flag;
+			parser.sp_debug_flag = debug_flag;
+			parser.sp_layouts_p = &layouts;
+
+			scope.ss_schema_p = schema_p;
+			scope.ss_document_p = schema_p;
+			scope.ss_url_s = schema_url_s;
+
+			success_flag = ParseObject (data_p, &scope, &parser, indent_level);
+
+			ClearLayoutCache (&layouts);
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * static definitions
+ */
+
+static int SortPropertiesByOrder (const void *v0_p, const void *v1_p)
+{
+	int res = 0;
+	const LayoutProperty *property_0_p = (const LayoutProperty *) v0_p;
+	const LayoutProperty *property_1_p = (const LayoutProperty *) v1_p;
+
+	if ((property_0_p -> lp_order_flag) && (property_1_p -> lp_order_flag))
+		{
+			res = property_0_p -> lp_order - property_1_p -> lp_order;
+		}
+
+	return res;
+}
+
+
+/*
+ * Get the ObjectLayout for an object schema, working it
+ * out if this is the first time that the schema is used.
+ */
+static const ObjectLayout *GetObjectLayout (const json_t *schema_p, const SchemaParser *parser_p)
+{
+	LayoutCache *cache_p = parser_p -> sp_layouts_p;
+	ObjectLayout *layout_p = NULL;
+	char key_s [32];
+	json_int_t index;
+
+	snprintf (key_s, sizeof (key_s), "%p", (const void *) schema_p);
+
+	if (GetJSONInteger (cache_p -> lc_indexes_p, key_s, &index))
+		{
+			layout_p = cache_p -> lc_layouts_pp [index];
+		}
+	else
+		{
+			if (cache_p -> lc_num_layouts == cache_p -> lc_capacity)
+				{
+					const size_t capacity = (cache_p -> lc_capacity > 0) ? (cache_p -> lc_capacity) << 1 : 16;
+					ObjectLayout **layouts_pp = (ObjectLayout **) realloc (cache_p -> lc_layouts_pp, capacity * sizeof (ObjectLayout *));
+
+					if (!layouts_pp)
+						{
+							return NULL;
+						}
+
+					cache_p -> lc_layouts_pp = layouts_pp;
+					cache_p -> lc_capacity = capacity;
+				}
+
+			layout_p = AllocateObjectLayout (schema_p, parser_p -> sp_schema_cache_p -> sc_keys_p);
+
+			if (layout_p)
+				{
+					if (SetJSONInteger (cache_p -> lc_indexes_p, key_s, (json_int_t) (cache_p -> lc_num_layouts)))
+						{
+							cache_p -> lc_layouts_pp [cache_p -> lc_num_layouts] = layout_p;
+							++ (cache_p -> lc_num_layouts);
+						}
+					else
+						{
+							FreeObjectLayout (layout_p);
+							layout_p = NULL;
+						}
+				}
+		}
+
+	return layout_p;
+}
+
+
+/*
+ * Get the properties sorted by their propertyOrder values along
+ * with whether each one is required and any ref to follow for it.
+ */
+static ObjectLayout *AllocateObjectLayout (const json_t *schema_p, KeyTable *keys_p)
+{
+	ObjectLayout *layout_p = (ObjectLayout *) calloc (1, sizeof (ObjectLayout));
+
+	if (layout_p)
+		{
+			const json_t *properties_p = json_object_get (schema_p, S_PROPERTIES_S);
+			const json_t *required_entries_p = json_object_get (schema_p, S_REQUIRED_S);
+			const size_t num_properties = json_object_size (properties_p);
+			bool success_flag = true;
+
+			layout_p -> ol_num_required = json_array_size (required_entries_p);
+
+			if (num_properties > 0)
+				{
+					layout_p -> ol_properties_p = (LayoutProperty *) calloc (num_properties, sizeof (LayoutProperty));
+
+					if (layout_p -> ol_properties_p)
+						{
+							KeyID *required_ids_p = NULL;
+							size_t num_required_ids = 0;
+							const char *key_s;
+							json_t *value_p;
+
+							/* Intern the required keys so that each property only needs to compare IDs */
+							if (layout_p -> ol_num_required > 0)
+								{
+									required_ids_p = (KeyID *) malloc ((layout_p -> ol_num_required) * sizeof (KeyID));
+
+									if (required_ids_p)
+										{
+											const json_t *entry_p;
+											size_t i;
+
+											json_array_foreach (required_entries_p, i, entry_p)
+												{
+													if ((json_is_string (entry_p)) && (InternKey (keys_p, json_string_value (entry_p), required_ids_p + num_required_ids)))
+														{
+															++ num_required_ids;
+														}
+												}
+										}
+									else
+										{
+											success_flag = false;
+										}
+								}
+
+							json_object_foreach (properties_p, key_s, value_p)
+								{
+									LayoutProperty *property_p = (layout_p -> ol_properties_p) + (layout_p -> ol_num_properties);
+									size_t i;
+
+									property_p -> lp_key_s = InternKey (keys_p, key_s, & (property_p -> lp_key_id));
+
+									if (! (property_p -> lp_key_s))
+										{
+											success_flag = false;
+											break;
+										}
+
+									property_p -> lp_schema_p = value_p;
+									property_p -> lp_order_flag = GetJSONInteger (value_p, FD_PROFILE_PROPERTY_ORDER_S, & (property_p -> lp_order));
+									property_p -> lp_select_flag = json_object_get (value_p, S_ANY_OF_S) || json_object_get (value_p, S_ONE_OF_S);
+
+									/*
+									 * A $ref alongside a type of array is the schema for the array's
+									 * entries so only follow it straight away if there is no type.
+									 */
+									if (!json_object_get (value_p, FD_TABLE_FIELD_TYPE))
+										{
+											property_p -> lp_ref_s = GetJSONString (value_p, S_REF_S);
+										}
+
+									for (i = 0; i < num_required_ids; ++ i)
+										{
+											if (required_ids_p [i] == property_p -> lp_key_id)
+												{
+													property_p -> lp_required_flag = true;
+													break;
+												}
+										}
+
+									++ (layout_p -> ol_num_properties);
+								}
+
+							if (required_ids_p)
+								{
+									free (required_ids_p);
+								}
+
+							qsort (layout_p -> ol_properties_p, layout_p -> ol_num_properties, sizeof (LayoutProperty), SortPropertiesByOrder);
+						}
+					else
+						{
+							success_flag = false;
+						}
+				}
+
+			if (!success_flag)
+				{
+					FreeObjectLayout (layout_p);
+					layout_p = NULL;
+				}
+		}
+
+	return layout_p;
+}
+
+
+static void FreeObjectLayout (ObjectLayout *layout_p)
+{
+	if (layout_p -> ol_properties_p)
+		{
+			free (layout_p -> ol_properties_p);
+		}
+
+	free (layout_p);
+}
+
+
+static void ClearLayoutCache (LayoutCache *cache_p)
+{
+	size_t i;
+
+	for (i = 0; i < cache_p -> lc_num_layouts; ++ i)
+		{
+			FreeObjectLayout (cache_p -> lc_layouts_pp [i]);
+		}
+
+	if (cache_p -> lc_layouts_pp)
+		{
+			free (cache_p -> lc_layouts_pp);
+		}
+
+	json_decref (cache_p -> lc_indexes_p);
+}
+
+
+static bool ParseObject (const json_t *data_p, const SchemaScope *scope_p, const SchemaParser *parser_p, const size_t indent_level)
+{
+	bool result = false;
+	const json_t *schema_p = scope_p -> ss_schema_p;
+
+	if (parser_p -> sp_debug_flag)
+		{
+			PrintJSON (stdout, data_p, "processing ");
+			PrintJSON (stdout, schema_p, "schema ");
+		}
+
+	if (json_object_get (schema_p, S_PROPERTIES_S))
+		{
+			const ObjectLayout *layout_p = GetObjectLayout (schema_p, parser_p);
+
+			if (layout_p)
+				{
+					const LayoutProperty *property_p = layout_p -> ol_properties_p;
+					size_t num_required_entries_found = 0;
+					size_t i;
+
+					/*
+					 * Now read in the values in order
+					 */
+					for (i = layout_p -> ol_num_properties; i > 0; -- i, ++ property_p)
+						{
+							SchemaScope property_scope = *scope_p;
+
+							property_scope.ss_schema_p = property_p -> lp_schema_p;
+
+							if (ParseProperty (data_p, property_p, &property_scope, parser_p, indent_level))
+								{
+									if (property_p -> lp_required_flag)
+										{
+											++ num_required_entries_found;
+										}
+								}
+
+						}		/* for (i = layout_p -> ol_num_properties; i > 0; -- i, ++ property_p) */
+
+					/*
+					 * Did we get all of the required fields?
+					 */
+					if (num_required_entries_found == layout_p -> ol_num_required)
+						{
+							result = true;
+						}
+
+				}		/* if (layout_p) */
+
+		}		/* if (json_object_get (schema_p, S_PROPERTIES_S)) */
+
+	return result;
+}
+
+
+/*
+ * Print a single property of an object, returning true if it has a value.
+ */
+static bool ParseProperty (const json_t *data_p, const LayoutProperty *property_p, const SchemaScope *property_scope_p, const SchemaParser *parser_p, const size_t indent_level)
+{
+	SchemaScope scope = *property_scope_p;
+	const json_t *value_p = json_object_get (data_p, property_p -> lp_key_s);
+
+	if (property_p -> lp_ref_s)
+		{
+			if (!ResolveScope (&scope, property_p -> lp_ref_s, parser_p))
+				{
+					fprintf (stderr, "Failed to resolve schema \"%s\" for \"%s\"\n", property_p -> lp_ref_s, property_p -> lp_key_s);
+					return false;
+				}
+
+			SelectSubschema (&scope, value_p, parser_p);
+		}
+	else if (property_p -> lp_select_flag)
+		{
+			SelectSubschema (&scope, value_p, parser_p);
+		}
+
+	ParseEntry (property_p -> lp_key_s, property_p -> lp_key_id, value_p, &scope, property_p -> lp_required_flag, parser_p, indent_level);
+
+	return (value_p != NULL);
+}
+
+
+/*
+ * Print a value whose schema has been resolved.
+ */
+static void ParseEntry (const char *key_s, const KeyID key_id, const json_t *value_p, const SchemaScope *scope_p, const bool required_flag, const SchemaParser *parser_p, const size_t indent_level)
+{
+	const json_t *schema_p = scope_p -> ss_schema_p;
+	const SchemaType type = GetSchemaType (schema_p, value_p);
+
+	if (type != ST_NONE)
+		{
+			if (type == ST_OBJECT)
+				{
+					if (json_is_object (value_p))
+						{
+							if (json_object_get (schema_p, S_PROPERTIES_S))
+								{
+									const char *title_s = GetJSONString (schema_p, FD_TITLE_S);
+
+									if (!title_s)
+										{
+											title_s = key_s;
+										}
+
+									StartPrintObject (parser_p -> sp_printer_p, key_s, title_s);
+
+									if (!ParseObject (value_p, scope_p, parser_p, indent_level + 1))
+										{
+											fprintf (stderr, "Failed to parse \"%s\"\n", key_s);
+										}
+
+									EndPrintObject (parser_p -> sp_printer_p);
+								}
+							else
+								{
+									PrintJSONObject (parser_p -> sp_printer_p, key_s, value_p, required_flag, GetJSONString (schema_p, FD_TABLE_FIELD_FORMAT));
+								}
+						}
+					else if (value_p)
+						{
+							PrintJSONObject (parser_p -> sp_printer_p, key_s, value_p, required_flag, GetJSONString (schema_p, FD_TABLE_FIELD_FORMAT));
+						}
+
+				}		/* if (type == ST_OBJECT) */
+			else if (type == ST_ARRAY)
+				{
+					if (json_is_array (value_p))
+						{
+							/*
+							 * Resolve the schema for the entries once rather than for each entry
+							 */
+							SchemaScope items_scope = *scope_p;
+							const char *ref_s = GetRefSchemaURI (schema_p);
+							bool items_flag = false;
+
+							if (ref_s)
+								{
+									items_flag = ResolveScope (&items_scope, ref_s, parser_p);
+
+									if (!items_flag)
+										{
+											fprintf (stderr, "Failed to resolve schema \"%s\" for \"%s\"\n", ref_s, key_s);
+										}
+								}
+							else
+								{
+									items_scope.ss_schema_p = json_object_get (schema_p, S_ITEMS_S);
+									items_flag = json_is_object (items_scope.ss_schema_p);
+								}
+
+							if (items_flag)
+								{
+									ParseArray (key_s, key_id, value_p, schema_p, &items_scope, parser_p, indent_level);
+								}
+							else if (!ref_s)
+								{
+									PrintJSONObject (parser_p -> sp_printer_p, key_s, value_p, required_flag, GetJSONString (schema_p, FD_TABLE_FIELD_FORMAT));
+								}
+						}
+					else if (value_p)
+						{
+							PrintJSONObject (parser_p -> sp_printer_p, key_s, value_p, required_flag, GetJSONString (schema_p, FD_TABLE_FIELD_FORMAT));
+						}
+
+				}		/* else if (type == ST_ARRAY) */
+			else
+				{
+					PrintValue (key_s, key_id, value_p, type, GetJSONString (schema_p, FD_TABLE_FIELD_FORMAT), required_flag, parser_p);
+				}
+
+		}		/* if (type != ST_NONE) */
+
+}
+
+
+/*
+ * Print the entries of an array as a section
+ */
+static void ParseArray (const char *key_s, const KeyID key_id, const json_t *values_p, const json_t *property_p, const SchemaScope *items_scope_p, const SchemaParser *parser_p, const size_t indent_level)
+{
+	const json_t *entry_p;
+	size_t i;
+	const char *title_s = GetJSONString (property_p, key_s);
+	const bool select_flag = json_object_get (items_scope_p -> ss_schema_p, S_ANY_OF_S) || json_object_get (items_scope_p -> ss_schema_p, S_ONE_OF_S);
+
+	if (!title_s)
+		{
+			title_s = key_s;
+		}
+
+	StartPrintSection (parser_p -> sp_printer_p, title_s);
+
+	json_array_foreach (values_p, i, entry_p)
+		{
+			SchemaScope entry_scope = *items_scope_p;
+
+			if (select_flag)
+				{
+					SelectSubschema (&entry_scope, entry_p, parser_p);
+				}
+
+			if ((json_is_object (entry_p)) && (GetSchemaType (entry_scope.ss_schema_p, entry_p) == ST_OBJECT))
+				{
+					StartPrintEntry (parser_p -> sp_printer_p);
+
+					if (!ParseObject (entry_p, &entry_scope, parser_p, indent_level + 1))
+						{
+							fprintf (stderr, "Failed to parse \"%s\"\n", key_s);
+						}
+
+					EndPrintEntry (parser_p -> sp_printer_p);
+				}
+			else
+				{
+					ParseEntry (key_s, key_id, entry_p, &entry_scope, false, parser_p, indent_level + 1);
+				}
+		}
+
+	EndPrintSection (parser_p -> sp_printer_p, NULL);
+}
+
+
+static void PrintValue (const char *key_s, const KeyID key_id, const json_t *value_p, const SchemaType type, const char *format_s, const bool required_flag, const SchemaParser *parser_p)
+{
+	Printer *printer_p = parser_p -> sp_printer_p;
+	const bool full_flag = parser_p -> sp_full_flag;
+
+	if (type == ST_STRING)
+		{
+			const char *value_s = json_is_string (value_p) ? json_string_value (value_p) : NULL;
+
+			if (value_s || full_flag)
+				{
+					/*
+					 * profiles may be a url so check for this
+					 */
+					if ((key_id == KI_PROFILE) && (DoesStringStartWith (value_s, "http")))
+						{
+							format_s = FD_TYPE_STRING_FORMAT_URI;
+						}
+
+					PrintString (printer_p, key_s, value_s, required_flag, format_s);
+				}
+
+		}		/* if (type == ST_STRING) */
+	else if (type == ST_INTEGER)
+		{
+			if (json_is_integer (value_p))
+				{
+					json_int_t value = json_integer_value (value_p);
+
+					PrintInteger (printer_p, key_s, &value, required_flag, format_s);
+				}
+			else if (full_flag)
+				{
+					PrintInteger (printer_p, key_s, NULL, required_flag, format_s);
+				}
+
+		}		/* else if (type == ST_INTEGER) */
+	else if (type == ST_NUMBER)
+		{
+			if (json_is_number (value_p))
+				{
+					double value = json_number_value (value_p);
+
+					PrintNumber (printer_p, key_s, &value, required_flag, format_s);
+				}
+			else if (full_flag)
+				{
+					PrintNumber (printer_p, key_s, NULL, required_flag, format_s);
+				}
+
+		}		/* else if (type == ST_NUMBER) */
+	else if (type == ST_BOOLEAN)
+		{
+			if (json_is_boolean (value_p))
+				{
+					bool value = json_is_true (value_p);
+
+					PrintBoolean (printer_p, key_s, &value, required_flag, format_s);
+				}
+			else if (full_flag)
+				{
+					PrintBoolean (printer_p, key_s, NULL, required_flag, format_s);
+				}
+
+		}		/* else if (type == ST_BOOLEAN) */
+
+}
+
+
+/*
+ * Replace the schema with the one that a ref points to
+ */
+static bool ResolveScope (SchemaScope *scope_p, const char *ref_s, const SchemaParser *parser_p)
+{
+	const json_t *document_p = NULL;
+	const char *url_s = NULL;
+	const json_t *schema_p = ResolveSchemaRef (parser_p -> sp_schema_cache_p, scope_p -> ss_document_p, scope_p -> ss_url_s, ref_s, &document_p, &url_s);
+
+	if (schema_p)
+		{
+			scope_p -> ss_schema_p = schema_p;
+			scope_p -> ss_document_p = document_p;
+			scope_p -> ss_url_s = url_s;
+
+			return true;
+		}
+
+	return false;
+}
+
+
+/*
+ * For an anyOf or oneOf schema, use the first of its
+ * schemas that the value matches.
+ */
+static void SelectSubschema (SchemaScope *scope_p, const json_t *value_p, const SchemaParser *parser_p)
+{
+	const json_t *subschemas_p = json_object_get (scope_p -> ss_schema_p, S_ANY_OF_S);
+
+	if (!subschemas_p)
+		{
+			subschemas_p = json_object_get (scope_p -> ss_schema_p, S_ONE_OF_S);
+		}
+
+	if (json_is_array (subschemas_p))
+		{
+			SchemaScope first_scope;
+			bool first_flag = false;
+			const json_t *subschema_p;
+			size_t i;
+
+			json_array_foreach (subschemas_p, i, subschema_p)
+				{
+					SchemaScope subschema_scope = *scope_p;
+					const char *ref_s = GetJSONString (subschema_p, S_REF_S);
+					bool resolved_flag = true;
+
+					subschema_scope.ss_schema_p = subschema_p;
+
+					if (ref_s)
+						{
+							resolved_flag = ResolveScope (&subschema_scope, ref_s, parser_p);
+						}
+
+					if (resolved_flag)
+						{
+							if (DoesSchemaMatchValue (&subschema_scope, value_p, parser_p))
+								{
+									*scope_p = subschema_scope;
+									return;
+								}
+
+							if (!first_flag)
+								{
+									first_scope = subschema_scope;
+									first_flag = true;
+								}
+						}
+				}
+
+			/* If nothing matches, fall back to the first schema */
+			if (first_flag)
+				{
+					*scope_p = first_scope;
+				}
+		}
+}
+
+
+static bool DoesSchemaMatchValue (const SchemaScope *scope_p, const json_t *value_p, const SchemaParser *parser_p)
+{
+	bool match_flag = false;
+	const json_t *schema_p = scope_p -> ss_schema_p;
+
+	if (json_object_get (schema_p, S_ANY_OF_S) || json_object_get (schema_p, S_ONE_OF_S))
+		{
+			SchemaScope nested_scope = *scope_p;
+
+			SelectSubschema (&nested_scope, value_p, parser_p);
+
+			if (nested_scope.ss_schema_p != schema_p)
+				{
+					match_flag = DoesSchemaMatchValue (&nested_scope, value_p, parser_p);
+				}
+		}
+	else
+		{
+			const SchemaType type = GetSchemaType (schema_p, value_p);
+
+			if (type != ST_NONE)
+				{
+					match_flag = DoesTypeMatchValue (type, value_p);
+
+					/*
+					 * Objects also need all of their required keys
+					 */
+					if (match_flag && (type == ST_OBJECT))
+						{
+							const json_t *required_entries_p = json_object_get (schema_p, S_REQUIRED_S);
+							const json_t *entry_p;
+							size_t i;
+
+							json_array_foreach (required_entries_p, i, entry_p)
+								{
+									if ((json_is_string (entry_p)) && (!json_object_get (value_p, json_string_value (entry_p))))
+										{
+											match_flag = false;
+											break;
+										}
+								}
+						}
+				}
+		}
+
+	return match_flag;
+}
+
+
+/*
+ * Get the type of a schema. If it allows several types
+ * then use the one that matches the value.
+ */
+static SchemaType GetSchemaType (const json_t *schema_p, const json_t *value_p)
+{
+	SchemaType type = ST_NONE;
+	const json_t *type_p = json_object_get (schema_p, FD_TABLE_FIELD_TYPE);
+
+	if (json_is_string (type_p))
+		{
+			type = GetSchemaTypeFromName (json_string_value (type_p));
+		}
+	else if (json_is_array (type_p))
+		{
+			const json_t *entry_p;
+			size_t i;
+
+			json_array_foreach (type_p, i, entry_p)
+				{
+					if (json_is_string (entry_p))
+						{
+							const SchemaType entry_type = GetSchemaTypeFromName (json_string_value (entry_p));
+
+							if (DoesTypeMatchValue (entry_type, value_p))
+								{
+									type = entry_type;
+									break;
+								}
+							else if (type == ST_NONE)
+								{
+									type = entry_type;
+								}
+						}
+				}
+		}
+	else if (json_object_get (schema_p, S_PROPERTIES_S))
+		{
+			type = ST_OBJECT;
+		}
+
+	return type;
+}
+
+
+static SchemaType GetSchemaTypeFromName (const char *type_s)
+{
+	SchemaType type = ST_OTHER;
+
+	/* Check the first character so that at most one full comparison is needed */
+	switch (*type_s)
+		{
+			case 'o':
+				if (strcmp (type_s, S_TYPE_OBJECT_S) == 0)
+					{
+						type = ST_OBJECT;
+					}
+				break;
+
+			case 'a':
+				if (strcmp (type_s, FD_TYPE_JSON_ARRAY) == 0)
+					{
+						type = ST_ARRAY;
+					}
+				break;
+
+			case 's':
+				if (strcmp (type_s, FD_TYPE_STRING) == 0)
+					{
+						type = ST_STRING;
+					}
+				break;
+
+			case 'i':
+				if (strcmp (type_s, FD_TYPE_INTEGER) == 0)
+					{
+						type = ST_INTEGER;
+					}
+				break;
+
+			case 'n':
+				if (strcmp (type_s, FD_TYPE_NUMBER) == 0)
+					{
+						type = ST_NUMBER;
+					}
+				break;
+
+			case 'b':
+				if (strcmp (type_s, FD_TYPE_BOOLEAN) == 0)
+					{
+						type = ST_BOOLEAN;
+					}
+				break;
+
+			default:
+				break;
+		}
+
+	return type;
+}
+
+
+static bool DoesTypeMatchValue (const SchemaType type, const json_t *value_p)
+{
+	bool match_flag = false;
+
+	if (!value_p)
+		{
+			return false;
+		}
+
+	switch (json_typeof (value_p))
+		{
+			case JSON_OBJECT:
+				match_flag = (type == ST_OBJECT);
+				break;
+
+			case JSON_ARRAY:
+				match_flag = (type == ST_ARRAY);
+				break;
+
+			case JSON_STRING:
+				match_flag = (type == ST_STRING);
+				break;
+
+			case JSON_INTEGER:
+				match_flag = (type == ST_INTEGER) || (type == ST_NUMBER);
+				break;
+
+			case JSON_REAL:
+				match_flag = (type == ST_NUMBER);
+				break;
+
+			case JSON_TRUE:
+			case JSON_FALSE:
+				match_flag = (type == ST_BOOLEAN);
+				break;
+
+			default:
+				break;
+		}
+
+	return match_flag;
+}
@@ -0,0 +1,916 @@
+/*
+ * template_printer.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "template_printer.h"
+#include "html_escape.h"
+
+#include "string_utils.h"
+#include "byte_buffer.h"
+
+
+typedef struct
+{
+	Printer tp_printer;
+	PrinterTemplate *tp_template_p;
+} TemplatePrinter;
+
+
+typedef struct
+{
+	const char *tn_name_s;
+	int tn_value;
+} TemplateName;
+
+
+static const TemplateName S_FRAGMENT_NAMES [] =
+{
+	{ "header", TF_HEADER },
+	{ "footer", TF_FOOTER },
+	{ "text", TF_TEXT },
+	{ "section_start", TF_SECTION_START },
+	{ "section_end", TF_SECTION_END },
+	{ "entry_start", TF_ENTRY_START },
+	{ "entry_end", TF_ENTRY_END },
+	{ "string", TF_STRING },
+	{ "integer", TF_INTEGER },
+	{ "number", TF_NUMBER },
+	{ "boolean", TF_BOOLEAN },
+	{ "json", TF_JSON },
+	{ "required", TF_REQUIRED },
+	{ NULL, 0 }
+};
+
+
+static const TemplateName S_SLOT_NAMES [] =
+{
+	{ "title", TS_TITLE },
+	{ "text", TS_TEXT },
+	{ "key", TS_KEY },
+	{ "value", TS_VALUE },
+	{ "format", TS_FORMAT },
+	{ "required", TS_REQUIRED },
+	{ NULL, 0 }
+};
+
+
+static const char * const S_DIRECTIVE_S = "%%";
+
+static const char * const S_DEFAULT_EXTENSION_S = "txt";
+
+static const uint64_t S_FNV_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+static const uint64_t S_FNV_PRIME = 0x00000100000001B3ULL;
+
+
+/*
+ * static declarations
+ */
+
+static bool PrintTemplateHeader (Printer *printer_p, const char *title_s, const char *text_s);
+
+static bool PrintTemplateFooter (Printer *printer_p, const char *text_s);
+
+static bool PrintTemplateText (Printer *printer_p, const char *value_s);
+
+static bool PrintTemplateString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s);
+
+static bool PrintTemplateInteger (Printer *printer_p, const char *key_s, const json_int_t *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintTemplateNumber (Printer *printer_p, const char *key_s, const double *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintTemplateBoolean (Printer *printer_p, const char *key_s, const bool *value_p, const bool required_flag, const char *format_s);
+
+static bool PrintTemplateJSON (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s);
+
+static void FreeTemplatePrinter (Printer *printer_p);
+
+static bool PrintTemplateSectionStart (Printer *printer_p, const char *value_s);
+
+static bool PrintTemplateSectionEnd (Printer *printer_p, const char *value_s);
+
+static bool PrintTemplateEntryStart (Printer *printer_p);
+
+static bool PrintTemplateEntryEnd (Printer *printer_p);
+
+static bool PrintTemplateValue (Printer *printer_p, const TemplateFragmentType fragment_type, const char *key_s, const char *value_s, const bool required_flag, const char *format_s);
+
+static bool RunTemplateFragment (TemplatePrinter *printer_p, const TemplateFragment *fragment_p, const char * const *values_ss, const bool required_flag);
+
+static bool AppendTemplateJSONChunk (const char *chunk_s, const size_t length, void *data_p);
+
+static char *LoadTemplateSource (const char *filename_s, size_t *length_p);
+
+static bool CompileTemplate (PrinterTemplate *template_p, const char *filename_s);
+
+static bool ParseTemplateDirective (PrinterTemplate *template_p, const char *line_s, const char *end_s, TemplateFragment **fragment_pp, TemplateFragmentType *fragment_type_p, const char *filename_s, const size_t line_number);
+
+static bool CompileTemplateText (PrinterTemplate *template_p, TemplateFragment *fragment_p, const TemplateFragmentType fragment_type, const char *start_s, const char *end_s, const char *filename_s, const size_t line_number);
+
+static bool AddTemplateOp (PrinterTemplate *template_p, TemplateFragment *fragment_p, const TemplateOpType op_type, const size_t offset, const size_t length, const TemplateSlot slot);
+
+static int GetTemplateName (const TemplateName *names_p, const char *name_s, const size_t length);
+
+static const char *FindTemplateDelimiter (const char *start_s, const char *end_s, const char c);
+
+
+/*
+ * api definitions
+ */
+
+PrinterTemplate *LoadPrinterTemplate (const char *filename_s)
+{
+	PrinterTemplate *template_p = (PrinterTemplate *) malloc (sizeof (PrinterTemplate));
+
+	if (template_p)
+		{
+			size_t length = 0;
+
+			memset (template_p, 0, sizeof (PrinterTemplate));
+			template_p -> pt_escaping = TE_NONE;
+
+			template_p -> pt_source_s = LoadTemplateSource (filename_s, &length);
+
+			if (template_p -> pt_source_s)
+				{
+					const unsigned char *c_p = (const unsigned char *) (template_p -> pt_source_s);
+					size_t i;
+
+					template_p -> pt_digest = S_FNV_OFFSET_BASIS;
+
+					for (i = 0; i < length; ++ i, ++ c_p)
+						{
+							template_p -> pt_digest ^= *c_p;
+							template_p -> pt_digest *= S_FNV_PRIME;
+						}
+
+					if (CompileTemplate (template_p, filename_s))
+						{
+							if (! (template_p -> pt_extension_s))
+								{
+									template_p -> pt_extension_s = EasyCopyToNewString (S_DEFAULT_EXTENSION_S);
+								}
+
+							if (template_p -> pt_extension_s)
+								{
+									return template_p;
+								}
+						}
+				}
+
+			FreePrinterTemplate (template_p);
+		}
+
+	return NULL;
+}
+
+
+void FreePrinterTemplate (PrinterTemplate *template_p)
+{
+	size_t i;
+
+	for (i = 0; i < template_p -> pt_num_string_formats; ++ i)
+		{
+			FreeCopiedString (template_p -> pt_string_formats_p [i].tff_format_s);
+		}
+
+	if (template_p -> pt_string_formats_p)
+		{
+			free (template_p -> pt_string_formats_p);
+		}
+
+	if (template_p -> pt_ops_p)
+		{
+			free (template_p -> pt_ops_p);
+		}
+
+	if (template_p -> pt_extension_s)
+		{
+			FreeCopiedString (template_p -> pt_extension_s);
+		}
+
+	if (template_p -> pt_source_s)
+		{
+			free (template_p -> pt_source_s);
+		}
+
+	free (template_p);
+}
+
+
+Printer *AllocateTemplatePrinter (PrinterTemplate *template_p)
+{
+	TemplatePrinter *printer_p = (TemplatePrinter *) malloc (sizeof (TemplatePrinter));
+
+	if (printer_p)
+		{
+			InitFDPrinter (& (printer_p -> tp_printer), PrintTemplateHeader, PrintTemplateFooter, PrintTemplateText,
+										 PrintTemplateSectionStart, PrintTemplateSectionEnd, PrintTemplateString,
+										 PrintTemplateInteger, PrintTemplateNumber, PrintTemplateBoolean, PrintTemplateJSON, FreeTemplatePrinter);
+
+			SetFDPrinterEntryFunctions (& (printer_p -> tp_printer), PrintTemplateEntryStart, PrintTemplateEntryEnd);
+
+			printer_p -> tp_template_p = template_p;
+
+			return (& (printer_p -> tp_printer));
+		}
+
+	return NULL;
+}
+
+
+/*
+ * static definitions
+ */
+
+static bool PrintTemplateHeader (Printer *printer_p, const char *title_s, const char *text_s)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	values_ss [TS_TITLE] = title_s;
+	values_ss [TS_TEXT] = text_s;
+
+	return RunTemplateFragment (tmpl_printer_p, & (tmpl_printer_p -> tp_template_p -> pt_fragments [TF_HEADER]), values_ss, false);
+}
+
+
+static bool PrintTemplateFooter (Printer *printer_p, const char *text_s)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	values_ss [TS_TEXT] = text_s;
+
+	return RunTemplateFragment (tmpl_printer_p, & (tmpl_printer_p -> tp_template_p -> pt_fragments [TF_FOOTER]), values_ss, false);
+}
+
+
+static bool PrintTemplateText (Printer *printer_p, const char *value_s)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	values_ss [TS_TEXT] = value_s;
+	values_ss [TS_VALUE] = value_s;
+
+	return RunTemplateFragment (tmpl_printer_p, & (tmpl_printer_p -> tp_template_p -> pt_fragments [TF_TEXT]), values_ss, false);
+}
+
+
+static bool PrintTemplateString (Printer *printer_p, const char *key_s, const char *value_s, const bool required_flag, const char *format_s)
+{
+	return PrintTemplateValue (printer_p, TF_STRING, key_s, value_s, required_flag, format_s);
+}
+
+
+static bool PrintTemplateInteger (Printer *printer_p, const char *key_s, const json_int_t *value_p, const bool required_flag, const char *format_s)
+{
+	char buffer_s [32];
+	const char *value_s = NULL;
+
+	if (value_p)
+		{
+			snprintf (buffer_s, sizeof (buffer_s), "%" JSON_INTEGER_FORMAT, *value_p);
+			value_s = buffer_s;
+		}
+
+	return PrintTemplateValue (printer_p, TF_INTEGER, key_s, value_s, required_flag, format_s);
+}
+
+
+static bool PrintTemplateNumber (Printer *printer_p, const char *key_s, const double *value_p, const bool required_flag, const char *format_s)
+{
+	char buffer_s [512];
+	const char *value_s = NULL;
+
+	if (value_p)
+		{
+			snprintf (buffer_s, sizeof (buffer_s), "%lf", *value_p);
+			value_s = buffer_s;
+		}
+
+	return PrintTemplateValue (printer_p, TF_NUMBER, key_s, value_s, required_flag, format_s);
+}
+
+
+static bool PrintTemplateBoolean (Printer *printer_p, const char *key_s, const bool *value_p, const bool required_flag, const char *format_s)
+{
+	const char *value_s = NULL;
+
+	if (value_p)
+		{
+			value_s = (*value_p) ? "true" : "false";
+		}
+
+	return PrintTemplateValue (printer_p, TF_BOOLEAN, key_s, value_s, required_flag, format_s);
+}
+
+
+static bool PrintTemplateJSON (Printer *printer_p, const char *key_s, const json_t *value_p, const bool required_flag, const char *format_s)
+{
+	bool success_flag = false;
+
+	if (value_p)
+		{
+			/*
+			 * The value has to be complete before it can go in a slot, but
+			 * it is still only ever as big as the printer's limit allows.
+			 */
+			ByteBuffer *buffer_p = AllocateByteBuffer (1024);
+
+			if (buffer_p)
+				{
+					bool truncated_flag = false;
+
+					if (StreamJSONValue (value_p, JSON_INDENT (2) | JSON_ENCODE_ANY, printer_p -> pr_json_max_size, AppendTemplateJSONChunk, buffer_p, &truncated_flag))
+						{
+							if ((!truncated_flag) || (AppendStringToByteBuffer (buffer_p, " ...")))
+								{
+									success_flag = PrintTemplateValue (printer_p, TF_JSON, key_s, GetByteBufferData (buffer_p), required_flag, format_s);
+								}
+						}
+
+					FreeByteBuffer (buffer_p);
+				}
+		}
+	else
+		{
+			success_flag = PrintTemplateValue (printer_p, TF_JSON, key_s, NULL, required_flag, format_s);
+		}
+
+	return success_flag;
+}
+
+
+static bool AppendTemplateJSONChunk (const char *chunk_s, const size_t length, void *data_p)
+{
+	return AppendToByteBuffer ((ByteBuffer *) data_p, chunk_s, length);
+}
+
+
+static void FreeTemplatePrinter (Printer *printer_p)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+
+	FreePrinterTemplate (tmpl_printer_p -> tp_template_p);
+	free (tmpl_printer_p);
+}
+
+
+static bool PrintTemplateSectionStart (Printer *printer_p, const char *value_s)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	values_ss [TS_TITLE] = value_s;
+	values_ss [TS_KEY] = value_s;
+
+	return RunTemplateFragment (tmpl_printer_p, & (tmpl_printer_p -> tp_template_p -> pt_fragments [TF_SECTION_START]), values_ss, false);
+}
+
+
+static bool PrintTemplateSectionEnd (Printer *printer_p, const char *value_s)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	values_ss [TS_TITLE] = value_s;
+	values_ss [TS_KEY] = value_s;
+
+	return RunTemplateFragment (tmpl_printer_p, & (tmpl_printer_p -> tp_template_p -> pt_fragments [TF_SECTION_END]), values_ss, false);
+}
+
+
+static bool PrintTemplateEntryStart (Printer *printer_p)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	return RunTemplateFragment (tmpl_printer_p, & (tmpl_printer_p -> tp_template_p -> pt_fragments [TF_ENTRY_START]), values_ss, false);
+}
+
+
+static bool PrintTemplateEntryEnd (Printer *printer_p)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	return RunTemplateFragment (tmpl_printer_p, & (tmpl_printer_p -> tp_template_p -> pt_fragments [TF_ENTRY_END]), values_ss, false);
+}
+
+
+/*
+ * Print a key-value pair using the fragment for its type, falling back
+ * to any fragment for its format and then to the string fragment.
+ */
+static bool PrintTemplateValue (Printer *printer_p, const TemplateFragmentType fragment_type, const char *key_s, const char *value_s, const bool required_flag, const char *format_s)
+{
+	TemplatePrinter *tmpl_printer_p = (TemplatePrinter *) printer_p;
+	const PrinterTemplate *template_p = tmpl_printer_p -> tp_template_p;
+	const TemplateFragment *fragment_p = & (template_p -> pt_fragments [fragment_type]);
+	const char *values_ss [TS_NUM_SLOTS] = { NULL };
+
+	if (! (fragment_p -> tf_defined_flag))
+		{
+			fragment_p = & (template_p -> pt_fragments [TF_STRING]);
+		}
+
+	if (format_s && (fragment_type == TF_STRING))
+		{
+			size_t i;
+
+			for (i = 0; i < template_p -> pt_num_string_formats; ++ i)
+				{
+					if (strcmp (template_p -> pt_string_formats_p [i].tff_format_s, format_s) == 0)
+						{
+							fragment_p = & (template_p -> pt_string_formats_p [i].tff_fragment);
+							i = template_p -> pt_num_string_formats;
+						}
+				}
+		}
+
+	values_ss [TS_KEY] = key_s;
+	values_ss [TS_VALUE] = value_s;
+	values_ss [TS_FORMAT] = format_s;
+
+	return RunTemplateFragment (tmpl_printer_p, fragment_p, values_ss, required_flag);
+}
+
+
+/*
+ * Execute a compiled fragment. Missing values are left empty.
+ */
+static bool RunTemplateFragment (TemplatePrinter *printer_p, const TemplateFragment *fragment_p, const char * const *values_ss, const bool required_flag)
+{
+	const PrinterTemplate *template_p = printer_p -> tp_template_p;
+	FILE *out_f = printer_p -> tp_printer.pr_out_f;
+	const TemplateOp *op_p = template_p -> pt_ops_p + fragment_p -> tf_first_op;
+	const TemplateOp * const end_p = op_p + fragment_p -> tf_num_ops;
+	bool success_flag = true;
+
+	while (success_flag && (op_p < end_p))
+		{
+			if (op_p -> to_type == TO_LITERAL)
+				{
+					success_flag = (fwrite (template_p -> pt_source_s + op_p -> to_offset, 1, op_p -> to_length, out_f) == op_p -> to_length);
+				}
+			else if (op_p -> to_slot == TS_REQUIRED)
+				{
+					if (required_flag)
+						{
+							success_flag = RunTemplateFragment (printer_p, & (template_p -> pt_fragments [TF_REQUIRED]), values_ss, false);
+						}
+				}
+			else
+				{
+					const char *value_s = values_ss [op_p -> to_slot];
+
+					if (value_s)
+						{
+							if ((op_p -> to_type == TO_SLOT) && (template_p -> pt_escaping == TE_HTML))
+								{
+									/* The attribute escaping is also safe for text so values can go in either */
+									success_flag = WriteEscapedHTMLString (out_f, value_s, HE_ATTRIBUTE);
+								}
+							else
+								{
+									success_flag = (fputs (value_s, out_f) >= 0);
+								}
+						}
+				}
+
+			++ op_p;
+		}
+
+	return success_flag;
+}
+
+
+static char *LoadTemplateSource (const char *filename_s, size_t *length_p)
+{
+	char *source_s = NULL;
+	FILE *in_f = fopen (filename_s, "rb");
+
+	if (in_f)
+		{
+			if (fseek (in_f, 0, SEEK_END) == 0)
+				{
+					const long length = ftell (in_f);
+
+					if ((length >= 0) && (fseek (in_f, 0, SEEK_SET) == 0))
+						{
+							source_s = (char *) malloc (length + 1);
+
+							if (source_s)
+								{
+									if (fread (source_s, 1, length, in_f) == (size_t) length)
+										{
+											* (source_s + length) = '\0';
+											*length_p = (size_t) length;
+										}
+									else
+										{
+											free (source_s);
+											source_s = NULL;
+										}
+								}
+						}
+				}
+
+			fclose (in_f);
+		}
+
+	return source_s;
+}
+
+
+/*
+ * Go through the template a line at a time, turning each fragment
+ * into ops so that nothing needs parsing when printing.
+ */
+static bool CompileTemplate (PrinterTemplate *template_p, const char *filename_s)
+{
+	const char *line_s = template_p -> pt_source_s;
+	TemplateFragment *fragment_p = NULL;
+	TemplateFragmentType fragment_type = TF_NUM_FRAGMENTS;
+	size_t line_number = 1;
+	bool success_flag = true;
+
+	while (success_flag && (*line_s != '\0'))
+		{
+			const char *next_s = strchr (line_s, '\n');
+			const char *end_s;
+
+			if (next_s)
+				{
+					++ next_s;
+				}
+			else
+				{
+					next_s = line_s + strlen (line_s);
+				}
+
+			/* The end of the line without the line break */
+			end_s = next_s;
+
+			if ((end_s > line_s) && (* (end_s - 1) == '\n'))
+				{
+					-- end_s;
+
+					if ((end_s > line_s) && (* (end_s - 1) == '\r'))
+						{
+							-- end_s;
+						}
+				}
+
+			if (DoesStringStartWith (line_s, S_DIRECTIVE_S))
+				{
+					success_flag = ParseTemplateDirective (template_p, line_s + strlen (S_DIRECTIVE_S), end_s, &fragment_p, &fragment_type, filename_s, line_number);
+				}
+			else if (fragment_p)
+				{
+					/* A trailing backslash joins this line to the next one */
+					if ((end_s > line_s) && (* (end_s - 1) == '\\'))
+						{
+							success_flag = CompileTemplateText (template_p, fragment_p, fragment_type, line_s, end_s - 1, filename_s, line_number);
+						}
+					else
+						{
+							success_flag = CompileTemplateText (template_p, fragment_p, fragment_type, line_s, next_s, filename_s, line_number);
+						}
+				}
+
+			line_s = next_s;
+			++ line_number;
+		}
+
+	return success_flag;
+}
+
+
+static bool ParseTemplateDirective (PrinterTemplate *template_p, const char *line_s, const char *end_s, TemplateFragment **fragment_pp, TemplateFragmentType *fragment_type_p, const char *filename_s, const size_t line_number)
+{
+	const char *name_s = line_s;
+	const char *name_end_s;
+	const char *arg_s;
+	const char *arg_end_s = end_s;
+	int fragment_type;
+	bool success_flag = false;
+
+	while ((name_s < end_s) && ((*name_s == ' ') || (*name_s == '\t')))
+		{
+			++ name_s;
+		}
+
+	name_end_s = name_s;
+
+	while ((name_end_s < end_s) && (*name_end_s != ' ') && (*name_end_s != '\t'))
+		{
+			++ name_end_s;
+		}
+
+	arg_s = name_end_s;
+
+	while ((arg_s < end_s) && ((*arg_s == ' ') || (*arg_s == '\t')))
+		{
+			++ arg_s;
+		}
+
+	while ((arg_end_s > arg_s) && ((* (arg_end_s - 1) == ' ') || (* (arg_end_s - 1) == '\t')))
+		{
+			-- arg_end_s;
+		}
+
+	fragment_type = GetTemplateName (S_FRAGMENT_NAMES, name_s, name_end_s - name_s);
+
+	if (fragment_type >= 0)
+		{
+			TemplateFragment *fragment_p = & (template_p -> pt_fragments [fragment_type]);
+
+			if (arg_s < arg_end_s)
+				{
+					fragment_p = NULL;
+
+					/* Only strings have formats */
+					if (fragment_type == TF_STRING)
+						{
+							const size_t format_length = arg_end_s - arg_s;
+							TemplateFormatFragment *formats_p = NULL;
+							size_t i;
+
+							for (i = 0; i < template_p -> pt_num_string_formats; ++ i)
+								{
+									const char *format_s = template_p -> pt_string_formats_p [i].tff_format_s;
+
+									if ((strncmp (format_s, arg_s, format_length) == 0) && (format_s [format_length] == '\0'))
+										{
+											break;
+										}
+								}
+
+							if (i == template_p -> pt_num_string_formats)
+								{
+									formats_p = (TemplateFormatFragment *) realloc (template_p -> pt_string_formats_p, (template_p -> pt_num_string_formats + 1) * sizeof (TemplateFormatFragment));
+								}
+							else
+								{
+									fprintf (stderr, "%s:%lu: the string fragment for this format is already defined\n", filename_s, (unsigned long) line_number);
+								}
+
+							if (formats_p)
+								{
+									TemplateFormatFragment *format_p = formats_p + template_p -> pt_num_string_formats;
+
+									template_p -> pt_string_formats_p = formats_p;
+									memset (format_p, 0, sizeof (TemplateFormatFragment));
+
+									format_p -> tff_format_s = CopyToNewString (arg_s, arg_end_s - arg_s, false);
+
+									if (format_p -> tff_format_s)
+										{
+											++ (template_p -> pt_num_string_formats);
+											fragment_p = & (format_p -> tff_fragment);
+										}
+								}
+						}
+					else
+						{
+							fprintf (stderr, "%s:%lu: only the string fragment can have a format\n", filename_s, (unsigned long) line_number);
+						}
+				}
+
+			if (fragment_p)
+				{
+					if (! (fragment_p -> tf_defined_flag))
+						{
+							fragment_p -> tf_first_op = template_p -> pt_num_ops;
+							fragment_p -> tf_num_ops = 0;
+							fragment_p -> tf_defined_flag = true;
+
+							*fragment_pp = fragment_p;
+							*fragment_type_p = (TemplateFragmentType) fragment_type;
+
+							success_flag = true;
+						}
+					else
+						{
+							fprintf (stderr, "%s:%lu: the fragment is already defined\n", filename_s, (unsigned long) line_number);
+						}
+				}
+		}
+	else
+		{
+			char *arg_copy_s = CopyToNewString (arg_s, arg_end_s - arg_s, false);
+
+			if (arg_copy_s)
+				{
+					const size_t name_length = name_end_s - name_s;
+
+					if ((name_length == 9) && (strncmp (name_s, "extension", name_length) == 0) && (*arg_copy_s != '\0'))
+						{
+							if (template_p -> pt_extension_s)
+								{
+									FreeCopiedString (template_p -> pt_extension_s);
+								}
+
+							template_p -> pt_extension_s = arg_copy_s;
+							arg_copy_s = NULL;
+							success_flag = true;
+						}
+					else if ((name_length == 6) && (strncmp (name_s, "escape", name_length) == 0))
+						{
+							if (strcmp (arg_copy_s, "html") == 0)
+								{
+									template_p -> pt_escaping = TE_HTML;
+									success_flag = true;
+								}
+							else if (strcmp (arg_copy_s, "none") == 0)
+								{
+									template_p -> pt_escaping = TE_NONE;
+									success_flag = true;
+								}
+							else
+								{
+									fprintf (stderr, "%s:%lu: unknown escaping \"%s\"\n", filename_s, (unsigned long) line_number, arg_copy_s);
+								}
+						}
+					else
+						{
+							fprintf (stderr, "%s:%lu: unknown directive\n", filename_s, (unsigned long) line_number);
+						}
+
+					if (arg_copy_s)
+						{
+							FreeCopiedString (arg_copy_s);
+						}
+				}
+
+			/* Settings end any fragment */
+			*fragment_pp = NULL;
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Split a run of text into literals and slots.
+ */
+static bool CompileTemplateText (PrinterTemplate *template_p, TemplateFragment *fragment_p, const TemplateFragmentType fragment_type, const char *start_s, const char *end_s, const char *filename_s, const size_t line_number)
+{
+	const char *c_p = start_s;
+	bool success_flag = true;
+
+	while (success_flag && (c_p < end_s))
+		{
+			const char *slot_s = FindTemplateDelimiter (c_p, end_s, '{');
+
+			if (slot_s > c_p)
+				{
+					success_flag = AddTemplateOp (template_p, fragment_p, TO_LITERAL, c_p - template_p -> pt_source_s, slot_s - c_p, TS_NUM_SLOTS);
+				}
+
+			if (success_flag && (slot_s < end_s))
+				{
+					const char *name_s = slot_s + 2;
+					const char *slot_end_s = FindTemplateDelimiter (name_s, end_s, '}');
+
+					success_flag = false;
+
+					if (slot_end_s < end_s)
+						{
+							TemplateOpType op_type = TO_SLOT;
+							int slot;
+
+							if (*name_s == '&')
+								{
+									op_type = TO_RAW_SLOT;
+									++ name_s;
+								}
+
+							slot = GetTemplateName (S_SLOT_NAMES, name_s, slot_end_s - name_s);
+
+							if (slot < 0)
+								{
+									fprintf (stderr, "%s:%lu: unknown slot \"%.*s\"\n", filename_s, (unsigned long) line_number, (int) (slot_end_s - name_s), name_s);
+								}
+							else if ((slot == TS_REQUIRED) && (fragment_type == TF_REQUIRED))
+								{
+									fprintf (stderr, "%s:%lu: the required fragment cannot contain itself\n", filename_s, (unsigned long) line_number);
+								}
+							else
+								{
+									success_flag = AddTemplateOp (template_p, fragment_p, op_type, 0, 0, (TemplateSlot) slot);
+									c_p = slot_end_s + 2;
+								}
+						}
+					else
+						{
+							fprintf (stderr, "%s:%lu: unterminated slot\n", filename_s, (unsigned long) line_number);
+						}
+				}
+			else
+				{
+					c_p = end_s;
+				}
+		}
+
+	return success_flag;
+}
+
+
+/*
+ * Add an op to the end of the fragment, joining adjacent
+ * literals so that each run is copied in one go.
+ */
+static bool AddTemplateOp (PrinterTemplate *template_p, TemplateFragment *fragment_p, const TemplateOpType op_type, const size_t offset, const size_t length, const TemplateSlot slot)
+{
+	TemplateOp *op_p;
+
+	if ((op_type == TO_LITERAL) && (fragment_p -> tf_num_ops > 0))
+		{
+			op_p = template_p -> pt_ops_p + template_p -> pt_num_ops - 1;
+
+			if ((op_p -> to_type == TO_LITERAL) && (op_p -> to_offset + op_p -> to_length == offset))
+				{
+					op_p -> to_length += length;
+					return true;
+				}
+		}
+
+	if (template_p -> pt_num_ops == template_p -> pt_ops_capacity)
+		{
+			const size_t capacity = (template_p -> pt_ops_capacity > 0) ? (template_p -> pt_ops_capacity << 1) : 32;
+			TemplateOp *ops_p = (TemplateOp *) realloc (template_p -> pt_ops_p, capacity * sizeof (TemplateOp));
+
+			if (!ops_p)
+				{
+					return false;
+				}
+
+			template_p -> pt_ops_p = ops_p;
+			template_p -> pt_ops_capacity = capacity;
+		}
+
+	op_p = template_p -> pt_ops_p + template_p -> pt_num_ops;
+	op_p -> to_type = op_type;
+	op_p -> to_offset = offset;
+	op_p -> to_length = length;
+	op_p -> to_slot = slot;
+
+	++ (template_p -> pt_num_ops);
+	++ (fragment_p -> tf_num_ops);
+
+	return true;
+}
+
+
+static int GetTemplateName (const TemplateName *names_p, const char *name_s, const size_t length)
+{
+	while (names_p -> tn_name_s)
+		{
+			if ((strlen (names_p -> tn_name_s) == length) && (strncmp (names_p -> tn_name_s, name_s, length) == 0))
+				{
+					return names_p -> tn_value;
+				}
+
+			++ names_p;
+		}
+
+	return -1;
+}
+
+
+/*
+ * Find the first pair of the given character within the line,
+ * returning end_s if there isn't one.
+ */
+static const char *FindTemplateDelimiter (const char *start_s, const char *end_s, const char c)
+{
+	const char *c_p = start_s;
+
+	while (c_p < end_s)
+		{
+			c_p = (const char *) memchr (c_p, c, end_s - c_p);
+
+			if (!c_p)
+				{
+					return end_s;
+				}
+
+			if ((c_p + 1 < end_s) && (* (c_p + 1) == c))
+				{
+					return c_p;
+				}
+
+			++ c_p;
+		}
+
+	return end_s;
+}
@@ -0,0 +1,472 @@
+/*
+ * tool_stats.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: billy
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef WINDOWS
+	#include <windows.h>
+#endif
+
+#include "tool_stats.h"
+
+#include "json_util.h"
+#include "string_utils.h"
+
+
+static const char * const S_PHASE_NAMES [SP_NUM_PHASES] = { "json_load", "schema_fetch", "schema_parse", "render", "csv_write", "close" };
+
+static const double S_PERCENTILES [] = { 50.0, 90.0, 99.0, 99.9 };
+
+static const char * const S_PERCENTILE_NAMES [] = { "p50_ms", "p90_ms", "p99_ms", "p99_9_ms" };
+
+#define S_NUM_PERCENTILES (sizeof (S_PERCENTILES) / sizeof (S_PERCENTILES [0]))
+
+
+/*
+ * static declarations
+ */
+
+static bool AddTraceEvent (ToolStats *stats_p, const StatsPhase phase, const double start, const double duration, const char *detail_s);
+
+static json_t *GetResourceTimingsAsJSON (const ToolStats *stats_p);
+
+
+/*
+ * api definitions
+ */
+
+ToolStats *AllocateToolStats (const bool trace_flag, const size_t max_slowest)
+{
+	ToolStats *stats_p = (ToolStats *) calloc (1, sizeof (ToolStats));
+
+	if (stats_p)
+		{
+			bool success_flag = false;
+
+			stats_p -> ts_start_wall = GetWallClockTime ();
+			stats_p -> ts_resource_times_p = AllocateLatencyHistogram ();
+
+			if (stats_p -> ts_resource_times_p)
+				{
+					if (max_slowest > 0)
+						{
+							stats_p -> ts_slowest_p = (ResourceTiming *) calloc (max_slowest, sizeof (ResourceTiming));
+
+							if (stats_p -> ts_slowest_p)
+								{
+									stats_p -> ts_max_slowest = max_slowest;
+									success_flag = true;
+								}
+						}
+					else
+						{
+							success_flag = true;
+						}
+
+					if (success_flag && trace_flag)
+						{
+							stats_p -> ts_trace_events_p = json_array ();
+
+							if (! (stats_p -> ts_trace_events_p))
+								{
+									success_flag = false;
+								}
+						}
+				}
+
+			if (!success_flag)
+				{
+					FreeToolStats (stats_p);
+					stats_p = NULL;
+				}
+		}
+
+	return stats_p;
+}
+
+
+void FreeToolStats (ToolStats *stats_p)
+{
+	if (stats_p -> ts_trace_events_p)
+		{
+			json_decref (stats_p -> ts_trace_events_p);
+		}
+
+	if (stats_p -> ts_slowest_p)
+		{
+			size_t i;
+
+			for (i = 0; i < stats_p -> ts_num_slowest; ++ i)
+				{
+					FreeCopiedString (stats_p -> ts_slowest_p [i].rt_name_s);
+				}
+
+			free (stats_p -> ts_slowest_p);
+		}
+
+	if (stats_p -> ts_resource_times_p)
+		{
+			FreeLatencyHistogram (stats_p -> ts_resource_times_p);
+		}
+
+	free (stats_p);
+}
+
+
+void StartStatsTimer (ToolStats *stats_p, StatsTimer *timer_p, const StatsPhase phase)
+{
+	if (stats_p)
+		{
+			timer_p -> st_phase = phase;
+			timer_p -> st_child_wall = 0.0;
+			timer_p -> st_child_cpu = 0.0;
+			timer_p -> st_parent_p = stats_p -> ts_current_timer_p;
+
+			stats_p -> ts_current_timer_p = timer_p;
+
+			timer_p -> st_start_cpu = GetCPUTime ();
+			timer_p -> st_start_wall = GetWallClockTime ();
+		}
+}
+
+
+void StopStatsTimer (ToolStats *stats_p, StatsTimer *timer_p, const char *detail_s)
+{
+	if (stats_p)
+		{
+			const double wall = GetWallClockTime () - (timer_p -> st_start_wall);
+			const double cpu = GetCPUTime () - (timer_p -> st_start_cpu);
+			const StatsPhase phase = timer_p -> st_phase;
+
+			stats_p -> ts_wall_times [phase] += wall - (timer_p -> st_child_wall);
+			stats_p -> ts_cpu_times [phase] += cpu - (timer_p -> st_child_cpu);
+			++ (stats_p -> ts_phase_counts [phase]);
+
+			if (timer_p -> st_parent_p)
+				{
+					timer_p -> st_parent_p -> st_child_wall += wall;
+					timer_p -> st_parent_p -> st_child_cpu += cpu;
+				}
+
+			stats_p -> ts_current_timer_p = timer_p -> st_parent_p;
+
+			if (stats_p -> ts_trace_events_p)
+				{
+					AddTraceEvent (stats_p, phase, timer_p -> st_start_wall, wall, detail_s);
+				}
+		}
+}
+
+
+void AddResourceTiming (ToolStats *stats_p, const char *name_s, const double wall, const size_t bytes)
+{
+	if (stats_p)
+		{
+			const double micros = wall * 1.0e6;
+			size_t i = stats_p -> ts_num_slowest;
+
+			AddLatencyHistogramValue (stats_p -> ts_resource_times_p, (micros > 0.0) ? (uint64_t) micros : 0);
+
+			/*
+			 * The list is short and kept in order, so most resources are
+			 * rejected by the comparison with the last entry.
+			 */
+			if ((i < stats_p -> ts_max_slowest) || ((i > 0) && (wall > stats_p -> ts_slowest_p [i - 1].rt_wall)))
+				{
+					ResourceTiming *timings_p = stats_p -> ts_slowest_p;
+					char *copied_name_s = EasyCopyToNewString (name_s ? name_s : "");
+
+					if (copied_name_s)
+						{
+							if (i == stats_p -> ts_max_slowest)
+								{
+									-- i;
+									FreeCopiedString (timings_p [i].rt_name_s);
+								}
+							else
+								{
+									++ (stats_p -> ts_num_slowest);
+								}
+
+							while ((i > 0) && (wall > timings_p [i - 1].rt_wall))
+								{
+									timings_p [i] = timings_p [i - 1];
+									-- i;
+								}
+
+							timings_p [i].rt_name_s = copied_name_s;
+							timings_p [i].rt_wall = wall;
+							timings_p [i].rt_bytes = bytes;
+						}
+				}
+		}
+}
+
+
+void PrintResourceTimings (const ToolStats *stats_p, FILE *out_f)
+{
+	const LatencyHistogram *histogram_p = stats_p -> ts_resource_times_p;
+	size_t i;
+
+	fprintf (out_f, "Generated %lu resources", (unsigned long) (histogram_p -> lh_total_count));
+
+	if (histogram_p -> lh_total_count > 0)
+		{
+			fprintf (out_f, ", mean %.3f ms", (histogram_p -> lh_sum / (double) (histogram_p -> lh_total_count)) * 1.0e-3);
+
+			for (i = 0; i < S_NUM_PERCENTILES; ++ i)
+				{
+					fprintf (out_f, ", p%g %.3f ms", S_PERCENTILES [i], ((double) GetLatencyHistogramPercentile (histogram_p, S_PERCENTILES [i])) * 1.0e-3);
+				}
+
+			fprintf (out_f, ", max %.3f ms", ((double) (histogram_p -> lh_max)) * 1.0e-3);
+		}
+
+	fprintf (out_f, "\n");
+
+	if (stats_p -> ts_num_slowest > 0)
+		{
+			fprintf (out_f, "\nSlowest resources:\n");
+			fprintf (out_f, "%6s %12s %12s  %s\n", "Rank", "Time (ms)", "Bytes", "Resource");
+
+			for (i = 0; i < stats_p -> ts_num_slowest; ++ i)
+				{
+					const ResourceTiming *timing_p = stats_p -> ts_slowest_p + i;
+
+					fprintf (out_f, "%6lu %12.3f %12lu  %s\n", (unsigned long) (i + 1), (timing_p -> rt_wall) * 1.0e3, (unsigned long) (timing_p -> rt_bytes), timing_p -> rt_name_s);
+				}
+		}
+}
+
+
+bool WriteToolStats (const ToolStats *stats_p, const char *filename_s)
+{
+	bool success_flag = false;
+	json_t *report_p = json_object ();
+
+	if (report_p)
+		{
+			json_t *phases_p = json_object ();
+
+			if (phases_p)
+				{
+					if (json_object_set_new (report_p, "phases", phases_p) == 0)
+						{
+							json_t *counters_p = json_pack ("{s:I,s:I,s:I,s:I,s:I}",
+																							"bytes_written", (json_int_t) stats_p -> ts_bytes_written,
+																							"rows_exported", (json_int_t) stats_p -> ts_rows_exported,
+																							"resources_processed", (json_int_t) stats_p -> ts_resources_processed,
+																							"schema_fetches", (json_int_t) stats_p -> ts_schema_fetches,
+																							"schema_cache_hits", (json_int_t) stats_p -> ts_schema_cache_hits);
+
+							if (counters_p)
+								{
+									if (json_object_set_new (report_p, "counters", counters_p) == 0)
+										{
+											json_t *resources_p = GetResourceTimingsAsJSON (stats_p);
+											size_t i;
+
+											if (resources_p)
+												{
+													if (json_object_set_new (report_p, "resources", resources_p) == 0)
+														{
+															success_flag = SetJSONReal (report_p, "total_wall_s", GetWallClockTime () - (stats_p -> ts_start_wall));
+														}
+													else
+														{
+															json_decref (resources_p);
+														}
+												}
+
+											for (i = 0; (i < SP_NUM_PHASES) && success_flag; ++ i)
+												{
+													json_t *phase_p = json_pack ("{s:f,s:f,s:I}",
+																											 "wall_s", stats_p -> ts_wall_times [i],
+																											 "cpu_s", stats_p -> ts_cpu_times [i],
+																											 "count", (json_int_t) stats_p -> ts_phase_counts [i]);
+
+													if (! ((phase_p) && (json_object_set_new (phases_p, S_PHASE_NAMES [i], phase_p) == 0)))
+														{
+															success_flag = false;
+														}
+												}
+
+											if (success_flag)
+												{
+													if (json_dump_file (report_p, filename_s, JSON_INDENT (2)) != 0)
+														{
+															fprintf (stderr, "Failed to write stats to \"%s\"\n", filename_s);
+															success_flag = false;
+														}
+												}
+										}
+								}
+						}
+					else
+						{
+							json_decref (phases_p);
+						}
+				}
+
+			json_decref (report_p);
+		}
+
+	return success_flag;
+}
+
+
+bool WriteToolStatsTrace (const ToolStats *stats_p, const char *filename_s)
+{
+	bool success_flag = false;
+
+	if (stats_p -> ts_trace_events_p)
+		{
+			json_t *trace_p = json_object ();
+
+			if (trace_p)
+				{
+					if (json_object_set (trace_p, "traceEvents", stats_p -> ts_trace_events_p) == 0)
+						{
+							if (json_dump_file (trace_p, filename_s, JSON_COMPACT) == 0)
+								{
+									success_flag = true;
+								}
+							else
+								{
+									fprintf (stderr, "Failed to write trace to \"%s\"\n", filename_s);
+								}
+						}
+
+					json_decref (trace_p);
+				}
+		}
+
+	return success_flag;
+}
+
+
+double GetWallClockTime (void)
+{
+	#ifdef WINDOWS
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	QueryPerformanceFrequency (&frequency);
+	QueryPerformanceCounter (&counter);
+
+	return ((double) counter.QuadPart) / ((double) frequency.QuadPart);
+	#else
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return ((double) ts.tv_sec) + (((double) ts.tv_nsec) * 1.0e-9);
+	#endif
+}
+
+
+double GetCPUTime (void)
+{
+	return ((double) clock ()) / CLOCKS_PER_SEC;
+}
+
+
+/*
+ * static definitions
+ */
+
+/*
+ * Complete events, "ph": "X", with the times in microseconds since the start of the run
+ */
+static bool AddTraceEvent (ToolStats *stats_p, const StatsPhase phase, const double start, const double duration, const char *detail_s)
+{
+	json_t *event_p = json_pack ("{s:s,s:s,s:f,s:f,s:i,s:i}",
+															 "name", S_PHASE_NAMES [phase],
+															 "ph", "X",
+															 "ts", (start - (stats_p -> ts_start_wall)) * 1.0e6,
+															 "dur", duration * 1.0e6,
+															 "pid", 1,
+															 "tid", 1);
+
+	if (event_p)
+		{
+			if (detail_s)
+				{
+					json_t *args_p = json_pack ("{s:s}", "detail", detail_s);
+
+					if (args_p)
+						{
+							json_object_set_new (event_p, "args", args_p);
+						}
+				}
+
+			if (json_array_append_new (stats_p -> ts_trace_events_p, event_p) == 0)
+				{
+					return true;
+				}
+		}
+
+	return false;
+}
+
+
+static json_t *GetResourceTimingsAsJSON (const ToolStats *stats_p)
+{
+	const LatencyHistogram *histogram_p = stats_p -> ts_resource_times_p;
+	json_t *resources_p = json_pack ("{s:I,s:f,s:f}",
+																	 "count", (json_int_t) (histogram_p -> lh_total_count),
+																	 "mean_ms", (histogram_p -> lh_total_count > 0) ? (histogram_p -> lh_sum / (double) (histogram_p -> lh_total_count)) * 1.0e-3 : 0.0,
+																	 "max_ms", ((double) (histogram_p -> lh_max)) * 1.0e-3);
+
+	if (resources_p)
+		{
+			json_t *slowest_p = json_array ();
+
+			if (slowest_p)
+				{
+					if (json_object_set_new (resources_p, "slowest", slowest_p) == 0)
+						{
+							bool success_flag = true;
+							size_t i;
+
+							for (i = 0; (i < S_NUM_PERCENTILES) && success_flag; ++ i)
+								{
+									success_flag = SetJSONReal (resources_p, S_PERCENTILE_NAMES [i], ((double) GetLatencyHistogramPercentile (histogram_p, S_PERCENTILES [i])) * 1.0e-3);
+								}
+
+							for (i = 0; (i < stats_p -> ts_num_slowest) && success_flag; ++ i)
+								{
+									const ResourceTiming *timing_p = stats_p -> ts_slowest_p + i;
+									json_t *timing_json_p = json_pack ("{s:s,s:f,s:I}",
+																										 "name", timing_p -> rt_name_s,
+																										 "wall_ms", (timing_p -> rt_wall) * 1.0e3,
+																										 "bytes", (json_int_t) (timing_p -> rt_bytes));
+
+									if (! ((timing_json_p) && (json_array_append_new (slowest_p, timing_json_p) == 0)))
+										{
+											success_flag = false;
+										}
+								}
+
+							if (success_flag)
+								{
+									return resources_p;
+								}
+						}
+					else
+						{
+							json_decref (slowest_p);
+						}
+				}
+
+			json_decref (resources_p);
+		}
+
+	return NULL;
+}